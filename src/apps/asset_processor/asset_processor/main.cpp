@@ -1,28 +1,131 @@
+#include <file-processor/Batch.h>
 #include <file-processor/Processor.h>
 
+#include <exception>
 #include <filesystem>
 #include <iostream>
+#include <string>
+#include <string_view>
+#include <vector>
 
 #include <cstdlib>
 
 
-int main(int argc, char * argv[])
-{
-    if(argc != 2)
+namespace {
+
+
+    constexpr std::string_view gCompactVerticesFlag{"--compact-vertices"};
+    constexpr std::string_view gJobsFlag{"--jobs"};
+    constexpr std::string_view gCacheFlag{"--cache"};
+    constexpr std::string_view gReportFlag{"--report"};
+    constexpr std::string_view gForceFlag{"--force"};
+    constexpr std::string_view gVerboseFlag{"--verbose"};
+
+
+    int usage(const char * aProgram)
     {
-        std::cerr << "Usage: " << std::filesystem::path{argv[0]}.filename().string() << " input_model_file\n";
+        std::cerr << "Usage: " << std::filesystem::path{aProgram}.filename().string()
+                  << " [" << gCompactVerticesFlag << "]"
+                  << " [" << gJobsFlag << " N]"
+                  << " [" << gCacheFlag << " cache_file]"
+                  << " [" << gReportFlag << " report.json]"
+                  << " [" << gForceFlag << "]"
+                  << " [" << gVerboseFlag << "]"
+                  << " input..."
+                  << "\n\n"
+                  << "Each input is a model file, a directory (searched recursively for models),"
+                  << " or @manifest (a file listing one input per line).\n"
+                  << "A single model file without batch options is processed with the complete report.\n";
         return EXIT_FAILURE;
     }
 
-    std::filesystem::path inputPath{argv[1]};
 
-    if(!is_regular_file(inputPath))
+} // unnamed namespace
+
+
+int main(int argc, char * argv[])
+{
+    ad::renderer::BatchOptions options;
+    std::vector<std::filesystem::path> inputs;
+    bool batchFlag = false;
+
+    for(int argIdx = 1; argIdx != argc; ++argIdx)
     {
-        std::cerr << "Provided argument should be a file.\n";
-        return EXIT_FAILURE;
+        std::string_view arg{argv[argIdx]};
+        // Flags taking a value
+        if(arg == gJobsFlag || arg == gCacheFlag || arg == gReportFlag)
+        {
+            if(++argIdx == argc)
+            {
+                return usage(argv[0]);
+            }
+            std::string_view value{argv[argIdx]};
+
+            if(arg == gJobsFlag)
+            {
+                try
+                {
+                    options.mJobs = (unsigned int)std::stoul(std::string{value});
+                }
+                catch(std::exception &)
+                {
+                    return usage(argv[0]);
+                }
+            }
+            else if(arg == gCacheFlag)
+            {
+                options.mCacheFile = value;
+            }
+            else
+            {
+                options.mReportFile = value;
+            }
+            batchFlag = true;
+        }
+        else if(arg == gCompactVerticesFlag)
+        {
+            options.mProcessor.mCompactVertices = true;
+        }
+        else if(arg == gForceFlag)
+        {
+            options.mForce = true;
+            batchFlag = true;
+        }
+        else if(arg == gVerboseFlag)
+        {
+            options.mVerbose = true;
+        }
+        else if(arg.starts_with("--"))
+        {
+            return usage(argv[0]);
+        }
+        else
+        {
+            inputs.emplace_back(arg);
+        }
+    }
+
+    if(inputs.empty())
+    {
+        return usage(argv[0]);
     }
 
-    ad::renderer::processModel(inputPath);
+    // Historical single model mode
+    if(!batchFlag && inputs.size() == 1 && is_regular_file(inputs.front()))
+    {
+        ad::renderer::ProcessResult result = ad::renderer::processModel(inputs.front(), options.mProcessor);
+        return result.mSuccess ? EXIT_SUCCESS : EXIT_FAILURE;
+    }
 
-    return EXIT_SUCCESS;
-}
\ No newline at end of file
+    try
+    {
+        std::vector<std::filesystem::path> models = ad::renderer::collectModels(inputs);
+        ad::renderer::BatchResult result = ad::renderer::processBatch(models, options);
+        return result.mFailed == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+    }
+    catch(std::exception & aException)
+    {
+        std::cerr << aException.what() << "\n";
+        return EXIT_FAILURE;
+    }
+}
@@ -1,76 +1,186 @@
 #pragma once
 
 
+#include "SpscQueue.h"
 #include "Timing.h"
 
 #include <math/Color.h>
 
-#include <list>
-#include <mutex>
+#include <array>
+#include <atomic>
+#include <memory>
 #include <optional>
 
+#include <cassert>
+
 
 namespace ad {
 namespace snac {
 
 
-template <class T_state>
-class StateFifo
+/// @brief Hand-off of states from a single producer thread (simulation)
+/// to a single consumer thread (render), without locks nor allocations.
+///
+/// The states are taken from a fixed pool, allocated once at construction.
+/// The producer acquire() a free state, fills it, then push() it.
+/// The consumer pop() published entries, and must release() each state once it does not read it anymore.
+/// Since states are recycled, their containers keep the capacity they grew in previous steps.
+///
+/// @note If the consumer stalls long enough for the pool to be exhausted,
+/// acquire() reclaims the oldest published state, which the consumer will then never see.
+/// This way the most recent states are always the ones available to the consumer.
+template <class T_state, std::size_t N_poolSize = 8>
+class StateRing
 {
+    using Index = std::size_t;
+
+    static_assert(N_poolSize > 0 && (N_poolSize & (N_poolSize - 1)) == 0,
+                  "Pool size must be a power of two, so the published counters wrap consistently.");
+
+    // Avoid false sharing between the producer and the consumer counters.
+    static constexpr std::size_t gCacheLine = 64;
+
 public:
     struct Entry
     {
         Clock::time_point pushTime;
-        std::unique_ptr<T_state> state;
+        T_state * state = nullptr;
     };
 
-
-    void push(std::unique_ptr<T_state> aState)
+    StateRing() :
+        mPool{std::make_unique<T_state[]>(N_poolSize)}
     {
-        std::lock_guard lock{mMutex};
-        mStore.push_back({Clock::now(), std::move(aState)});
+        for(Index i = 0; i != N_poolSize; ++i)
+        {
+            mFree.push(i);
+        }
     }
 
+    //
+    // Producer side
+    //
 
-    Entry pop()
+    /// @brief Return a free state from the pool, reclaiming the oldest published state if the pool is exhausted.
+    /// @return nullptr only if the consumer holds every state of the pool.
+    /// @note The state content is whatever was left by its previous use.
+    T_state * acquire()
     {
-        std::lock_guard lock{mMutex};
-        Entry result = std::move(mStore.front());
-        mStore.pop_front();
-        return result;
+        if(std::optional<Index> index = mFree.pop())
+        {
+            return &mPool[*index];
+        }
+        else if(std::optional<Index> reclaimed = popPublished())
+        {
+            ++mReclaimedCount;
+            return &mPool[*reclaimed];
+        }
+        // The consumer might have popped the published states, and released some of them, since the first check.
+        // (States only flow from published, to the consumer, to free: once the published queue was observed empty,
+        // this check sees every state not held by the consumer.)
+        else if(std::optional<Index> index = mFree.pop())
+        {
+            return &mPool[*index];
+        }
+        return nullptr;
     }
 
+    /// @brief Publish a state previously obtained via acquire().
+    void push(T_state * aState)
+    {
+        const Index index = indexOf(aState);
+        mPushTimes[index] = Clock::now();
+
+        const std::size_t tail = mPublishedTail.load(std::memory_order_relaxed);
+        // Cannot overflow: there are never more published states than states in the pool.
+        assert(tail - mPublishedHead.load(std::memory_order_acquire) < N_poolSize);
+        mPublished[tail % N_poolSize].store(index, std::memory_order_relaxed);
+        mPublishedTail.store(tail + 1, std::memory_order_release);
+    }
 
-    bool empty()
+    /// @brief The number of published states that were reclaimed before the consumer popped them.
+    std::size_t getReclaimedCount() const
+    { return mReclaimedCount; }
+
+    //
+    // Consumer side
+    //
+
+    /// @brief Approximate, since the producer can publish or reclaim concurrently.
+    bool empty() const
+    { return size() == 0; }
+
+    /// @brief Approximate, since the producer can publish or reclaim concurrently.
+    std::size_t size() const
     {
-        std::lock_guard lock{mMutex};
-        return mStore.empty();
+        // Head is loaded first: the tail can only move forward, so the difference never underflows.
+        const std::size_t head = mPublishedHead.load(std::memory_order_acquire);
+        return mPublishedTail.load(std::memory_order_acquire) - head;
     }
 
+    /// @brief Pop the oldest published entry, if any.
+    /// @note Even after observing a non-empty ring, the pop can fail if the producer reclaimed the entry.
+    std::optional<Entry> pop()
+    {
+        if(std::optional<Index> index = popPublished())
+        {
+            return Entry{mPushTimes[*index], &mPool[*index]};
+        }
+        return std::nullopt;
+    }
 
-    std::size_t size()
+    /// @brief Give a state back to the pool, so the producer can reuse it.
+    /// It is valid to release a nullptr (no-op).
+    void release(T_state * aState)
     {
-        std::lock_guard lock{mMutex};
-        return mStore.size();
+        if(aState != nullptr)
+        {
+            [[maybe_unused]] bool pushed = mFree.push(indexOf(aState));
+            assert(pushed);
+        }
     }
 
+private:
+    Index indexOf(const T_state * aState) const
+    {
+        assert(aState >= mPool.get() && aState < mPool.get() + N_poolSize);
+        return aState - mPool.get();
+    }
 
-    std::optional<Entry> popToEnd()
+    /// @brief Pop the oldest published index, called by both the consumer and the producer (when reclaiming).
+    ///
+    /// The head is advanced by compare-exchange, so a given index is popped by exactly one of them.
+    /// The slot read before the exchange cannot have been overwritten when the exchange succeeds:
+    /// the producer only writes the slot at the head position when the published queue is full,
+    /// and it would first advance the head by reclaiming.
+    std::optional<Index> popPublished()
     {
-        std::optional<Entry> result;
-        std::lock_guard lock{mMutex};
-        if (! mStore.empty())
+        std::size_t head = mPublishedHead.load(std::memory_order_acquire);
+        while(head != mPublishedTail.load(std::memory_order_acquire))
         {
-            result = std::move(mStore.back());
-            mStore.clear();
+            const Index index = mPublished[head % N_poolSize].load(std::memory_order_relaxed);
+            if(mPublishedHead.compare_exchange_weak(head, head + 1,
+                                                    std::memory_order_acq_rel,
+                                                    std::memory_order_acquire))
+            {
+                return index;
+            }
+            // On failure, head was reloaded by the exchange.
         }
-        return result;
+        return std::nullopt;
     }
 
+    std::unique_ptr<T_state[]> mPool;
+    // Written by the producer while it owns the state, read by the consumer once it popped it.
+    std::array<Clock::time_point, N_poolSize> mPushTimes{};
 
-private:
-    std::mutex mMutex;
-    std::list<Entry> mStore;
+    // Bounded queue of published indices, with a single pusher (producer) but two poppers (consumer, producer).
+    alignas(gCacheLine) std::atomic<std::size_t> mPublishedHead{0};
+    alignas(gCacheLine) std::atomic<std::size_t> mPublishedTail{0};
+    std::array<std::atomic<Index>, N_poolSize> mPublished{};
+
+    SpscQueue<Index, N_poolSize> mFree;
+    // Only accessed by the producer.
+    std::size_t mReclaimedCount = 0;
 };
 
 
@@ -0,0 +1,96 @@
+#pragma once
+
+
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <vector>
+
+
+namespace ad {
+namespace snac {
+
+
+/// @brief Threads executing the tasks pushed to them, in submission order.
+///
+/// Intended for the part of asset loading that does not require the GL context
+/// (file I/O, parsing, decoding), so it occurs neither on the simulation thread nor on the render thread.
+///
+/// @note Tasks still queued on destruction are discarded, running tasks are completed.
+class IoWorkers
+{
+public:
+    using Task = std::function<void()>;
+
+    explicit IoWorkers(unsigned int aThreadCount)
+    {
+        mThreads.reserve(aThreadCount);
+        for(unsigned int i = 0; i != aThreadCount; ++i)
+        {
+            mThreads.emplace_back([this](){ work(); });
+        }
+    }
+
+    /// @brief Complete the running tasks, and discard the queued ones.
+    ///
+    /// A discarded task is destroyed without being run: the promises it owns are broken,
+    /// so their futures throw std::future_error (std::future_errc::broken_promise).
+    ~IoWorkers()
+    {
+        {
+            std::lock_guard lock{mMutex};
+            mStop = true;
+        }
+        mWakeWorkers.notify_all();
+        for(std::thread & thread : mThreads)
+        {
+            thread.join();
+        }
+    }
+
+    IoWorkers(const IoWorkers &) = delete;
+    IoWorkers & operator=(const IoWorkers &) = delete;
+
+    void push(Task aTask)
+    {
+        {
+            std::lock_guard lock{mMutex};
+            mTasks.push(std::move(aTask));
+        }
+        mWakeWorkers.notify_one();
+    }
+
+private:
+    void work()
+    {
+        while(true /* explicit return in body */)
+        {
+            Task task;
+            {
+                std::unique_lock lock{mMutex};
+                mWakeWorkers.wait(lock, [this](){ return mStop || !mTasks.empty(); });
+                if(mStop)
+                {
+                    return;
+                }
+                task = std::move(mTasks.front());
+                mTasks.pop();
+            }
+            // Execute the task while the mutex is unlocked.
+            task();
+        }
+    }
+
+    std::queue<Task> mTasks;
+    std::mutex mMutex;
+    std::condition_variable mWakeWorkers;
+    bool mStop = false;
+
+    std::vector<std::thread> mThreads;
+};
+
+
+} // namespace snac
+} // namespace ad
@@ -2,12 +2,14 @@
 
 
 #include "GraphicState.h"
+#include "IoWorkers.h"
 #include "Logging.h"
 #include "LoopSettings.h"
 #include "Profiling.h"
 #include "Profiling_V2.h"
 #include "ProfilingGPU.h"
 #include "Timing.h"
+#include "UploadQueue.h"
 
 #include <arte/Freetype.h>
 
@@ -49,15 +51,18 @@ void recompilePrograms(Resources & aResources);
 
 
 template <class T_renderer>
-using GraphicStateFifo = StateFifo<typename T_renderer::GraphicState_t>;
+using GraphicStateRing = StateRing<typename T_renderer::GraphicState_t>;
 
 
 /// \brief A double buffer implementation, consuming entries from a
-/// GraphicStateFifo.
+/// GraphicStateRing.
+///
+/// The buffer keeps the two most recent entries it consumed, and releases
+/// the superseded states back to the ring pool.
 template <class T_renderer>
 class EntryBuffer
 {
-    using GraphicStateFifo_t = GraphicStateFifo<T_renderer>;
+    using GraphicStateRing_t = GraphicStateRing<T_renderer>;
 
 public:
     static constexpr std::size_t BufferDepth = 2;
@@ -65,41 +70,43 @@ public:
 
     /// \brief Construct the buffer, block until it could initialize all its
     /// entries.
-    EntryBuffer(GraphicStateFifo_t & aStateFifo)
+    EntryBuffer(GraphicStateRing_t & aStateRing)
     {
         for (std::size_t i = 0; i != std::size(mDoubleBuffer); ++i)
         {
+            std::optional<typename GraphicStateRing_t::Entry> entry;
             // busy wait
-            while (aStateFifo.empty())
+            while (!(entry = aStateRing.pop()))
             {}
 
-            mDoubleBuffer[i] = aStateFifo.pop();
+            mDoubleBuffer[i] = *entry;
         }
 
         // Make sure the EntryBuffer is up-to-date
-        consume(aStateFifo);
+        consume(aStateRing);
     }
 
-    const typename GraphicStateFifo_t::Entry & current() const
+    const typename GraphicStateRing_t::Entry & current() const
     {
         return mDoubleBuffer[mFront];
     }
 
-    const typename GraphicStateFifo_t::Entry & previous() const
+    const typename GraphicStateRing_t::Entry & previous() const
     {
         return mDoubleBuffer[back()];
     }
 
-    /// \brief Pop as many states as available from the Fifo.
+    /// \brief Pop as many states as available from the ring.
     ///
     /// Ensures the buffer current() and previous() entries are
     /// up-to-date at the time of return (modulo return branching duration).
-    void consume(GraphicStateFifo_t & aStateFifo)
+    void consume(GraphicStateRing_t & aStateRing)
     {
-        while (!aStateFifo.empty())
+        while (std::optional<typename GraphicStateRing_t::Entry> entry = aStateRing.pop())
         {
             mFront = back();
-            mDoubleBuffer[mFront] = aStateFifo.pop();
+            aStateRing.release(mDoubleBuffer[mFront].state);
+            mDoubleBuffer[mFront] = *entry;
             SELOG(trace)("Render thread: Newer state retrieved.");
         }
     }
@@ -107,14 +114,14 @@ public:
 private:
     std::size_t back() const { return (mFront + 1) % 2; }
 
-    std::array<typename GraphicStateFifo_t::Entry, BufferDepth> mDoubleBuffer;
+    std::array<typename GraphicStateRing_t::Entry, BufferDepth> mDoubleBuffer;
     std::size_t mFront = 1;
 };
 
 template <class T_renderer>
 class RenderThread
 {
-    using GraphicStateFifo_t = GraphicStateFifo<T_renderer>;
+    using GraphicStateRing_t = GraphicStateRing<T_renderer>;
     using Operation = std::function<void(T_renderer &)>;
 
     struct Controls
@@ -124,7 +131,7 @@ class RenderThread
 
 public:
     RenderThread(graphics::ApplicationGlfw & aGlfwApp,
-                 GraphicStateFifo_t & aStates,
+                 GraphicStateRing_t & aStates,
                  T_renderer && aRenderer,
                  imguiui::ImguiUi & aImguiUi,
                  ConfigurableSettings & aSettingsIncludingControls) :
@@ -186,6 +193,8 @@ public:
     //    });
     //}
 
+    /// @brief Stream the model: it is read and decoded by an I/O worker,
+    /// then uploaded by the render thread within the per-frame upload budget.
     std::future<typename T_renderer::template Handle_t<const renderer::Object>> 
     loadModel(filesystem::path aModel, 
               filesystem::path aEffect, 
@@ -201,12 +210,25 @@ public:
         using Handle_t = typename T_renderer::template Handle_t<const renderer::Object>;
         auto promise = std::make_shared<std::promise<Handle_t>>();
         std::future<Handle_t> future = promise->get_future();
-        push([promise = std::move(promise), shape = std::move(aModel), effect = std::move(aEffect), &aResources]
-             (T_renderer & aRenderer) 
+        mIoWorkers.push([this, promise = std::move(promise), shape = std::move(aModel), effect = std::move(aEffect), &aResources]
+             ()
              {
                 try
                 {
-                    promise->set_value(aRenderer.loadModel(shape, effect, aResources));
+                    // Shared, because the prepared model is not copyable.
+                    auto prepared = std::make_shared<typename T_renderer::PreparedModel>(T_renderer::prepareModel(shape));
+                    mUploads.push([promise, prepared = std::move(prepared), effect, &aResources]
+                               (T_renderer & aRenderer)
+                               {
+                                    try
+                                    {
+                                        promise->set_value(aRenderer.uploadModel(std::move(*prepared), effect, aResources));
+                                    }
+                                    catch(...)
+                                    {
+                                        promise->set_exception(std::current_exception());
+                                    }
+                               });
                 }
                 catch(...)
                 {
@@ -345,7 +367,7 @@ private:
         mThread.join();
     }
 
-    void run(GraphicStateFifo_t & aStates)
+    void run(GraphicStateRing_t & aStates)
     {
         try
         {
@@ -400,7 +422,7 @@ private:
         }
     }
 
-    void run_impl(GraphicStateFifo_t & aStates)
+    void run_impl(GraphicStateRing_t & aStates)
     {
         SELOG(info)("Render thread started");
 
@@ -421,6 +443,9 @@ private:
         // Used by non-interpolating path, to decide if frame is dirty.
         Clock::time_point renderedPushTime;
 
+        // The state actually rendered, kept accross frames so its containers reuse their storage.
+        typename T_renderer::GraphicState_t state;
+
         // If the client is waiting on a future from this thread 
         // before producing the two first states, we must service to avoid a deadlock.
         std::optional<EntryBuffer<T_renderer>> entries;
@@ -429,6 +454,8 @@ private:
             // Note: this is busy looping at the moment.
             // This should only be for a brief period at the beginning.
             serviceOperations(*mRenderer);
+            // Nothing is rendered yet, so the uploads are not limited by a budget.
+            mUploads.service(*mRenderer, Clock::duration::max());
 
             if(aStates.size() >= EntryBuffer<T_renderer>::BufferDepth)
             {
@@ -459,6 +486,11 @@ private:
                     serviceOperations(*mRenderer);
                 }
 
+                {
+                    TIME_RECURRING(Render, "Service_uploads");
+                    mUploads.service(*mRenderer, gUploadBudget);
+                }
+
                 // TODO simulate delay in the render thread:
                 // * Thread iteration time (simulate what CPU compuations run on the
                 // thread, e.g. visibility).
@@ -476,7 +508,6 @@ private:
                 // Interpolate (or pick the current state if interpolation is
                 // disabled)
                 //
-                typename T_renderer::GraphicState_t state;
                 if (mControls.mInterpolate)
                 {
                     TIME_RECURRING(Render, "Interpolation");
@@ -499,8 +530,7 @@ private:
                     duration_cast<ms>(latest.pushTime - previous.pushTime)
                         .count());
 
-                    state =
-                        interpolate(*previous.state, *latest.state, interpolant);
+                    interpolate(*previous.state, *latest.state, interpolant, state);
                 }
                 else
                 {
@@ -557,6 +587,9 @@ private:
     };
 
 private:
+    /// @brief Time the render thread spends uploading streamed assets each frame.
+    static constexpr Clock::duration gUploadBudget = std::chrono::milliseconds{4};
+
     graphics::ApplicationGlfw & mApplication;
     std::shared_ptr<graphics::AppInterface::SizeListener> mViewportListening;
 
@@ -589,6 +622,11 @@ private:
 
     std::atomic<bool> mStop{false};
     std::thread mThread;
+
+    // Filled by the I/O workers, serviced by the render thread.
+    UploadQueue<T_renderer> mUploads;
+    // Declared last, so the workers are joined before the members they access are destroyed.
+    IoWorkers mIoWorkers{2};
 };
 
 
@@ -21,38 +21,66 @@ Resources::~Resources()
     SELOG(debug)("Destructing snacman::Resources instance.");
 }
 
+namespace {
+
+    filesystem::path patchModelPath(filesystem::path aModel)
+    {
+        // TODO: remove this cube section when we fill confident there are not
+        // requests left in the code This was bad design, but lazy to get the result
+        // quickly
+        if (aModel.string() == "CUBE")
+        {
+            throw std::invalid_argument(
+                "'CUBE' hardcoded model is now deprecated.");
+        }
+        else if (aModel.extension() == ".gltf")
+        {
+            aModel.replace_extension(".seum");
+            SELOG(warn)("Live patching extension of '{}'.", aModel.string());
+        }
+        return aModel;
+    }
+
+} // unnamed namespace
+
 snacgame::Renderer_t::Handle_t<const renderer::Object>
 Resources::getModel(filesystem::path aModel, filesystem::path aEffect)
 {
     // TODO Ad 2024/03/27: Since it will reuse the effect of first load,
     // we should explicitly error if an already-loader model is requested with a
     // different effect file.
+    aModel = patchModelPath(std::move(aModel));
+    auto model = mModels.load(aModel, mFinder, aEffect, *this);
+    // This should be in resource manager however load is a variadic
+    // template function It is not possible to declare a store for those
+    // parameters inside ResourceManager because those are not template
+    // parameters of ResourceManager
+    mModelDataFromResource.insert_or_assign(model,
+                                            ModelData{aModel, aEffect});
+    return model;
+}
 
-    // TODO: remove this cube section when we fill confident there are not
-    // requests left in the code This was bad design, but lazy to get the result
-    // quickly
-    if (aModel.string() == "CUBE")
-    {
-        throw std::invalid_argument(
-            "'CUBE' hardcoded model is now deprecated.");
-    }
-    else
+ModelRequest Resources::requestModel(filesystem::path aModel, filesystem::path aEffect)
+{
+    aModel = patchModelPath(std::move(aModel));
+    return requestFoundModel(mFinder.pathFor(aModel), std::move(aEffect));
+}
+
+ModelRequest Resources::requestFoundModel(const filesystem::path & aModelPath,
+                                          filesystem::path aEffect)
+{
+    auto found = mModelRequests.find(aModelPath);
+    if (found == mModelRequests.end())
     {
-        if (aModel.extension() == ".gltf")
-        {
-            aModel.replace_extension(".seum");
-            SELOG(warn)("Live patching extension of '{}'.", aModel.string());
-        }
-        auto model = mModels.load(aModel, mFinder, aEffect, mRenderThread,
-                                  mResources_V2);
-        // This should be in resource manager however load is a variadic
-        // template function It is not possible to declare a store for those
-        // parameters inside ResourceManager because those are not template
-        // parameters of ResourceManager
-        mModelDataFromResource.insert_or_assign(model,
-                                                ModelData{aModel, aEffect});
-        return model;
+        found = mModelRequests
+                    .emplace(aModelPath,
+                             mRenderThread
+                                 .loadModel(aModelPath, std::move(aEffect),
+                                            mResources_V2)
+                                 .share())
+                    .first;
     }
+    return ModelRequest{found->second};
 }
 
 std::shared_ptr<Resources::LoadedFont_t> Resources::getFont(filesystem::path aFont,
@@ -105,10 +133,10 @@ Resources::FontLoader(filesystem::path aFont,
 snacgame::Renderer_t::Handle_t<const renderer::Object>
 Resources::ModelLoader(filesystem::path aModel,
                        filesystem::path aEffect,
-                       RenderThread<snacgame::Renderer_t> & aRenderThread,
-                       snacgame::Resources_V2 & aResources)
+                       Resources & aResources)
 {
-    return aRenderThread.loadModel(aModel, aEffect, aResources)
+    // Waits on the streaming, which might already have been requested
+    return aResources.requestFoundModel(aModel, std::move(aEffect))
         .get(); // synchronize call
 }
 
@@ -15,6 +15,8 @@
 #include <arte/Freetype.h>             // for Freetype
 
 #include <filesystem>                  // for path
+#include <future>                      // for shared_future
+#include <map>                         // for map
 #include <memory>                      // for shared_ptr
 #include <utility>                     // for move
 
@@ -44,6 +46,29 @@ template <class T_renderer> class RenderThread;
 
 constexpr unsigned int gDefaultPixelHeight = 64;
 
+
+/// @brief Handle to a model streamed by Resources::requestModel().
+/// @note There are no placeholder assets: the game reads the model data (e.g. rig, bounding box)
+/// as soon as it gets a handle, so it waits for the loaded model.
+class ModelRequest
+{
+public:
+    using Handle_t = snacgame::Renderer_t::Handle_t<const renderer::Object>;
+
+    explicit ModelRequest(std::shared_future<Handle_t> aFuture) :
+        mFuture{std::move(aFuture)}
+    {}
+
+    /// @brief Block until the model is loaded.
+    /// @throw If the load failed.
+    Handle_t get() const
+    { return mFuture.get(); }
+
+private:
+    std::shared_future<Handle_t> mFuture;
+};
+
+
 // TODO Ad 2024/02/14: This class should at least be split in 2:
 // * The high level client-facing API, to request (async?) loads on the RenderThread
 // * And underlying synchronous loader, which does not need to know about RenderThread,
@@ -70,7 +95,17 @@ public:
     /// @warning It is an error to load the same model with distinct effects.
     /// At the moment, the effect path is not considered when looking up in the map,
     /// so the model will always have the effect it was loaded with the first time.
+    /// @note Blocks until the model is loaded, only waiting for the end of the streaming
+    /// if the model was already requested.
     snacgame::Renderer_t::Handle_t<const renderer::Object> getModel(filesystem::path aModel, filesystem::path aEffect);
+
+    /// @brief Start streaming the model, if it was not already requested, without blocking.
+    ///
+    /// The model is read and decoded by I/O workers, then uploaded by the render thread.
+    /// Requesting all models of a scene ahead of getModel() allows the loads to overlap.
+    /// @warning Same restriction as getModel() regarding effects.
+    ModelRequest requestModel(filesystem::path aModel, filesystem::path aEffect);
+
     ModelData getModelDataFromResource(snacgame::Renderer_t::Handle_t<const renderer::Object> aResource)
     { return mModelDataFromResource.at(aResource); }
 
@@ -116,10 +151,15 @@ private:
     static snacgame::Renderer_t::Handle_t<const renderer::Object> ModelLoader(
         filesystem::path aModel, 
         filesystem::path aEffect,
-        RenderThread<snacgame::Renderer_t> & aRenderThread,
-        snacgame::Resources_V2 & aResources);
+        Resources & aResources);
     std::unordered_map<snacgame::Renderer_t::Handle_t<const renderer::Object>, ModelData> mModelDataFromResource;
 
+    /// @brief Start streaming the model if it was not already requested.
+    /// @param aModelPath The path as found by mFinder.
+    ModelRequest requestFoundModel(const filesystem::path & aModelPath, filesystem::path aEffect);
+    // By path as found by mFinder, kept after completion so a model is never streamed twice.
+    std::map<filesystem::path, std::shared_future<ModelRequest::Handle_t>> mModelRequests;
+
     static ent::Handle<ent::Entity> BpLoader(
         const filesystem::path & aBpFile, 
         ent::EntityManager & aWorld,
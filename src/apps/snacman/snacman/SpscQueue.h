@@ -0,0 +1,81 @@
+#pragma once
+
+
+#include <array>
+#include <atomic>
+#include <optional>
+
+#include <cstddef>
+
+
+namespace ad {
+namespace snac {
+
+
+/// @brief Bounded, wait-free, single-producer / single-consumer queue.
+///
+/// Only one thread may call push(), only one (other) thread may call pop().
+/// The queue never allocates: its storage is an in-place array of `N_capacity` values.
+///
+/// @note Head and tail are monotonic counters, wrapped into the array via modulo,
+/// so the full and empty states are disambiguated without wasting a slot.
+template <class T_value, std::size_t N_capacity>
+class SpscQueue
+{
+    static_assert(N_capacity > 0 && (N_capacity & (N_capacity - 1)) == 0,
+                  "Capacity must be a power of two, so the counters wrap consistently.");
+
+    // Avoid false sharing between the producer and the consumer counters.
+    static constexpr std::size_t gCacheLine = 64;
+
+public:
+    static constexpr std::size_t Capacity = N_capacity;
+
+    /// @brief Producer side.
+    /// @return false if the queue was full (the value is then left untouched).
+    bool push(T_value aValue)
+    {
+        const std::size_t tail = mTail.load(std::memory_order_relaxed);
+        if(tail - mHead.load(std::memory_order_acquire) == N_capacity)
+        {
+            return false;
+        }
+        mStore[tail % N_capacity] = std::move(aValue);
+        mTail.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+    /// @brief Consumer side.
+    /// @return The oldest value, or an empty optional if the queue was empty.
+    std::optional<T_value> pop()
+    {
+        const std::size_t head = mHead.load(std::memory_order_relaxed);
+        if(head == mTail.load(std::memory_order_acquire))
+        {
+            return std::nullopt;
+        }
+        std::optional<T_value> result{std::move(mStore[head % N_capacity])};
+        mHead.store(head + 1, std::memory_order_release);
+        return result;
+    }
+
+    /// @brief Approximate when called from a thread that is neither the producer nor the consumer.
+    std::size_t size() const
+    {
+        // Head is loaded first: the tail can only move forward, so the difference never underflows.
+        const std::size_t head = mHead.load(std::memory_order_acquire);
+        return mTail.load(std::memory_order_acquire) - head;
+    }
+
+    bool empty() const
+    { return size() == 0; }
+
+private:
+    alignas(gCacheLine) std::atomic<std::size_t> mHead{0};
+    alignas(gCacheLine) std::atomic<std::size_t> mTail{0};
+    std::array<T_value, N_capacity> mStore;
+};
+
+
+} // namespace snac
+} // namespace ad
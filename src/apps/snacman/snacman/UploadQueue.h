@@ -0,0 +1,66 @@
+#pragma once
+
+
+#include "Timing.h"
+
+#include <functional>
+#include <mutex>
+#include <queue>
+
+#include <cstddef>
+
+
+namespace ad {
+namespace snac {
+
+
+/// @brief Operations on a `T_target` (e.g. the GL uploads of streamed assets) pushed from any thread,
+/// then serviced by the thread owning the target, within a time budget.
+template <class T_target>
+class UploadQueue
+{
+public:
+    using Upload = std::function<void(T_target &)>;
+
+    void push(Upload aUpload)
+    {
+        std::lock_guard lock{mMutex};
+        mUploads.push(std::move(aUpload));
+    }
+
+    /// @brief Execute queued uploads, in submission order, until `aBudget` is exhausted.
+    ///
+    /// At least one upload is executed (if any is queued), so the budget might be exceeded,
+    /// but the uploads always progress.
+    /// @return The number of uploads executed.
+    std::size_t service(T_target & aTarget, Clock::duration aBudget)
+    {
+        const Clock::time_point start = Clock::now();
+        std::size_t serviced = 0;
+        do
+        {
+            Upload upload;
+            {
+                std::lock_guard lock{mMutex};
+                if (mUploads.empty())
+                {
+                    break;
+                }
+                upload = std::move(mUploads.front());
+                mUploads.pop();
+            }
+            // Execute the upload while the mutex is unlocked.
+            upload(aTarget);
+            ++serviced;
+        } while(Clock::now() - start < aBudget);
+        return serviced;
+    }
+
+private:
+    std::queue<Upload> mUploads;
+    std::mutex mMutex;
+};
+
+
+} // namespace snac
+} // namespace ad
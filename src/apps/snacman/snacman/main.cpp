@@ -177,7 +177,7 @@ void runApplication()
     // the render thread.
     glfwApp.removeCurrentContext();
 
-    GraphicStateFifo<snacgame::Renderer_t> graphicStates;
+    GraphicStateRing<snacgame::Renderer_t> graphicStates;
     RenderThread renderingThread{
         glfwApp,
         graphicStates,
@@ -264,7 +264,17 @@ void runApplication()
         //
         // Push the graphic state for the latest simulated state
         //
-        graphicStates.push(simulation.makeGraphicState());
+        if (auto * graphicState = graphicStates.acquire())
+        {
+            simulation.makeGraphicState(*graphicState);
+            graphicStates.push(graphicState);
+        }
+        else
+        {
+            // Cannot happen while the pool is larger than the states held by the render thread.
+            // (When the render thread lags, acquire() reclaims its oldest pending state instead.)
+            SELOG(error)("All graphic states are held by the render thread, skipping the state for this step.");
+        }
 
         // Regularly check if the rendering thread did not throw
         renderingThread.checkRethrow();
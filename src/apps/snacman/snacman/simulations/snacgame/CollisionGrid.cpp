@@ -0,0 +1,214 @@
+#include "CollisionGrid.h"
+
+#include "component/LevelData.h"
+
+#include <algorithm>
+
+#include <cassert>
+#include <cmath>
+
+
+namespace ad {
+namespace snacgame {
+
+
+void CollisionGrid::reset(const component::Level & aLevel)
+{
+    mCellSize = aLevel.mCellSize;
+    mColumns = std::max(1, aLevel.mSize.width());
+    mRows = std::max(1, aLevel.mSize.height());
+
+    for (Layer & layer : mLayers)
+    {
+        layer.mEntries.clear();
+        layer.mEntryIndices.clear();
+        layer.mVisitStamps.clear();
+        layer.mSyncStamps.clear();
+        layer.mCells.resize(mColumns * mRows);
+        for (std::vector<EntryIndex> & cell : layer.mCells)
+        {
+            cell.clear();
+        }
+    }
+}
+
+
+void CollisionGrid::insert(CollisionLayer aLayer, EntHandle aHandle, const Box_f & aHitbox)
+{
+    Layer & layer = getLayer(aLayer);
+    const EntryIndex entryIdx = (EntryIndex)layer.mEntries.size();
+    layer.mEntries.push_back(Entry{.mHandle = aHandle, .mHitbox = aHitbox});
+    layer.mEntryIndices.insert_or_assign(aHandle, entryIdx);
+    layer.mVisitStamps.push_back(mQueryStamp);
+    layer.mSyncStamps.push_back(mSyncStamp);
+
+    addToCells(layer, entryIdx, getCellRange(aHitbox));
+}
+
+
+void CollisionGrid::move(CollisionLayer aLayer, EntHandle aHandle, const Box_f & aHitbox)
+{
+    Layer & layer = getLayer(aLayer);
+    auto found = layer.mEntryIndices.find(aHandle);
+    if (found == layer.mEntryIndices.end())
+    {
+        return;
+    }
+
+    const EntryIndex entryIdx = found->second;
+    Entry & entry = layer.mEntries[entryIdx];
+    const CellRange previous = getCellRange(entry.mHitbox);
+    const CellRange next = getCellRange(aHitbox);
+    entry.mHitbox = aHitbox;
+    layer.mSyncStamps[entryIdx] = mSyncStamp;
+
+    if (previous == next)
+    {
+        return;
+    }
+
+    removeFromCells(layer, entryIdx, previous);
+    addToCells(layer, entryIdx, next);
+}
+
+
+void CollisionGrid::erase(CollisionLayer aLayer, EntHandle aHandle)
+{
+    Layer & layer = getLayer(aLayer);
+    if (auto found = layer.mEntryIndices.find(aHandle);
+        found != layer.mEntryIndices.end())
+    {
+        eraseEntry(layer, found->second);
+    }
+}
+
+
+void CollisionGrid::beginSync(const component::Level & aLevel)
+{
+    if (mCellSize != aLevel.mCellSize
+        || mColumns != std::max(1, aLevel.mSize.width())
+        || mRows != std::max(1, aLevel.mSize.height()))
+    {
+        reset(aLevel);
+    }
+    ++mSyncStamp;
+}
+
+
+void CollisionGrid::sync(CollisionLayer aLayer, EntHandle aHandle, const Box_f & aHitbox)
+{
+    Layer & layer = getLayer(aLayer);
+    if (layer.mEntryIndices.contains(aHandle))
+    {
+        move(aLayer, aHandle, aHitbox);
+    }
+    else
+    {
+        insert(aLayer, aHandle, aHitbox);
+    }
+}
+
+
+void CollisionGrid::endSync()
+{
+    for (Layer & layer : mLayers)
+    {
+        // Backward, so the entries moved into erased slots are already synchronized.
+        for (EntryIndex entryIdx = (EntryIndex)layer.mEntries.size(); entryIdx != 0; --entryIdx)
+        {
+            if (layer.mSyncStamps[entryIdx - 1] != mSyncStamp)
+            {
+                eraseEntry(layer, entryIdx - 1);
+            }
+        }
+    }
+}
+
+
+void CollisionGrid::addToCells(Layer & aLayer, EntryIndex aEntryIdx, const CellRange & aRange)
+{
+    for (int row = aRange.mRowBegin; row != aRange.mRowEnd; ++row)
+    {
+        for (int column = aRange.mColumnBegin; column != aRange.mColumnEnd; ++column)
+        {
+            aLayer.mCells[row * mColumns + column].push_back(aEntryIdx);
+        }
+    }
+}
+
+
+void CollisionGrid::removeFromCells(Layer & aLayer, EntryIndex aEntryIdx, const CellRange & aRange)
+{
+    for (int row = aRange.mRowBegin; row != aRange.mRowEnd; ++row)
+    {
+        for (int column = aRange.mColumnBegin; column != aRange.mColumnEnd; ++column)
+        {
+            std::vector<EntryIndex> & cell = aLayer.mCells[row * mColumns + column];
+            auto position = std::find(cell.begin(), cell.end(), aEntryIdx);
+            assert(position != cell.end());
+            *position = cell.back();
+            cell.pop_back();
+        }
+    }
+}
+
+
+void CollisionGrid::eraseEntry(Layer & aLayer, EntryIndex aEntryIdx)
+{
+    removeFromCells(aLayer, aEntryIdx, getCellRange(aLayer.mEntries[aEntryIdx].mHitbox));
+    aLayer.mEntryIndices.erase(aLayer.mEntries[aEntryIdx].mHandle);
+
+    // The last entry takes the erased slot, so the entries stay contiguous.
+    const EntryIndex lastIdx = (EntryIndex)aLayer.mEntries.size() - 1;
+    if (aEntryIdx != lastIdx)
+    {
+        const CellRange range = getCellRange(aLayer.mEntries[lastIdx].mHitbox);
+        for (int row = range.mRowBegin; row != range.mRowEnd; ++row)
+        {
+            for (int column = range.mColumnBegin; column != range.mColumnEnd; ++column)
+            {
+                std::vector<EntryIndex> & cell = aLayer.mCells[row * mColumns + column];
+                auto position = std::find(cell.begin(), cell.end(), lastIdx);
+                assert(position != cell.end());
+                *position = aEntryIdx;
+            }
+        }
+        aLayer.mEntries[aEntryIdx] = aLayer.mEntries[lastIdx];
+        aLayer.mEntryIndices.insert_or_assign(aLayer.mEntries[aEntryIdx].mHandle, aEntryIdx);
+        aLayer.mVisitStamps[aEntryIdx] = aLayer.mVisitStamps[lastIdx];
+        aLayer.mSyncStamps[aEntryIdx] = aLayer.mSyncStamps[lastIdx];
+    }
+
+    aLayer.mEntries.pop_back();
+    aLayer.mVisitStamps.pop_back();
+    aLayer.mSyncStamps.pop_back();
+}
+
+
+int CollisionGrid::clampColumn(float aX) const
+{
+    // Tiles are centered on multiples of the cell size.
+    return std::clamp((int)std::floor(aX / mCellSize + 0.5f), 0, mColumns - 1);
+}
+
+
+int CollisionGrid::clampRow(float aZ) const
+{
+    return std::clamp((int)std::floor(-aZ / mCellSize + 0.5f), 0, mRows - 1);
+}
+
+
+CollisionGrid::CellRange CollisionGrid::getCellRange(const Box_f & aHitbox) const
+{
+    return CellRange{
+        .mColumnBegin = clampColumn(aHitbox.xMin()),
+        .mColumnEnd = clampColumn(aHitbox.xMax()) + 1,
+        // Rows extend toward -Z, so the max Z gives the first row.
+        .mRowBegin = clampRow(aHitbox.zMax()),
+        .mRowEnd = clampRow(aHitbox.zMin()) + 1,
+    };
+}
+
+
+} // namespace snacgame
+} // namespace ad
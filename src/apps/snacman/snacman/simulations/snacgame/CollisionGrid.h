@@ -0,0 +1,164 @@
+#pragma once
+
+#include "typedef.h"
+
+#include "component/Collision.h"
+
+#include <array>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include <cstdint>
+
+
+namespace ad {
+namespace snacgame {
+
+namespace component {
+struct Level;
+}
+
+
+/// @brief The kinds of entities registered in the CollisionGrid, each layer is queried separately.
+enum class CollisionLayer
+{
+    Player,
+    Pill,
+    PowerUp,
+    Portal,
+    BurgerParticle,
+    _End,
+};
+
+
+/// @brief Uniform grid broadphase, with one cell per level tile.
+///
+/// Hitboxes are in scene coordinates (i.e. transformHitbox() applied to the GlobalPose),
+/// where the level lies in the XZ plane, its rows extending toward -Z (see gWorldCoordTo3dCoord).
+/// Each entry is registered in all the cells its hitbox overlaps, so a query only runs the SAT test
+/// against entries sharing a cell with the queried box.
+/// Hitboxes outside of the level are clamped to the border cells, so they are still found.
+///
+/// @note The grid is synchronized each tick (see beginSync()): entries that did not change cells
+/// are not touched, so the cost grows with the moving entities, not with the level size.
+class CollisionGrid
+{
+public:
+    using EntryIndex = std::uint32_t;
+
+    struct Entry
+    {
+        EntHandle mHandle;
+        Box_f mHitbox;
+    };
+
+    /// @brief Remove all entries, and fit the cells to the level.
+    void reset(const component::Level & aLevel);
+
+    void insert(CollisionLayer aLayer, EntHandle aHandle, const Box_f & aHitbox);
+
+    /// @brief Incremental update of an entity that moved since it was inserted,
+    /// only the cells that changed are touched.
+    /// @note Entities that are not in the layer are ignored.
+    void move(CollisionLayer aLayer, EntHandle aHandle, const Box_f & aHitbox);
+
+    /// @brief Remove the entry of an entity, entities that are not in the layer are ignored.
+    void erase(CollisionLayer aLayer, EntHandle aHandle);
+
+    /// @brief Start synchronizing the grid with the current entities.
+    ///
+    /// The grid is only reset() if the level dimensions changed.
+    /// Then, each current entity should be passed to sync(), before endSync() removes the others.
+    void beginSync(const component::Level & aLevel);
+
+    /// @brief Insert the entity, or move() it if it is already in the layer.
+    void sync(CollisionLayer aLayer, EntHandle aHandle, const Box_f & aHitbox);
+
+    /// @brief Erase the entries that were not inserted nor moved since beginSync() (e.g. erased entities).
+    void endSync();
+
+    /// @brief Invoke `aVisitor(const Entry &)` once for each entry of `aLayer` colliding with `aHitbox`.
+    /// Entries whose entity was erased since the insertion are skipped.
+    template <class T_visitor>
+    void forEachCollision(CollisionLayer aLayer, const Box_f & aHitbox, T_visitor && aVisitor) const;
+
+private:
+    /// @brief Half-open range of cells overlapped by a hitbox.
+    struct CellRange
+    {
+        bool operator==(const CellRange &) const = default;
+
+        int mColumnBegin;
+        int mColumnEnd;
+        int mRowBegin;
+        int mRowEnd;
+    };
+
+    struct Layer
+    {
+        std::vector<Entry> mEntries;
+        // Index of each entity entry, so move() does not search the entries.
+        std::unordered_map<EntHandle, EntryIndex> mEntryIndices;
+        std::vector<std::vector<EntryIndex>> mCells;
+        // Stamp of the last query that visited each entry,
+        // so an entry overlapping several cells is visited once per query.
+        mutable std::vector<std::uint32_t> mVisitStamps;
+        // Stamp of the last synchronization that inserted or moved each entry.
+        std::vector<std::uint32_t> mSyncStamps;
+    };
+
+    CellRange getCellRange(const Box_f & aHitbox) const;
+    void addToCells(Layer & aLayer, EntryIndex aEntryIdx, const CellRange & aRange);
+    void removeFromCells(Layer & aLayer, EntryIndex aEntryIdx, const CellRange & aRange);
+    void eraseEntry(Layer & aLayer, EntryIndex aEntryIdx);
+    int clampColumn(float aX) const;
+    int clampRow(float aZ) const;
+
+    Layer & getLayer(CollisionLayer aLayer)
+    { return mLayers[static_cast<std::size_t>(aLayer)]; }
+
+    const Layer & getLayer(CollisionLayer aLayer) const
+    { return mLayers[static_cast<std::size_t>(aLayer)]; }
+
+    std::array<Layer, static_cast<std::size_t>(CollisionLayer::_End)> mLayers;
+    float mCellSize = 1.f;
+    int mColumns = 1;
+    int mRows = 1;
+    mutable std::uint32_t mQueryStamp = 0;
+    std::uint32_t mSyncStamp = 0;
+};
+
+
+template <class T_visitor>
+void CollisionGrid::forEachCollision(CollisionLayer aLayer, const Box_f & aHitbox, T_visitor && aVisitor) const
+{
+    const Layer & layer = getLayer(aLayer);
+    const std::uint32_t stamp = ++mQueryStamp;
+    const CellRange range = getCellRange(aHitbox);
+
+    for (int row = range.mRowBegin; row != range.mRowEnd; ++row)
+    {
+        for (int column = range.mColumnBegin; column != range.mColumnEnd; ++column)
+        {
+            for (EntryIndex entryIdx : layer.mCells[row * mColumns + column])
+            {
+                if (std::exchange(layer.mVisitStamps[entryIdx], stamp) == stamp)
+                {
+                    continue;
+                }
+
+                const Entry & entry = layer.mEntries[entryIdx];
+                if (entry.mHandle.isValid()
+                    && component::collideWithSat(entry.mHitbox, aHitbox))
+                {
+                    aVisitor(entry);
+                }
+            }
+        }
+    }
+}
+
+
+} // namespace snacgame
+} // namespace ad
@@ -149,25 +149,36 @@ namespace {
 //     },
 // }};
 
-void createLevelElement(Phase & aPhase,
-                        EntHandle aHandle,
-                        GameContext & aContext,
-                        const math::Position<2, float> & aGridPos,
-                        HdrColor_f aColor,
-                        EntHandle pillHandle = {})
+constexpr float gLevelElementHeight = -0.030f;
+
+void addLevelElementComponents(GameContext & aContext,
+                               Entity & aElement,
+                               const math::Position<2, float> & aGridPos,
+                               HdrColor_f aColor,
+                               EntHandle pillHandle = {})
 {
-    Entity path = *aHandle.get(aPhase);
     // const PathPositionalElement & pos = PathInitPosList.at((int)std::abs(aGridPos.x()) % 2 + (int)std::abs(aGridPos.y()) % 2);
     addMeshGeoNode(
-        aContext, path, "models/square_biscuit/square_biscuit.sel",
+        aContext, aElement, "models/square_biscuit/square_biscuit.sel",
         gMeshGenericEffect,
         {static_cast<float>(aGridPos.x()), static_cast<float>(aGridPos.y()),
-         -0.030f},
+         gLevelElementHeight},
         0.45f, lLevelElementScaling,
         math::Quaternion<float>{math::UnitVec<3, float>{{1.f, 0.f, 0.f}},
                                 math::Turn<float>{0.25f}},
         aColor);
-    path.add(component::LevelTile{.mPill = pillHandle});
+    aElement.add(component::LevelTile{.mPill = pillHandle});
+}
+
+void createLevelElement(Phase & aPhase,
+                        EntHandle aHandle,
+                        GameContext & aContext,
+                        const math::Position<2, float> & aGridPos,
+                        HdrColor_f aColor,
+                        EntHandle pillHandle = {})
+{
+    Entity path = *aHandle.get(aPhase);
+    addLevelElementComponents(aContext, path, aGridPos, aColor, pillHandle);
 }
 } // namespace
 
@@ -196,20 +207,20 @@ ent::Handle<ent::Entity> createWorldText(GameContext & aContext,
     return handle;
 }
 
-ent::Handle<ent::Entity> createPill(GameContext & aContext,
-                                    Phase & aPhase,
-                                    const math::Position<2, float> & aGridPos)
+namespace {
+
+void addPillComponents(GameContext & aContext,
+                       Entity & aPill,
+                       const math::Position<2, float> & aGridPos)
 {
-    auto handle = aContext.mWorld.addEntity(fmt::format("pill ({}, {})", aGridPos.x(), aGridPos.y()));
-    Entity pill = *handle.get(aPhase);
-    addMeshGeoNode(aContext, pill, "models/burger/burger.sel",
+    addMeshGeoNode(aContext, aPill, "models/burger/burger.sel",
                    gMeshGenericEffect,
                    {static_cast<float>(aGridPos.x()),
                     static_cast<float>(aGridPos.y()), gPillHeight},
                    0.16f, {1.f, 1.f, 1.f},
                    math::Quaternion<float>{
                        math::UnitVec<3, float>{{1.f, 0.f, 0.f}}, Turn_f{0.1f}});
-    pill
+    aPill
         .add(component::Speed{
             .mRotation =
                 AxisAngle{.mAxis = math::UnitVec<3, float>{{0.f, 0.f, 1.f}},
@@ -218,9 +229,44 @@ ent::Handle<ent::Entity> createPill(GameContext & aContext,
         .add(component::Pill{})
         .add(component::Collision{component::gPillHitbox})
         .add(component::RoundTransient{});
+}
+
+/// @brief Move an instance spawned from a batch blueprint to its own position.
+void placeInstance(Entity & aInstance, const Pos3 & aPos)
+{
+    aInstance.get<component::Geometry>().mPosition = aPos;
+    aInstance.get<component::GlobalPose>().mPosition = aPos;
+}
+
+} // namespace
+
+ent::Handle<ent::Entity> createPill(GameContext & aContext,
+                                    Phase & aPhase,
+                                    const math::Position<2, float> & aGridPos)
+{
+    auto handle = aContext.mWorld.addEntity(fmt::format("pill ({}, {})", aGridPos.x(), aGridPos.y()));
+    Entity pill = *handle.get(aPhase);
+    addPillComponents(aContext, pill, aGridPos);
     return handle;
 }
 
+EntityBatch createPillBatch(GameContext & aContext)
+{
+    return EntityBatch{aContext.mWorld, "pill blueprint",
+                       [&aContext](Entity & aBlueprint)
+                       { addPillComponents(aContext, aBlueprint, Pos2::Zero()); }};
+}
+
+ent::Handle<ent::Entity> createPill(const EntityBatch & aPills,
+                                    const math::Position<2, float> & aGridPos)
+{
+    return aPills.spawn(fmt::format("pill ({}, {})", aGridPos.x(), aGridPos.y()),
+                        [&aGridPos](Entity & aPill)
+                        {
+                            placeInstance(aPill, {aGridPos.x(), aGridPos.y(), gPillHeight});
+                        });
+}
+
 ent::Handle<ent::Entity>
 createPowerUp(GameContext & aContext,
               Phase & aPhase,
@@ -437,6 +483,28 @@ EntHandle createPathEntity(GameContext & aContext,
     return handle;
 }
 
+EntityBatch createPathBatch(GameContext & aContext)
+{
+    return EntityBatch{aContext.mWorld, "path blueprint",
+                       [&aContext](Entity & aBlueprint)
+                       {
+                           addLevelElementComponents(aContext, aBlueprint, Pos2::Zero(),
+                                                     math::hdr::gWhite<float>);
+                       }};
+}
+
+EntHandle createPathEntity(const EntityBatch & aPaths,
+                           const math::Position<2, float> & aGridPos,
+                           EntHandle pillHandle)
+{
+    return aPaths.spawn(fmt::format("Path ({}, {})", aGridPos.x(), aGridPos.y()),
+                        [&aGridPos, pillHandle](Entity & aPath)
+                        {
+                            placeInstance(aPath, {aGridPos.x(), aGridPos.y(), gLevelElementHeight});
+                            aPath.get<component::LevelTile>().mPill = pillHandle;
+                        });
+}
+
 ent::Handle<ent::Entity>
 createPortalEntity(GameContext & aContext,
                    Phase & aPhase,
@@ -1,5 +1,6 @@
 #pragma once
 
+#include "EntityBatch.h"
 #include "GameParameters.h"
 #include "Handle_V2.h"
 #include "component/PowerUp.h"
@@ -78,6 +79,15 @@ createPathEntity(GameContext & aContext,
                  ent::Phase & aPhase,
                  const math::Position<2, float> & aPos,
                  ent::Handle<ent::Entity> aPill = {});
+// Batched level utils, the entities are spawned from a shared blueprint
+EntityBatch createPillBatch(GameContext & aContext);
+ent::Handle<ent::Entity> createPill(const EntityBatch & aPills,
+                                    const math::Position<2, float> & aPos);
+EntityBatch createPathBatch(GameContext & aContext);
+ent::Handle<ent::Entity>
+createPathEntity(const EntityBatch & aPaths,
+                 const math::Position<2, float> & aPos,
+                 ent::Handle<ent::Entity> aPill = {});
 ent::Handle<ent::Entity>
 createCopPenEntity(GameContext & aContext,
                    const math::Position<2, float> & aPos);
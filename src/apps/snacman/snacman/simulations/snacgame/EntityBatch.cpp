@@ -0,0 +1,16 @@
+#include "EntityBatch.h"
+
+
+namespace ad {
+namespace snacgame {
+
+
+EntityBatch::~EntityBatch()
+{
+    Phase destroy;
+    mBlueprint.get(destroy)->erase();
+}
+
+
+} // namespace snacgame
+} // namespace ad
@@ -0,0 +1,69 @@
+#pragma once
+
+#include "typedef.h"
+
+#include <entity/Entity.h>
+#include <entity/EntityManager.h>
+
+#include <string>
+
+
+namespace ad {
+namespace snacgame {
+
+
+/// @brief Instantiates many entities sharing the same component set.
+///
+/// Adding components one by one moves the entity to a new archetype at each addition,
+/// which dominated the level creation (about 66us per tile entity).
+/// Instead, the full component set is added once to a blueprint, and each instance is created
+/// directly in the final archetype by copying the blueprint. The instance specific values
+/// are then written in place, which is not a structural change.
+///
+/// @note The blueprint entity is erased when the batch is destroyed, the instances are not affected.
+class EntityBatch
+{
+public:
+    /// @param aSetup Invoked as `aSetup(ent::Entity &)` on the blueprint, to add the shared components.
+    template <class T_setup>
+    EntityBatch(ent::EntityManager & aWorld, const char * aName, T_setup && aSetup);
+
+    ~EntityBatch();
+
+    EntityBatch(const EntityBatch &) = delete;
+    EntityBatch & operator=(const EntityBatch &) = delete;
+
+    /// @brief Create an instance with all the blueprint components.
+    /// @param aInit Invoked as `aInit(ent::Entity &)` on the instance, to write its own component values.
+    template <class T_init>
+    EntHandle spawn(const std::string & aName, T_init && aInit) const;
+
+private:
+    ent::EntityManager * mWorld;
+    EntHandle mBlueprint;
+};
+
+
+template <class T_setup>
+EntityBatch::EntityBatch(ent::EntityManager & aWorld, const char * aName, T_setup && aSetup) :
+    mWorld{&aWorld},
+    mBlueprint{aWorld.addBlueprint(aName)}
+{
+    Phase setup;
+    Entity blueprint = *mBlueprint.get(setup);
+    aSetup(blueprint);
+}
+
+
+template <class T_init>
+EntHandle EntityBatch::spawn(const std::string & aName, T_init && aInit) const
+{
+    EntHandle instance = mWorld->createFromBlueprint(mBlueprint, aName.c_str());
+    Entity entity = *instance.get();
+    aInit(entity);
+    return instance;
+}
+
+
+} // namespace snacgame
+} // namespace ad
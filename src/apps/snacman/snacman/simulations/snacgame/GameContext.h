@@ -22,6 +22,8 @@
 #include <snacman/Resources.h>
 #include <snac-renderer-V1/Camera.h>
 
+#include <utilities/JobPool.h>
+
 namespace ad {
 
 namespace snac {
@@ -103,6 +105,9 @@ struct GameContext
     const graphics::AppInterface & mAppInterface;
     pcg32_random_t mRandom;
     sounds::SoundManager mSoundManager{{SoundCategory_SFX, SoundCategory_Music}};
+    // Executes the concurrent systems of the simulation step.
+    // Few workers are needed: a step has a handful of systems that can overlap.
+    JobPool mJobPool{std::min(2u, JobPool::DefaultWorkerCount())};
 };
 
 } // namespace snacgame
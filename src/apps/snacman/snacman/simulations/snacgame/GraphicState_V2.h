@@ -123,6 +123,20 @@ struct GraphicState
 {
     static constexpr std::size_t MaxEntityId{2048};
 
+    /// @brief Reset to an empty state, while keeping the allocated storage of the containers.
+    ///
+    /// Intended for states that are recycled from one simulation step to the next.
+    void clear()
+    {
+        mEntities.clear();
+        mTextWorldEntities.clear();
+        mCamera = {};
+        mLights = {};
+        // Note: mEnvironment is intentionally kept, so its next copy-assignment can reuse storage.
+        mTextScreenEntities.clear();
+        mDebugDrawList = {};
+    }
+
     snac::SparseSet<Entity, MaxEntityId> mEntities;    
     snac::SparseSet<Text, MaxEntityId> mTextWorldEntities;
     // TODO #interpolation Interpolate the camera pose
@@ -152,26 +166,36 @@ void interpolateEach(float aInterpolant,
     }
 }
 
+/// @brief Interpolate into an existing state, reusing its storage.
 // TODO Handle cases where left and right do not have the same entities (i.e. only interpolate the sets intersection).
-inline GraphicState interpolate(const GraphicState & aLeft, const GraphicState & aRight, float aInterpolant)
+inline void interpolate(const GraphicState & aLeft,
+                        const GraphicState & aRight,
+                        float aInterpolant,
+                        GraphicState & aOut)
 {
-    GraphicState state{
-        // TODO #pose
-        //.mCamera = math::lerp(aLeft.mCamera.mPosition_world, aRight.mCamera.mPosition_world, aInterpolant),
-        .mCamera{aRight.mCamera},
-        // We probably do not want to interpolate lights, unlikely this would be noticeable
-        .mLights{aRight.mLights},
-        .mEnvironment{aRight.mEnvironment},
-        // Note: For the moment, we do not interpolate the debug drawings, both for simplicity and performance
-        .mDebugDrawList{aRight.mDebugDrawList},
-    };
-
-    interpolateEach(aInterpolant, aLeft.mEntities, aRight.mEntities, state.mEntities);
-
-    interpolateEach(aInterpolant, aLeft.mTextWorldEntities, aRight.mTextWorldEntities, state.mTextWorldEntities);
-
-    interpolateEach(aInterpolant, aLeft.mTextScreenEntities, aRight.mTextScreenEntities, state.mTextScreenEntities);
+    // TODO #pose
+    //aOut.mCamera = math::lerp(aLeft.mCamera.mPosition_world, aRight.mCamera.mPosition_world, aInterpolant),
+    aOut.mCamera = aRight.mCamera;
+    // We probably do not want to interpolate lights, unlikely this would be noticeable
+    aOut.mLights = aRight.mLights;
+    aOut.mEnvironment = aRight.mEnvironment;
+    // Note: For the moment, we do not interpolate the debug drawings, both for simplicity and performance
+    aOut.mDebugDrawList = aRight.mDebugDrawList;
+
+    aOut.mEntities.clear();
+    interpolateEach(aInterpolant, aLeft.mEntities, aRight.mEntities, aOut.mEntities);
+
+    aOut.mTextWorldEntities.clear();
+    interpolateEach(aInterpolant, aLeft.mTextWorldEntities, aRight.mTextWorldEntities, aOut.mTextWorldEntities);
+
+    aOut.mTextScreenEntities.clear();
+    interpolateEach(aInterpolant, aLeft.mTextScreenEntities, aRight.mTextScreenEntities, aOut.mTextScreenEntities);
+}
 
+inline GraphicState interpolate(const GraphicState & aLeft, const GraphicState & aRight, float aInterpolant)
+{
+    GraphicState state;
+    interpolate(aLeft, aRight, aInterpolant, state);
     return state;
 }
 
@@ -25,6 +25,7 @@
 #include <snac-renderer-V1/ResourceLoad.h>
 
 #include <snac-renderer-V2/Constants.h>
+#include <snac-renderer-V2/GlStateTracker.h>
 #include <snac-renderer-V2/Lights.h>
 #include <snac-renderer-V2/Pass.h>
 #include <snac-renderer-V2/Profiling.h>
@@ -70,15 +71,28 @@ namespace {
 } // unnamed namespace
 
 
-renderer::PassCache SnacGraph::preparePass(std::vector<renderer::Technique::Annotation> aAnnotations,
-                                           const PartList & aPartList,
-                                           renderer::Storage & aStorage)
+const SnacGraph::SortedPass & SnacGraph::getSortedPass(
+    const std::vector<renderer::Technique::Annotation> & aAnnotations,
+    renderer::Storage & aStorage)
 {
+    std::vector<renderer::StringKey> passKey;
+    passKey.reserve(2 * aAnnotations.size());
+    for(const renderer::Technique::Annotation & annotation : aAnnotations)
+    {
+        passKey.push_back(annotation.mCategory);
+        passKey.push_back(annotation.mValue);
+    }
+
+    SortedPass & sorted = mSortedPasses[passKey];
+    if(sorted.mPartListGeneration == mPartListGeneration
+       && sorted.mEffectsGeneration == aStorage.mEffectsGeneration)
+    {
+        return sorted;
+    }
+
     TIME_RECURRING_GL("prepare_pass");
 
-    renderer::DrawEntryHelper helper;
-    std::vector<renderer::PartDrawEntry> entries = 
-        helper.generateDrawEntries(aAnnotations, aPartList, aStorage);
+    sorted.mEntries = sorted.mHelper.generateDrawEntries(aAnnotations, mPartList, aStorage);
 
     //
     // Sort the entries
@@ -86,38 +100,89 @@ renderer::PassCache SnacGraph::preparePass(std::vector<renderer::Technique::Anno
     {
         TIME_RECURRING_GL("sort_draw_entries");
         // Since the PartList is sorted by Part, the PartDrawEntries will.
-        // By using a stable sort, we guarantee that all instance of a given part **with the same key**
+        // The radix sort is stable, so we guarantee that all instance of a given part **with the same key**
         // will still be adjacent, and in the same order, allowing some (restricted) instanced rendering.
         // Note: the restriction comes from the fact that sorting might create holes 
         //       in the pre-established instance buffer.
-        std::stable_sort(entries.begin(), entries.end());
+        // Note: for the same reason, and because the entries are reused by all views, the keys have no depth.
+        sorted.mHelper.sortDrawEntries(sorted.mEntries);
     }
 
     //
-    // Traverse the sorted array to generate the actual draw commands and draw calls
+    // Generate one draw call per distinct key
     //
-    renderer::PassCache result;
+    sorted.mCalls.clear();
+    sorted.mEntryCalls.clear();
+    sorted.mEntryCalls.reserve(sorted.mEntries.size());
     renderer::PartDrawEntry::Key drawKey = renderer::PartDrawEntry::gInvalidKey;
+    for(const renderer::PartDrawEntry & entry : sorted.mEntries)
+    {
+        if(sorted.mHelper.getDrawCallKey(entry) != drawKey)
+        {
+            drawKey = sorted.mHelper.getDrawCallKey(entry);
+            const renderer::Part & part = *mPartList.mParts[entry.mPartListIdx];
+            sorted.mCalls.push_back(sorted.mHelper.generateDrawCall(entry, part, *part.mVertexStream));
+        }
+        sorted.mEntryCalls.push_back((std::uint32_t)(sorted.mCalls.size() - 1));
+    }
+
+    sorted.mPartListGeneration = mPartListGeneration;
+    sorted.mEffectsGeneration = aStorage.mEffectsGeneration;
+    return sorted;
+}
+
+
+SnacGraph::ViewDraws & SnacGraph::prepareViewDraws(const SortedPass & aSortedPass,
+                                                   std::span<const renderer::LodView> aLodViews,
+                                                   GLfloat aLodMaxError)
+{
+    TIME_RECURRING_GL("prepare_view_draws");
+
+    if(mFrameViewCount == mViewDraws.size())
+    {
+        mViewDraws.emplace_back();
+    }
+    ViewDraws & view = mViewDraws[mFrameViewCount++];
+
+    //
+    // Traverse the sorted entries to generate the actual draw commands and draw calls
+    //
+    renderer::PassCache & result = mNextViewPassCache;
+    result.mCalls.clear();
+    result.mDrawCommands.clear();
+
+    std::uint32_t currentCall = std::numeric_limits<std::uint32_t>::max();
     // Note: there is actually no handle on Part atm...
     renderer::Handle<const renderer::Part> currentPart = renderer::gNullHandle;
+    std::size_t currentLod = 0;
     GLuint previousInstanceIdx = std::numeric_limits<GLuint>::max();
 
-    for(const renderer::PartDrawEntry & entry : entries)
+    for(std::size_t sortedIdx = 0; sortedIdx != aSortedPass.mEntries.size(); ++sortedIdx)
     {
-        renderer::Handle<const renderer::Part> part = aPartList.mParts[entry.mPartListIdx];
+        const renderer::PartDrawEntry & entry = aSortedPass.mEntries[sortedIdx];
+        if(!mVisibility[entry.mPartListIdx])
+        {
+            continue;
+        }
+
+        renderer::Handle<const renderer::Part> part = mPartList.mParts[entry.mPartListIdx];
         const renderer::VertexStream & vertexStream = *part->mVertexStream;
-        GLuint instanceIdx = aPartList.mInstanceIdx[entry.mPartListIdx];
+        GLuint instanceIdx = mPartList.mInstanceIdx[entry.mPartListIdx];
+        const std::size_t lod = renderer::selectLod(*part,
+                                                    mLodInstances[entry.mPartListIdx],
+                                                    aLodViews,
+                                                    aLodMaxError);
 
         // If true: this is the start of a new DrawCall
-        if(entry.mKey != drawKey)
+        if(aSortedPass.mEntryCalls[sortedIdx] != currentCall)
         {
-            // Record the new drawkey
-            drawKey = entry.mKey;
+            currentCall = aSortedPass.mEntryCalls[sortedIdx];
             // Push the new DrawCall
-            result.mCalls.push_back(helper.generateDrawCall(entry, *part, vertexStream));
+            result.mCalls.push_back(aSortedPass.mCalls[currentCall]);
         }
         else if(part == currentPart 
-            // If there is a "hole" in the instance sequence (e.g. the part before had a different key)
+            && lod == currentLod
+            // If there is a "hole" in the instance sequence (e.g. the part before had a different key, or was culled)
             // we cannot continue with the same instanced command
             && instanceIdx == (previousInstanceIdx + 1))
         {
@@ -137,12 +202,16 @@ renderer::PassCache SnacGraph::preparePass(std::vector<renderer::Technique::Anno
         // This means the offset into the buffer must be aligned with the index size.
         assert((vertexStream.mIndexBufferView.mOffset %  indiceSize) == 0);
 
+        const auto [indexFirst, indicesCount] = (lod == 0) ?
+            std::pair{part->mIndexFirst, part->mIndicesCount}
+            : std::pair{part->mLods[lod - 1].mIndexFirst, part->mLods[lod - 1].mIndicesCount};
+
         result.mDrawCommands.push_back(
             renderer::DrawElementsIndirectCommand{
-                .mCount = part->mIndicesCount,
+                .mCount = indicesCount,
                 .mInstanceCount = 1, // Will be incremented if next entry allows it.
                 .mFirstIndex = (GLuint)(vertexStream.mIndexBufferView.mOffset / indiceSize)
-                                + part->mIndexFirst,
+                                + indexFirst,
                 .mBaseVertex = part->mVertexFirst,
                 .mBaseInstance = instanceIdx,
             }
@@ -152,10 +221,21 @@ renderer::PassCache SnacGraph::preparePass(std::vector<renderer::Technique::Anno
         
         // Update inter-iteration variables
         currentPart = part;
+        currentLod = lod;
         previousInstanceIdx = instanceIdx;
     }
 
-    return result;
+    // When only the transforms changed, the commands of a view are usually identical to the previous frame.
+    const bool commandsChanged = (result.mDrawCommands != view.mPassCache.mDrawCommands);
+    std::swap(view.mPassCache, result);
+    if(commandsChanged)
+    {
+        renderer::proto::load(view.mIndirectBuffer,
+                              std::span{view.mPassCache.mDrawCommands},
+                              graphics::BufferHint::DynamicDraw);
+    }
+
+    return view;
 }
    
 
@@ -167,6 +247,10 @@ void SnacGraph::drawInstancedDirect(const renderer::Object & aObject,
 {
     using renderer::gl;
 
+    // Parts of an object usually share programs, blocks and textures:
+    // the tracker skips the binds that would not change the state.
+    renderer::GlStateTracker state;
+
     // ATTENTION: this logic assumes there is no override of the material for a part:
     // A given part **always** use the same material, in all entities.
     for(const renderer::Part & part : aObject.mParts)
@@ -175,26 +259,25 @@ void SnacGraph::drawInstancedDirect(const renderer::Object & aObject,
         if(renderer::Handle<renderer::ConfiguredProgram> configuredProgram = 
                 renderer::getProgram(*part.mMaterial.mEffect, annotations))
         {
-            // Materials are uploaded to the UBO by loadBinary()
+            // Materials are uploaded to the SSBO by loadBinary()
             // ViewProjection data should already be loaded by the calling code.
             
-            // Consolidate the UBO repository:
-            // Make a copy of the materials ubo, and append to it.
-            renderer::RepositoryUbo repositoryUbo = part.mMaterial.mContext->mUboRepo;
-            for(const auto & [semantic, ubo] : mGraphUbos.mUboRepository)
-            {
-                repositoryUbo[semantic] = ubo;
-            }
-
-            renderer::setBufferBackedBlocks(configuredProgram->mProgram, repositoryUbo);
+            // The graph UBOs take precedence, the material UBOs are looked up as a fallback.
+            renderer::setBufferBackedBlocks(configuredProgram->mProgram,
+                                            mGraphUbos.mUboRepository,
+                                            &part.mMaterial.mContext->mUboRepo,
+                                            state);
 
-            renderer::setTextures(configuredProgram->mProgram, part.mMaterial.mContext->mTextureRepo);
+            renderer::setTextures(configuredProgram->mProgram,
+                                  part.mMaterial.mContext->mTextureRepo,
+                                  nullptr,
+                                  state);
 
             renderer::Handle<graphics::VertexArrayObject> vao =
                 renderer::getVao(*configuredProgram, part, aStorage);
 
-            graphics::ScopedBind vaoScope{*vao};
-            graphics::ScopedBind programScope{configuredProgram->mProgram.mProgram};
+            state.bindVertexArray(*vao);
+            state.useProgram(configuredProgram->mProgram);
 
             gl.DrawElementsInstancedBaseVertexBaseInstance(
                 part.mPrimitiveMode,
@@ -208,6 +291,8 @@ void SnacGraph::drawInstancedDirect(const renderer::Object & aObject,
         }
         aBaseInstance += aInstancesCount;
     }
+
+    state.restore();
 };
 
 
@@ -234,28 +319,48 @@ struct EntitiesRecord
 };
 
 
-void SnacGraph::passDepth(SnacGraph::PartList aPartList,
+void SnacGraph::cull(std::span<const math::Matrix<4, 4, GLfloat>> aViewProjections)
+{
+    TIME_RECURRING_GL("Frustum_culling", renderer::VisibleInstances, renderer::CulledInstances);
+
+    assert(mCuller.size() == mPartList.mParts.size());
+    const std::size_t visibleCount = mCuller.cull(aViewProjections, mVisibility);
+    renderer::gl.countCulling((unsigned int)visibleCount,
+                              (unsigned int)(mVisibility.size() - visibleCount));
+}
+
+
+void SnacGraph::drawView(const std::vector<renderer::Technique::Annotation> & aAnnotations,
+                         std::span<const math::Matrix<4, 4, GLfloat>> aViewProjections,
+                         const renderer::RepositoryTexture & aTextureRepository,
+                         renderer::Storage & aStorage,
+                         GLfloat aLodBias)
+{
+    cull(aViewProjections);
+
+    mLodViews.clear();
+    for(const math::Matrix<4, 4, GLfloat> & viewProjection : aViewProjections)
+    {
+        mLodViews.push_back(renderer::LodView::FromViewProjection(viewProjection));
+    }
+    ViewDraws & view = prepareViewDraws(getSortedPass(aAnnotations, aStorage),
+                                        mLodViews,
+                                        mUseLods ? aLodBias * mLodMaxError : 0.f);
+
+    graphics::ScopedBind boundIndirect{view.mIndirectBuffer};
+    DISABLE_PROFILING_GL;
+    renderer::draw(view.mPassCache,
+                   mGraphUbos.mUboRepository,
+                   aTextureRepository);
+    ENABLE_PROFILING_GL;
+}
+
+
+void SnacGraph::passDepth(std::span<const math::Matrix<4, 4, GLfloat>> aLightViewProjections,
                           renderer::RepositoryTexture aTextureRepository,
                           renderer::Storage & aStorage,
                           renderer::DepthMethod aDepthMethod)
 {
-    renderer::PassCache passCache = 
-        SnacGraph::preparePass(
-            {
-                {"pass", (aDepthMethod == renderer::DepthMethod::Cascaded ?  
-                          "cascaded_depth_opaque"
-                          : "depth_opaque")
-                },
-                {"entities", "on"},
-            },
-            aPartList,
-            aStorage);
-
-    // Load the draw indirect buffer with command generated in preparePass()
-    renderer::proto::load(mIndirectBuffer,
-                          std::span{passCache.mDrawCommands},
-                          graphics::BufferHint::StreamDraw);
-
     {
         glEnable(GL_CULL_FACE);
         glEnable(GL_DEPTH_TEST);
@@ -263,11 +368,18 @@ void SnacGraph::passDepth(SnacGraph::PartList aPartList,
         glDisable(GL_BLEND);
     }
 
-    DISABLE_PROFILING_GL;
-    renderer::draw(passCache,
-                   mGraphUbos.mUboRepository,
-                   aTextureRepository);
-    ENABLE_PROFILING_GL;
+    drawView(
+        {
+            {"pass", (aDepthMethod == renderer::DepthMethod::Cascaded ?  
+                      "cascaded_depth_opaque"
+                      : "depth_opaque")
+            },
+            {"entities", "on"},
+        },
+        aLightViewProjections,
+        aTextureRepository,
+        aStorage,
+        mShadowLodBias);
 }
 
 
@@ -281,6 +393,10 @@ void SnacGraph::renderWorld(const visu_V2::GraphicState & aState,
     // TODO Ad 2024/04/09: #staticentities We might actually want several, for example one that is constant
     // between frames and contain the draw commands for static geometry.
     gl.BindBuffer(GL_DRAW_INDIRECT_BUFFER, mIndirectBuffer);
+    mFrameViewCount = 0;
+
+    // Might wait for the GPU to complete the frame that last used the region, so do it as late as possible.
+    mStreamingBuffer->beginFrame();
         
     // TODO can we host as data member ? It is mostly permanent, used for the shadow map, but the texture change on depth method change...
     renderer::RepositoryTexture textureRepository;
@@ -301,49 +417,113 @@ void SnacGraph::renderWorld(const visu_V2::GraphicState & aState,
     // Populate sortedModels and the global matrix palette
     //
     auto sortModelEntry = BEGIN_RECURRING_GL("Sort_meshes_and_animate");
-    // The "ideal" semantic for the paletted buffer is a local,
-    // but we do not want to reallocate dynamic data each frame. So clear between runs.
-    mRiggingPalettesBuffer.clear();
-    for (const visu_V2::Entity & entity : aState.mEntities)
+    // Only reserve a slice of the palette buffer for each distinct pose,
+    // the poses and palettes are computed afterwards by the skinning jobs.
+    mSkinningJobs.clear();
+    mPoseToPaletteOffset.clear();
+    GLuint paletteSize = 0;
+    for (const auto & entityEntry : aState.mEntities)
     {
+        const visu_V2::Entity & entity = entityEntry.get();
         assert(entity.mInstance.mObject != renderer::gNullHandle 
             && "Only instances with geometry should be part of the GraphicState");
         renderer::Handle<const renderer::Object> object = entity.mInstance.mObject;
 
-        // Offset to the matrix palette that will be computed by this iteration
-        GLuint matrixPaletteOffset = (GLuint)mRiggingPalettesBuffer.size();
+        // Offset to the matrix palette of this entity
+        GLuint matrixPaletteOffset = paletteSize;
 
-        if(auto rigAnimation = entity.mAnimationState.mAnimation;
-           rigAnimation != renderer::gNullHandle)
+        if(object->mAnimatedRig)
         {
+            const renderer::Rig & rig = object->mAnimatedRig->mRig;
+            // Entities without animation are in the rig default pose.
+            const renderer::RigAnimation * rigAnimation = entity.mAnimationState.mAnimation;
+            const renderer::PoseKey poseKey = 
+                renderer::makePoseKey(rig, rigAnimation, entity.mAnimationState.mParameterValue);
+
+            // Entities in the same pose share a single palette.
+            auto [found, isNewPose] = mPoseToPaletteOffset.try_emplace(poseKey, paletteSize);
+            matrixPaletteOffset = found->second;
+            if(isNewPose)
             {
-                TIME_RECURRING_GL("Prepare_joint_matrices");
-
-                //entity.mInstance->mAnimationState =
-                auto posedNodes =
-                    renderer::animate(*rigAnimation,
-                                      entity.mAnimationState.mParameterValue,
-                                      object->mAnimatedRig->mRig.mJointTree);
-
-                object->mAnimatedRig->mRig.computeJointMatrices(
-                    std::back_inserter(mRiggingPalettesBuffer),
-                    posedNodes);
+                mSkinningJobs.push_back(SkinningJob{
+                    .mPoseKey = poseKey,
+                    .mEntityId = entityEntry.id(),
+                    .mPaletteOffset = matrixPaletteOffset,
+                });
+                paletteSize += (GLuint)rig.countJoints();
             }
         }
 
         sortedModels[object].append(
             SnacGraph::EntityData_glsl{
-                .mModelTransform = poseTransformMatrix(entity.mInstanceScaling, entity.mInstance.mPose),
+                // Quantized vertex positions are first mapped back to the object space.
+                .mModelTransform = static_cast<math::AffineMatrix<4, float>>(object->mPositionDequantization)
+                                   * poseTransformMatrix(entity.mInstanceScaling, entity.mInstance.mPose),
                 .mColorFactor = entity.mColor,
             },
             matrixPaletteOffset);
     }
 
-    //
-    // Load the matrix palettes UBO with all palettes computed during the loop
-    //
-    renderer::loadJoints(mGraphUbos.mJointMatricesUbo,
-                         std::span{mRiggingPalettesBuffer});
+    if(mAnimateOnGpu)
+    {
+        TIME_RECURRING_GL("Prepare_joint_matrices");
+
+        // Only the (animation, time) of each distinct pose is uploaded,
+        // the compute program writes the palettes directly in the joint matrices SSBO.
+        mGpuAnimatedInstances.clear();
+        for(const SkinningJob & job : mSkinningJobs)
+        {
+            mGpuAnimatedInstances.push_back(renderer::RigAnimationCompute::AnimatedInstance{
+                .mAnimation = mRigAnimationCompute.getAnimationId(*job.mPoseKey.mRig, job.mPoseKey.mAnimation),
+                .mTimepoint = job.mPoseKey.timepoint(),
+                .mPaletteOffset = job.mPaletteOffset,
+            });
+        }
+        mRigAnimationCompute.dispatch(mGpuAnimatedInstances, paletteSize, mGraphUbos.mJointMatricesSsbo);
+        mGraphUbos.mUboRepository.at(renderer::semantic::gJointMatrices) = &mGraphUbos.mJointMatricesSsbo;
+    }
+    else
+    {
+        TIME_RECURRING_GL("Prepare_joint_matrices");
+
+        if(mAnimatedEntities.size() < visu_V2::GraphicState::MaxEntityId)
+        {
+            mAnimatedEntities.resize(visu_V2::GraphicState::MaxEntityId);
+        }
+
+        const renderer::StreamingBuffer::Range paletteRange =
+            mStreamingBuffer->allocateShaderStorage<math::AffineMatrix<4, GLfloat>>(paletteSize);
+        const std::span<math::AffineMatrix<4, GLfloat>> palettes =
+            paletteRange.as<math::AffineMatrix<4, GLfloat>>();
+
+        // Each job only touches its entity storage and its own slice of the palettes,
+        // writing the matrices directly in the mapped buffer.
+        // (The writes are sequential: the mapped memory might be write-combined, it should not be read back.)
+        mSkinningJobPool->parallelFor(mSkinningJobs.size(), [this, palettes](std::size_t aJobIdx)
+        {
+            const SkinningJob & job = mSkinningJobs[aJobIdx];
+            const renderer::Rig & rig = *job.mPoseKey.mRig;
+            auto paletteFirst = palettes.begin() + job.mPaletteOffset;
+
+            if(job.mPoseKey.mAnimation == nullptr)
+            {
+                std::copy(rig.mDefaultPalette.begin(), rig.mDefaultPalette.end(), paletteFirst);
+                return;
+            }
+
+            AnimatedEntity & animated = mAnimatedEntities[job.mEntityId];
+
+            renderer::animate(*job.mPoseKey.mAnimation,
+                              job.mPoseKey.timepoint(),
+                              rig.mJointTree,
+                              animated.mSampler,
+                              animated.mPosedNodes);
+
+            rig.computeJointMatrices(paletteFirst, animated.mPosedNodes);
+        });
+
+        mGraphUbos.mUboRepository.at(renderer::semantic::gJointMatrices) = paletteRange.binding();
+    }
 
     END_RECURRING_GL(sortModelEntry);
 
@@ -351,38 +531,30 @@ void SnacGraph::renderWorld(const visu_V2::GraphicState & aState,
     SnacGraph::PartList partList;
 
     //
-    // Load the EntityData buffer (UBO) and the Instance buffer (instanced Vertex attribute)
+    // Load the EntityData buffer (SSBO) and the Instance buffer (instanced Vertex attribute)
     // and populate the PartList
     //
     {
-        // TODO Ad 2024/04/04: Should we use SSBO for this kind of "unbound" data?
-        assert(totalEntities <= renderer::gMaxEntities
-            && ("Currently, the shader Uniform Block array is " + std::to_string(renderer::gMaxEntities) + ".").c_str());
+        // Entity indices must fit in their field of the packed instance data.
+        // (the graphic state cannot hold more than MaxEntityId entities)
+        static_assert(visu_V2::GraphicState::MaxEntityId <= renderer::PackedEntityMaterial::max<0>() + 1);
 
-        graphics::ScopedBind boundEntitiesUbo{mGraphUbos.mEntitiesUbo};
-        // Orphan the buffer, and set it to the current size 
-        //(TODO: might be good to keep a separate counter to never shrink it)
-        gl.BufferData(GL_UNIFORM_BUFFER,
-                      sizeof(SnacGraph::EntityData_glsl) * totalEntities,
-                      nullptr,
-                      GL_STREAM_DRAW);
+        // The entities are written directly in the streaming buffer, without any GL call.
+        const renderer::StreamingBuffer::Range entitiesRange =
+            mStreamingBuffer->allocateShaderStorage<SnacGraph::EntityData_glsl>(totalEntities);
+        const std::span<SnacGraph::EntityData_glsl> entitiesData = entitiesRange.as<SnacGraph::EntityData_glsl>();
+        mGraphUbos.mUboRepository.at(renderer::semantic::gEntities) = entitiesRange.binding();
 
         mInstanceBuffer.clear();
-        GLintptr entityDataOffset = 0;
+        mCuller.clear();
+        mLodInstances.clear();
         GLuint entityIdxOffset = 0;
         GLuint instanceIdx = 0;
         for (const auto & [object, entities] : sortedModels)
         {
-            // This implementation relies on multiple loads, 
-            // maybe it is a good candidate for buffer mapping? (glMapBufferRange())
-            GLsizeiptr size = entities.size() * sizeof(SnacGraph::EntityData_glsl);
-            gl.BufferSubData(
-                GL_UNIFORM_BUFFER,
-                entityDataOffset,
-                size,
-                entities.mEntitiesBlock.data());
-
-            entityDataOffset += size;
+            std::copy(entities.mEntitiesBlock.begin(),
+                      entities.mEntitiesBlock.end(),
+                      entitiesData.begin() + entityIdxOffset);
 
             // We load all the required entities indices for **each Part**,
             // before moving on to the next Part to load the same entities.
@@ -395,8 +567,10 @@ void SnacGraph::renderWorld(const visu_V2::GraphicState & aState,
                     ++entityLocalIdx)
                 {
                     mInstanceBuffer.push_back(SnacGraph::InstanceData{
-                        .mEntityIdx = entityLocalIdx + entityIdxOffset,
-                        .mMaterialParametersIdx = (GLuint)part.mMaterial.mMaterialParametersIdx,
+                        .mEntityMaterial = renderer::PackedEntityMaterial{
+                            entityLocalIdx + entityIdxOffset,
+                            (GLuint)part.mMaterial.mMaterialParametersIdx,
+                        },
                         .mMatrixPaletteOffset = entities.mMatrixPaletteOffsets[entityLocalIdx],
                     });
 
@@ -405,14 +579,43 @@ void SnacGraph::renderWorld(const visu_V2::GraphicState & aState,
                     // (so we can look up the Program for a given pass)
                     partList.push_back(&part, &part.mMaterial, instanceIdx);
                     ++instanceIdx;
+
+                    const math::AffineMatrix<4, float> & modelTransform =
+                        entities.mEntitiesBlock[entityLocalIdx].mModelTransform;
+                    const math::Box<GLfloat> worldBounds =
+                        renderer::transformAabb(object->mPositionDequantization.quantize(part.mAabb), modelTransform);
+
+                    // The part bounds are for the rest pose, they do not bound the animated geometry.
+                    if(object->mAnimatedRig != renderer::gNullHandle)
+                    {
+                        mCuller.pushUnbounded();
+                    }
+                    else
+                    {
+                        mCuller.push_back(worldBounds);
+                    }
+
+                    // The errors of the levels of detail are in the Part space, before the position quantization.
+                    mLodInstances.push_back(renderer::LodInstance{
+                        .mCenter = worldBounds.center(),
+                        .mScale = renderer::getMaxScale(modelTransform) / object->mPositionDequantization.mScale,
+                    });
                 }
             }
             entityIdxOffset += (GLuint)entities.size();
         }
     }
 
+    // Draw entries only depend on the PartList entries, so they can be reused while those do not change.
+    if(!partList.hasSameEntries(mPartList))
+    {
+        ++mPartListGeneration;
+    }
+    mPartList = std::move(partList);
+
     // Load the instance buffer, at once.
-    renderer::proto::load(*getBufferView(mInstanceStream, renderer::semantic::gEntityIdx).mGLBuffer,
+    // Note: it is not streamed, because the VAOs attach the instance buffer at a fixed offset.
+    renderer::proto::load(*getBufferView(mInstanceStream, renderer::semantic::gPackedEntityMaterial).mGLBuffer,
                           std::span{mInstanceBuffer},          
                           graphics::BufferHint::StreamDraw);
 
@@ -446,9 +649,10 @@ void SnacGraph::renderWorld(const visu_V2::GraphicState & aState,
             .mLightViewProjectionUbo = &mGraphUbos.mLightViewProjectionUbo,
             .mShadowCascadeUbo = &mGraphUbos.mShadowCascadeUbo,
         },
-        [this, &partList, &textureRepository, &aStorage](renderer::DepthMethod aMethod)
+        [this, &textureRepository, &aStorage]
+        (renderer::DepthMethod aMethod, std::span<const math::Matrix<4, 4, GLfloat>> aLightViewProjections)
         {
-            passDepth(partList, textureRepository, aStorage, aMethod);
+            passDepth(aLightViewProjections, textureRepository, aStorage, aMethod);
         });
 
     textureRepository[renderer::semantic::gShadowMap] = mShadowMapping.mShadowMap;
@@ -521,26 +725,16 @@ void SnacGraph::renderWorld(const visu_V2::GraphicState & aState,
     else
     {
         // Multi-draw indirect
-        renderer::PassCache passCache = 
-            SnacGraph::preparePass(
-                {
-                    {"pass", gForwardPass},
-                    {"entities", "on"},
-                    {(mShadowMapping.mControls.mUseCascades ? "csm" : "shadows"), "on"},
-                },
-                partList,
-                aStorage);
-
-        // Load the draw indirect buffer with command generated in preparePass()
-        renderer::proto::load(mIndirectBuffer,
-                              std::span{passCache.mDrawCommands},
-                              graphics::BufferHint::StreamDraw);
-
-        DISABLE_PROFILING_GL;
-        renderer::draw(passCache,
-                       mGraphUbos.mUboRepository,
-                       textureRepository);
-        ENABLE_PROFILING_GL;
+        const math::Matrix<4, 4, GLfloat> viewProjection = aState.mCamera.assembleViewProjection();
+        drawView(
+            {
+                {"pass", gForwardPass},
+                {"entities", "on"},
+                {(mShadowMapping.mControls.mUseCascades ? "csm" : "shadows"), "on"},
+            },
+            std::span{&viewProjection, 1},
+            textureRepository,
+            aStorage);
     }
 
     // Skybox
@@ -561,6 +755,9 @@ void SnacGraph::renderWorld(const visu_V2::GraphicState & aState,
                           graphics::BufferHint::StreamDraw);
         mSkybox.pass(mGraphUbos.mUboRepository, aState.mEnvironment);
     }
+
+    // All the commands reading the streamed ranges of this frame are issued.
+    mStreamingBuffer->endFrame();
 }
 
 
@@ -623,7 +820,7 @@ void SnacGraph::passText(
         renderer::proto::load(*glyphPart.mInstanceToStringEntityBuffer,
                               std::span{glyphInstanceToStringEntity},
                               graphics::BufferHint::StreamDraw);
-        renderer::proto::load(*glyphPart.mStringEntitiesUbo,
+        renderer::proto::load(*glyphPart.mStringEntitiesSsbo,
                               std::span{stringEntities},
                               graphics::BufferHint::StreamDraw);
         const GLsizei glyphCount = (GLsizei)allGlyphInstances.size();
@@ -707,20 +904,58 @@ Renderer_V2::Renderer_V2(graphics::AppInterface & aAppInterface,
 {}
 
 
-renderer::Handle<const renderer::Object> Renderer_V2::loadModel(filesystem::path aModel,
-                                                                filesystem::path aEffect, 
-                                                                Resources_t & aResources)
+Renderer_V2::PreparedModel Renderer_V2::prepareModel(filesystem::path aModel)
 {
     // If the provided path is a ".sel" file, read the features
     auto model = (aModel.extension() == ".sel") ?
         renderer::getModelAndFeatures(aModel) :
         renderer::ModelWithFeatures{.mModel = aModel};
 
-    if(auto loadResult = loadBinary(model.mModel, 
-                                    mRendererToKeep.mStorage,
-                                    aResources.loadEffect(aEffect, mRendererToKeep.mStorage, model.mFeatures),
-                                    mRendererToKeep.mRenderGraph.mInstanceStream);
-        std::holds_alternative<renderer::Node>(loadResult))
+    auto prepareResult = renderer::prepareBinary(model.mModel);
+    if(auto * errorCode = std::get_if<renderer::SeumErrorCode>(&prepareResult))
+    {
+        // Atempt to reprocess (gltf to seum) if the error code indicates outdated version
+        if(auto basePath = filesystem::path{model.mModel}.replace_extension(".gltf");
+           *errorCode == renderer::SeumErrorCode::OutdatedVersion && is_regular_file(basePath))
+        {
+            SELOG(warn)("Failed to load '{}', error code '{}'. Attempting to re-process file '{}'.", 
+                        model.mModel.string(),
+                        (unsigned int)*errorCode,
+                        basePath.string());
+            // Models might be prepared concurrently, so the global importer logger must not be used.
+            ad::renderer::processModel(basePath, {.mImporterLog = false});
+            // Note: a single new attempt, since the seum file has been processed
+            //       and should now match the current version.
+            prepareResult = renderer::prepareBinary(model.mModel);
+        }
+    }
+
+    if(auto * errorCode = std::get_if<renderer::SeumErrorCode>(&prepareResult))
+    {
+        SELOG(critical)("Failed to load '{}', error code '{}'.", 
+                        model.mModel.string(),
+                        (unsigned int)*errorCode);
+        throw std::runtime_error{"Invalid binary file in loadModel()."};
+    }
+
+    return PreparedModel{
+        .mBinary = std::get<renderer::PreparedBinary>(std::move(prepareResult)),
+        .mFeatures = std::move(model.mFeatures),
+    };
+}
+
+
+renderer::Handle<const renderer::Object> Renderer_V2::uploadModel(PreparedModel aModel,
+                                                                  filesystem::path aEffect, 
+                                                                  Resources_t & aResources)
+{
+    const filesystem::path modelPath = aModel.mBinary.mPath;
+    auto loadResult = loadBinary(std::move(aModel.mBinary), 
+                                 mRendererToKeep.mStorage,
+                                 aResources.loadEffect(aEffect, mRendererToKeep.mStorage, aModel.mFeatures),
+                                 mRendererToKeep.mRenderGraph.mInstanceStream);
+
+    if(std::holds_alternative<renderer::Node>(loadResult))
     {
         // TODO Ad 2024/03/27: This does not feel right:
         // we would like the models to be consistent discretes Objects,
@@ -732,33 +967,40 @@ renderer::Handle<const renderer::Object> Renderer_V2::loadModel(filesystem::path
         {
             throw std::logic_error{"There should have been an object in the Node hierarchy of a VisualModel"};
         }
+
+        // Material indices must fit in their field of the packed instance data,
+        // otherwise the parts would silently be drawn with another material.
+        for(const renderer::Part & part : object->mParts)
+        {
+            if(part.mMaterial.mMaterialParametersIdx > renderer::PackedEntityMaterial::max<1>())
+            {
+                SELOG(critical)("Failed to upload '{}', part '{}' material index {} exceeds the packed maximum {}.",
+                                modelPath.string(),
+                                part.mName,
+                                part.mMaterial.mMaterialParametersIdx,
+                                renderer::PackedEntityMaterial::max<1>());
+                throw std::runtime_error{"Material index overflow in loadModel()."};
+            }
+        }
         return object;
     }
     else
     {
-        // Atempt to reprocess (gltf to seum) if the error code indicates outdated version
-        auto errorCode = std::get<renderer::SeumErrorCode>(loadResult);
-        if(auto basePath = filesystem::path{aModel}.replace_extension(".gltf");
-           errorCode == renderer::SeumErrorCode::OutdatedVersion && is_regular_file(basePath))
-        {
-            SELOG(warn)("Failed to load '{}', error code '{}'. Attempting to re-process file '{}'.", 
-                        aModel.string(),
-                        (unsigned int)errorCode,
-                        basePath.string());
-            ad::renderer::processModel(basePath);
-            // Note: This recursion intention is to try again **one** time, since the seum file has been processed
-            //       and should now match the current version (which would prevent re-satisfying this condition)
-            //       This is quite brittle, and could lead to infinite loops.
-            return loadModel(aModel, aEffect, aResources);
-        }
-
-        SELOG(critical)("Failed to load '{}', error code '{}'.", 
-                        aModel.string(),
-                        (unsigned int)errorCode);
+        SELOG(critical)("Failed to upload '{}', error code '{}'.", 
+                        modelPath.string(),
+                        (unsigned int)std::get<renderer::SeumErrorCode>(loadResult));
         throw std::runtime_error{"Invalid binary file in loadModel()."};
     }
 }
 
+
+renderer::Handle<const renderer::Object> Renderer_V2::loadModel(filesystem::path aModel,
+                                                                filesystem::path aEffect, 
+                                                                Resources_t & aResources)
+{
+    return uploadModel(prepareModel(std::move(aModel)), std::move(aEffect), aResources);
+}
+
 // TODO Ad 2024/11/27: #text I really dislike that it is taking a reference to Freetype
 // The current loading code is messy, and I suppose that could lead to data-races.
 // Could the font should be moved entirely to main thread? (only calling render-thread to load OpenGL resources)
@@ -799,6 +1041,8 @@ void Renderer_V2::continueGui()
     addCheckbox("Render models", mControl.mRenderModels);
     addCheckbox("Render text", mControl.mRenderText);
     addCheckbox("Render debug", mControl.mRenderDebug);
+    addCheckbox("Animate on GPU", mControl.mAnimateOnGpu);
+    addCheckbox("Levels of detail", mControl.mUseLods);
 
     ImGui::Checkbox("Show shadow controls", &mControl.mShowShadowControls);
     if (mControl.mShowShadowControls)
@@ -815,7 +1059,8 @@ void Renderer_V2::continueGui()
 void Renderer_V2::render(const GraphicState_t & aState)
 {
 
-    TIME_RECURRING_GL("Render", renderer::GpuPrimitiveGen, renderer::DrawCalls);
+    TIME_RECURRING_GL("Render", renderer::GpuPrimitiveGen, renderer::DrawCalls,
+                      renderer::BufferMemoryWritten, renderer::FenceWaits);
 
     const math::Size<2, int> framebufferSize = mAppInterface.getFramebufferSize();
 
@@ -824,6 +1069,8 @@ void Renderer_V2::render(const GraphicState_t & aState)
     //
     if (mControl.mRenderModels)
     {
+        mRendererToKeep.mRenderGraph.mAnimateOnGpu = mControl.mAnimateOnGpu;
+        mRendererToKeep.mRenderGraph.mUseLods = mControl.mUseLods;
         mRendererToKeep.mRenderGraph.renderWorld(aState, mRendererToKeep.mStorage, framebufferSize);
     }
 
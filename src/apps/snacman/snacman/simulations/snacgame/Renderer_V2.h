@@ -12,6 +12,7 @@
 
 // V2: the good stuff
 #include <snac-renderer-V2/Camera.h>
+#include <snac-renderer-V2/Constants.h>
 #include <snac-renderer-V2/Model.h>
 #include <snac-renderer-V2/Pass.h>
 #include <snac-renderer-V2/Semantics.h>
@@ -21,12 +22,24 @@
 #include <snac-renderer-V2/files/Loader.h>
 
 #include <snac-renderer-V2/graph/EnvironmentMapping.h>
+#include <snac-renderer-V2/graph/RigAnimationCompute.h>
 #include <snac-renderer-V2/graph/ShadowMapping.h>
 
+#include <snac-renderer-V2/utilities/FrustumCulling.h>
+#include <snac-renderer-V2/utilities/LevelOfDetail.h>
+#include <snac-renderer-V2/utilities/StreamingBuffer.h>
 #include <snac-renderer-V2/utilities/VertexStreamUtilities.h>
 
+#include <utilities/JobPool.h>
+
+#include <algorithm>
+#include <deque>
 #include <filesystem>
+#include <map>
 #include <memory>
+#include <span>
+#include <unordered_map>
+#include <vector>
 
 
 namespace ad {
@@ -57,7 +70,7 @@ struct SnacGraph
     struct alignas(16) EntityData_glsl
     {
         // Note: 16-aligned, because it is intended to be stored as an array in a buffer object
-        // and then the elements are accessed via a std140 uniform block
+        // and then the elements are accessed via a std430 shader storage block
 
         math::AffineMatrix<4, GLfloat> mModelTransform;
         math::hdr::Rgba_f mColorFactor;
@@ -69,13 +82,15 @@ struct SnacGraph
     /// @brief The data to populate the GL instance attribute buffer, for instanced rendering.
     ///
     /// From our data model, the graphics API instance is the Part (not the Object)
+    /// The indices are packed, since the whole stream is loaded each frame.
     struct InstanceData
     {
-        GLuint mEntityIdx;
-        GLuint mMaterialParametersIdx;
+        renderer::PackedEntityMaterial mEntityMaterial;
         GLuint mMatrixPaletteOffset = (GLuint)-1;
     };
 
+    static_assert(sizeof(InstanceData) == 8);
+
     /// @brief The list of parts to be rendered. This might be valid for several passes (intra, or inter frame)
     struct PartList : public renderer::PartList
     {
@@ -86,6 +101,14 @@ struct SnacGraph
             mInstanceIdx.push_back(aInstanceIdx);
         }
 
+        /// @brief Compare the entries, which are all the draw entries depend on.
+        bool hasSameEntries(const PartList & aRhs) const
+        {
+            return mParts == aRhs.mParts
+                && mMaterials == aRhs.mMaterials
+                && mInstanceIdx == aRhs.mInstanceIdx;
+        }
+
         // SOA, continued
         // Index of this part in the instance buffer, which is filled before creating the partlist.
         std::vector<GLuint> mInstanceIdx;
@@ -94,9 +117,45 @@ struct SnacGraph
         //std::vector<GLuint> mEntityIdx;
     };
 
-    static renderer::PassCache preparePass(std::vector<renderer::Technique::Annotation> aAnnotations,
-                                           const PartList & aPartList,
-                                           renderer::Storage & aStorage);
+    /// @brief The sorted draw entries of a pass, for a given generation of the PartList.
+    ///
+    /// Sorting and generating the draw calls (program and VAO lookups) only depend on the PartList entries,
+    /// not on the entities transforms. So it is reused by all the views rendering the pass in a frame
+    /// (e.g. each shadow light and its cascades), and by the following frames while the PartList is unchanged.
+    struct SortedPass
+    {
+        renderer::DrawEntryHelper mHelper;
+        std::vector<renderer::PartDrawEntry> mEntries;
+        // One DrawCall per distinct key in mEntries, their mDrawCount is left to zero.
+        std::vector<renderer::DrawCall> mCalls;
+        // For each entry in mEntries, the index of its DrawCall in mCalls.
+        std::vector<std::uint32_t> mEntryCalls;
+        // The PartList generation the entries were sorted for.
+        std::uint64_t mPartListGeneration = 0;
+        // The Storage effects generation the entries were generated for (their programs change on recompilation).
+        std::uint64_t mEffectsGeneration = 0;
+    };
+
+    /// @brief The draw commands of a view (i.e. a pass rendered from a viewpoint), with their own indirect buffer.
+    ///
+    /// Views are identified by their order of rendering in the frame,
+    /// the buffer is only reloaded when the commands differ from the previous frame.
+    struct ViewDraws
+    {
+        renderer::PassCache mPassCache;
+        graphics::Buffer<graphics::BufferType::DrawIndirect> mIndirectBuffer;
+    };
+
+    /// @brief Return the SortedPass for the annotations, sorting it again if the PartList changed.
+    const SortedPass & getSortedPass(const std::vector<renderer::Technique::Annotation> & aAnnotations,
+                                     renderer::Storage & aStorage);
+
+    /// @brief Generate the draw commands of the next view, for the entries of aSortedPass visible in mVisibility.
+    /// Each entry draws its level of detail selected for aLodViews.
+    /// The view indirect buffer is reloaded if the commands changed.
+    ViewDraws & prepareViewDraws(const SortedPass & aSortedPass,
+                                 std::span<const renderer::LodView> aLodViews,
+                                 GLfloat aLodMaxError);
 
     static renderer::GenericStream makeInstanceStream(renderer::Storage & aStorage)
     {
@@ -106,29 +165,16 @@ struct SnacGraph
                                                                    GL_STREAM_DRAW,
                                                                    aStorage);
 
-        // TODO Ad 2024/04/04: #perf Indices should be grouped by 4 in vertex attributes,
-        // instead of using a distinct attribute each.
         return renderer::GenericStream{
             .mVertexBufferViews = { vboView, },
             .mSemanticToAttribute{
                 {
-                    renderer::semantic::gEntityIdx,
+                    renderer::semantic::gPackedEntityMaterial,
                     renderer::AttributeAccessor{
                         .mBufferViewIndex = 0, // view is added above
                         .mClientDataFormat{
                             .mDimension = 1,
-                            .mOffset = offsetof(InstanceData, mEntityIdx),
-                            .mComponentType = GL_UNSIGNED_INT,
-                        },
-                    }
-                },
-                {
-                    renderer::semantic::gMaterialIdx,
-                    renderer::AttributeAccessor{
-                        .mBufferViewIndex = 0, // view is added above
-                        .mClientDataFormat{
-                            .mDimension = 1,
-                            .mOffset = offsetof(InstanceData, mMaterialParametersIdx),
+                            .mOffset = offsetof(InstanceData, mEntityMaterial),
                             .mComponentType = GL_UNSIGNED_INT,
                         },
                     }
@@ -177,11 +223,22 @@ struct SnacGraph
                   renderer::Storage & aStorage,
                   renderer::AnnotationsSelector aAnnotations = {});
 
-    void passDepth(SnacGraph::PartList aPartList,
+    void passDepth(std::span<const math::Matrix<4, 4, GLfloat>> aLightViewProjections,
                    renderer::RepositoryTexture aTextureRepository,
                    renderer::Storage & aStorage,
                    renderer::DepthMethod aDepthMethod);
 
+    /// @brief Draw the entries of mPartList visible from at least one of the view frusta, with the pass selected by aAnnotations.
+    /// @param aLodBias Factor applied to mLodMaxError for this view.
+    void drawView(const std::vector<renderer::Technique::Annotation> & aAnnotations,
+                  std::span<const math::Matrix<4, 4, GLfloat>> aViewProjections,
+                  const renderer::RepositoryTexture & aTextureRepository,
+                  renderer::Storage & aStorage,
+                  GLfloat aLodBias = 1.f);
+
+    /// @brief Mark in mVisibility the entries of mPartList whose bounds (in mCuller) intersect at least one of the view frusta.
+    void cull(std::span<const math::Matrix<4, 4, GLfloat>> aViewProjections);
+
     static constexpr bool gMultiIndirectDraw = true;
 
     // List and describes the buffer views used for per-instance vertex attributes
@@ -193,16 +250,17 @@ struct SnacGraph
     struct GraphUbos
     {
         // TODO should they be hosted in renderer::Storage instead of this class?
-        graphics::UniformBufferObject mJointMatricesUbo;
-        graphics::UniformBufferObject mEntitiesUbo;
+        // Shader storage, only written by the compute animation (the palettes animated on the CPU are streamed).
+        graphics::BufferAny mJointMatricesSsbo;
         graphics::UniformBufferObject mLightsUbo;
         graphics::UniformBufferObject mLightViewProjectionUbo;
         graphics::UniformBufferObject mShadowCascadeUbo;
         graphics::UniformBufferObject mViewingProjectionUbo;
 
         renderer::RepositoryUbo mUboRepository{
-            {renderer::semantic::gJointMatrices, &mJointMatricesUbo},
-            {renderer::semantic::gEntities, &mEntitiesUbo},
+            {renderer::semantic::gJointMatrices, &mJointMatricesSsbo},
+            // Bound to a range of the streaming buffer each frame.
+            {renderer::semantic::gEntities, renderer::BufferRange{}},
             {renderer::semantic::gLights, &mLightsUbo},
             {renderer::semantic::gLightViewProjection, &mLightViewProjectionUbo},
             {renderer::semantic::gShadowCascade, &mShadowCascadeUbo},
@@ -210,10 +268,75 @@ struct SnacGraph
         };
     } mGraphUbos;
 
+    // Initial sizing of the streaming buffer regions, which grow when a frame overflows them.
+    static constexpr std::size_t gInitialStreamedEntities = 512;
+    static constexpr std::size_t gInitialStreamedJoints = 512;
+
+    // Per-frame entities and joint palettes are written there directly, each frame in a distinct region.
+    // Held by pointer, since the renderer is moved to the render thread.
+    std::unique_ptr<renderer::StreamingBuffer> mStreamingBuffer =
+        std::make_unique<renderer::StreamingBuffer>(
+            gInitialStreamedEntities * sizeof(EntityData_glsl)
+            + gInitialStreamedJoints * sizeof(math::AffineMatrix<4, GLfloat>));
+
     // Intended for function-local storage, made a member so its reuses the allocated memory between frames.
-    std::vector<math::AffineMatrix<4, GLfloat>> mRiggingPalettesBuffer;
     std::vector<SnacGraph::InstanceData> mInstanceBuffer;
 
+    /// @brief Pose evaluation and joint palette computation for one distinct pose,
+    /// writing to its own slice of the streamed palettes.
+    struct SkinningJob
+    {
+        renderer::PoseKey mPoseKey;
+        // The first entity in this pose, whose storage is used to sample the animation.
+        std::size_t mEntityId;
+        GLuint mPaletteOffset;
+    };
+    std::vector<SkinningJob> mSkinningJobs;
+    // The offset of the palette of each distinct pose in the current frame.
+    std::unordered_map<renderer::PoseKey, GLuint> mPoseToPaletteOffset;
+
+    /// @brief Per-entity storage, only accessed by the job animating this entity.
+    struct AnimatedEntity
+    {
+        renderer::AnimationSampler mSampler;
+        renderer::Rig::FuturePose_type mPosedNodes;
+    };
+    // Indexed by the entity id in the GraphicState, so each entity keeps its keyframe cursor between frames.
+    // (An id reused by another entity only invalidates the cursor, which is validated on each sampling.)
+    std::vector<AnimatedEntity> mAnimatedEntities;
+    // Alternative to the skinning jobs, evaluating the poses with a compute program.
+    bool mAnimateOnGpu = false;
+    renderer::RigAnimationCompute mRigAnimationCompute;
+    std::vector<renderer::RigAnimationCompute::AnimatedInstance> mGpuAnimatedInstances;
+
+    // Distinct from the simulation pool: a JobPool does not accept batches from concurrent threads.
+    // Held by pointer, since the renderer is moved to the render thread.
+    std::unique_ptr<JobPool> mSkinningJobPool =
+        std::make_unique<JobPool>(std::min(2u, JobPool::DefaultWorkerCount()));
+    // World bounds of each entry in the frame PartList, tested against each view before its pass.
+    renderer::FrustumCuller mCuller;
+    std::vector<std::uint8_t> mVisibility;
+    // Placement of each entry in the frame PartList, to select its level of detail for each view.
+    std::vector<renderer::LodInstance> mLodInstances;
+    // Scratch storage for the views of drawView().
+    std::vector<renderer::LodView> mLodViews;
+    bool mUseLods = true;
+    // Largest projected error of the levels of detail, relative to half the viewport height.
+    GLfloat mLodMaxError = 0.002f;
+    // Shadow maps tolerate coarser geometry: their texels usually cover more of the scene than screen pixels.
+    GLfloat mShadowLodBias = 4.f;
+
+    // The PartList of the current frame, its generation changes when its entries differ from previous frame.
+    PartList mPartList;
+    std::uint64_t mPartListGeneration = 0;
+    // Keyed by the pass annotations, flattened as category-value sequences.
+    std::map<std::vector<renderer::StringKey>, SortedPass> mSortedPasses;
+    // A deque, so references to the ViewDraws stay valid when more views are added.
+    std::deque<ViewDraws> mViewDraws;
+    std::size_t mFrameViewCount = 0;
+    // Scratch storage for the commands generated by prepareViewDraws().
+    renderer::PassCache mNextViewPassCache;
+
     renderer::ShadowMapping mShadowMapping;
 
     renderer::DebugRenderer mDebugRenderer;
@@ -230,6 +353,7 @@ struct Impl_V2
     Impl_V2(const renderer::Loader & aLoader) :
         mRenderGraph{
             .mInstanceStream = SnacGraph::makeInstanceStream(mStorage),
+            .mRigAnimationCompute = renderer::RigAnimationCompute{aLoader},
             .mShadowMapping = renderer::ShadowMapping{mStorage},
             .mDebugRenderer = renderer::DebugRenderer{mStorage, aLoader},
             .mSkybox = renderer::SkyPassCache{aLoader, mStorage},
@@ -258,6 +382,8 @@ class Renderer_V2
         MovableAtomic<bool> mRenderModels{true};
         MovableAtomic<bool> mRenderText{true};
         MovableAtomic<bool> mRenderDebug{true};
+        MovableAtomic<bool> mAnimateOnGpu{false};
+        MovableAtomic<bool> mUseLods{true};
 
         // This boolean is only accessed by main thread
         bool mShowShadowControls{false};
@@ -279,6 +405,22 @@ public:
 
     //void resetProjection(float aAspectRatio, snac::Camera::Parameters aParameters);
 
+    /// @brief The part of a model load that does not require the GL context (file I/O, parsing, decoding).
+    struct PreparedModel
+    {
+        renderer::PreparedBinary mBinary;
+        std::vector<std::string> mFeatures;
+    };
+
+    /// @brief Prepare the model, can be called from any thread (it does not access the renderer).
+    static PreparedModel prepareModel(filesystem::path aModel);
+
+    /// @brief Upload a prepared model, must be called on the thread where the GL context is current.
+    renderer::Handle<const renderer::Object> uploadModel(PreparedModel aModel,
+                                                         filesystem::path aEffect,
+                                                         Resources_t & aResources);
+
+    /// @brief Synchronous equivalent to uploadModel(prepareModel(aModel), ...).
     renderer::Handle<const renderer::Object> loadModel(filesystem::path aModel,
                                                        filesystem::path aEffect,
                                                        Resources_t & aResources);
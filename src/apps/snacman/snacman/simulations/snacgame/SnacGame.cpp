@@ -481,17 +481,18 @@ bool SnacGame::update(snac::Clock::duration & aUpdatePeriod, RawInput & aInput)
     return false;
 }
 
-std::unique_ptr<Renderer_t::GraphicState_t> SnacGame::makeGraphicState()
+void SnacGame::makeGraphicState(Renderer_t::GraphicState_t & aState)
 {
     TIME_RECURRING_FUNC(Main);
 
-    auto state = std::make_unique<Renderer_t::GraphicState_t>();
+    // The state is recycled from a previous step: reset its content, keep its storage.
+    aState.clear();
 
     //
     // Worldspace models
     //
     mQueryRenderable
-        ->each([&state](ent::Handle<ent::Entity> aHandle,
+        ->each([&aState](ent::Handle<ent::Entity> aHandle,
                        const component::GlobalPose & aGlobPose,
                        // TODO #anim restore this constness (for the moment,
                        // animation mutate the rig's scene)
@@ -513,7 +514,7 @@ std::unique_ptr<Renderer_t::GraphicState_t> SnacGame::makeGraphicState()
                 };
             }
 
-            state->mEntities.insert(
+            aState.mEntities.insert(
                 aHandle.id(),
                 visu_V2::Entity{
                     .mColor = aGlobPose.mColor,
@@ -543,32 +544,32 @@ std::unique_ptr<Renderer_t::GraphicState_t> SnacGame::makeGraphicState()
     //
     static constexpr math::hdr::Rgb_f ambientColor = math::hdr::Rgb_f{0.4f, 0.4f, 0.4f};
 
-    state->mLights = renderer::LightsDataUi{
+    aState.mLights = renderer::LightsDataUi{
         renderer::LightsDataCommon{
             .mAmbientColor = ambientColor,
         },
     };
 
     mQueryLightDirections
-        ->each([&state](const component::LightDirection & aLightDirection)
+        ->each([&aState](const component::LightDirection & aLightDirection)
             {
-                GLuint lightIdx = state->mLights.mDirectionalCount++;
-                state->mLights.mDirectionalLights[lightIdx] =
+                GLuint lightIdx = aState.mLights.mDirectionalCount++;
+                aState.mLights.mDirectionalLights[lightIdx] =
                     renderer::DirectionalLight{
                         .mDirection = aLightDirection.mDirection,
                         .mDiffuseColor = aLightDirection.mColors.mDiffuse,
                         .mSpecularColor = aLightDirection.mColors.mSpecular,
                     };
-                state->mLights.mDirectionalLightProjectShadow[lightIdx].mIsProjectingShadow = 
+                aState.mLights.mDirectionalLightProjectShadow[lightIdx].mIsProjectingShadow = 
                     aLightDirection.mProjectShadow;
             });
 
     mQueryLightPoints
-        ->each([&state](const component::GlobalPose & aGlobalPose,
+        ->each([&aState](const component::GlobalPose & aGlobalPose,
                         const component::LightPoint & aLightPoint)
             {
-                GLuint lightIdx = state->mLights.mPointCount++;
-                state->mLights.mPointLights[lightIdx] =
+                GLuint lightIdx = aState.mLights.mPointCount++;
+                aState.mLights.mPointLights[lightIdx] =
                     renderer::PointLight{
                         .mPosition = aGlobalPose.mPosition,
                         .mRadius = aLightPoint.mRadius,
@@ -581,7 +582,7 @@ std::unique_ptr<Renderer_t::GraphicState_t> SnacGame::makeGraphicState()
     // Worldspace Text
     //
     mQueryTextWorld
-        ->each([&state](ent::Handle<ent::Entity> aHandle,
+        ->each([&aState](ent::Handle<ent::Entity> aHandle,
                        component::Text & aText,
                        // Taken by value to mutate it locally.
                        component::GlobalPose aGlobPose) {
@@ -591,7 +592,7 @@ std::unique_ptr<Renderer_t::GraphicState_t> SnacGame::makeGraphicState()
             // component to still mean "about visible". 
             aGlobPose.mScaling /= 100;
 
-            state->mTextWorldEntities.insert(
+            aState.mTextWorldEntities.insert(
                 aHandle.id(), visu_V2::Text{
                                   .mString = aText.mString,
                                   .mPose = toPose(aGlobPose),
@@ -604,7 +605,7 @@ std::unique_ptr<Renderer_t::GraphicState_t> SnacGame::makeGraphicState()
     // Screenspace Text
     //
     mQueryTextScreen
-        ->each([&state, this](ent::Handle<ent::Entity> aHandle,
+        ->each([&aState, this](ent::Handle<ent::Entity> aHandle,
                              component::Text & aText,
                              component::PoseScreenSpace & aPose)
         {
@@ -624,7 +625,7 @@ std::unique_ptr<Renderer_t::GraphicState_t> SnacGame::makeGraphicState()
             // You know I like my scales uniform
             assert(aPose.mScale[0] == aPose.mScale[1]);
 
-            state->mTextScreenEntities.insert(
+            aState.mTextScreenEntities.insert(
                 aHandle.id(),
                 visu_V2::Text{
                     .mString = aText.mString,
@@ -644,7 +645,7 @@ std::unique_ptr<Renderer_t::GraphicState_t> SnacGame::makeGraphicState()
     //
     // Camera
     //
-    state->mCamera = mSystemOrbitalCamera->getCamera();
+    aState.mCamera = mSystemOrbitalCamera->getCamera();
 
     //
     // Environment map
@@ -653,14 +654,12 @@ std::unique_ptr<Renderer_t::GraphicState_t> SnacGame::makeGraphicState()
     // (makes a copy of the static environment each update)
     // It feels like a more generic interface is also lying here 
     // (currently, the environment is a RepositoryTexture)
-    state->mEnvironment = mEnvironmentMap;
+    aState.mEnvironment = mEnvironmentMap;
 
     //
     // Debug drawing
     //
-    state->mDebugDrawList = snac::DebugDrawer::EndFrame();
-
-    return state;
+    aState.mDebugDrawList = snac::DebugDrawer::EndFrame();
 }
 
 } // namespace snacgame
@@ -113,7 +113,8 @@ public:
                      RawInput & aInput,
                      const std::string & aProfilerResults);
 
-    std::unique_ptr<Renderer_t::GraphicState_t> makeGraphicState();
+    /// @brief Fill the provided graphic state from the current simulation state.
+    void makeGraphicState(Renderer_t::GraphicState_t & aState);
 
 private:
     graphics::AppInterface * mAppInterface;
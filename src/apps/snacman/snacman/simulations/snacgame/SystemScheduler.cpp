@@ -0,0 +1,222 @@
+#include "SystemScheduler.h"
+
+#include <snacman/Profiling.h>
+
+#include <entity/EntityManager.h>
+
+#include <handy/Guard.h>
+
+#include <utilities/JobPool.h>
+
+#include <algorithm>
+
+
+namespace ad {
+namespace snacgame {
+
+
+void SystemScheduler::add(const char * aName, SystemAccess aAccess, Task aTask)
+{
+    add(aName, aAccess, [task = std::move(aTask)](DeferredChanges &) { task(); });
+}
+
+
+void SystemScheduler::add(const char * aName, SystemAccess aAccess, DeferringTask aTask)
+{
+    mSystems.push_back(System{
+        .mName = aName,
+        .mAccess = aAccess,
+        .mTask = std::move(aTask),
+    });
+    mGraphBuilt = false;
+}
+
+
+void SystemScheduler::run()
+{
+    if(!mGraphBuilt)
+    {
+        buildGraph();
+    }
+    // If a system throws, the changes deferred by the interrupted run are not carried to the next one.
+    Guard discardChanges{[this]
+    {
+        for(System & system : mSystems)
+        {
+            system.mChanges.mChanges.clear();
+        }
+    }};
+
+    std::size_t segmentBegin = 0;
+    for(std::size_t systemIdx = 0; systemIdx != mSystems.size(); ++systemIdx)
+    {
+        System & system = mSystems[systemIdx];
+        if(system.mAccess.isExclusive())
+        {
+            runConcurrent(segmentBegin, systemIdx);
+            // Merge point: the exclusive system observes all the previous structural changes.
+            applyDeferredChanges(segmentBegin, systemIdx);
+            system.mTask(system.mChanges);
+            applyDeferredChanges(systemIdx, systemIdx + 1);
+            segmentBegin = systemIdx + 1;
+        }
+    }
+    runConcurrent(segmentBegin, mSystems.size());
+    applyDeferredChanges(segmentBegin, mSystems.size());
+
+    // Exclusive systems ran on this thread, they can profile themselves.
+    for(const System & system : mSystems)
+    {
+        if(!system.mAccess.isExclusive())
+        {
+            PROFILER_RECORD_RECURRING_DURATION(
+                ::ad::snac::ProfilerMap_V2::Main,
+                system.mName,
+                ::ad::renderer::CpuTime,
+                std::chrono::duration_cast<std::chrono::nanoseconds>(system.mDuration));
+        }
+    }
+}
+
+
+void SystemScheduler::buildGraph()
+{
+    // An edge from each system to all the later systems it conflicts with, in the same segment.
+    // Exclusive systems separate the segments, they have no edges.
+    mDependents.clear();
+    std::size_t segmentBegin = 0;
+    for(std::size_t systemIdx = 0; systemIdx != mSystems.size(); ++systemIdx)
+    {
+        System & system = mSystems[systemIdx];
+        system.mFirstDependent = mDependents.size();
+        system.mDependencyCount = 0;
+        if(system.mAccess.isExclusive())
+        {
+            system.mDependentCount = 0;
+            segmentBegin = systemIdx + 1;
+            continue;
+        }
+
+        for(std::size_t otherIdx = segmentBegin;
+            otherIdx != mSystems.size() && !mSystems[otherIdx].mAccess.isExclusive();
+            ++otherIdx)
+        {
+            if(otherIdx != systemIdx && system.mAccess.conflictsWith(mSystems[otherIdx].mAccess))
+            {
+                if(otherIdx > systemIdx)
+                {
+                    mDependents.push_back(otherIdx);
+                }
+                else
+                {
+                    ++system.mDependencyCount;
+                }
+            }
+        }
+        system.mDependentCount = mDependents.size() - system.mFirstDependent;
+    }
+
+    mReady.clear();
+    mReady.reserve(mSystems.size());
+    mGraphBuilt = true;
+}
+
+
+void SystemScheduler::runConcurrent(std::size_t aFirst, std::size_t aLast)
+{
+    if(aFirst == aLast)
+    {
+        return;
+    }
+
+    // Ready systems are appended as their dependencies complete.
+    mReady.clear();
+    for(std::size_t systemIdx = aFirst; systemIdx != aLast; ++systemIdx)
+    {
+        System & system = mSystems[systemIdx];
+        system.mPendingDependencies = system.mDependencyCount;
+        if(system.mPendingDependencies == 0)
+        {
+            mReady.push_back(systemIdx);
+        }
+    }
+
+    mNextReady = 0;
+    mRemaining = aLast - aFirst;
+    mAborted = false;
+
+    // One executor per thread that can usefully run systems concurrently.
+    const std::size_t executors = std::min(aLast - aFirst, mJobPool->countWorkers() + 1);
+    mJobPool->parallelFor(executors, [this](std::size_t)
+    {
+        executeReady();
+    });
+}
+
+
+void SystemScheduler::executeReady()
+{
+    std::unique_lock lock{mMutex};
+    while(true)
+    {
+        mReadyChanged.wait(lock, [this]()
+        {
+            return mNextReady != mReady.size() || mRemaining == 0 || mAborted;
+        });
+        if(mRemaining == 0 || mAborted)
+        {
+            return;
+        }
+
+        System & system = mSystems[mReady[mNextReady++]];
+        lock.unlock();
+
+        try
+        {
+            snac::Clock::time_point begin = snac::Clock::now();
+            system.mTask(system.mChanges);
+            system.mDuration = snac::Clock::now() - begin;
+        }
+        catch(...)
+        {
+            // The dependents will never be ready, release the other executors.
+            // The job pool rethrows the exception on the calling thread.
+            lock.lock();
+            mAborted = true;
+            mReadyChanged.notify_all();
+            throw;
+        }
+
+        lock.lock();
+        for(std::size_t dependentIdx = system.mFirstDependent;
+            dependentIdx != system.mFirstDependent + system.mDependentCount;
+            ++dependentIdx)
+        {
+            const std::size_t dependent = mDependents[dependentIdx];
+            if(--mSystems[dependent].mPendingDependencies == 0)
+            {
+                mReady.push_back(dependent);
+            }
+        }
+        --mRemaining;
+        mReadyChanged.notify_all();
+    }
+}
+
+
+void SystemScheduler::applyDeferredChanges(std::size_t aFirst, std::size_t aLast)
+{
+    Phase deferred;
+    for(std::size_t systemIdx = aFirst; systemIdx != aLast; ++systemIdx)
+    {
+        for(const DeferredChanges::Change & change : mSystems[systemIdx].mChanges.mChanges)
+        {
+            change(deferred);
+        }
+        mSystems[systemIdx].mChanges.mChanges.clear();
+    }
+}
+
+
+} // namespace snacgame
+} // namespace ad
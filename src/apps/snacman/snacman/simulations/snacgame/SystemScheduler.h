@@ -0,0 +1,222 @@
+#pragma once
+
+
+#include "typedef.h"
+
+#include <snacman/Timing.h>
+
+#include <atomic>
+#include <bitset>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#include <cstddef>
+
+
+namespace ad {
+
+class JobPool;
+
+namespace snacgame {
+
+
+/// @brief The components a system reads and writes,
+/// used by the SystemScheduler to find which systems can run concurrently.
+///
+/// Shared state that is not a component (e.g. the CollisionGrid, the debug drawers)
+/// is declared the same way, by its type.
+/// A system that makes immediate structural changes (e.g. via its own ent::Phase, or World::addEntity()),
+/// or touches anything it cannot declare, has to be declared Exclusive().
+class SystemAccess
+{
+public:
+    static constexpr std::size_t gMaxComponents = 64;
+
+    static SystemAccess Exclusive()
+    {
+        SystemAccess access;
+        access.mExclusive = true;
+        return access;
+    }
+
+    /// @throw std::logic_error if more than gMaxComponents distinct types are declared over the program.
+    template <class... VT_components>
+    SystemAccess & reads()
+    {
+        (mReads.set(ComponentBit<std::remove_cv_t<VT_components>>()), ...);
+        return *this;
+    }
+
+    /// @throw std::logic_error if more than gMaxComponents distinct types are declared over the program.
+    template <class... VT_components>
+    SystemAccess & writes()
+    {
+        (mWrites.set(ComponentBit<std::remove_cv_t<VT_components>>()), ...);
+        return *this;
+    }
+
+    bool isExclusive() const
+    { return mExclusive; }
+
+    bool conflictsWith(const SystemAccess & aOther) const
+    {
+        return mExclusive || aOther.mExclusive
+               || (mWrites & (aOther.mWrites | aOther.mReads)).any()
+               || (mReads & aOther.mWrites).any();
+    }
+
+private:
+    template <class T_component>
+    static std::size_t ComponentBit()
+    {
+        static const std::size_t bit = AllocateBit();
+        return bit;
+    }
+
+    static std::size_t AllocateBit()
+    {
+        const std::size_t bit = gNextComponentBit++;
+        if(bit >= gMaxComponents)
+        {
+            throw std::logic_error{
+                "SystemAccess cannot declare more than " + std::to_string(gMaxComponents) + " distinct types."};
+        }
+        return bit;
+    }
+
+    inline static std::atomic<std::size_t> gNextComponentBit{0};
+
+    std::bitset<gMaxComponents> mReads;
+    std::bitset<gMaxComponents> mWrites;
+    bool mExclusive = false;
+};
+
+
+/// @brief Structural changes (entity or component additions and removals) recorded by a system,
+/// to be applied by the SystemScheduler at the next merge point.
+class DeferredChanges
+{
+public:
+    using Change = std::function<void(Phase &)>;
+
+    void record(Change aChange)
+    { mChanges.push_back(std::move(aChange)); }
+
+    /// @brief Erase the entity, if it is still valid when the change is applied.
+    void erase(EntHandle aHandle)
+    {
+        record([aHandle](Phase & aPhase) mutable
+        {
+            if(auto entity = aHandle.get(aPhase))
+            {
+                entity->erase();
+            }
+        });
+    }
+
+private:
+    friend class SystemScheduler;
+
+    std::vector<Change> mChanges;
+};
+
+
+/// @brief Runs the systems of a simulation step, concurrently when their declared accesses do not conflict.
+///
+/// Systems are added once, in the order they would run sequentially, then the whole schedule is run on each step.
+/// Each system depends on all the previous systems it conflicts with, so this order is preserved between
+/// any two conflicting systems. A system is dispatched to the job pool as soon as the systems it depends on completed.
+/// The dependency graph is built on the first run following an addition, so the steady state run does not allocate
+/// (except for the recorded DeferredChanges).
+///
+/// Exclusive systems run alone on the calling thread, acting as merge points: the changes deferred
+/// by the previous systems are applied (in the order the systems were added) before the exclusive system runs.
+/// The remaining changes are applied at the end of the run.
+///
+/// Contract making the concurrent systems race-free (the entity library does not enforce it, the declarations do):
+/// - No immediate structural change: a non-exclusive system must not use an ent::Phase, nor add entities,
+///   since this mutates the EntityManager. It records its structural changes in the DeferredChanges instead.
+///   It only iterates its own queries (Query::each()) and reads entities through phase-less
+///   Handle::get() (e.g. snac::getComponent()), which are assumed not to mutate the EntityManager.
+/// - A system only accesses the components it declared, on any entity (including through handles
+///   stored in its components, e.g. a path target), plus its own system instance and task captures.
+///   Conflicting systems are thus ordered by their dependency, and the completion of a system
+///   synchronizes with the start of the systems depending on it.
+/// - Two systems declaring only reads of a component may run concurrently: reads must be const
+///   (no lazily cached values in components).
+///
+/// @note The profiler sections can only be opened from the simulation thread,
+/// so the non-exclusive systems must not be instrumented internally.
+/// Instead, the scheduler measures them, and records their durations to the Main profiler after the run.
+class SystemScheduler
+{
+public:
+    using Task = std::function<void()>;
+    using DeferringTask = std::function<void(DeferredChanges &)>;
+
+    explicit SystemScheduler(JobPool & aJobPool) :
+        mJobPool{&aJobPool}
+    {}
+
+    /// @param aName Profiler section name, it must outlive the scheduler (e.g. a string literal).
+    void add(const char * aName, SystemAccess aAccess, Task aTask);
+
+    /// @brief Add a system recording its structural changes, to be applied at the next merge point.
+    void add(const char * aName, SystemAccess aAccess, DeferringTask aTask);
+
+    /// @brief Run all the systems, following their dependencies.
+    /// @note The tasks are kept, so the values changing between steps must be read through their captures.
+    void run();
+
+private:
+    struct System
+    {
+        const char * mName;
+        SystemAccess mAccess;
+        DeferringTask mTask;
+        DeferredChanges mChanges;
+        // The systems depending on this one are mDependents[mFirstDependent, mFirstDependent + mDependentCount).
+        std::size_t mFirstDependent = 0;
+        std::size_t mDependentCount = 0;
+        std::size_t mDependencyCount = 0;
+        std::size_t mPendingDependencies = 0;
+        snac::Clock::duration mDuration{0};
+    };
+
+    /// @brief Build the dependency graph of each segment of non-exclusive systems.
+    void buildGraph();
+
+    /// @brief Run the non-exclusive systems in [aFirst, aLast), following their dependencies.
+    void runConcurrent(std::size_t aFirst, std::size_t aLast);
+
+    /// @brief Execute ready systems of the current segment, until all of them completed.
+    void executeReady();
+
+    /// @brief Apply the changes deferred by the systems in [aFirst, aLast), in the order they were added.
+    void applyDeferredChanges(std::size_t aFirst, std::size_t aLast);
+
+    JobPool * mJobPool;
+    std::vector<System> mSystems;
+    bool mGraphBuilt = false;
+
+    // The dependency edges of all the systems.
+    std::vector<std::size_t> mDependents;
+    // Reserved for all the systems when the graph is built, so a run never reallocates it.
+    std::vector<std::size_t> mReady;
+
+    // Execution state of the current segment, guarded by mMutex.
+    std::mutex mMutex;
+    std::condition_variable mReadyChanged;
+    std::size_t mNextReady = 0;
+    std::size_t mRemaining = 0;
+    bool mAborted = false;
+};
+
+
+} // namespace snacgame
+} // namespace ad
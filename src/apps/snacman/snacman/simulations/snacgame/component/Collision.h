@@ -8,6 +8,8 @@
 #include <math/Vector.h>
 #include <math/Box.h>
 
+#include <algorithm>
+
 namespace ad {
 namespace snacgame {
 namespace component {
@@ -50,6 +52,21 @@ inline math::Box<float> transformHitbox(const math::Position<3, float> & aPos, c
     };
 }
 
+/// @brief Smallest box containing both boxes.
+inline math::Box<float> uniteHitboxes(const math::Box<float> & aLhs, const math::Box<float> & aRhs)
+{
+    const math::Position<3, float> min{std::min(aLhs.xMin(), aRhs.xMin()),
+                                       std::min(aLhs.yMin(), aRhs.yMin()),
+                                       std::min(aLhs.zMin(), aRhs.zMin())};
+    const math::Position<3, float> max{std::max(aLhs.xMax(), aRhs.xMax()),
+                                       std::max(aLhs.yMax(), aRhs.yMax()),
+                                       std::max(aLhs.zMax(), aRhs.zMax())};
+    return {
+        .mPosition = min,
+        .mDimension = {max.x() - min.x(), max.y() - min.y(), max.z() - min.z()},
+    };
+}
+
 inline bool collideWithSat(const math::Box<float> & aLhs, const math::Box<float> & aRhs)
 {
     return aLhs.xMin() <= aRhs.xMax()
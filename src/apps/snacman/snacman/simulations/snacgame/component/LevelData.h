@@ -113,6 +113,8 @@ struct Level
 
     std::vector<int> mPortalIndex;
     float mCellSize = 1.f;
+    // Identifies the pathable state of mNodes, so navigation caches know when they are stale.
+    int mNavigationGeneration = 0;
 
     template<class T_witness>
     void describeTo(T_witness && aWitness)
@@ -122,6 +124,7 @@ struct Level
         aWitness.witness(NVP(mNodes));
         aWitness.witness(NVP(mPortalIndex));
         aWitness.witness(NVP(mCellSize));
+        aWitness.witness(NVP(mNavigationGeneration));
     }
 };
 
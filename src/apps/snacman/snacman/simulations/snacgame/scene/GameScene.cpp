@@ -29,6 +29,7 @@
 #include "../component/MenuItem.h"
 #include "../component/MovementScreenSpace.h"
 #include "../component/PathToOnGrid.h"
+#include "../component/Physics.h"
 #include "../component/PlayerGameData.h"
 #include "../component/PlayerHud.h"
 #include "../component/PlayerRoundData.h"
@@ -41,6 +42,7 @@
 #include "../component/Tags.h"
 #include "../component/Text.h"
 #include "../component/VisualModel.h"
+#include "../CollisionGrid.h"
 #include "../Entities.h"
 #include "../GameContext.h"
 #include "../GameParameters.h"
@@ -52,6 +54,7 @@
 #include "../system/AdvanceAnimations.h"
 #include "../system/AllowMovement.h"
 #include "../system/AnimationManager.h"
+#include "../system/CollisionBroadphase.h"
 #include "../system/ConsolidateGridMovement.h"
 #include "../system/Debug_BoundingBoxes.h"
 #include "../system/EatPill.h"
@@ -74,6 +77,7 @@
 #include <entity/EntityManager.h>
 #include <map> // for opera...
 #include <memory>
+#include <snacman/DebugDrawing.h>
 #include <snacman/Input.h>
 #include <snacman/Profiling.h>
 #include <snacman/QueryManipulation.h>
@@ -108,45 +112,49 @@ GameScene::GameScene(GameContext & aGameContext,
     mHuds{mGameContext.mWorld},
     mPlayers{mGameContext.mWorld},
     mPathfinders{mGameContext.mWorld},
-    mCrowns{mGameContext.mWorld}
+    mCrowns{mGameContext.mWorld},
+    mVictoryScheduler{mGameContext.mJobPool},
+    mPlayingScheduler{mGameContext.mJobPool}
 {
     TIME_SINGLE(Main, "Constructor game scene");
 
     {
         TIME_SINGLE(Main, "Load game assets");
-        // Preload models to avoid loading time when they first appear in the game
+        // Stream models to avoid loading time when they first appear in the game.
+        // The requests do not block, so the scene starts while the models are loading.
         mGameContext.mResources.getFont("fonts/fill_boiga.ttf", gTextSize);
-        mGameContext.mResources.getModel("models/collar/collar.sel",
-                                         gMeshGenericEffect);
-        mGameContext.mResources.getModel("models/teleport/teleport.sel",
-                                         gMeshGenericEffect);
-        mGameContext.mResources.getModel("models/missile/missile.sel",
-                                         gMeshGenericEffect);
-        mGameContext.mResources.getModel("models/boom/boom.sel",
-                                         gMeshGenericEffect);
-        mGameContext.mResources.getModel("models/portal/portal.sel",
-                                         gMeshGenericEffect);
-        mGameContext.mResources.getModel("models/bomb/Bomb.sel",
-                                         gMeshGenericEffect);
-        mGameContext.mResources.getModel("models/missile/area.sel",
-                                         gMeshGenericEffect);
-        mGameContext.mResources.getModel(
+        mGameContext.mResources.requestModel("models/collar/collar.sel",
+                                             gMeshGenericEffect);
+        mGameContext.mResources.requestModel("models/teleport/teleport.sel",
+                                             gMeshGenericEffect);
+        mGameContext.mResources.requestModel("models/missile/missile.sel",
+                                             gMeshGenericEffect);
+        mGameContext.mResources.requestModel("models/boom/boom.sel",
+                                             gMeshGenericEffect);
+        mGameContext.mResources.requestModel("models/portal/portal.sel",
+                                             gMeshGenericEffect);
+        mGameContext.mResources.requestModel("models/bomb/Bomb.sel",
+                                             gMeshGenericEffect);
+        mGameContext.mResources.requestModel("models/missile/area.sel",
+                                             gMeshGenericEffect);
+        mGameContext.mResources.requestModel(
             "models/square_biscuit/square_biscuit.sel",
             gMeshGenericEffect);
-        mGameContext.mResources.getModel("models/burger/burger.sel",
-                                         gMeshGenericEffect);
-        mGameContext.mResources.getModel("models/billpad/billpad.sel",
-                                         gMeshGenericEffect);
-        mGameContext.mResources.getModel(gDonutModel,
-                                         gMeshGenericEffect);
-        mGameContext.mResources.getModel("models/arrow/arrow.sel",
-                                         gMeshGenericEffect);
-        mGameContext.mResources.getModel("models/portal/portal.sel",
-                                         gMeshGenericEffect);
-        mGameContext.mResources.getModel("models/podium/podium.sel",
-                                         gMeshGenericEffect);
+        mGameContext.mResources.requestModel("models/burger/burger.sel",
+                                             gMeshGenericEffect);
+        mGameContext.mResources.requestModel("models/billpad/billpad.sel",
+                                             gMeshGenericEffect);
+        mGameContext.mResources.requestModel(gDonutModel,
+                                             gMeshGenericEffect);
+        mGameContext.mResources.requestModel("models/arrow/arrow.sel",
+                                             gMeshGenericEffect);
+        mGameContext.mResources.requestModel("models/portal/portal.sel",
+                                             gMeshGenericEffect);
+        mGameContext.mResources.requestModel("models/podium/podium.sel",
+                                             gMeshGenericEffect);
     }
 
+    buildSchedules();
 }
 
 void GameScene::onEnter(Transition aTransition)
@@ -194,7 +202,8 @@ void GameScene::onEnter(Transition aTransition)
                 .add(system::Debug_BoundingBoxes{mGameContext})
                 .add(system::FallingPlayersSystem{mGameContext})
                 .add(system::TextZoomSystem{mGameContext})
-                .add(system::BurgerLoss{mGameContext});
+                .add(system::BurgerLoss{mGameContext})
+                .add(system::CollisionBroadphase{mGameContext});
             break;
     }
 }
@@ -344,6 +353,179 @@ WinnerList GameScene::getLeaderList()
     return leaderList;
 }
 
+void GameScene::buildSchedules()
+{
+    mVictoryScheduler.add(
+        "AllowMovement::update",
+        SystemAccess{}
+            .reads<component::Level, component::Geometry>()
+            .writes<component::AllowedMovement>(),
+        [this]() { mStep.mAllowMovement->update(*mStep.mLevel); });
+    mVictoryScheduler.add(
+        "GameScene::victoryMoves",
+        SystemAccess{}
+            .reads<component::AllowedMovement>()
+            .writes<component::PlayerRoundData>(),
+        [this]() {
+            mPlayers.each([](component::PlayerRoundData & aRoundData, const component::AllowedMovement & aAllowedMovement) {
+                if ((aRoundData.mMoveState & aAllowedMovement.mAllowedMovement) == gPlayerMoveFlagNone)
+                {
+                    // This just shift the bit by one if it's less than 16
+                    // And transforms 16 into 2 (basically a rotation between 2,4,8 and 16)
+                    aRoundData.mMoveState = (aRoundData.mMoveState % 15) << 1;
+                }
+            });
+        });
+    scheduleIntegrateAndAnimate(mVictoryScheduler);
+    scheduleGraphAndCollisions(mVictoryScheduler);
+    mVictoryScheduler.add(
+        "TextZoomSystem::update",
+        SystemAccess{}
+            .reads<component::TextZoom, component::Text>()
+            .writes<component::PoseScreenSpace>(),
+        [this]() { mStep.mTextZoom->update(*mStep.mTime); });
+
+    mPlayingScheduler.add(
+        "PlayerInvulFrame::update",
+        SystemAccess{}
+            .reads<component::VisualModel>()
+            .writes<component::PlayerRoundData>(),
+        [this](DeferredChanges & aChanges)
+        { mStep.mPlayerInvulFrame->update((float) mStep.mTime->mDeltaSeconds, aChanges); });
+    mPlayingScheduler.add(
+        "AllowMovement::update",
+        SystemAccess{}
+            .reads<component::Level, component::Geometry>()
+            .writes<component::AllowedMovement>(),
+        [this]() { mStep.mAllowMovement->update(*mStep.mLevel); });
+    mPlayingScheduler.add(
+        "ConsolidateGridMovement::update",
+        SystemAccess{}
+            .reads<component::AllowedMovement, component::Controller,
+                   component::PathToOnGrid, component::GlobalPose>()
+            .writes<component::PlayerRoundData, component::Geometry, snac::DebugDrawer>(),
+        [this]() { mStep.mConsolidateGridMovement->update((float) mStep.mTime->mDeltaSeconds); });
+    scheduleIntegrateAndAnimate(mPlayingScheduler);
+    scheduleGraphAndCollisions(mPlayingScheduler);
+    // These systems create entities, play sounds or edit texts, they run alone.
+    mPlayingScheduler.add(
+        "PowerUpUsage::update",
+        SystemAccess::Exclusive(),
+        [this]() { mStep.mPowerUpUsage->update(*mStep.mTime, mLevel, *mStep.mCollisionGrid); });
+    mPlayingScheduler.add(
+        "EatPill::update",
+        SystemAccess::Exclusive(),
+        [this]() { mStep.mEatPill->update(mGameContext, *mStep.mCollisionGrid); });
+    mPlayingScheduler.add(
+        "BurgerLoss::update",
+        SystemAccess::Exclusive(),
+        [this]() { mStep.mBurgerLoss->update(mLevel, *mStep.mTime, *mStep.mCollisionGrid); });
+    mPlayingScheduler.add(
+        "Debug_BoundingBoxes::update",
+        SystemAccess{}
+            .reads<component::GlobalPose, component::VisualModel>()
+            .writes<snac::DebugDrawer>(),
+        [this]() { mStep.mDebugBoundingBoxes->update(); });
+}
+
+void GameScene::scheduleIntegrateAndAnimate(SystemScheduler & aScheduler)
+{
+    // The declared accesses must cover the components each system reaches through handles as well
+    // (IntegratePlayerMovement: the player models' Geometry and VisualModel,
+    // AnimationManager: the player models' RigAnimation, Pathfinding: the targets' Geometry).
+    aScheduler.add(
+        "IntegratePlayerMovement::update",
+        SystemAccess{}
+            .reads<component::PlayerRoundData>()
+            .writes<component::Geometry, component::VisualModel>(),
+        [this]() { mStep.mIntegratePlayerMovement->update((float) mStep.mTime->mDeltaSeconds); });
+    aScheduler.add(
+        "MovementIntegration::update",
+        SystemAccess{}
+            .reads<component::Gravity, component::BurgerParticle, component::MovementScreenSpace>()
+            .writes<component::Speed, component::Geometry, component::PoseScreenSpace>(),
+        [this]() { mStep.mMovementIntegration->update((float) mStep.mTime->mDeltaSeconds); });
+    aScheduler.add(
+        "AnimationManager::update",
+        SystemAccess{}
+            .reads<component::PlayerRoundData>()
+            .writes<component::RigAnimation>(),
+        [this]() { mStep.mAnimationManager->update(); });
+    aScheduler.add(
+        "AdvanceAnimations::update",
+        SystemAccess{}
+            .writes<component::RigAnimation>(),
+        [this]() { mStep.mAdvanceAnimations->update(*mStep.mTime); });
+    aScheduler.add(
+        "Pathfinding::update",
+        SystemAccess{}
+            .reads<component::Level, component::Geometry>()
+            .writes<component::PathToOnGrid>(),
+        [this]() { mStep.mPathfinding->update(*mStep.mLevel); });
+}
+
+void GameScene::scheduleGraphAndCollisions(SystemScheduler & aScheduler)
+{
+    // Creates the portal images.
+    aScheduler.add(
+        "PortalManagement::preGraphUpdate",
+        SystemAccess::Exclusive(),
+        [this]() { mStep.mPortalManagement->preGraphUpdate(); });
+    aScheduler.add(
+        "Explosion::update",
+        SystemAccess{}
+            .reads<component::Explosion>()
+            .writes<component::Geometry>(),
+        [this](DeferredChanges & aChanges) { mStep.mExplosion->update(*mStep.mTime, aChanges); });
+    aScheduler.add(
+        "SceneGraphResolver::update",
+        SystemAccess{}
+            .reads<component::SceneNode, component::Geometry>()
+            .writes<component::GlobalPose>(),
+        [this]() { mStep.mSceneGraphResolver->update(); });
+    // Hitboxes are placed from the global poses, so after the scene graph resolution.
+    aScheduler.add(
+        "CollisionBroadphase::update",
+        SystemAccess{}
+            .reads<component::Level, component::GlobalPose, component::Collision, component::Portal>()
+            .writes<CollisionGrid>(),
+        [this]() { mStep.mCollisionBroadphase->update(*mStep.mLevel); });
+    // Teleported players are moved, with their children (portal image), in the scene graph and the grid.
+    aScheduler.add(
+        "PortalManagement::postGraphUpdate",
+        SystemAccess{}
+            .reads<component::Level, component::Collision, component::SceneNode, component::Portal>()
+            .writes<component::GlobalPose, component::Geometry, component::PlayerRoundData,
+                    component::VisualModel, CollisionGrid, snac::DebugDrawer>(),
+        [this](DeferredChanges & aChanges)
+        { mStep.mPortalManagement->postGraphUpdate(*mStep.mLevel, *mStep.mCollisionGrid, aChanges); });
+}
+
+void GameScene::prepareStep(const snac::Time & aTime, component::Level & aLevel)
+{
+    auto systems = mSystems.get();
+    mStep.mTime = &aTime;
+    mStep.mLevel = &aLevel;
+    mStep.mAdvanceAnimations = &systems->get<system::AdvanceAnimations>();
+    mStep.mAllowMovement = &systems->get<system::AllowMovement>();
+    mStep.mAnimationManager = &systems->get<system::AnimationManager>();
+    mStep.mBurgerLoss = &systems->get<system::BurgerLoss>();
+    mStep.mCollisionBroadphase = &systems->get<system::CollisionBroadphase>();
+    mStep.mCollisionGrid = &mStep.mCollisionBroadphase->mGrid;
+    mStep.mConsolidateGridMovement = &systems->get<system::ConsolidateGridMovement>();
+    mStep.mDebugBoundingBoxes = &systems->get<system::Debug_BoundingBoxes>();
+    mStep.mEatPill = &systems->get<system::EatPill>();
+    mStep.mExplosion = &systems->get<system::Explosion>();
+    mStep.mIntegratePlayerMovement = &systems->get<system::IntegratePlayerMovement>();
+    mStep.mMovementIntegration = &systems->get<system::MovementIntegration>();
+    mStep.mPathfinding = &systems->get<system::Pathfinding>();
+    mStep.mPlayerInvulFrame = &systems->get<system::PlayerInvulFrame>();
+    mStep.mPortalManagement = &systems->get<system::PortalManagement>();
+    mStep.mPowerUpUsage = &systems->get<system::PowerUpUsage>();
+    mStep.mSceneGraphResolver = &systems->get<system::SceneGraphResolver>();
+    mStep.mTextZoom = &systems->get<system::TextZoomSystem>();
+}
+
 void GameScene::update(const snac::Time & aTime, RawInput & aInput)
 {
     TIME_RECURRING(Main, "GameScene::update");
@@ -421,9 +603,16 @@ void GameScene::update(const snac::Time & aTime, RawInput & aInput)
     case GamePhase::SpawningSequence:
     {
 
-        mSystems.get()->get<system::MovementIntegration>().update(
-            (float) aTime.mDeltaSeconds);
-        mSystems.get()->get<system::SceneGraphResolver>().update();
+        // The systems are not instrumented themselves, since they can run on the job pool.
+        {
+            TIME_RECURRING(Main, "MovementIntegration::update");
+            mSystems.get()->get<system::MovementIntegration>().update(
+                (float) aTime.mDeltaSeconds);
+        }
+        {
+            TIME_RECURRING(Main, "SceneGraphResolver::update");
+            mSystems.get()->get<system::SceneGraphResolver>().update();
+        }
         mSystems.get()->get<system::FallingPlayersSystem>().update();
         mSystems.get()->get<system::TextZoomSystem>().update(aTime);
         // Creating level from markov data
@@ -504,28 +693,8 @@ void GameScene::update(const snac::Time & aTime, RawInput & aInput)
                 mVictoryText = createSpawningPhaseText("Victory!", color, aTime);
             }
             auto level = snac::getComponent<component::Level>(mLevel);
-            mSystems.get()->get<system::AllowMovement>().update(level);
-            mPlayers.each([](component::PlayerRoundData & aRoundData, const component::AllowedMovement & aAllowedMovement) {
-                if ((aRoundData.mMoveState & aAllowedMovement.mAllowedMovement) == gPlayerMoveFlagNone)
-                {
-                    // This just shift the bit by one if it's less than 16
-                    // And transforms 16 into 2 (basically a rotation between 2,4,8 and 16)
-                    aRoundData.mMoveState = (aRoundData.mMoveState % 15) << 1;
-                }
-            });
-            mSystems.get()->get<system::IntegratePlayerMovement>().update(
-                (float) aTime.mDeltaSeconds);
-            mSystems.get()->get<system::MovementIntegration>().update(
-                (float) aTime.mDeltaSeconds);
-            mSystems.get()->get<system::AnimationManager>().update();
-            mSystems.get()->get<system::AdvanceAnimations>().update(aTime);
-            mSystems.get()->get<system::Pathfinding>().update(level);
-            mSystems.get()->get<system::PortalManagement>().preGraphUpdate();
-            mSystems.get()->get<system::Explosion>().update(aTime);
-            mSystems.get()->get<system::SceneGraphResolver>().update();
-            mSystems.get()->get<system::PortalManagement>().postGraphUpdate(
-                level);
-            mSystems.get()->get<system::TextZoomSystem>().update(aTime);
+            prepareStep(aTime, level);
+            mVictoryScheduler.run();
         }
         else
         {
@@ -588,30 +757,8 @@ void GameScene::update(const snac::Time & aTime, RawInput & aInput)
     case GamePhase::Playing:
     {
         auto level = snac::getComponent<component::Level>(mLevel);
-
-        mSystems.get()->get<system::PlayerInvulFrame>().update(
-            (float) aTime.mDeltaSeconds);
-        mSystems.get()->get<system::AllowMovement>().update(level);
-        mSystems.get()->get<system::ConsolidateGridMovement>().update(
-            (float) aTime.mDeltaSeconds);
-        mSystems.get()->get<system::IntegratePlayerMovement>().update(
-            (float) aTime.mDeltaSeconds);
-        mSystems.get()->get<system::MovementIntegration>().update(
-            (float) aTime.mDeltaSeconds);
-        mSystems.get()->get<system::AnimationManager>().update();
-        mSystems.get()->get<system::AdvanceAnimations>().update(aTime);
-        mSystems.get()->get<system::Pathfinding>().update(level);
-        mSystems.get()->get<system::PortalManagement>().preGraphUpdate();
-        mSystems.get()->get<system::Explosion>().update(aTime);
-
-        mSystems.get()->get<system::SceneGraphResolver>().update();
-
-        mSystems.get()->get<system::PortalManagement>().postGraphUpdate(level);
-        mSystems.get()->get<system::PowerUpUsage>().update(aTime, mLevel);
-        mSystems.get()->get<system::EatPill>().update(mGameContext);
-        mSystems.get()->get<system::BurgerLoss>().update(mLevel, aTime);
-
-        mSystems.get()->get<system::Debug_BoundingBoxes>().update();
+        prepareStep(aTime, level);
+        mPlayingScheduler.run();
 
         break;
     }
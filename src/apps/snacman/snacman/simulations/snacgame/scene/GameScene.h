@@ -1,6 +1,7 @@
 #pragma once
 
 #include "Scene.h"
+#include "../SystemScheduler.h"
 #include "snacman/Timing.h"
 #include "snacman/simulations/snacgame/component/AllowedMovement.h"
 #include "snacman/simulations/snacgame/component/Geometry.h"
@@ -28,6 +29,7 @@ struct RawInput;
 namespace snacgame {
 
 struct GameContext;
+class CollisionGrid;
 
 namespace component {
 struct MappingContext;
@@ -40,8 +42,29 @@ struct LevelTile;
 struct RoundTransient;
 struct LevelSetupData;
 struct Gravity;
+struct Level;
 } // namespace component
 
+namespace system {
+class AdvanceAnimations;
+class AllowMovement;
+class AnimationManager;
+class BurgerLoss;
+class CollisionBroadphase;
+class ConsolidateGridMovement;
+class Debug_BoundingBoxes;
+class EatPill;
+class Explosion;
+class IntegratePlayerMovement;
+class MovementIntegration;
+class Pathfinding;
+class PlayerInvulFrame;
+class PortalManagement;
+class PowerUpUsage;
+class SceneGraphResolver;
+class TextZoomSystem;
+} // namespace system
+
 namespace scene {
 
 enum class GamePhase
@@ -86,6 +109,46 @@ private:
     ent::Handle<ent::Entity> createSpawningPhaseText(const std::string & aText, const math::hdr::Rgba_f & aColor, const snac::Time & aTimer);
     void cleanGameScene(ent::Phase & destroyPhase);
 
+    /// @brief What the scheduled systems access, refreshed on the simulation thread before each run.
+    ///
+    /// The system instances are components of mSystems, so they are fetched again on each step
+    /// (restoring a saved state may relocate them), and the tasks do not access mSystems concurrently.
+    struct ScheduledStep
+    {
+        const snac::Time * mTime = nullptr;
+        component::Level * mLevel = nullptr;
+        CollisionGrid * mCollisionGrid = nullptr;
+
+        system::AdvanceAnimations * mAdvanceAnimations = nullptr;
+        system::AllowMovement * mAllowMovement = nullptr;
+        system::AnimationManager * mAnimationManager = nullptr;
+        system::BurgerLoss * mBurgerLoss = nullptr;
+        system::CollisionBroadphase * mCollisionBroadphase = nullptr;
+        system::ConsolidateGridMovement * mConsolidateGridMovement = nullptr;
+        system::Debug_BoundingBoxes * mDebugBoundingBoxes = nullptr;
+        system::EatPill * mEatPill = nullptr;
+        system::Explosion * mExplosion = nullptr;
+        system::IntegratePlayerMovement * mIntegratePlayerMovement = nullptr;
+        system::MovementIntegration * mMovementIntegration = nullptr;
+        system::Pathfinding * mPathfinding = nullptr;
+        system::PlayerInvulFrame * mPlayerInvulFrame = nullptr;
+        system::PortalManagement * mPortalManagement = nullptr;
+        system::PowerUpUsage * mPowerUpUsage = nullptr;
+        system::SceneGraphResolver * mSceneGraphResolver = nullptr;
+        system::TextZoomSystem * mTextZoom = nullptr;
+    };
+
+    /// @brief Add the systems of the victory sequence and playing phases to their schedulers, once.
+    /// The tasks read everything that changes between steps from mStep.
+    void buildSchedules();
+    /// @brief Add the movement integration, animations and pathfinding systems to the scheduler.
+    void scheduleIntegrateAndAnimate(SystemScheduler & aScheduler);
+    /// @brief Add the portal, explosion, scene graph and collision broadphase systems to the scheduler.
+    /// @attention The collision grid is only populated once the scheduler ran.
+    void scheduleGraphAndCollisions(SystemScheduler & aScheduler);
+    /// @brief Point mStep to the values of this step, before running a scheduler.
+    void prepareStep(const snac::Time & aTime, component::Level & aLevel);
+
     ent::Query<component::LevelTile> mTiles;
     ent::Query<component::RoundTransient> mRoundTransients;
     ent::Query<component::PlayerSlot, component::PlayerGameData> mSlots;
@@ -97,6 +160,9 @@ private:
     ent::Handle<ent::Entity> mReadyText;
     ent::Handle<ent::Entity> mGoText;
     ent::Handle<ent::Entity> mVictoryText;
+    ScheduledStep mStep;
+    SystemScheduler mVictoryScheduler;
+    SystemScheduler mPlayingScheduler;
 };
 
 } // namespace scene
@@ -7,7 +7,6 @@
 
 #include <snacman/Timing.h>
 #include <snacman/Logging.h>
-#include <snacman/Profiling.h>
 #include <snac-renderer-V1/Camera.h>
 
 
@@ -21,8 +20,6 @@ AdvanceAnimations::AdvanceAnimations(GameContext & aGameContext) :
 
 void AdvanceAnimations::update(const snac::Time & aSimulationTime)
 {
-    TIME_RECURRING_CLASSFUNC(Main);
-
     mAnimations.each([&](component::RigAnimation & aRigAnimation)
     {
         // TODO Ad 2024/03/27: It should be asserted that the resulting value has enough precision as a float.
@@ -13,7 +13,6 @@
 
 #include <snacman/Input.h>
 #include <snacman/Logging.h>
-#include <snacman/Profiling.h>
 
 #include <entity/EntityManager.h>
 
@@ -33,10 +32,6 @@ AllowMovement::AllowMovement(GameContext & aGameContext) :
 
 void AllowMovement::update(component::Level & aLevelData)
 {
-    TIME_RECURRING_CLASSFUNC(Main);
-
-    ent::Phase nomutation;
-
     auto tiles = aLevelData.mTiles;
     if (tiles.size() == 0) [[unlikely]]
     {
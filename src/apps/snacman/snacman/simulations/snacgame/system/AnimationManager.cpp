@@ -9,6 +9,8 @@
 #include "../InputConstants.h"
 #include "../typedef.h"
 
+#include <snacman/EntityUtilities.h>
+
 #include <entity/EntityManager.h>
 #include <string>
 
@@ -23,7 +25,6 @@ AnimationManager::AnimationManager(GameContext & aGameContext) :
 void AnimationManager::update()
 {
     mAnimated.each([](component::PlayerRoundData & aRoundData) {
-        Phase animPhase;
         float animSpeed = 0.6f;
         std::string newAnimName = "idle";
         if (aRoundData.mMoveState
@@ -34,7 +35,8 @@ void AnimationManager::update()
             animSpeed = 3.0f;
         }
 
-        component::RigAnimation & playerAnim = aRoundData.mModel.get(animPhase)->get<component::RigAnimation>();
+        component::RigAnimation & playerAnim =
+            snac::getComponent<component::RigAnimation>(aRoundData.mModel);
 
         if (newAnimName != playerAnim.mAnimation->mName)
         {
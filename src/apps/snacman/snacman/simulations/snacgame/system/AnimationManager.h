@@ -15,6 +15,7 @@ class AnimationManager
 public:
     AnimationManager(GameContext & aGameContext);
 
+    /// @brief Writes the RigAnimation of the player models, reached via phase-less handle access.
     void update();
 
 private:
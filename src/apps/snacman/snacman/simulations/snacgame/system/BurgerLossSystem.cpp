@@ -5,6 +5,7 @@
 #include "snacman/EntityUtilities.h"
 #include "snacman/Logging.h"
 #include "snacman/Timing.h"
+#include "snacman/simulations/snacgame/CollisionGrid.h"
 #include "snacman/simulations/snacgame/Entities.h"
 #include "snacman/simulations/snacgame/SceneGraph.h"
 #include "snacman/simulations/snacgame/component/Collision.h"
@@ -14,6 +15,10 @@
 
 #include <snacman/DebugDrawing.h>
 
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
 namespace ad {
 namespace snacgame {
 namespace system {
@@ -23,20 +28,58 @@ BurgerLoss::BurgerLoss(GameContext & aContext) :
     mContext{&aContext}
 {}
 
-void BurgerLoss::update(ent::Handle<ent::Entity> aLevel, const snac::Time & aTime)
+void BurgerLoss::update(ent::Handle<ent::Entity> aLevel,
+                        const snac::Time & aTime,
+                        const CollisionGrid & aCollisionGrid)
 {
     ent::Phase destroyHitbox;
-    //TODO(franz): this isn't right particle should have the target they aim for
-    // we don't have to check all hitbox
-    std::vector<ent::Handle<ent::Entity>> usedTiles;
-    usedTiles.reserve(mBurgerHitbox.countMatches());
-    mBurgerHitbox.each([this, &destroyHitbox, aLevel, &aTime, &usedTiles](ent::Handle<ent::Entity> aHandleHb,
+    // Tiles and particles already consumed this update.
+    std::unordered_set<ent::Handle<ent::Entity>> consumed;
+    consumed.reserve(2 * mBurgerHitbox.countMatches());
+
+    auto consume = [this, &destroyHitbox, aLevel, &consumed](
+                       ent::Handle<ent::Entity> aHandleHb,
+                       ent::Handle<ent::Entity> aTileHandle,
+                       ent::Handle<ent::Entity> aHandleParticle,
+                       const component::BurgerParticle & aParticle)
+    {
+        if (consumed.contains(aTileHandle) || consumed.contains(aHandleParticle))
+        {
+            return;
+        }
+
+        if (aTileHandle.isValid())
+        {
+            component::LevelTile & tile = snac::getComponent<component::LevelTile>(aTileHandle);
+            ent::Handle<ent::Entity> pill;
+            {
+                ent::Phase createPillPhase;
+                pill = createPill(*mContext, createPillPhase, aParticle.mTargetPos.xy());
+            }
+            insertEntityInScene(pill, aLevel);
+            tile.mPill = pill;
+        }
+        consumed.insert(aTileHandle);
+        consumed.insert(aHandleParticle);
+        SELOG(debug)("Tile handle: {}",aTileHandle.id());
+        SELOG(debug)("hb handle: {}",aHandleHb.id());
+        SELOG(debug)("Particle handle: {}",aHandleParticle.id());
+        aHandleHb.get(destroyHitbox)->erase();
+        aHandleParticle.get(destroyHitbox)->erase();
+    };
+
+    // Hitboxes in query order, for the particles that missed them all.
+    std::vector<std::pair<ent::Handle<ent::Entity>, ent::Handle<ent::Entity>>> hitboxes;
+    hitboxes.reserve(mBurgerHitbox.countMatches());
+
+    // Particles landing on a hitbox.
+    mBurgerHitbox.each([&aCollisionGrid, &consume, &hitboxes](ent::Handle<ent::Entity> aHandleHb,
                               const component::BurgerLossHitbox & aHitbox,
                               const component::Collision & aCollision,
                               const component::GlobalPose & aPose) {
+        hitboxes.emplace_back(aHandleHb, aHitbox.mTile);
         const math::Box<float> hitbox =
             component::transformHitbox(aPose.mPosition, aCollision.mHitbox);
-        ent::Handle<ent::Entity> tileHandle = aHitbox.mTile;
         DBGDRAW(snac::gHitboxDrawer, snac::DebugDrawer::Level::debug).addBox(
             snac::DebugDrawer::Entry{
                 .mPosition = {0.f, 0.f, 0.f},
@@ -44,49 +87,45 @@ void BurgerLoss::update(ent::Handle<ent::Entity> aLevel, const snac::Time & aTim
             },
             hitbox
         );
-        mBurgerParticles.each([&hitbox, &destroyHitbox, this, &tileHandle, &aHandleHb, aLevel, &aTime, &usedTiles](
-                        ent::Handle<ent::Entity> aHandleParticle,
-                        const component::BurgerParticle & aParticle,
-                        const component::Collision & aCollisionP,
-                        const component::GlobalPose & aPoseP) {
-            const math::Box<float> hitboxParticles = component::transformHitbox(
-                aPoseP.mPosition, aCollisionP.mHitbox);
-            bool collide = component::collideWithSat(hitbox, hitboxParticles);
-            const double duration = snac::asSeconds(aTime.mTimepoint - aParticle.mStartTime);
-            DBGDRAW(snac::gHitboxDrawer, snac::DebugDrawer::Level::debug).addBox(
-                snac::DebugDrawer::Entry{
-                    .mPosition = {0.f, 0.f, 0.f},
-                    .mColor = math::hdr::Rgb_f{1.f, 0.5f, 0.1f},
-                },
-                hitboxParticles
-            );
-            //TODO(franz): I mean wtf is this get your shit together
-            bool notDone = std::find(usedTiles.begin(), usedTiles.end(), tileHandle) == usedTiles.end() &&
-                               std::find(usedTiles.begin(), usedTiles.end(), aHandleParticle) == usedTiles.end();
-            if ((collide ||
-                duration > (2 * aParticle.mTargetNorm / aParticle.mBaseSpeed)) &&
-                notDone)
+        aCollisionGrid.forEachCollision(
+            CollisionLayer::BurgerParticle, hitbox,
+            [&consume, &aHandleHb, &aHitbox](const CollisionGrid::Entry & aParticleEntry) {
+                consume(aHandleHb, aHitbox.mTile, aParticleEntry.mHandle,
+                        snac::getComponent<component::BurgerParticle>(aParticleEntry.mHandle));
+            });
+    });
+
+    // Particles that missed all the hitboxes, after the time to land, are consumed by the first hitbox available.
+    // Consumed tiles are never released during the update, so the first available hitbox only moves forward.
+    std::size_t firstAvailable = 0;
+    mBurgerParticles.each([&aTime, &consume, &consumed, &hitboxes, &firstAvailable](
+                    ent::Handle<ent::Entity> aHandleParticle,
+                    const component::BurgerParticle & aParticle,
+                    const component::Collision & aCollisionP,
+                    const component::GlobalPose & aPoseP) {
+        DBGDRAW(snac::gHitboxDrawer, snac::DebugDrawer::Level::debug).addBox(
+            snac::DebugDrawer::Entry{
+                .mPosition = {0.f, 0.f, 0.f},
+                .mColor = math::hdr::Rgb_f{1.f, 0.5f, 0.1f},
+            },
+            component::transformHitbox(aPoseP.mPosition, aCollisionP.mHitbox)
+        );
+
+        const double duration = snac::asSeconds(aTime.mTimepoint - aParticle.mStartTime);
+        if (duration > (2 * aParticle.mTargetNorm / aParticle.mBaseSpeed)
+            && !consumed.contains(aHandleParticle))
+        {
+            while (firstAvailable != hitboxes.size()
+                   && consumed.contains(hitboxes[firstAvailable].second))
+            {
+                ++firstAvailable;
+            }
+            if (firstAvailable != hitboxes.size())
             {
-                if (tileHandle.isValid())
-                {
-                    component::LevelTile & tile = snac::getComponent<component::LevelTile>(tileHandle);
-                    ent::Handle<ent::Entity> pill;
-                    {
-                        ent::Phase createPillPhase;
-                        pill = createPill(*mContext, createPillPhase, aParticle.mTargetPos.xy());
-                    }
-                    insertEntityInScene(pill, aLevel);
-                    tile.mPill = pill;
-                }
-                usedTiles.push_back(tileHandle);
-                usedTiles.push_back(aHandleParticle);
-                SELOG(debug)("Tile handle: {}",tileHandle.id());
-                SELOG(debug)("hb handle: {}",aHandleHb.id());
-                SELOG(debug)("Particle handle: {}",aHandleParticle.id());
-                aHandleHb.get(destroyHitbox)->erase();
-                aHandleParticle.get(destroyHitbox)->erase();
+                auto [handleHb, tileHandle] = hitboxes[firstAvailable];
+                consume(handleHb, tileHandle, aHandleParticle, aParticle);
             }
-        });
+        }
     });
 }
 } // namespace system
@@ -9,6 +9,7 @@
 
 namespace ad {
 namespace snacgame {
+class CollisionGrid;
 namespace system {
 
 class BurgerLoss
@@ -16,7 +17,9 @@ class BurgerLoss
 public:
     BurgerLoss(GameContext & aGameContext);
 
-    void update(ent::Handle<ent::Entity> aLevel, const snac::Time & aTime);
+    void update(ent::Handle<ent::Entity> aLevel,
+                const snac::Time & aTime,
+                const CollisionGrid & aCollisionGrid);
 
 private:
     ent::Query<component::BurgerLossHitbox, component::Collision, component::GlobalPose>
@@ -0,0 +1,62 @@
+#include "CollisionBroadphase.h"
+
+#include "../component/Collision.h"
+#include "../component/GlobalPose.h"
+#include "../component/LevelData.h"
+#include "../component/PlayerRoundData.h"
+#include "../component/Portal.h"
+#include "../component/PowerUp.h"
+#include "../component/Tags.h"
+
+#include "../GameContext.h"
+#include "../typedef.h"
+
+namespace ad {
+namespace snacgame {
+namespace system {
+
+CollisionBroadphase::CollisionBroadphase(GameContext & aGameContext) :
+    mPlayers{aGameContext.mWorld},
+    mPills{aGameContext.mWorld},
+    mPowerups{aGameContext.mWorld},
+    mPortals{aGameContext.mWorld},
+    mBurgerParticles{aGameContext.mWorld}
+{}
+
+void CollisionBroadphase::update(const component::Level & aLevelData)
+{
+    mGrid.beginSync(aLevelData);
+
+    auto syncAll = [this](CollisionLayer aLayer)
+    {
+        return [this, aLayer](EntHandle aHandle,
+                              const component::GlobalPose & aPose,
+                              const component::Collision & aCollision)
+        {
+            mGrid.sync(aLayer, aHandle,
+                       component::transformHitbox(aPose.mPosition, aCollision.mHitbox));
+        };
+    };
+
+    mPlayers.each(syncAll(CollisionLayer::Player));
+    mPills.each(syncAll(CollisionLayer::Pill));
+    mPowerups.each(syncAll(CollisionLayer::PowerUp));
+    mBurgerParticles.each(syncAll(CollisionLayer::BurgerParticle));
+
+    // Portals have distinct enter and exit hitboxes, the entry covers both.
+    mPortals.each([this](EntHandle aHandle,
+                         const component::GlobalPose & aPose,
+                         const component::Portal & aPortal)
+    {
+        mGrid.sync(CollisionLayer::Portal, aHandle,
+                   component::uniteHitboxes(
+                       component::transformHitbox(aPose.mPosition, aPortal.mEnterHitbox),
+                       component::transformHitbox(aPose.mPosition, aPortal.mExitHitbox)));
+    });
+
+    mGrid.endSync();
+}
+
+} // namespace system
+} // namespace snacgame
+} // namespace ad
@@ -0,0 +1,52 @@
+#pragma once
+
+#include "../CollisionGrid.h"
+
+#include <entity/Query.h>
+
+namespace ad {
+namespace snacgame {
+struct GameContext;
+namespace component {
+struct BurgerParticle;
+struct Collision;
+struct GlobalPose;
+struct Level;
+struct Pill;
+struct PlayerRoundData;
+struct Portal;
+struct PowerUp;
+}
+namespace system {
+
+/// @brief Synchronizes the CollisionGrid shared by the collision systems, once per tick.
+///
+/// It must run after the scene graph is resolved, since the hitboxes are placed from the GlobalPose.
+class CollisionBroadphase
+{
+public:
+    CollisionBroadphase(GameContext & aGameContext);
+
+    void update(const component::Level & aLevelData);
+
+    CollisionGrid mGrid;
+
+private:
+    ent::Query<component::GlobalPose,
+               component::Collision,
+               component::PlayerRoundData>
+        mPlayers;
+    ent::Query<component::GlobalPose, component::Collision, component::Pill>
+        mPills;
+    ent::Query<component::GlobalPose, component::Collision, component::PowerUp>
+        mPowerups;
+    ent::Query<component::GlobalPose, component::Portal> mPortals;
+    ent::Query<component::GlobalPose,
+               component::Collision,
+               component::BurgerParticle>
+        mBurgerParticles;
+};
+
+} // namespace system
+} // namespace snacgame
+} // namespace ad
@@ -16,7 +16,6 @@
 
 #include <snacman/DebugDrawing.h>
 #include <snacman/Logging.h>
-#include <snacman/Profiling.h>
 
 namespace ad {
 namespace snacgame {
@@ -29,7 +28,6 @@ ConsolidateGridMovement::ConsolidateGridMovement(GameContext & aGameContext) :
 
 void ConsolidateGridMovement::update(float aDelta)
 {
-    TIME_RECURRING_CLASSFUNC(Main);
     mPlayer.each([](const component::AllowedMovement & aAllowedMovement,
                     component::Controller & aController,
                     component::PlayerRoundData & aRoundData) {
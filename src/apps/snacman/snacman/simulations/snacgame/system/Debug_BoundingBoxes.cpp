@@ -11,7 +11,6 @@
 #include "../GameContext.h"
 
 #include <snacman/DebugDrawing.h>
-#include <snacman/Profiling.h>
 
 
 namespace ad {
@@ -26,8 +25,6 @@ Debug_BoundingBoxes::Debug_BoundingBoxes(GameContext & aGameContext) :
 
 void Debug_BoundingBoxes::update()
 {
-    TIME_RECURRING_CLASSFUNC(Main);
-
     using Level = snac::DebugDrawer::Level;
 
     Level level = Level::off;
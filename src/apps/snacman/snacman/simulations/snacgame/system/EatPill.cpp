@@ -12,6 +12,7 @@
 #include "../component/PlayerGameData.h"
 #include "../component/PlayerSlot.h"
 
+#include "../CollisionGrid.h"
 #include "../GameParameters.h"
 #include "../typedef.h"
 #include "../GameContext.h"
@@ -43,10 +44,10 @@ EatPill::EatPill(GameContext & aGameContext) :
 {}
 
 
-void EatPill::update(GameContext & aGameContext)
+void EatPill::update(GameContext & aGameContext, const CollisionGrid & aCollisionGrid)
 {
     TIME_RECURRING_CLASSFUNC(Main);
-    mPlayers.each([this, &aGameContext]
+    mPlayers.each([this, &aGameContext, &aCollisionGrid]
                   (const component::GlobalPose & aPlayerGeo,
                    component::Collision aPlayerCol,
                    component::PlayerRoundData & aRoundData)
@@ -65,23 +66,19 @@ void EatPill::update(GameContext & aGameContext)
 
         const component::PlayerSlot & slot = aRoundData.mSlot.get()->get<component::PlayerSlot>();
 
-        mPills.each([this, &eatPillUpdate, &playerHitbox, &aRoundData, &slot]
-                    (ent::Handle<ent::Entity> aHandle,
-                     const component::GlobalPose & aPillGeo,
-                     const component::Collision & aPillCol) 
+        if (aRoundData.mInvulFrameCounter <= 0.f)
         {
-            Box_f pillHitbox = component::transformHitbox(aPillGeo.mPosition,
-                                                          aPillCol.mHitbox);
-
-            if (component::collideWithSat(pillHitbox, playerHitbox) && aRoundData.mInvulFrameCounter <= 0.f)
-            {
-                mEatSoundPerSlot.at(slot.mSlotIndex).play();
-
-                aHandle.get(eatPillUpdate)->erase();
-                aRoundData.mRoundScore += gPointPerPill;
-
-            }
-        });
+            aCollisionGrid.forEachCollision(
+                CollisionLayer::Pill, playerHitbox,
+                [this, &eatPillUpdate, &aRoundData, &slot](const CollisionGrid::Entry & aPill)
+                {
+                    mEatSoundPerSlot.at(slot.mSlotIndex).play();
+
+                    EntHandle pill = aPill.mHandle;
+                    pill.get(eatPillUpdate)->erase();
+                    aRoundData.mRoundScore += gPointPerPill;
+                });
+        }
 
         // TODO: Should only happen on pill eating (collision),
         // but it would show the previous round score until 1st pill of next round is eaten (stunfest Q&D)
@@ -7,6 +7,7 @@
 
 namespace ad {
 namespace snacgame {
+class CollisionGrid;
 struct GameContext;
 namespace component {
 struct GlobalPose;
@@ -23,7 +24,7 @@ class EatPill
 public:
     EatPill(GameContext & aGameContext);
 
-    void update(GameContext & aGameContext);
+    void update(GameContext & aGameContext, const CollisionGrid & aCollisionGrid);
 
 private:
     ent::Query<component::GlobalPose,
@@ -6,6 +6,7 @@
 #include "../component/PlayerSlot.h"
 
 #include "../GameContext.h"
+#include "../SystemScheduler.h"
 
 #include "../typedef.h"
 
@@ -19,16 +20,15 @@ Explosion::Explosion(GameContext & aGameContext) :
     mExplosions(aGameContext.mWorld)
 {}
 
-void Explosion::update(const snac::Time & aTime)
+void Explosion::update(const snac::Time & aTime, DeferredChanges & aChanges)
 {
-    Phase removeExplosion;
-    mExplosions.each([&aTime, &removeExplosion](EntHandle aHandle, component::Explosion & aExplosion, component::Geometry & aGeometry)
+    mExplosions.each([&aTime, &aChanges](EntHandle aHandle, component::Explosion & aExplosion, component::Geometry & aGeometry)
     {
         float duration = (float)snac::asSeconds(aTime.mTimepoint - aExplosion.mStartTime);
 
         if (aExplosion.mParameter.isCompleted(duration))
         {
-            aHandle.get(removeExplosion)->erase();
+            aChanges.erase(aHandle);
         }
         else
         {
@@ -6,6 +6,7 @@
 
 namespace ad {
 namespace snacgame {
+class DeferredChanges;
 struct GameContext;
 
 namespace component {
@@ -19,7 +20,8 @@ class Explosion
 public:
     Explosion(GameContext & aGameContext);
 
-    void update(const snac::Time & aTime);
+    /// @param aChanges Records the removal of the completed explosions.
+    void update(const snac::Time & aTime, DeferredChanges & aChanges);
 private:
     ent::Query<component::Explosion, component::Geometry> mExplosions;
 };
@@ -14,7 +14,6 @@
 #include "../component/PlayerSlot.h"
 
 #include <snacman/EntityUtilities.h>
-#include <snacman/Profiling.h>
 
 #include <snac-renderer-V1/Cube.h>
 
@@ -32,8 +31,6 @@ IntegratePlayerMovement::IntegratePlayerMovement(GameContext & aGameContext) :
 
 void IntegratePlayerMovement::update(float aDelta)
 {
-    TIME_RECURRING_CLASSFUNC(Main);
-
     mPlayer.each([aDelta](component::Geometry & aGeometry,
                           component::PlayerRoundData & aRoundData) {
         Pos2_i intPos = getLevelPosition_i(aGeometry.mPosition.xy());
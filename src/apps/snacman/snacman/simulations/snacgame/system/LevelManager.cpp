@@ -9,6 +9,7 @@
 #include "../component/PlayerSlot.h"
 
 #include "../Entities.h"
+#include "../EntityBatch.h"
 #include "../GameContext.h"
 #include "../LevelHelper.h"
 #include "../SceneGraph.h"
@@ -27,6 +28,10 @@ namespace system {
 constexpr Pos3 gBaseLevelPos{-7.f, -7.f, 0.f};
 constexpr float gBaseLevelScalingNumerator = 15.f;
 
+namespace {
+    int gNextNavigationGeneration = 1;
+} // namespace
+
 LevelManager::LevelManager(GameContext & aGameContext) :
     mGameContext{&aGameContext},
     mTiles{mGameContext->mWorld},
@@ -74,16 +79,17 @@ LevelManager::createLevel(const component::LevelSetupData & aSetupData)
     nodes.reserve(stride * height);
     std::vector<int> portalIndices;
 
-    // This takes a lot of time
-    // Presumable because there is a lot of allocation and moving
-    // of archetypes
-    // However this needs a way to instantiate null handle
-    // so that we can pre instantiate component containing handles
-    // Or we need a custom allocator for the whole entity manager
-    // Right now it's 15 ms in release for 225 entity that's 66us per
-    // instantiation
     {
         TIME_SINGLE(Main, "Create elements with phase destruction");
+
+        // Adding the components one by one used to take 15 ms in release for 225 entities
+        // (66us per instantiation), because of the archetype moves.
+        // Paths and pills, which make up most of the level, are now spawned from
+        // blueprints directly in their final archetype.
+        // The batches are scoped to the level creation: their blueprints are erased
+        // (after the createLevel phase) before the scene insertion queries the level entities.
+        EntityBatch pills = createPillBatch(*mGameContext);
+        EntityBatch paths = createPathBatch(*mGameContext);
         {
             Phase createLevel;
 
@@ -115,14 +121,14 @@ LevelManager::createLevel(const component::LevelSetupData & aSetupData)
                     case 'W':
                     {
                         type = component::TileType::Path;
-                        ent::Handle<ent::Entity> pill = createPill(*mGameContext, createLevel, tilePos);
-                        createPathEntity(*mGameContext, createLevel, tilePos, pill);
+                        ent::Handle<ent::Entity> pill = createPill(pills, tilePos);
+                        createPathEntity(paths, tilePos, pill);
                         break;
                     }
                     case 'O':
                     {
                         type = component::TileType::Powerup;
-                        createPathEntity(*mGameContext, createLevel, tilePos);
+                        createPathEntity(paths, tilePos);
 
                         using component::PowerUpType;
                         createPowerUp(
@@ -199,6 +205,7 @@ LevelManager::createLevel(const component::LevelSetupData & aSetupData)
 
             levelData.mTiles = std::move(tiles);
             levelData.mNodes = std::move(nodes);
+            levelData.mNavigationGeneration = gNextNavigationGeneration++;
             levelData.mPortalIndex = std::move(portalIndices);
 
             level.get(createLevel)
@@ -13,7 +13,6 @@
 #include "../GameContext.h"
 
 #include <entity/EntityManager.h>
-#include <snacman/Profiling.h>
 
 namespace ad {
 namespace snacgame {
@@ -28,9 +27,6 @@ MovementIntegration::MovementIntegration(GameContext & aGameContext) :
 
 void MovementIntegration::update(float aDelta)
 {
-    TIME_RECURRING_CLASSFUNC(Main);
-
-    ent::Phase integrate;
     mGravityObject.each([aDelta](component::Speed & aMovement,
                                  const component::Gravity & aGravity) {
         aMovement.mSpeed.z() += aGravity.mGravityAccel * aDelta;
@@ -11,45 +11,305 @@
 #include "../component/PlayerSlot.h"
 
 #include <snacman/Logging.h>
-#include <snacman/Profiling.h>
 
+#include <algorithm>
 #include <cmath>
 #include <cstdlib>
-#include <queue>
 
 namespace ad {
 namespace snacgame {
 namespace system {
 
+namespace {
+
+    /// @brief Index of the node at `aOffset` from node `aIndex`,
+    /// or an empty optional if it is outside of the level.
+    std::optional<std::size_t> getNeighbourIndex(const component::Level & aLevel,
+                                                 std::size_t aIndex,
+                                                 math::Vec<2, int> aOffset)
+    {
+        const int width = aLevel.mSize.width();
+        const int x = (int)(aIndex % width) + aOffset.x();
+        const int y = (int)(aIndex / width) + aOffset.y();
+        if (x < 0 || x >= width || y < 0 || y >= aLevel.mSize.height())
+        {
+            return std::nullopt;
+        }
+        return (std::size_t)(x + y * width);
+    }
+
+    /// @brief Index of the node under `aPos`, or an empty optional if it is outside of the level.
+    std::optional<std::size_t> getNodeIndex(const component::Level & aLevel,
+                                            const math::Position<2, float> & aPos)
+    {
+        const Pos2 tilePos = getLevelPosition(aPos);
+        if (tilePos.x() < 0.f || tilePos.x() >= (float)aLevel.mSize.width()
+            || tilePos.y() < 0.f || tilePos.y() >= (float)aLevel.mSize.height())
+        {
+            return std::nullopt;
+        }
+        return (std::size_t)tilePos.x()
+               + (std::size_t)tilePos.y() * aLevel.mSize.width();
+    }
+
+} // namespace
+
+std::optional<math::Position<2, float>>
+DistanceFieldCache::getNextStep(const component::Level & aLevel,
+                                const math::Position<2, float> & aSource,
+                                std::size_t aTargetIndex)
+{
+    std::optional<std::size_t> sourceIndex = getNodeIndex(aLevel, aSource);
+    if (!sourceIndex)
+    {
+        return std::nullopt;
+    }
+    else if (*sourceIndex == aTargetIndex)
+    {
+        return aSource;
+    }
+
+    const std::vector<component::PathfindNode> & nodes = aLevel.mNodes;
+    const std::vector<int> & distances = getDistances(aLevel, aTargetIndex);
+
+    std::optional<math::Position<2, float>> nextStep;
+    float bestCost = std::numeric_limits<float>::max();
+    auto consider = [&](std::size_t aIndex)
+    {
+        if (distances[aIndex] != gUnreachable)
+        {
+            float cost = (nodes[aIndex].mPos - aSource).getNorm()
+                         + (float)distances[aIndex] * gCellSize;
+            if (cost < bestCost)
+            {
+                bestCost = cost;
+                nextStep = nodes[aIndex].mPos;
+            }
+        }
+    };
+
+    // If the agent is perfectly on its tile, it must not step to it
+    // otherwise it would be stuck.
+    if ((nodes[*sourceIndex].mPos - aSource).getNorm() != 0.f)
+    {
+        consider(*sourceIndex);
+    }
+    for (math::Vec<2, int> offset : gDirections)
+    {
+        if (std::optional<std::size_t> neighbour =
+                getNeighbourIndex(aLevel, *sourceIndex, offset))
+        {
+            consider(*neighbour);
+        }
+    }
+
+    return nextStep;
+}
+
+const std::vector<int> &
+DistanceFieldCache::getDistances(const component::Level & aLevel,
+                                 std::size_t aTargetIndex)
+{
+    if (aLevel.mNavigationGeneration != mNavigationGeneration)
+    {
+        mFields.clear();
+        mNavigationGeneration = aLevel.mNavigationGeneration;
+    }
+
+    ++mUseCounter;
+    auto found = std::find_if(mFields.begin(), mFields.end(),
+                              [aTargetIndex](const DistanceField & aField)
+                              {
+                                  return aField.mTargetIndex == aTargetIndex;
+                              });
+
+    if (found == mFields.end())
+    {
+        if (mFields.size() < gCapacity)
+        {
+            found = mFields.emplace(mFields.end());
+        }
+        else
+        {
+            // Recycle the least recently used field, keeping its storage.
+            found = std::min_element(mFields.begin(), mFields.end(),
+                                     [](const DistanceField & aLhs, const DistanceField & aRhs)
+                                     {
+                                         return aLhs.mLastUse < aRhs.mLastUse;
+                                     });
+        }
+        found->mTargetIndex = aTargetIndex;
+        computeDistances(aLevel, aTargetIndex, found->mDistances);
+    }
+
+    found->mLastUse = mUseCounter;
+    return found->mDistances;
+}
+
+void DistanceFieldCache::computeDistances(const component::Level & aLevel,
+                                          std::size_t aTargetIndex,
+                                          std::vector<int> & aDistances)
+{
+    const std::vector<component::PathfindNode> & nodes = aLevel.mNodes;
+    aDistances.assign(nodes.size(), gUnreachable);
+    if (!nodes.at(aTargetIndex).mPathable)
+    {
+        return;
+    }
+
+    mQueue.clear();
+    aDistances[aTargetIndex] = 0;
+    mQueue.push_back(aTargetIndex);
+    // The queue is never popped, the head index walks it instead.
+    for (std::size_t head = 0; head != mQueue.size(); ++head)
+    {
+        const std::size_t current = mQueue[head];
+        for (math::Vec<2, int> offset : gDirections)
+        {
+            std::optional<std::size_t> neighbour =
+                getNeighbourIndex(aLevel, current, offset);
+            if (neighbour && nodes[*neighbour].mPathable
+                && aDistances[*neighbour] == gUnreachable)
+            {
+                aDistances[*neighbour] = aDistances[current] + 1;
+                mQueue.push_back(*neighbour);
+            }
+        }
+    }
+}
+
+void GridAStar::open(const component::Level & aLevel,
+                     std::size_t aIndex,
+                     std::size_t aPrevious,
+                     float aCost,
+                     const math::Position<2, float> & aTarget)
+{
+    if (mStamps[aIndex] == mStamp && mCosts[aIndex] <= aCost)
+    {
+        return;
+    }
+
+    mStamps[aIndex] = mStamp;
+    mCosts[aIndex] = aCost;
+    mPrevious[aIndex] = aPrevious;
+
+    mOpened.push_back(OpenNode{
+        .mReducedCost = aCost + manhattan(aLevel.mNodes[aIndex].mPos, aTarget),
+        .mCost = aCost,
+        .mIndex = aIndex,
+    });
+    std::push_heap(mOpened.begin(), mOpened.end(), &OpenNode::GreaterReducedCost);
+}
+
+bool GridAStar::findPath(const component::Level & aLevel,
+                         const math::Position<2, float> & aSource,
+                         const math::Position<2, float> & aTarget,
+                         std::vector<math::Position<2, float>> & aPath)
+{
+    aPath.clear();
+    if (aSource.equalsWithinTolerance(aTarget, gCellSize / 2))
+    {
+        return true;
+    }
+
+    std::optional<std::size_t> sourceIndex = getNodeIndex(aLevel, aSource);
+    if (!sourceIndex)
+    {
+        return false;
+    }
+
+    const std::vector<component::PathfindNode> & nodes = aLevel.mNodes;
+    if (mStamps.size() != nodes.size() || ++mStamp == 0)
+    {
+        mCosts.resize(nodes.size());
+        mPrevious.resize(nodes.size());
+        mStamps.assign(nodes.size(), 0);
+        mStamp = 1;
+    }
+    mOpened.clear();
+
+    // The search starts from the agent position, which is not a node:
+    // seed its tile and the tile neighbours with their distance to the agent.
+    // If the agent is perfectly on its tile, it must not path to it
+    // otherwise it would be stuck.
+    const std::size_t startIndex = *sourceIndex;
+    const float startCost = (nodes[startIndex].mPos - aSource).getNorm();
+    if (startCost != 0.f && nodes[startIndex].mPathable)
+    {
+        open(aLevel, startIndex, gNoPrevious, startCost, aTarget);
+    }
+    for (math::Vec<2, int> offset : gDirections)
+    {
+        std::optional<std::size_t> neighbour =
+            getNeighbourIndex(aLevel, startIndex, offset);
+        if (neighbour && nodes[*neighbour].mPathable)
+        {
+            open(aLevel, *neighbour, gNoPrevious,
+                 (nodes[*neighbour].mPos - aSource).getNorm(), aTarget);
+        }
+    }
+
+    while (!mOpened.empty())
+    {
+        std::pop_heap(mOpened.begin(), mOpened.end(), &OpenNode::GreaterReducedCost);
+        const OpenNode current = mOpened.back();
+        mOpened.pop_back();
+
+        // Outdated entry, the node was reopened with a lower cost since.
+        if (current.mCost > mCosts[current.mIndex])
+        {
+            continue;
+        }
+
+        if (nodes[current.mIndex].mPos.equalsWithinTolerance(aTarget, gCellSize / 2))
+        {
+            for (std::size_t index = current.mIndex; index != gNoPrevious; index = mPrevious[index])
+            {
+                aPath.push_back(nodes[index].mPos);
+            }
+            std::reverse(aPath.begin(), aPath.end());
+            return true;
+        }
+
+        for (math::Vec<2, int> offset : gDirections)
+        {
+            std::optional<std::size_t> neighbour =
+                getNeighbourIndex(aLevel, current.mIndex, offset);
+            if (neighbour && nodes[*neighbour].mPathable)
+            {
+                open(aLevel, *neighbour, current.mIndex,
+                     current.mCost + (nodes[*neighbour].mPos - nodes[current.mIndex].mPos).getNorm(),
+                     aTarget);
+            }
+        }
+    }
+
+    return false;
+}
+
 Pathfinding::Pathfinding(GameContext & aGameContext) :
     mGameContext{&aGameContext}, mPathfinder{mGameContext->mWorld}
 {}
 
 void Pathfinding::update(component::Level & aLevelData)
 {
-    TIME_RECURRING_CLASSFUNC(Main);
-
-    ent::Phase pathfinding;
     const std::vector<component::Tile> & tiles = aLevelData.mTiles;
-    const std::vector<component::PathfindNode> & nodes = aLevelData.mNodes;
-    int stride = aLevelData.mSize.height();
+    const std::size_t stride = aLevelData.mSize.width();
 
-    mPathfinder.each([stride, &tiles, &pathfinding, &nodes](
+    mPathfinder.each([this, stride, &tiles, &aLevelData](
                          component::PathToOnGrid & aPathfinder,
                          const component::Geometry & aGeo) {
         EntHandle target = aPathfinder.mEntityTarget;
         assert(target.isValid()
                && "Trying to pathfind to an obsolete handle");
-        assert(target.get(pathfinding)->has<component::Geometry>()
+        assert(target.get()->has<component::Geometry>()
                && "Trying to pathfind to an entity with no geometry");
         const Pos2 & targetPos = getLevelPosition(
-            target.get(pathfinding)->get<component::Geometry>().mPosition.xy());
-
+            target.get()->get<component::Geometry>().mPosition.xy());
+        const std::size_t targetIndex =
+            (std::size_t) targetPos.x() + (std::size_t) targetPos.y() * stride;
 
-
-        if (tiles.at((size_t) targetPos.x() + (size_t) targetPos.y() * stride)
-                .mType
-            == component::TileType::Void)
+        if (tiles.at(targetIndex).mType == component::TileType::Void)
         {
             SELOG(info)("Pathfinding to a entity not on a Path");
             // TODO: (franz) handle the case where the target is not
@@ -57,28 +317,13 @@ void Pathfinding::update(component::Level & aLevelData)
             return;
         }
 
-        // We need a copy of nodes to make the calculation in place
-        // so nodes is captured by value
-        std::vector<component::PathfindNode> localNodes = nodes;
-        // We need to create the startNode locally because it can be pointed to
-        // by the resulting pathfind node and would be unstacked if it's created inside
-        // pathfind
-        component::PathfindNode startNode = createStartPathfindNode(aGeo.mPosition.xy(), targetPos, stride);
-        component::PathfindNode closestNode = pathfind(startNode, targetPos,  localNodes, stride);
-
-        // There is two possible states
-        // 1. The target and pathfinder are perfectly on the same tile -> there
-        //    is only one node in the path
-        // 2. All other case -> there is at least two node in the path and we
-        //    want the second node in the path to be the target
-        while (closestNode.mPrev != nullptr
-               && closestNode.mPrev->mPrev != nullptr)
+        // All the pathfinders chasing the same target share its distance field.
+        if (std::optional<Pos2> nextStep = mDistanceFields.getNextStep(
+                aLevelData, aGeo.mPosition.xy(), targetIndex))
         {
-            closestNode = *closestNode.mPrev;
+            aPathfinder.mCurrentTarget = *nextStep;
+            aPathfinder.mTargetFound = true;
         }
-
-        aPathfinder.mCurrentTarget = closestNode.mPos;
-        aPathfinder.mTargetFound = true;
     });
 }
 
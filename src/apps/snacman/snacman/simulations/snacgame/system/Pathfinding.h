@@ -8,7 +8,11 @@
 #include <entity/Entity.h>
 #include <entity/Query.h>
 #include <limits>
-#include <queue>
+#include <optional>
+#include <vector>
+
+#include <cstddef>
+#include <cstdint>
 
 namespace ad {
 namespace snacgame {
@@ -20,136 +24,110 @@ struct Level;
 }
 namespace system {
 
-class Pathfinding
+/// @brief Breadth first distance maps toward target nodes, shared by all the agents pathing to the same node.
+///
+/// All the agents chasing a given target read the same distance map, so the cost of a search is paid once per
+/// target instead of once per agent and per tick. Maps are computed lazily, the least recently used one
+/// is evicted when the capacity is reached. All maps are invalidated when the level navigation generation changes.
+///
+/// @note Steps between nodes have a uniform cost (the grid is 4-connected), so the BFS distances
+/// are the exact shortest path lengths in nodes.
+class DistanceFieldCache
 {
 public:
-    Pathfinding(GameContext & aGameContext);
-
-    void update(component::Level & aLevelData);
+    /// @brief The position an agent at `aSource` should move toward, in order to follow a shortest path
+    /// to the node at `aTargetIndex`.
+    ///
+    /// If the agent is already on the target tile, its own position is returned.
+    /// @return An empty optional if the target cannot be reached from `aSource`.
+    std::optional<math::Position<2, float>> getNextStep(const component::Level & aLevel,
+                                                        const math::Position<2, float> & aSource,
+                                                        std::size_t aTargetIndex);
 
 private:
-    GameContext * mGameContext;
-    ent::Query<component::PathToOnGrid,
-               component::Geometry>
-        mPathfinder;
-};
+    static constexpr int gUnreachable = std::numeric_limits<int>::max();
+    static constexpr std::size_t gCapacity = 8;
 
-inline component::PathfindNode createStartPathfindNode(const math::Position<2, float> & aSource,
-         const math::Position<2, float> & aTarget,
-         size_t stride
-)
-{
-    math::Position<2, float> startPos = getLevelPosition(aSource);
-    component::PathfindNode start{
-        .mReducedCost = manhattan(aSource, aTarget),
-        .mCost = 0,
-        .mIndex = (size_t) startPos.x() + (size_t) startPos.y() * stride,
-        .mPos = aSource,
-        .mOpened = true,
+    struct DistanceField
+    {
+        std::size_t mTargetIndex;
+        std::uint64_t mLastUse;
+        std::vector<int> mDistances;
     };
 
-    return start;
-}
+    const std::vector<int> & getDistances(const component::Level & aLevel, std::size_t aTargetIndex);
+    void computeDistances(const component::Level & aLevel,
+                          std::size_t aTargetIndex,
+                          std::vector<int> & aDistances);
+
+    std::vector<DistanceField> mFields;
+    int mNavigationGeneration = -1;
+    std::uint64_t mUseCounter = 0;
+    // Scratch storage, the BFS does not allocate once capacity is reached.
+    std::vector<std::size_t> mQueue;
+};
 
-inline component::PathfindNode
-pathfind(component::PathfindNode & aStartNode,
-         const math::Position<2, float> & aTarget,
-         std::vector<component::PathfindNode> & aNodes,
-         size_t stride)
+/// @brief A* on the level nodes, reusing its buffers between searches.
+///
+/// Costs are invalidated by bumping a stamp instead of clearing the buffers, so a search only touches
+/// the nodes it actually visits, and does not copy the level nodes.
+class GridAStar
 {
-    // Comparator is basically greater on the reduced cost
-    // this make the priority queue store the lowest cost
-    // node at the top
-    constexpr auto comparator = [](component::PathfindNode * aLhs,
-                                   component::PathfindNode * aRhs) {
-        return aLhs->mReducedCost > aRhs->mReducedCost;
-    };
+public:
+    /// @brief Find a path from `aSource` to the node reached at `aTarget` (within half a cell).
+    ///
+    /// @param aPath Receives the positions of the nodes along the path, from the first step to the
+    /// reached node. It is empty if `aSource` is already at `aTarget`.
+    /// @return `false` if `aTarget` cannot be reached.
+    bool findPath(const component::Level & aLevel,
+                  const math::Position<2, float> & aSource,
+                  const math::Position<2, float> & aTarget,
+                  std::vector<math::Position<2, float>> & aPath);
+
+private:
+    static constexpr std::size_t gNoPrevious = std::numeric_limits<std::size_t>::max();
 
-    using PathfindingQueue =
-        std::priority_queue<component::PathfindNode *,
-                            std::vector<component::PathfindNode *>,
-                            decltype(comparator)>;
-
-    constexpr auto visitNode =
-        [](component::PathfindNode & node, component::PathfindNode * current,
-           float newCost, const math::Position<2, float> & targetPos,
-           PathfindingQueue & queue) {
-            node.mCost = newCost;
-            node.mReducedCost = newCost + manhattan(node.mPos, targetPos);
-            node.mPrev = current;
-
-            if (!node.mOpened)
-            {
-                queue.push(&node);
-                node.mOpened = true;
-            }
-        };
-
-    // setup opened node with the start position and the node
-    // where the pathfinder is residing so that when we try to path
-    // so that the residing node is a possible destination
-
-    // Since priority do not have a clear() method we need to reinstantiate
-    // a priority queue for all pathfinder
-    PathfindingQueue openedNode(comparator);
-    openedNode.push(&aStartNode);
-
-    component::PathfindNode & startTile = aNodes.at(aStartNode.mIndex);
-    startTile.mCost = (aStartNode.mPos - startTile.mPos).getNorm();
-    startTile.mPrev = &aStartNode;
-    startTile.mReducedCost =
-        startTile.mCost + manhattan(startTile.mPos, aTarget);
-
-    // If the start tile as the cost of zero it means
-    // that the pathfinder is perfectly on the tile we must not
-    // path to the tile otherwise we will be stuck
-    if (startTile.mCost != 0.f)
+    struct OpenNode
     {
-        openedNode.push(&startTile);
-        startTile.mOpened = true;
-    }
+        float mReducedCost;
+        float mCost;
+        std::size_t mIndex;
 
-    component::PathfindNode * closestNode = nullptr;
+        /// @brief Heap comparator, so the heap top is the lowest reduced cost.
+        static bool GreaterReducedCost(const OpenNode & aLhs, const OpenNode & aRhs)
+        { return aLhs.mReducedCost > aRhs.mReducedCost; }
+    };
 
-    while (openedNode.size() > 0)
-    {
-        // When we want to find a new node to explore we want to
-        // find the node with the lowest reduced cost
-        // (distance from start + heuristic)
-        // However when we think about revisiting a node
-        // we want to allow revisit if the new cost (distance from start) is
-        // lower than the previous visit
-        component::PathfindNode * current = openedNode.top();
-        openedNode.pop();
-        current->mOpened = false;
-
-        if (current->mPos.equalsWithinTolerance(aTarget, gCellSize / 2))
-        {
-            closestNode = current;
-            break;
-        }
-
-        for (math::Vec<2, int> offset : gDirections)
-        {
-            component::PathfindNode & visitedNode =
-                aNodes.at(static_cast<size_t>((int) current->mIndex + offset.x()
-                                              + offset.y() * (int) stride));
-            float distance = (visitedNode.mPos - current->mPos).getNorm();
-            float newCost = current->mCost + distance;
-
-            // the distance <= 1.f guarantees that the pathfinder
-            // cannot cut corners because the next node in it's path cannot
-            // be more than 1 cell away
-            if (visitedNode.mPathable && newCost < visitedNode.mCost
-                /*&& distance <= 1.f*/)
-            {
-                visitNode(visitedNode, current, newCost, aTarget, openedNode);
-            }
-        }
-    }
-
-    return *closestNode;
-}
+    /// @brief Record `aCost` for the node if it improves on this search best known cost.
+    void open(const component::Level & aLevel,
+              std::size_t aIndex,
+              std::size_t aPrevious,
+              float aCost,
+              const math::Position<2, float> & aTarget);
+
+    std::vector<float> mCosts;
+    std::vector<std::size_t> mPrevious;
+    std::vector<std::uint32_t> mStamps;
+    std::uint32_t mStamp = 0;
+    std::vector<OpenNode> mOpened;
+};
+
+class Pathfinding
+{
+public:
+    Pathfinding(GameContext & aGameContext);
+
+    /// @brief Reads the targets' Geometry via phase-less handle access,
+    /// the distance fields cache is owned by this system instance.
+    void update(component::Level & aLevelData);
+
+private:
+    GameContext * mGameContext;
+    ent::Query<component::PathToOnGrid,
+               component::Geometry>
+        mPathfinder;
+    DistanceFieldCache mDistanceFields;
+};
 
 } // namespace system
 } // namespace snacgame
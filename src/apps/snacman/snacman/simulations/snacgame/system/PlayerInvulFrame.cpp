@@ -9,8 +9,7 @@
 #include "../ModelInfos.h" // For models variables
 #include "../typedef.h"
 #include "../GameContext.h"
-
-#include <snacman/Profiling.h>
+#include "../SystemScheduler.h"
 
 #include <snac-renderer-V1/Mesh.h>
 
@@ -28,14 +27,11 @@ PlayerInvulFrame::PlayerInvulFrame(GameContext & aGameContext) :
     mGameContext{&aGameContext}, mPlayer{mGameContext->mWorld}
 {}
 
-void PlayerInvulFrame::update(float aDelta)
+void PlayerInvulFrame::update(float aDelta, DeferredChanges & aChanges)
 {
-    TIME_RECURRING_CLASSFUNC(Main);
-
     // TODO: (franz) this is needed because we can't set the model 
     // of the player to a null model because of the animation component
-    ent::Phase hitStunAndInvul;
-    mPlayer.each([aDelta, this, &hitStunAndInvul](
+    mPlayer.each([aDelta, this, &aChanges](
                      component::PlayerRoundData & aRoundData) {
         // TODO: (franz): this should be better
         if (aRoundData.mInvulFrameCounter > 0.f)
@@ -47,20 +43,25 @@ void PlayerInvulFrame::update(float aDelta)
             // we remove the model from the player model
             // but we also need to remove the animation from the player model
             // entity since there is no animation on the null model
-            Entity model = *aRoundData.mModel.get(hitStunAndInvul);
+            EntHandle model = aRoundData.mModel;
 
             if (static_cast<int>(aRoundData.mInvulFrameCounter * 10.f) % 4 == 0
-                && !model.has<component::VisualModel>())
+                && !model.get()->has<component::VisualModel>())
             {
-                model.add(component::VisualModel{
-                    .mModel = mGameContext->mResources.getModel(
-                        gDonutModel,
-                        gMeshGenericEffect)});
+                // The resources are not thread safe, the model is fetched when the change is applied.
+                aChanges.record([this, model](Phase & aPhase) mutable {
+                    model.get(aPhase)->add(component::VisualModel{
+                        .mModel = mGameContext->mResources.getModel(
+                            gDonutModel,
+                            gMeshGenericEffect)});
+                });
             }
             if (static_cast<int>(aRoundData.mInvulFrameCounter * 10.f) % 4 == 2
-                && model.has<component::VisualModel>())
+                && model.get()->has<component::VisualModel>())
             {
-                model.remove<component::VisualModel>();
+                aChanges.record([model](Phase & aPhase) mutable {
+                    model.get(aPhase)->remove<component::VisualModel>();
+                });
             }
         }
     });
@@ -4,6 +4,7 @@
 
 namespace ad {
 namespace snacgame {
+class DeferredChanges;
 struct GameContext;
 namespace component {
 struct PlayerRoundData;
@@ -15,7 +16,8 @@ class PlayerInvulFrame
 public:
     PlayerInvulFrame(GameContext & aGameContext);
 
-    void update(float aDelta);
+    /// @param aChanges Records the visual model toggling, so this can run concurrently (see SystemScheduler).
+    void update(float aDelta, DeferredChanges & aChanges);
 
 private:
     GameContext * mGameContext;
@@ -13,7 +13,9 @@
 #include "../component/PlayerSlot.h"
 #include "../component/PlayerGameData.h"
 
+#include "../CollisionGrid.h"
 #include "../GameContext.h"
+#include "../SystemScheduler.h"
 #include "../Entities.h"
 #include "../SceneGraph.h"
 #include "../LevelHelper.h"
@@ -53,12 +55,33 @@ void PortalManagement::preGraphUpdate()
     });
 }
 
-void PortalManagement::postGraphUpdate(component::Level & aLevelData)
+void PortalManagement::postGraphUpdate(component::Level & aLevelData,
+                                       CollisionGrid & aCollisionGrid,
+                                       DeferredChanges & aChanges)
 {
-    TIME_RECURRING_CLASSFUNC(Main);
-    ent::Phase portalPhase;
 
-    mPlayer.each([&aLevelData, &portalPhase, this](
+    mPortals.each([](const component::Portal & aPortal,
+                     const component::GlobalPose & aPortalPose) {
+        DBGDRAW(snac::gPortalDrawer, snac::DebugDrawer::Level::debug)
+            .addBox(
+                snac::DebugDrawer::Entry{
+                    .mPosition = {0.f, 0.f, 0.f},
+                    .mColor = math::hdr::gGreen<float>,
+                },
+                component::transformHitbox(aPortalPose.mPosition,
+                                           aPortal.mEnterHitbox));
+
+        DBGDRAW(snac::gPortalDrawer, snac::DebugDrawer::Level::debug)
+            .addBox(
+                snac::DebugDrawer::Entry{
+                    .mPosition = {0.f, 0.f, 0.f},
+                    .mColor = math::hdr::gRed<float>,
+                },
+                component::transformHitbox(aPortalPose.mPosition,
+                                           aPortal.mExitHitbox));
+    });
+
+    mPlayer.each([&aLevelData, &aCollisionGrid, &aChanges](
                      EntHandle aPlayerHandle,
                      component::GlobalPose & aPlayerPose,
                      const component::Collision & aPlayerCol,
@@ -71,32 +94,33 @@ void PortalManagement::postGraphUpdate(component::Level & aLevelData)
         Box_f playerHitbox = component::transformHitbox(
             aPlayerPose.mPosition, aPlayerCol.mHitbox);
 
-        mPortals.each([&playerHitbox, &aLevelData, &aPlayerGeo,
-                       &aRoundData, &aPlayerNode, &portalPhase](
-                          const component::Portal & aPortal,
-                          const component::Geometry & aPortalGeo,
-                          const component::GlobalPose & aPortalPose) {
-            Box_f portalHitbox = component::transformHitbox(
-                aPortalPose.mPosition, aPortal.mEnterHitbox);
-
-            DBGDRAW(snac::gPortalDrawer, snac::DebugDrawer::Level::debug)
-                .addBox(
-                    snac::DebugDrawer::Entry{
-                        .mPosition = {0.f, 0.f, 0.f},
-                        .mColor = math::hdr::gGreen<float>,
-                    },
-                    portalHitbox);
+        // Only the portals overlapping the player, or its portal image, can collide.
+        Box_f queryBox = playerHitbox;
+        if (aRoundData.mPortalImage.isValid())
+        {
+            Box_f playerPortalImageHitbox = component::transformHitbox(
+                snac::getComponent<component::GlobalPose>(aRoundData.mPortalImage).mPosition,
+                snac::getComponent<component::Collision>(aRoundData.mPortalImage).mHitbox);
+            queryBox = component::uniteHitboxes(queryBox, playerPortalImageHitbox);
+        }
+
+        aCollisionGrid.forEachCollision(
+            CollisionLayer::Portal, queryBox,
+            [&playerHitbox, &aLevelData, &aPlayerGeo, &aPlayerPose,
+             &aPlayerHandle, &aCollisionGrid, &aPlayerCol,
+             &aRoundData, &aPlayerNode, &aChanges](
+                const CollisionGrid::Entry & aPortalEntry) {
+            const component::Portal & portal =
+                snac::getComponent<component::Portal>(aPortalEntry.mHandle);
+            const component::Geometry & portalGeo =
+                snac::getComponent<component::Geometry>(aPortalEntry.mHandle);
+            const component::GlobalPose & portalPose =
+                snac::getComponent<component::GlobalPose>(aPortalEntry.mHandle);
 
+            Box_f portalHitbox = component::transformHitbox(
+                portalPose.mPosition, portal.mEnterHitbox);
             Box_f portalExitHitbox = component::transformHitbox(
-                aPortalPose.mPosition, aPortal.mExitHitbox);
-
-            DBGDRAW(snac::gPortalDrawer, snac::DebugDrawer::Level::debug)
-                .addBox(
-                    snac::DebugDrawer::Entry{
-                        .mPosition = {0.f, 0.f, 0.f},
-                        .mColor = math::hdr::gRed<float>,
-                    },
-                    portalExitHitbox);
+                portalPose.mPosition, portal.mExitHitbox);
 
             // If player collides with the portal hitbox we set up
             // the player portal teleportation
@@ -105,25 +129,25 @@ void PortalManagement::postGraphUpdate(component::Level & aLevelData)
                 int destinationPortalIndex = -1;
                 for (int portalIndex : aLevelData.mPortalIndex)
                 {
-                    if (portalIndex != aPortal.portalIndex)
+                    if (portalIndex != portal.portalIndex)
                     {
                         destinationPortalIndex = portalIndex;
                         break;
                     }
                 }
 
-                aRoundData.mCurrentPortal = aPortal.portalIndex;
-                aRoundData.mCurrentPortalPos = aPortalGeo.mPosition.xy();
+                aRoundData.mCurrentPortal = portal.portalIndex;
+                aRoundData.mCurrentPortalPos = portalGeo.mPosition.xy();
                 aRoundData.mDestinationPortal = destinationPortalIndex;
             }
 
             if (aRoundData.mPortalImage.isValid())
             {
-                ent::Entity portalEnt = *aRoundData.mPortalImage.get(portalPhase);
-                component::GlobalPose imagePose =
-                    portalEnt.get<component::GlobalPose>();
-                component::Collision imageCollision =
-                    portalEnt.get<component::Collision>();
+                EntHandle portalImage = aRoundData.mPortalImage;
+                const component::GlobalPose & imagePose =
+                    snac::getComponent<component::GlobalPose>(portalImage);
+                const component::Collision & imageCollision =
+                    snac::getComponent<component::Collision>(portalImage);
                 Box_f playerPortalImageHitbox = component::transformHitbox(
                     imagePose.mPosition, imageCollision.mHitbox);
 
@@ -137,8 +161,12 @@ void PortalManagement::postGraphUpdate(component::Level & aLevelData)
                 if (component::collideWithSat(portalExitHitbox,
                                               playerPortalImageHitbox))
                 {
-                    aPlayerGeo.mPosition = aPortalGeo.mPosition;
+                    aPlayerGeo.mPosition = portalGeo.mPosition;
                     updateGlobalPosition(aPlayerNode);
+                    aCollisionGrid.move(
+                        CollisionLayer::Player, aPlayerHandle,
+                        component::transformHitbox(aPlayerPose.mPosition,
+                                                   aPlayerCol.mHitbox));
                     // TODO: (franz) this can be removed once the models can be made transparent
                     if (aRoundData.mModel.get()->has<component::VisualModel>())
                     {
@@ -149,7 +177,7 @@ void PortalManagement::postGraphUpdate(component::Level & aLevelData)
                     aRoundData.mCurrentPortal = -1;
                     aRoundData.mDestinationPortal = -1;
 
-                    portalEnt.erase();
+                    aChanges.erase(portalImage);
                 }
 
                 if (component::collideWithSat(portalExitHitbox,
@@ -158,7 +186,7 @@ void PortalManagement::postGraphUpdate(component::Level & aLevelData)
                     aRoundData.mCurrentPortal = -1;
                     aRoundData.mDestinationPortal = -1;
 
-                    portalEnt.erase();
+                    aChanges.erase(portalImage);
                 }
             }
         });
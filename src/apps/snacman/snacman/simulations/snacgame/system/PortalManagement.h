@@ -4,6 +4,8 @@
 
 namespace ad {
 namespace snacgame {
+class CollisionGrid;
+class DeferredChanges;
 struct GameContext;
 namespace component {
 struct GlobalPose;
@@ -22,7 +24,11 @@ public:
     PortalManagement(GameContext & aGameContext);
 
     void preGraphUpdate();
-    void postGraphUpdate(component::Level & aLevelData);
+    /// @param aCollisionGrid Players teleported by the portals are moved in the grid.
+    /// @param aChanges Records the removal of the portal images that were used.
+    void postGraphUpdate(component::Level & aLevelData,
+                         CollisionGrid & aCollisionGrid,
+                         DeferredChanges & aChanges);
 
 private:
     GameContext * mGameContext;
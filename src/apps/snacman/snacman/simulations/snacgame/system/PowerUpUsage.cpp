@@ -19,6 +19,7 @@
 #include "../component/Tags.h"
 #include "../component/Text.h"
 #include "../component/VisualModel.h"
+#include "../CollisionGrid.h"
 #include "../Entities.h"
 #include "../GameContext.h"
 #include "../GameParameters.h"
@@ -28,6 +29,7 @@
 #include "../system/Pathfinding.h"
 #include "../typedef.h"
 
+#include <algorithm>
 #include <limits>
 #include <math/Box.h>
 #include <math/Transformations.h>
@@ -58,7 +60,9 @@ PowerUpUsage::PowerUpUsage(GameContext & aGameContext) :
     }}
 {}
 
-void PowerUpUsage::update(const snac::Time & aTime, EntHandle aLevel)
+void PowerUpUsage::update(const snac::Time & aTime,
+                          EntHandle aLevel,
+                          CollisionGrid & aCollisionGrid)
 {
     TIME_RECURRING_CLASSFUNC(Main);
     const float delta = (float) aTime.mDeltaSeconds;
@@ -93,11 +97,26 @@ void PowerUpUsage::update(const snac::Time & aTime, EntHandle aLevel)
     });
 
     {
+        mPowerups.each(
+            [](const component::GlobalPose & aPowerupPose,
+               const component::Collision & aPowerupCol)
+            {
+                DBGDRAW(snac::gHitboxDrawer, snac::DebugDrawer::Level::debug)
+                    .addBox(
+                        snac::DebugDrawer::Entry{
+                            .mPosition = {0.f, 0.f, 0.f},
+                            .mColor = math::hdr::gBlue<float>,
+                        },
+                        component::transformHitbox(aPowerupPose.mPosition,
+                                                   aPowerupCol.mHitbox));
+            });
+
         // Powerup pickup phase
         mPlayers.each(
-            [this](EntHandle aPlayer, const component::GlobalPose & aPlayerPose,
-                   component::Collision aPlayerCol,
-                   component::PlayerRoundData & aRoundData)
+            [this, &aCollisionGrid](EntHandle aPlayer,
+                                    const component::GlobalPose & aPlayerPose,
+                                    component::Collision aPlayerCol,
+                                    component::PlayerRoundData & aRoundData)
             {
             const Box_f playerHitbox = component::transformHitbox(
                 aPlayerPose.mPosition, aPlayerCol.mHitbox);
@@ -105,70 +124,55 @@ void PowerUpUsage::update(const snac::Time & aTime, EntHandle aLevel)
                 && aRoundData.mInvulFrameCounter <= 0)
             {
                 Phase powerupDestroyOnPickup;
-                mPowerups.each(
-                    [&playerHitbox, this, &aPlayer,
-                     &powerupDestroyOnPickup,
-                     &aRoundData](ent::Handle<ent::Entity> aPowerupHandle,
-                                  component::PowerUp & aPowerup,
-                                  const component::GlobalPose & aPowerupGeo,
-                                  const component::Collision & aPowerupCol)
+                aCollisionGrid.forEachCollision(
+                    CollisionLayer::PowerUp, playerHitbox,
+                    [this, &aPlayer, &powerupDestroyOnPickup, &aRoundData](
+                        const CollisionGrid::Entry & aPowerupEntry)
                     {
-                        const Box_f powerupHitbox = component::transformHitbox(
-                            aPowerupGeo.mPosition, aPowerupCol.mHitbox);
-
-                        DBGDRAW(snac::gHitboxDrawer,
-                                snac::DebugDrawer::Level::debug)
-                            .addBox(
-                                snac::DebugDrawer::Entry{
-                                    .mPosition = {0.f, 0.f, 0.f},
-                                    .mColor = math::hdr::gBlue<float>,
-                                },
-                                powerupHitbox);
-
-                        if (component::collideWithSat(powerupHitbox, playerHitbox))
+                        EntHandle aPowerupHandle = aPowerupEntry.mHandle;
+                        const component::PowerUp & aPowerup =
+                            snac::getComponent<component::PowerUp>(aPowerupHandle);
+                        EntHandle hud =
+                            snac::getComponent<component::PlayerGameData>(aRoundData.mSlot)
+                                .mHud;
+                        auto & playerHud = snac::getComponent<component::PlayerHud>(hud);
+                        EntHandle playerPowerup =
+                            createPlayerPowerUp(*mGameContext, aPowerup.mType);
+                        aRoundData.mType = aPowerup.mType;
+                        aRoundData.mPowerUp = playerPowerup;
+
+                        insertEntityInScene(
+                            playerPowerup,
+                            aRoundData.mModel);
+                        updateGlobalPosition(
+                            snac::getComponent<component::SceneNode>(
+                                playerPowerup));
+                        aPowerupHandle.get(powerupDestroyOnPickup)->erase();
+
+                        switch (aRoundData.mType)
                         {
-                            EntHandle hud =
-                                snac::getComponent<component::PlayerGameData>(aRoundData.mSlot)
-                                    .mHud;
-                            auto & playerHud = snac::getComponent<component::PlayerHud>(hud);
-                            EntHandle playerPowerup =
-                                createPlayerPowerUp(*mGameContext, aPowerup.mType);
-                            aRoundData.mType = aPowerup.mType;
-                            aRoundData.mPowerUp = playerPowerup;
-
-                            insertEntityInScene(
-                                playerPowerup,
-                                aRoundData.mModel);
-                            updateGlobalPosition(
-                                snac::getComponent<component::SceneNode>(
-                                    playerPowerup));
-                            aPowerupHandle.get(powerupDestroyOnPickup)->erase();
-
-                            switch (aRoundData.mType)
-                            {
-                            case component::PowerUpType::Dog:
-                            {
-                                break;
-                            }
-                            case component::PowerUpType::Teleport:
-                            {
-                                aRoundData.mInfo = component::TeleportPowerUpInfo{};
-                                break;
-                            }
-                            case component::PowerUpType::Missile:
-                            {
-                                aRoundData.mInfo = component::MissilePowerUpInfo{};
-                                break;
-                            }
-                            default:
-                                break;
-                            }
-
-                            // Update power-up name in HUD
-                            changeString(snac::getComponent<component::Text>(playerHud.mPowerupText),
-                                         component::getPowerUpName(aPlayer),
-                                         getBillpadFont(*mGameContext)->mFont);
+                        case component::PowerUpType::Dog:
+                        {
+                            break;
+                        }
+                        case component::PowerUpType::Teleport:
+                        {
+                            aRoundData.mInfo = component::TeleportPowerUpInfo{};
+                            break;
+                        }
+                        case component::PowerUpType::Missile:
+                        {
+                            aRoundData.mInfo = component::MissilePowerUpInfo{};
+                            break;
                         }
+                        default:
+                            break;
+                        }
+
+                        // Update power-up name in HUD
+                        changeString(snac::getComponent<component::Text>(playerHud.mPowerupText),
+                                     component::getPowerUpName(aPlayer),
+                                     getBillpadFont(*mGameContext)->mFont);
                     });
             }
         });
@@ -177,7 +181,7 @@ void PowerUpUsage::update(const snac::Time & aTime, EntHandle aLevel)
     Phase usage;
     // Power up usage phase
     mPlayers.each(
-        [this, &usage, &delta, aLevel](
+        [this, &usage, &delta, aLevel, &aCollisionGrid](
             EntHandle aHandle, const component::Geometry & aPlayerGeo,
             component::PlayerRoundData & aRoundData,
             component::GlobalPose & aPlayerPose,
@@ -253,6 +257,18 @@ void PowerUpUsage::update(const snac::Time & aTime, EntHandle aLevel)
                 && info.mCurrentTarget.isValid())
             {
                 swapPlayerPosition(usage, aHandle, info.mCurrentTarget);
+                // The grid was populated with the positions before the swap,
+                // later queries on the player layer (e.g. in-game dogs) must see the swapped players.
+                for (EntHandle swapped : {aHandle, info.mCurrentTarget})
+                {
+                    updateGlobalPosition(
+                        snac::getComponent<component::SceneNode>(swapped));
+                    aCollisionGrid.move(
+                        CollisionLayer::Player, swapped,
+                        component::transformHitbox(
+                            snac::getComponent<component::GlobalPose>(swapped).mPosition,
+                            snac::getComponent<component::Collision>(swapped).mHitbox));
+                }
                 info.mTargetArrow.get(usage)->erase();
                 aRoundData.mPowerUp.get(usage)->erase();
                 aHandle.get(usage)->remove<component::PlayerPowerUp>();
@@ -482,7 +498,7 @@ void PowerUpUsage::update(const snac::Time & aTime, EntHandle aLevel)
     {
         Phase inGameDog;
         mInGameDogPowerups.each(
-            [this, &inGameDog, &aTime, aLevel](
+            [this, &inGameDog, &aTime, aLevel, &aCollisionGrid](
                 EntHandle aPowerupHandle,
                 const component::GlobalPose & aPowerupPose,
                 const component::Geometry & aGeo,
@@ -491,37 +507,33 @@ void PowerUpUsage::update(const snac::Time & aTime, EntHandle aLevel)
             {
             const Box_f powerupHitbox = component::transformHitbox(
                 aPowerupPose.mPosition, aPowerupCol.mHitbox);
-            mPlayers.each(
-                [&aPowerup, powerupHitbox, &aPowerupHandle, &inGameDog,
+            aCollisionGrid.forEachCollision(
+                CollisionLayer::Player, powerupHitbox,
+                [&aPowerup, &aPowerupHandle, &inGameDog,
                  this, &aTime,
-                 aLevel](EntHandle aPlayerHandle,
-                         const component::GlobalPose & aPlayerPose,
-                         const component::Geometry & aPlayerGeo,
-                         const component::Collision & aPlayerCol,
-                         component::PlayerRoundData & aPlayerRoundData)
+                 aLevel](const CollisionGrid::Entry & aPlayerEntry)
                 {
-                if (aPlayerHandle != aPowerup.mOwner)
+                if (aPlayerEntry.mHandle != aPowerup.mOwner)
                 {
-                    const Box_f playerHitbox = component::transformHitbox(
-                        aPlayerPose.mPosition, aPlayerCol.mHitbox);
-
-                    if (component::collideWithSat(powerupHitbox, playerHitbox))
-                    {
-                        ExplodedPlayerList list;
-                        list.playerCount = 1;
-                        list.mPlayers.at(0) = ExplodedPlayer{aPlayerGeo.mPosition, &aPlayerRoundData};
-                        explodePlayer(*mGameContext,
-                                      inGameDog,
-                                      aLevel,
-                                      aTime,
-                                      aPowerupHandle,
-                                      aPlayerGeo.mPosition,
-                                      list);
-
-                        mExplosionSound.play();
-                        mHurtIdx = (mHurtIdx + 1) % mHurtPlayerSound.size();
-                        mHurtPlayerSound[mHurtIdx].play();
-                    }
+                    const component::Geometry & playerGeo =
+                        snac::getComponent<component::Geometry>(aPlayerEntry.mHandle);
+                    component::PlayerRoundData & playerRoundData =
+                        snac::getComponent<component::PlayerRoundData>(aPlayerEntry.mHandle);
+
+                    ExplodedPlayerList list;
+                    list.playerCount = 1;
+                    list.mPlayers.at(0) = ExplodedPlayer{playerGeo.mPosition, &playerRoundData};
+                    explodePlayer(*mGameContext,
+                                  inGameDog,
+                                  aLevel,
+                                  aTime,
+                                  aPowerupHandle,
+                                  playerGeo.mPosition,
+                                  list);
+
+                    mExplosionSound.play();
+                    mHurtIdx = (mHurtIdx + 1) % mHurtPlayerSound.size();
+                    mHurtPlayerSound[mHurtIdx].play();
                 }
             });
         });
@@ -635,45 +647,29 @@ std::pair<Pos2, EntHandle> PowerUpUsage::getDogPlacementTile(
     EntHandle aHandle, const component::Geometry & aGeo, EntHandle aLevel)
 {
     const component::Level & lvlData = aLevel.get()->get<component::Level>();
-    const std::vector<component::PathfindNode> & nodes = lvlData.mNodes;
-    const size_t stride = lvlData.mSize.width();
 
     unsigned int currentDepth = std::numeric_limits<unsigned int>::max();
     Pos2 targetPos;
     EntHandle targetHandle = aHandle;
 
     mPlayers.each(
-        [&stride, &aGeo, aHandle, &currentDepth, &targetPos, &targetHandle,
-         &nodes](EntHandle aOther, const component::Geometry & aOtherGeo)
+        [this, &lvlData, &aGeo, aHandle, &currentDepth, &targetPos, &targetHandle](
+            EntHandle aOther, const component::Geometry & aOtherGeo)
         {
-        if (aHandle != aOther)
+        if (aHandle != aOther
+            && mDogPathfinder.findPath(lvlData, aGeo.mPosition.xy(),
+                                       aOtherGeo.mPosition.xy(), mDogPath))
         {
-            // We need a copy of nodes to make the calculation in place
-            // so nodes is captured by value
-            std::vector<component::PathfindNode> localNodes = nodes;
-
-            // We need to create the startNode locally because it can be pointed
-            // to by the resulting pathfind node and would be unstacked if it's
-            // created inside pathfind
-            component::PathfindNode startNode = createStartPathfindNode(
-                aGeo.mPosition.xy(), aOtherGeo.mPosition.xy(), stride);
-            component::PathfindNode targetNode = pathfind(
-                startNode, aOtherGeo.mPosition.xy(), localNodes, stride);
-
-            unsigned int newDepth = 0;
-
-            while (targetNode.mPrev != nullptr
-                   && targetNode.mPrev->mPrev != nullptr
-                   && targetNode.mPrev->mPrev->mPrev != nullptr)
-            {
-                newDepth++;
-                targetNode = *targetNode.mPrev;
-            }
+            // The dog is placed two nodes along the path (or at the end of a shorter path),
+            // the depth is the number of nodes remaining after it.
+            const std::size_t length = mDogPath.size();
+            unsigned int newDepth = (unsigned int) (length > 2 ? length - 2 : 0);
 
             if (newDepth < currentDepth)
             {
                 currentDepth = newDepth;
-                targetPos = targetNode.mPos;
+                targetPos = length == 0 ? aGeo.mPosition.xy()
+                                        : mDogPath[std::min<std::size_t>(length, 2) - 1];
                 targetHandle = aOther;
             }
         }
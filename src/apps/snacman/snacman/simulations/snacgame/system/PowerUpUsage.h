@@ -2,14 +2,18 @@
 
 #include "../Sound.h"
 
+#include "Pathfinding.h"
+
 #include <snacman/Timing.h>
 
 #include <entity/Query.h>
 #include <math/Vector.h>
 #include <utility>
+#include <vector>
 
 namespace ad {
 namespace snacgame {
+class CollisionGrid;
 struct GameContext;
 namespace component {
 struct GlobalPose;
@@ -31,7 +35,9 @@ class PowerUpUsage
 public:
     PowerUpUsage(GameContext & aGameContext);
 
-    void update(const snac::Time & aTime, ent::Handle<ent::Entity> aLevel);
+    void update(const snac::Time & aTime,
+                ent::Handle<ent::Entity> aLevel,
+                CollisionGrid & aCollisionGrid);
 
     std::pair<math::Position<2, float>, ent::Handle<ent::Entity>>
     getDogPlacementTile(ent::Handle<ent::Entity> aHandle,
@@ -70,6 +76,10 @@ private:
     Sfx mHomingLaunchSound;
     std::array<Sfx, 2> mHurtPlayerSound;
     std::size_t mHurtIdx = 0;
+
+    // Reused between the dog placement searches.
+    GridAStar mDogPathfinder;
+    std::vector<math::Position<2, float>> mDogPath;
 };
 
 } // namespace system
@@ -11,7 +11,6 @@
 #include "../component/PlayerSlot.h"
 #include "../component/PlayerGameData.h"
 
-#include <snacman/Profiling.h>
 #include <snacman/EntityUtilities.h>
 
 #include <entity/EntityManager.h>
@@ -118,7 +117,6 @@ SceneGraphResolver::SceneGraphResolver(GameContext & aGameContext,
 
 void SceneGraphResolver::update()
 {
-    TIME_RECURRING_CLASSFUNC(Main);
     component::SceneNode & rootNode =
         mSceneRoot.get()->get<component::SceneNode>();
     depthFirstResolve(rootNode, gWorldCoordTo3dCoord);
@@ -1,3 +1,5 @@
+#pragma once
+
 #include <entity/Entity.h>
 #include <math/Angle.h>
 #include <math/Box.h>
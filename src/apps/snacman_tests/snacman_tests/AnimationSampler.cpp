@@ -0,0 +1,238 @@
+#include "catch.hpp"
+
+#include "Benchmark.h"
+#include "RigFixture.h"
+
+#include <snac-renderer-V2/Rigging.h>
+
+#include <math/Interpolation/QuaternionInterpolation.h>
+
+#include <algorithm>
+#include <iterator>
+
+#include <cmath>
+
+
+using namespace ad;
+using namespace ad::renderer;
+using namespace ad::snac::fixture;
+namespace bench = ad::snac::bench;
+
+
+namespace {
+
+
+    /// @brief The allocating animate() replaced by AnimationSampler, kept as the reference implementation.
+    Rig::FuturePose_type animateReference(const RigAnimation & aAnimation,
+                                          float aTimepoint,
+                                          const NodeTree<Rig::Pose> & aAnimatedTree)
+    {
+        using Node = NodeTree<Rig::Pose>::Node;
+
+        NodeTree<Rig::Pose> posedNodes;
+        posedNodes.mGlobalPose.reserve(aAnimatedTree.size());
+
+        auto localPoses = aAnimatedTree.mLocalPose;
+
+        const auto & timepoints = aAnimation.mTimepoints;
+        auto timepointAfter =
+            std::find_if(timepoints.begin(), timepoints.end(),
+                         [aTimepoint](float aTime){return aTime > aTimepoint;});
+
+        std::size_t previousIdx, nextIdx;
+        float interpolant = 0.f;
+        if (timepointAfter == timepoints.begin())
+        {
+            previousIdx = nextIdx = 0;
+        }
+        else if(timepointAfter == timepoints.end())
+        {
+            previousIdx = nextIdx = timepoints.size() - 1;
+        }
+        else
+        {
+            nextIdx = timepointAfter - timepoints.begin();
+            previousIdx = nextIdx - 1;
+            interpolant = (aTimepoint - timepoints[previousIdx])
+                           / (*timepointAfter - timepoints[previousIdx]);
+        }
+
+        const auto & nodes = aAnimation.mNodes;
+        for(std::size_t jointIdx = 0; jointIdx != nodes.size(); ++jointIdx)
+        {
+            const RigAnimation::NodeKeyframes & keyframes = aAnimation.mKeyframes[jointIdx];
+            localPoses[nodes[jointIdx]] =
+                math::trans3d::scale(
+                    math::lerp(keyframes.mScales[previousIdx].as<math::Size>(),
+                               keyframes.mScales[nextIdx].as<math::Size>(),
+                               interpolant))
+                * math::slerp(keyframes.mRotations[previousIdx],
+                              keyframes.mRotations[nextIdx],
+                              interpolant).toRotationMatrix()
+                * math::trans3d::translate(
+                    math::lerp(keyframes.mTranslations[previousIdx],
+                               keyframes.mTranslations[nextIdx],
+                               interpolant));
+        }
+
+        for(Node::Index hierarchyIdx = 0; hierarchyIdx != aAnimatedTree.mHierarchy.size(); ++hierarchyIdx)
+        {
+            if(Node::Index parentIdx = aAnimatedTree.mHierarchy[hierarchyIdx].mParent;
+               parentIdx != Node::gInvalidIndex)
+            {
+                posedNodes.mGlobalPose.push_back(
+                    localPoses[hierarchyIdx] * posedNodes.mGlobalPose[parentIdx]);
+            }
+            else
+            {
+                posedNodes.mGlobalPose.push_back(localPoses[hierarchyIdx]);
+            }
+        }
+
+        return posedNodes;
+    }
+
+
+    constexpr float gTolerance = 1e-4f;
+
+
+    /// @brief Largest difference between the global poses sampled by the reference and by `aSampler`.
+    float sampleDifference(const AnimatedRig & aRig,
+                           float aTimepoint,
+                           AnimationSampler & aSampler,
+                           Rig::FuturePose_type & aPosedNodes)
+    {
+        const RigAnimation & animation = aRig.mNameToAnimation.at("anim");
+        const NodeTree<Rig::Pose> & tree = aRig.mRig.mJointTree;
+
+        animate(animation, aTimepoint, tree, aSampler, aPosedNodes);
+        const Rig::FuturePose_type expected = animateReference(animation, aTimepoint, tree);
+
+        REQUIRE(aPosedNodes.mGlobalPose.size() == expected.mGlobalPose.size());
+        float result = 0.f;
+        for(std::size_t nodeIdx = 0; nodeIdx != expected.mGlobalPose.size(); ++nodeIdx)
+        {
+            result = std::max(result, maxDifference(aPosedNodes.mGlobalPose[nodeIdx], expected.mGlobalPose[nodeIdx]));
+        }
+        return result;
+    }
+
+
+} // unnamed namespace
+
+
+SCENARIO("AnimationSampler poses match the former animate().")
+{
+    GIVEN("An animated rig, and a sampler.")
+    {
+        const AnimatedRig rig = makeAnimatedRig(24, 9, 3);
+        AnimationSampler sampler;
+        Rig::FuturePose_type posed;
+
+        THEN("Sampling with time advancing monotonically gives the reference poses.")
+        {
+            // Before the first keyframe, in between and exactly on keyframes, and after the last keyframe.
+            for(float timepoint = -0.1f; timepoint < 1.2f; timepoint += 1.f / 64.f)
+            {
+                CHECK(sampleDifference(rig, timepoint, sampler, posed) <= gTolerance);
+            }
+            for(float timepoint : rig.mNameToAnimation.at("anim").mTimepoints)
+            {
+                CHECK(sampleDifference(rig, timepoint, sampler, posed) <= gTolerance);
+            }
+        }
+
+        THEN("Sampling with time jumping (e.g. looping) gives the reference poses.")
+        {
+            for(float timepoint : {0.9f, 0.1f, 0.95f, 0.5f, 0.f, 1.f, 0.33f, 0.32f, 0.31f})
+            {
+                CHECK(sampleDifference(rig, timepoint, sampler, posed) <= gTolerance);
+            }
+        }
+
+        WHEN("The sampler was used with another animation.")
+        {
+            const AnimatedRig other = makeAnimatedRig(40, 30, 4);
+            sampleDifference(other, 0.9f, sampler, posed);
+
+            THEN("It is reused without corruption.")
+            {
+                CHECK(sampleDifference(rig, 0.2f, sampler, posed) <= gTolerance);
+                CHECK(sampleDifference(rig, 0.25f, sampler, posed) <= gTolerance);
+            }
+        }
+
+        WHEN("The sampler is warmed up.")
+        {
+            const RigAnimation & animation = rig.mNameToAnimation.at("anim");
+            animate(animation, 0.f, rig.mRig.mJointTree, sampler, posed);
+            const auto * localPoses = sampler.mLocalPoses.data();
+            const auto * rotations = sampler.mRotations.data();
+            const auto * globalPoses = posed.mGlobalPose.data();
+
+            THEN("Sampling the same animation does not reallocate.")
+            {
+                for(float timepoint = 0.f; timepoint < 1.f; timepoint += 1.f / 16.f)
+                {
+                    animate(animation, timepoint, rig.mRig.mJointTree, sampler, posed);
+                }
+                CHECK(sampler.mLocalPoses.data() == localPoses);
+                CHECK(sampler.mRotations.data() == rotations);
+                CHECK(posed.mGlobalPose.data() == globalPoses);
+            }
+        }
+    }
+}
+
+
+TEST_CASE("AnimationSampler and former animate() frame duration.", "[.benchmark]")
+{
+    // Animated characters, each at its own animation time, as in a frame of the game renderer.
+    constexpr std::size_t frames = 600;
+    constexpr std::size_t instanceCount = 100;
+    constexpr float frameDuration = 1.f / 60.f;
+
+    const AnimatedRig rig = makeAnimatedRig(60, 30, 5);
+    const RigAnimation & animation = rig.mNameToAnimation.at("anim");
+    const NodeTree<Rig::Pose> & tree = rig.mRig.mJointTree;
+
+    auto instanceTime = [&](std::size_t aFrame, std::size_t aInstance)
+    {
+        return std::fmod(aFrame * frameDuration + aInstance * 0.037f, animation.mDuration);
+    };
+
+    std::vector<Rig::Pose> palettes;
+    palettes.reserve(instanceCount * rig.mRig.countJoints());
+
+    {
+        std::size_t frame = 0;
+        std::vector<bench::Clock::duration> durations = bench::sample(frames, [&]()
+        {
+            palettes.clear();
+            for(std::size_t instance = 0; instance != instanceCount; ++instance)
+            {
+                Rig::FuturePose_type posed = animateReference(animation, instanceTime(frame, instance), tree);
+                rig.mRig.computeJointMatrices(std::back_inserter(palettes), posed);
+            }
+            ++frame;
+        });
+        bench::report("Former animate(), 100 instances", durations);
+    }
+
+    {
+        std::vector<AnimationSampler> samplers(instanceCount);
+        Rig::FuturePose_type posed;
+        std::size_t frame = 0;
+        std::vector<bench::Clock::duration> durations = bench::sample(frames, [&]()
+        {
+            palettes.clear();
+            for(std::size_t instance = 0; instance != instanceCount; ++instance)
+            {
+                animate(animation, instanceTime(frame, instance), tree, samplers[instance], posed);
+                rig.mRig.computeJointMatrices(std::back_inserter(palettes), posed);
+            }
+            ++frame;
+        });
+        bench::report("AnimationSampler, 100 instances", durations);
+    }
+}
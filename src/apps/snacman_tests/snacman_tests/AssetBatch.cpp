@@ -0,0 +1,381 @@
+#include "catch.hpp"
+
+#include "Benchmark.h"
+
+#include <file-processor/Batch.h>
+#include <file-processor/BatchCache.h>
+
+#include <chrono>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include <cstdint>
+
+
+using namespace ad;
+using namespace ad::renderer;
+namespace bench = ad::snac::bench;
+
+
+namespace {
+
+
+    /// @brief A fresh directory under the temporary directory, removed with its content on destruction.
+    struct TemporaryDirectory
+    {
+        explicit TemporaryDirectory(const std::string & aName) :
+            mPath{std::filesystem::temp_directory_path() / aName}
+        {
+            std::filesystem::remove_all(mPath);
+            std::filesystem::create_directories(mPath);
+        }
+
+        ~TemporaryDirectory()
+        {
+            std::error_code ec;
+            std::filesystem::remove_all(mPath, ec);
+        }
+
+        /// @brief Write `aContent` to the file at `aRelative`, creating its parent directories.
+        std::filesystem::path write(const std::filesystem::path & aRelative, const std::string & aContent) const
+        {
+            std::filesystem::path file = mPath / aRelative;
+            std::filesystem::create_directories(file.parent_path());
+            std::ofstream{file, std::ios::binary} << aContent;
+            return file;
+        }
+
+        std::filesystem::path mPath;
+    };
+
+
+    /// @brief Move the write time of `aFile`, as a touch would, without changing its content.
+    void shiftWriteTime(const std::filesystem::path & aFile, std::chrono::seconds aShift)
+    {
+        std::filesystem::last_write_time(aFile, std::filesystem::last_write_time(aFile) + aShift);
+    }
+
+
+    std::int64_t writeTicks(const std::filesystem::path & aFile)
+    {
+        return (std::int64_t)std::filesystem::last_write_time(aFile).time_since_epoch().count();
+    }
+
+
+} // unnamed namespace
+
+
+SCENARIO("The batch cache is saved, then loaded back.")
+{
+    TemporaryDirectory directory{"snacman_tests_batch_cache"};
+    const std::filesystem::path cacheFile = directory.mPath / "cache.txt";
+
+    GIVEN("A cache with several models, one of them in a path containing spaces.")
+    {
+        BatchCache cache{
+            {directory.mPath / "a.gltf", CacheEntry{
+                .mSettings = 0x0123456789abcdef,
+                .mFiles = {
+                    {directory.mPath / "a.gltf", 0xfedcba9876543210, 1024, 1'700'000'000'000'000'000},
+                    {directory.mPath / "a.bin", 0x1, 0, -12},
+                },
+            }},
+            {directory.mPath / "with spaces" / "b c.fbx", CacheEntry{
+                .mSettings = 0,
+                .mFiles = {
+                    {directory.mPath / "with spaces" / "b c.fbx", ~ContentHash{0}, 7, 3},
+                },
+            }},
+        };
+
+        WHEN("It is saved.")
+        {
+            saveCache(cache, cacheFile);
+
+            THEN("Loading it gives back the same cache, and no temporary file is left.")
+            {
+                CHECK(loadCache(cacheFile) == cache);
+                CHECK_FALSE(std::filesystem::exists(directory.mPath / "cache.txt.tmp"));
+            }
+
+            THEN("Saving it again overwrites the previous file.")
+            {
+                cache.erase(cache.begin());
+                saveCache(cache, cacheFile);
+                CHECK(loadCache(cacheFile) == cache);
+            }
+        }
+    }
+
+    GIVEN("Files which are not valid caches.")
+    {
+        const std::string header = "asset_processor cache 1\n";
+        const std::string model = "model 1f /models/a.gltf\n";
+
+        THEN("A missing file loads as an empty cache.")
+        {
+            CHECK(loadCache(directory.mPath / "missing.txt").empty());
+        }
+
+        THEN("A file with an unknown header loads as an empty cache.")
+        {
+            CHECK(loadCache(directory.write("v0.txt", "asset_processor cache 0\n" + model)).empty());
+            CHECK(loadCache(directory.write("empty.txt", "")).empty());
+        }
+
+        THEN("A corrupted file loads as an empty cache, even if it starts with valid entries.")
+        {
+            CHECK(loadCache(directory.write("valid.txt", header + model)).size() == 1);
+
+            // File record before any model.
+            CHECK(loadCache(directory.write("orphan.txt", header + "file 1 2 3 /models/a.gltf\n")).empty());
+            // Truncated file record.
+            CHECK(loadCache(directory.write("truncated.txt", header + model + "file 1 2\n")).empty());
+            // Invalid settings hash.
+            CHECK(loadCache(directory.write("hash.txt", header + "model zz /models/a.gltf\n")).empty());
+            // Unknown record kind.
+            CHECK(loadCache(directory.write("kind.txt", header + model + "texture 1 /models/a.png\n")).empty());
+        }
+    }
+}
+
+
+SCENARIO("A cached model is up to date while its files, the settings and its output did not change.")
+{
+    TemporaryDirectory directory{"snacman_tests_batch_up_to_date"};
+    const std::filesystem::path model = directory.write("model.obj", "v 0 0 0\n");
+    const std::filesystem::path texture = directory.write("texture.png", "texels");
+    const std::filesystem::path output = directory.write(getOutputPath(model).filename(), "seum");
+
+    const ProcessorOptions options;
+    const ContentHash settings = hashSettings(options);
+
+    GIVEN("The entry recorded for the model and its texture.")
+    {
+        CacheEntry entry{.mSettings = settings, .mFiles = {*recordFile(model), *recordFile(texture)}};
+
+        THEN("It is up to date.")
+        {
+            CHECK(isUpToDate(entry, settings, output));
+        }
+
+        WHEN("Only the write time of the model changes.")
+        {
+            shiftWriteTime(model, std::chrono::seconds{10});
+
+            THEN("It is still up to date, and the recorded write time is refreshed.")
+            {
+                CHECK(isUpToDate(entry, settings, output));
+                CHECK(entry.mFiles[0].mWriteTime == writeTicks(model));
+            }
+        }
+
+        WHEN("The content of the model changes, keeping its size.")
+        {
+            directory.write("model.obj", "v 1 1 1\n");
+            shiftWriteTime(model, std::chrono::seconds{10});
+
+            THEN("It is not up to date.")
+            {
+                CHECK_FALSE(isUpToDate(entry, settings, output));
+            }
+        }
+
+        WHEN("The size of the texture changes.")
+        {
+            directory.write("texture.png", "more texels");
+
+            THEN("It is not up to date.")
+            {
+                CHECK_FALSE(isUpToDate(entry, settings, output));
+            }
+        }
+
+        WHEN("The texture is removed.")
+        {
+            std::filesystem::remove(texture);
+
+            THEN("It is not up to date.")
+            {
+                CHECK_FALSE(isUpToDate(entry, settings, output));
+            }
+        }
+
+        WHEN("The output is removed.")
+        {
+            std::filesystem::remove(output);
+
+            THEN("It is not up to date.")
+            {
+                CHECK_FALSE(isUpToDate(entry, settings, output));
+            }
+        }
+
+        WHEN("An option affecting the output changes.")
+        {
+            ProcessorOptions compact = options;
+            compact.mCompactVertices = !options.mCompactVertices;
+            ProcessorOptions moreLods = options;
+            moreLods.mLodCount = options.mLodCount + 1;
+            ProcessorOptions coarser = options;
+            coarser.mLodMaxError = options.mLodMaxError * 2;
+
+            THEN("It is not up to date.")
+            {
+                CHECK_FALSE(isUpToDate(entry, hashSettings(compact), output));
+                CHECK_FALSE(isUpToDate(entry, hashSettings(moreLods), output));
+                CHECK_FALSE(isUpToDate(entry, hashSettings(coarser), output));
+            }
+        }
+
+        WHEN("Only options not affecting the output change.")
+        {
+            ProcessorOptions quiet = options;
+            quiet.mImporterLog = !options.mImporterLog;
+
+            THEN("It is still up to date.")
+            {
+                CHECK(isUpToDate(entry, hashSettings(quiet), output));
+            }
+        }
+    }
+}
+
+
+SCENARIO("Models are collected from files, directories and manifests.")
+{
+    TemporaryDirectory directory{"snacman_tests_batch_inputs"};
+    const std::filesystem::path a = directory.write("a.obj", "v 0 0 0\n");
+    const std::filesystem::path b = directory.write("sub/b.obj", "v 0 0 0\n");
+    directory.write("sub/notes.not_a_model", "notes");
+
+    GIVEN("A manifest with comments, empty lines, CRLF line endings and paths relative to its directory.")
+    {
+        const std::filesystem::path manifest = directory.write(
+            "list/models.txt",
+            "# Models of the level\r\n"
+            "\r\n"
+            "../a.obj\r\n"
+            "../sub/b.obj\r\n"
+            "# ../missing.obj\r\n"
+            "../a.obj");
+
+        THEN("The listed models are collected, as absolute paths without duplicates.")
+        {
+            const std::vector<std::filesystem::path> inputs{"@" + manifest.string()};
+            CHECK(collectModels(inputs) == std::vector<std::filesystem::path>{
+                std::filesystem::absolute(a).lexically_normal(),
+                std::filesystem::absolute(b).lexically_normal(),
+            });
+        }
+    }
+
+    GIVEN("A directory and a file inside it.")
+    {
+        const std::vector<std::filesystem::path> inputs{directory.mPath / "sub", b};
+
+        THEN("Only the files with a supported extension are collected, once.")
+        {
+            CHECK(collectModels(inputs) == std::vector<std::filesystem::path>{
+                std::filesystem::absolute(b).lexically_normal(),
+            });
+        }
+    }
+
+    GIVEN("Missing inputs.")
+    {
+        THEN("Collecting throws.")
+        {
+            const std::vector<std::filesystem::path> missingFile{directory.mPath / "missing.obj"};
+            CHECK_THROWS_AS(collectModels(missingFile), std::runtime_error);
+
+            const std::vector<std::filesystem::path> missingManifest{"@" + (directory.mPath / "missing.txt").string()};
+            CHECK_THROWS_AS(collectModels(missingManifest), std::runtime_error);
+
+            const std::filesystem::path manifest = directory.write("broken.txt", "missing.obj\n");
+            const std::vector<std::filesystem::path> brokenManifest{"@" + manifest.string()};
+            CHECK_THROWS_AS(collectModels(brokenManifest), std::runtime_error);
+        }
+    }
+}
+
+
+SCENARIO("Models that would write the same output are rejected.")
+{
+    TemporaryDirectory directory{"snacman_tests_batch_conflict"};
+
+    GIVEN("Two models sharing a directory and a stem.")
+    {
+        const std::vector<std::filesystem::path> models{
+            directory.write("foo.obj", "v 0 0 0\n"),
+            directory.write("foo.ply", "ply\n"),
+        };
+
+        WHEN("They are processed in a batch.")
+        {
+            BatchOptions options;
+            options.mJobs = 2;
+            options.mCacheFile = directory.mPath / "cache.txt";
+            const BatchResult result = processBatch(models, options);
+
+            THEN("Both fail without being processed, and none is recorded in the cache.")
+            {
+                CHECK(result.mFailed == 2);
+                CHECK(result.mProcessed == 0);
+                CHECK(result.mUpToDate == 0);
+                CHECK_FALSE(std::filesystem::exists(getOutputPath(models[0])));
+                CHECK(loadCache(options.mCacheFile).empty());
+            }
+        }
+    }
+}
+
+
+// The models are taken from the SNACMAN_TESTS_MODELS environment variable: a model, a directory,
+// or a manifest prefixed with '@' (e.g. the models directory of snac-assets).
+// The outputs are written next to the models, as asset_processor does.
+TEST_CASE("Batch cold and warm rebuild durations.", "[.benchmark]")
+{
+    const char * modelsVariable = std::getenv("SNACMAN_TESTS_MODELS");
+    if(modelsVariable == nullptr)
+    {
+        WARN("SNACMAN_TESTS_MODELS is not set, skipping the batch benchmark.");
+        return;
+    }
+    const std::vector<std::filesystem::path> inputs{modelsVariable};
+    const std::vector<std::filesystem::path> models = collectModels(inputs);
+    REQUIRE_FALSE(models.empty());
+
+    TemporaryDirectory directory{"snacman_tests_batch_benchmark"};
+
+    auto timeBatch = [&](std::string_view aLabel, unsigned int aJobs, bool aForce)
+    {
+        BatchOptions options;
+        options.mProcessor.mImporterLog = false;
+        options.mJobs = aJobs;
+        options.mCacheFile = directory.mPath / "cache.txt";
+        options.mForce = aForce;
+
+        const bench::Clock::time_point begin = bench::Clock::now();
+        const BatchResult result = processBatch(models, options);
+        const double seconds = std::chrono::duration<double>{bench::Clock::now() - begin}.count();
+
+        std::cout << aLabel << ": " << seconds << " s, "
+                  << result.mProcessed << " processed, " << result.mUpToDate << " up to date, "
+                  << result.mFailed << " failed\n";
+        return result;
+    };
+
+    // Cold: all the models are processed, first sequentially, then on all the hardware threads.
+    timeBatch("Cold batch, 1 job", 1, true);
+    const BatchResult cold = timeBatch("Cold batch, default jobs", 0, true);
+    // Warm: nothing changed since the cold batch, every processed model is up to date.
+    const BatchResult warm = timeBatch("Warm batch, default jobs", 0, false);
+
+    CHECK(warm.mUpToDate == cold.mProcessed);
+}
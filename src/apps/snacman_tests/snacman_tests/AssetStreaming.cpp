@@ -0,0 +1,176 @@
+#include "catch.hpp"
+
+#include <snacman/IoWorkers.h>
+#include <snacman/UploadQueue.h>
+
+#include <algorithm>
+#include <future>
+#include <memory>
+#include <thread>
+#include <vector>
+
+
+using namespace ad;
+using namespace ad::snac;
+
+
+SCENARIO("IoWorkers execute the tasks pushed to them.")
+{
+    GIVEN("A single I/O worker.")
+    {
+        IoWorkers workers{1};
+
+        WHEN("Several tasks are pushed.")
+        {
+            std::vector<int> executed;
+            std::promise<void> last;
+            std::future<void> lastDone = last.get_future();
+            for(int taskIdx = 0; taskIdx != 8; ++taskIdx)
+            {
+                workers.push([&executed, taskIdx]() { executed.push_back(taskIdx); });
+            }
+            workers.push([&last]() { last.set_value(); });
+            lastDone.wait();
+
+            THEN("They are executed in submission order.")
+            {
+                CHECK(executed == std::vector<int>{0, 1, 2, 3, 4, 5, 6, 7});
+            }
+        }
+    }
+
+    GIVEN("Several I/O workers.")
+    {
+        IoWorkers workers{3};
+
+        WHEN("Tasks fulfilling promises are pushed.")
+        {
+            std::vector<std::future<std::thread::id>> futures;
+            for(int taskIdx = 0; taskIdx != 16; ++taskIdx)
+            {
+                auto promise = std::make_shared<std::promise<std::thread::id>>();
+                futures.push_back(promise->get_future());
+                workers.push([promise]() { promise->set_value(std::this_thread::get_id()); });
+            }
+
+            THEN("They all complete, away from the pushing thread.")
+            {
+                for(std::future<std::thread::id> & future : futures)
+                {
+                    CHECK(future.get() != std::this_thread::get_id());
+                }
+            }
+        }
+    }
+
+    GIVEN("Tasks still queued when the workers are destroyed.")
+    {
+        std::future<int> future;
+        {
+            // Without threads, the tasks stay queued until destruction.
+            IoWorkers workers{0};
+            auto promise = std::make_shared<std::promise<int>>();
+            future = promise->get_future();
+            workers.push([promise]() { promise->set_value(1); });
+        }
+
+        THEN("They are discarded, breaking their promises.")
+        {
+            REQUIRE(future.wait_for(std::chrono::seconds{0}) == std::future_status::ready);
+            try
+            {
+                future.get();
+                FAIL("The discarded task was executed.");
+            }
+            catch(std::future_error & aError)
+            {
+                CHECK(aError.code() == std::future_errc::broken_promise);
+            }
+        }
+    }
+}
+
+
+SCENARIO("UploadQueue services the uploads within a budget.")
+{
+    UploadQueue<std::vector<int>> queue;
+    std::vector<int> target;
+
+    GIVEN("An empty queue.")
+    {
+        THEN("Servicing executes nothing, whatever the budget.")
+        {
+            CHECK(queue.service(target, Clock::duration::max()) == 0);
+            CHECK(queue.service(target, Clock::duration::zero()) == 0);
+        }
+    }
+
+    GIVEN("Several queued uploads.")
+    {
+        for(int uploadIdx = 0; uploadIdx != 4; ++uploadIdx)
+        {
+            queue.push([uploadIdx](std::vector<int> & aTarget) { aTarget.push_back(uploadIdx); });
+        }
+
+        WHEN("The queue is serviced with an exhausted budget.")
+        {
+            const std::size_t serviced = queue.service(target, Clock::duration::zero());
+
+            THEN("Exactly one upload is executed, so the uploads always progress.")
+            {
+                CHECK(serviced == 1);
+                CHECK(target == std::vector<int>{0});
+            }
+
+            THEN("The following services continue in submission order.")
+            {
+                CHECK(queue.service(target, Clock::duration::zero()) == 1);
+                CHECK(queue.service(target, Clock::duration::max()) == 2);
+                CHECK(target == std::vector<int>{0, 1, 2, 3});
+            }
+        }
+
+        WHEN("The queue is serviced with an unlimited budget.")
+        {
+            const std::size_t serviced = queue.service(target, Clock::duration::max());
+
+            THEN("All the uploads are executed, in submission order.")
+            {
+                CHECK(serviced == 4);
+                CHECK(target == std::vector<int>{0, 1, 2, 3});
+                CHECK(queue.service(target, Clock::duration::max()) == 0);
+            }
+        }
+    }
+
+    GIVEN("Uploads pushed from I/O workers.")
+    {
+        {
+            IoWorkers workers{2};
+            std::vector<std::future<void>> pushed;
+            for(int uploadIdx = 0; uploadIdx != 32; ++uploadIdx)
+            {
+                auto promise = std::make_shared<std::promise<void>>();
+                pushed.push_back(promise->get_future());
+                workers.push([&queue, promise, uploadIdx]()
+                {
+                    queue.push([uploadIdx](std::vector<int> & aTarget) { aTarget.push_back(uploadIdx); });
+                    promise->set_value();
+                });
+            }
+            for(std::future<void> & future : pushed)
+            {
+                future.wait();
+            }
+        }
+
+        THEN("They are all serviced on this thread.")
+        {
+            CHECK(queue.service(target, Clock::duration::max()) == 32);
+            std::sort(target.begin(), target.end());
+            CHECK(target.front() == 0);
+            CHECK(target.back() == 31);
+            CHECK(std::adjacent_find(target.begin(), target.end()) == target.end());
+        }
+    }
+}
@@ -0,0 +1,129 @@
+#pragma once
+
+
+#include <algorithm>
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <string_view>
+#include <vector>
+
+#include <cassert>
+#include <cstddef>
+
+#if defined(_WIN32)
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#include <psapi.h>
+#else
+#include <sys/resource.h>
+#endif
+
+
+// Helpers for the benchmarks, which are Catch test cases tagged [.benchmark]:
+// hidden from the default run, they are executed with `snacman_tests [benchmark]`.
+namespace ad::snac::bench {
+
+
+using Clock = std::chrono::steady_clock;
+
+
+/// @brief Latency distribution of a repeated operation.
+struct Percentiles
+{
+    Clock::duration mP50;
+    Clock::duration mP90;
+    Clock::duration mP99;
+    Clock::duration mP999;
+    Clock::duration mMax;
+};
+
+
+/// @brief Compute the percentiles of `aSamples`, which is sorted in the process.
+inline Percentiles computePercentiles(std::vector<Clock::duration> & aSamples)
+{
+    assert(!aSamples.empty());
+    std::sort(aSamples.begin(), aSamples.end());
+    auto at = [&aSamples](double aRank)
+    {
+        return aSamples[std::min(aSamples.size() - 1, (std::size_t)(aRank * aSamples.size()))];
+    };
+    return Percentiles{
+        .mP50 = at(0.5),
+        .mP90 = at(0.9),
+        .mP99 = at(0.99),
+        .mP999 = at(0.999),
+        .mMax = aSamples.back(),
+    };
+}
+
+
+inline double asMicroseconds(Clock::duration aDuration)
+{
+    return std::chrono::duration<double, std::micro>{aDuration}.count();
+}
+
+
+/// @brief Print a line of percentiles (in microseconds) to the standard output.
+inline void report(std::string_view aLabel, std::vector<Clock::duration> & aSamples)
+{
+    const Percentiles p = computePercentiles(aSamples);
+    std::cout << std::left << std::setw(40) << aLabel << std::right << std::fixed << std::setprecision(3)
+              << " p50 " << std::setw(10) << asMicroseconds(p.mP50)
+              << " p90 " << std::setw(10) << asMicroseconds(p.mP90)
+              << " p99 " << std::setw(10) << asMicroseconds(p.mP99)
+              << " p99.9 " << std::setw(10) << asMicroseconds(p.mP999)
+              << " max " << std::setw(10) << asMicroseconds(p.mMax)
+              << " (us, " << aSamples.size() << " samples)\n";
+}
+
+
+/// @brief Run `aOperation` `aRepetitions` times, returning the duration of each run.
+template <class F_operation>
+std::vector<Clock::duration> sample(std::size_t aRepetitions, F_operation && aOperation)
+{
+    std::vector<Clock::duration> samples;
+    samples.reserve(aRepetitions);
+    for(std::size_t repetition = 0; repetition != aRepetitions; ++repetition)
+    {
+        const Clock::time_point begin = Clock::now();
+        aOperation();
+        samples.push_back(Clock::now() - begin);
+    }
+    return samples;
+}
+
+
+/// @brief The peak resident set size of the process since it started, in bytes.
+/// @note It never decreases: measure the operations by increasing expected peak, or in distinct runs.
+inline std::size_t getPeakResidentBytes()
+{
+#if defined(_WIN32)
+    PROCESS_MEMORY_COUNTERS counters{};
+    GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters));
+    return counters.PeakWorkingSetSize;
+#else
+    rusage usage{};
+    getrusage(RUSAGE_SELF, &usage);
+    // Kilobytes on Linux, but bytes on macOS.
+#if defined(__APPLE__)
+    return (std::size_t)usage.ru_maxrss;
+#else
+    return (std::size_t)usage.ru_maxrss * 1024;
+#endif
+#endif
+}
+
+
+/// @brief Print a line with a peak resident set size growth, in MiB.
+inline void reportPeakGrowth(std::string_view aLabel, std::size_t aPeakBefore, std::size_t aPeakAfter)
+{
+    std::cout << std::left << std::setw(40) << aLabel << std::right << std::fixed << std::setprecision(3)
+              << " peak RSS " << std::setw(10) << aPeakAfter / (1024. * 1024.)
+              << " growth " << std::setw(10) << (aPeakAfter - aPeakBefore) / (1024. * 1024.)
+              << " (MiB)\n";
+}
+
+
+} // namespace ad::snac::bench
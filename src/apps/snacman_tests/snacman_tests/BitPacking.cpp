@@ -0,0 +1,74 @@
+#include "catch.hpp"
+
+#include <snac-renderer-V2/utilities/BitPacking.h>
+
+#include <cstdint>
+
+
+using namespace ad;
+using namespace ad::renderer;
+
+
+SCENARIO("Unsigned fields are packed in a 32-bit word.")
+{
+    using Pack = BitPack<20, 12>;
+
+    GIVEN("The layout of a pack.")
+    {
+        THEN("The fields are laid out from the least significant bits.")
+        {
+            CHECK(Pack::gOffsets[0] == 0);
+            CHECK(Pack::gOffsets[1] == 20);
+            CHECK(Pack::max<0>() == (1u << 20) - 1);
+            CHECK(Pack::max<1>() == (1u << 12) - 1);
+        }
+    }
+
+    GIVEN("A pack of maximal values.")
+    {
+        Pack pack{Pack::max<0>(), Pack::max<1>()};
+
+        THEN("Each field returns its value, and the word is full.")
+        {
+            CHECK(pack.get<0>() == Pack::max<0>());
+            CHECK(pack.get<1>() == Pack::max<1>());
+            CHECK(pack.word() == 0xFFFFFFFF);
+        }
+
+        WHEN("A field is set.")
+        {
+            pack.set<0>(12345);
+
+            THEN("Only this field changes.")
+            {
+                CHECK(pack.get<0>() == 12345);
+                CHECK(pack.get<1>() == Pack::max<1>());
+            }
+        }
+    }
+
+    GIVEN("A pack whose fields span the whole word.")
+    {
+        using Full = BitPack<32>;
+        const Full pack{0xDEADBEEFu};
+
+        THEN("The single field is the word.")
+        {
+            CHECK(Full::max<0>() == 0xFFFFFFFF);
+            CHECK(pack.get<0>() == 0xDEADBEEF);
+            CHECK(pack.word() == 0xDEADBEEF);
+        }
+    }
+
+    GIVEN("The GLSL unpacking macros of a pack.")
+    {
+        const auto defines = Pack::makeGlslUnpackDefines({"UNPACK_A", "UNPACK_B"});
+
+        THEN("They shift and mask each field.")
+        {
+            REQUIRE(defines.size() == 2);
+            CHECK(defines[0] == "UNPACK_A(packed) (((packed) >> 0u) & 1048575u)");
+            CHECK(defines[1] == "UNPACK_B(packed) (((packed) >> 20u) & 4095u)");
+        }
+    }
+}
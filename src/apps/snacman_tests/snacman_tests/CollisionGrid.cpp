@@ -0,0 +1,266 @@
+#include "catch.hpp"
+
+#include <snacman/simulations/snacgame/CollisionGrid.h>
+
+#include <snacman/simulations/snacgame/component/Collision.h>
+#include <snacman/simulations/snacgame/component/LevelData.h>
+
+#include <entity/EntityManager.h>
+
+#include <vector>
+
+
+using namespace ad;
+using namespace ad::snacgame;
+
+
+namespace {
+
+
+    component::Level makeLevel(int aWidth, int aHeight)
+    {
+        component::Level level;
+        level.mSize = math::Size<3, int>{aWidth, aHeight, 1};
+        level.mCellSize = 1.f;
+        return level;
+    }
+
+
+    /// @brief Square hitbox centered on (aX, -aZ), i.e. on the tile (aX, aZ) for integral coordinates.
+    Box_f makeHitbox(float aX, float aZ, float aHalfSize = 0.35f)
+    {
+        return Box_f{
+            {aX - aHalfSize, 0.f, -aZ - aHalfSize},
+            {2 * aHalfSize, 0.7f, 2 * aHalfSize},
+        };
+    }
+
+
+    std::vector<EntHandle> collide(const CollisionGrid & aGrid, CollisionLayer aLayer, const Box_f & aHitbox)
+    {
+        std::vector<EntHandle> result;
+        aGrid.forEachCollision(aLayer, aHitbox,
+                               [&result](const CollisionGrid::Entry & aEntry)
+                               {
+                                   result.push_back(aEntry.mHandle);
+                               });
+        return result;
+    }
+
+
+} // unnamed namespace
+
+
+SCENARIO("Collision grid queries.")
+{
+    ent::EntityManager world;
+    CollisionGrid grid;
+    grid.reset(makeLevel(10, 10));
+
+    GIVEN("An entry overlapping 4 cells.")
+    {
+        EntHandle player = world.addEntity("player");
+        // Centered on the corner shared by tiles (2, 2), (3, 2), (2, 3) and (3, 3).
+        grid.insert(CollisionLayer::Player, player, makeHitbox(2.5f, 2.5f));
+
+        WHEN("A query overlaps the same 4 cells.")
+        {
+            THEN("The entry is visited exactly once, for each query.")
+            {
+                CHECK(collide(grid, CollisionLayer::Player, makeHitbox(2.5f, 2.5f, 0.8f))
+                      == std::vector<EntHandle>{player});
+                CHECK(collide(grid, CollisionLayer::Player, makeHitbox(2.5f, 2.5f, 0.8f))
+                      == std::vector<EntHandle>{player});
+            }
+        }
+
+        WHEN("A query shares a cell with the entry, without overlapping it.")
+        {
+            THEN("The entry is rejected by the SAT test.")
+            {
+                CHECK(collide(grid, CollisionLayer::Player, makeHitbox(3.4f, 3.4f, 0.05f)).empty());
+            }
+        }
+
+        THEN("Other layers are not visited.")
+        {
+            CHECK(collide(grid, CollisionLayer::Pill, makeHitbox(2.5f, 2.5f)).empty());
+        }
+
+        WHEN("The entry is teleported.")
+        {
+            grid.move(CollisionLayer::Player, player, makeHitbox(8.f, 7.f));
+
+            THEN("It is only found at its new position.")
+            {
+                CHECK(collide(grid, CollisionLayer::Player, makeHitbox(2.5f, 2.5f)).empty());
+                CHECK(collide(grid, CollisionLayer::Player, makeHitbox(8.f, 7.f))
+                      == std::vector<EntHandle>{player});
+            }
+
+            AND_WHEN("It moves within the same cell.")
+            {
+                grid.move(CollisionLayer::Player, player, makeHitbox(8.f, 7.2f));
+
+                THEN("Its hitbox is updated.")
+                {
+                    CHECK(collide(grid, CollisionLayer::Player, makeHitbox(8.f, 6.7f, 0.1f)).empty());
+                    CHECK(collide(grid, CollisionLayer::Player, makeHitbox(8.f, 7.5f, 0.1f))
+                          == std::vector<EntHandle>{player});
+                }
+            }
+        }
+
+        WHEN("An entity that is not in the layer is moved.")
+        {
+            grid.move(CollisionLayer::Player, world.addEntity("other"), makeHitbox(2.5f, 2.5f));
+
+            THEN("It is ignored.")
+            {
+                CHECK(collide(grid, CollisionLayer::Player, makeHitbox(2.5f, 2.5f))
+                      == std::vector<EntHandle>{player});
+            }
+        }
+    }
+
+    GIVEN("A portal on the level edge, its entry uniting the enter and exit hitboxes.")
+    {
+        EntHandle portal = world.addEntity("portal");
+        // The exit hitbox lies outside the level, beyond its first column.
+        const Box_f enter = makeHitbox(0.f, 4.f, 0.3f);
+        const Box_f exit = makeHitbox(-1.f, 4.f, 0.3f);
+        grid.insert(CollisionLayer::Portal, portal, component::uniteHitboxes(enter, exit));
+
+        THEN("It is found from both hitboxes, and in between.")
+        {
+            CHECK(collide(grid, CollisionLayer::Portal, makeHitbox(0.f, 4.f))
+                  == std::vector<EntHandle>{portal});
+            CHECK(collide(grid, CollisionLayer::Portal, makeHitbox(-1.f, 4.f))
+                  == std::vector<EntHandle>{portal});
+            CHECK(collide(grid, CollisionLayer::Portal, makeHitbox(-0.5f, 4.f, 0.1f))
+                  == std::vector<EntHandle>{portal});
+        }
+
+        THEN("It is not found from the neighbouring rows.")
+        {
+            CHECK(collide(grid, CollisionLayer::Portal, makeHitbox(-1.f, 5.f)).empty());
+            CHECK(collide(grid, CollisionLayer::Portal, makeHitbox(0.f, 3.f)).empty());
+        }
+    }
+
+    GIVEN("Entries outside of each level edge.")
+    {
+        std::vector<EntHandle> pills;
+        const std::vector<Box_f> hitboxes{
+            makeHitbox(-3.f, 5.f),
+            makeHitbox(12.f, 5.f),
+            makeHitbox(5.f, -3.f),
+            makeHitbox(5.f, 12.f),
+            makeHitbox(-2.f, -2.f),
+        };
+        for(const Box_f & hitbox : hitboxes)
+        {
+            pills.push_back(world.addEntity("pill"));
+            grid.insert(CollisionLayer::Pill, pills.back(), hitbox);
+        }
+
+        THEN("They are found by queries outside of the level.")
+        {
+            for(std::size_t pillIdx = 0; pillIdx != pills.size(); ++pillIdx)
+            {
+                CHECK(collide(grid, CollisionLayer::Pill, hitboxes[pillIdx])
+                      == std::vector<EntHandle>{pills[pillIdx]});
+            }
+        }
+
+        THEN("The border cells they are clamped to do not report them for inside queries.")
+        {
+            CHECK(collide(grid, CollisionLayer::Pill, makeHitbox(0.f, 5.f)).empty());
+            CHECK(collide(grid, CollisionLayer::Pill, makeHitbox(9.f, 5.f)).empty());
+            CHECK(collide(grid, CollisionLayer::Pill, makeHitbox(5.f, 0.f)).empty());
+            CHECK(collide(grid, CollisionLayer::Pill, makeHitbox(5.f, 9.f)).empty());
+            CHECK(collide(grid, CollisionLayer::Pill, makeHitbox(0.f, 0.f)).empty());
+        }
+    }
+}
+
+
+SCENARIO("Collision grid synchronization.")
+{
+    ent::EntityManager world;
+    CollisionGrid grid;
+    const component::Level level = makeLevel(10, 10);
+
+    std::vector<EntHandle> pills;
+    grid.beginSync(level);
+    for(int pillIdx = 0; pillIdx != 5; ++pillIdx)
+    {
+        pills.push_back(world.addEntity("pill"));
+        grid.sync(CollisionLayer::Pill, pills.back(), makeHitbox((float)pillIdx, 1.f));
+    }
+    grid.endSync();
+
+    GIVEN("A synchronization where an entity is missing, and another moved.")
+    {
+        grid.beginSync(level);
+        for(int pillIdx = 0; pillIdx != 5; ++pillIdx)
+        {
+            if(pillIdx == 1)
+            {
+                continue;
+            }
+            const float row = (pillIdx == 3 ? 6.f : 1.f);
+            grid.sync(CollisionLayer::Pill, pills[pillIdx], makeHitbox((float)pillIdx, row));
+        }
+        grid.endSync();
+
+        THEN("The missing entity is erased, the others are found at their current position.")
+        {
+            CHECK(collide(grid, CollisionLayer::Pill, makeHitbox(1.f, 1.f)).empty());
+            CHECK(collide(grid, CollisionLayer::Pill, makeHitbox(3.f, 1.f)).empty());
+            CHECK(collide(grid, CollisionLayer::Pill, makeHitbox(3.f, 6.f))
+                  == std::vector<EntHandle>{pills[3]});
+            for(int pillIdx : {0, 2, 4})
+            {
+                CHECK(collide(grid, CollisionLayer::Pill, makeHitbox((float)pillIdx, 1.f))
+                      == std::vector<EntHandle>{pills[pillIdx]});
+            }
+        }
+
+        THEN("Moving an erased entity does not insert it again.")
+        {
+            grid.move(CollisionLayer::Pill, pills[1], makeHitbox(1.f, 1.f));
+            CHECK(collide(grid, CollisionLayer::Pill, makeHitbox(1.f, 1.f)).empty());
+        }
+    }
+
+    GIVEN("An explicit erasure, followed by the insertion of a new entity.")
+    {
+        grid.erase(CollisionLayer::Pill, pills[0]);
+        EntHandle added = world.addEntity("pill");
+        grid.insert(CollisionLayer::Pill, added, makeHitbox(0.f, 1.f));
+
+        THEN("Only the new entity is found at the erased entity position.")
+        {
+            CHECK(collide(grid, CollisionLayer::Pill, makeHitbox(0.f, 1.f))
+                  == std::vector<EntHandle>{added});
+            CHECK(collide(grid, CollisionLayer::Pill, makeHitbox(2.f, 1.f, 2.5f)).size() == 5);
+        }
+    }
+
+    GIVEN("A synchronization with a level of different dimensions.")
+    {
+        grid.beginSync(makeLevel(20, 20));
+        grid.sync(CollisionLayer::Pill, pills[0], makeHitbox(15.f, 15.f));
+        grid.endSync();
+
+        THEN("The grid covers the new level, and only keeps the synchronized entities.")
+        {
+            CHECK(collide(grid, CollisionLayer::Pill, makeHitbox(15.f, 15.f))
+                  == std::vector<EntHandle>{pills[0]});
+            CHECK(collide(grid, CollisionLayer::Pill, makeHitbox(2.f, 1.f, 2.5f)).empty());
+            // Clamped to the last column and row in the previous level.
+            CHECK(collide(grid, CollisionLayer::Pill, makeHitbox(9.f, 9.f)).empty());
+        }
+    }
+}
@@ -0,0 +1,180 @@
+#include "catch.hpp"
+
+#include <snac-renderer-V2/Pass.h>
+
+#include <algorithm>
+#include <random>
+#include <stdexcept>
+#include <vector>
+
+#include <cstdint>
+
+
+using namespace ad;
+using namespace ad::renderer;
+
+
+namespace {
+
+
+    std::uint64_t makeMask(unsigned int aBitCount)
+    {
+        return aBitCount >= 64 ? ~std::uint64_t{0} : (std::uint64_t{1} << aBitCount) - 1;
+    }
+
+
+    /// @brief `aCount` entries, whose keys only use the low `aUsedBits`, drawn from `aDistinctKeys` values
+    /// (so there are equal keys, exercising the stability).
+    std::vector<PartDrawEntry> makeEntries(std::size_t aCount,
+                                           std::size_t aDistinctKeys,
+                                           unsigned int aUsedBits,
+                                           unsigned int aSeed)
+    {
+        std::mt19937_64 engine{aSeed};
+        std::vector<PartDrawEntry::Key> keys;
+        for(std::size_t keyIdx = 0; keyIdx != aDistinctKeys; ++keyIdx)
+        {
+            keys.push_back(PartDrawEntry::Key{
+                .mHigh = engine() & makeMask(aUsedBits > 64 ? aUsedBits - 64 : 0),
+                .mLow = engine() & makeMask(std::min(aUsedBits, 64u)),
+            });
+        }
+
+        std::uniform_int_distribution<std::size_t> pick{0, aDistinctKeys - 1};
+        std::vector<PartDrawEntry> entries;
+        for(std::size_t entryIdx = 0; entryIdx != aCount; ++entryIdx)
+        {
+            entries.push_back(PartDrawEntry{.mKey = keys[pick(engine)], .mPartListIdx = entryIdx});
+        }
+        return entries;
+    }
+
+
+    bool isSame(const std::vector<PartDrawEntry> & aLhs, const std::vector<PartDrawEntry> & aRhs)
+    {
+        return std::equal(aLhs.begin(), aLhs.end(), aRhs.begin(), aRhs.end(),
+                          [](const PartDrawEntry & aL, const PartDrawEntry & aR)
+                          {
+                              return aL.mKey == aR.mKey && aL.mPartListIdx == aR.mPartListIdx;
+                          });
+    }
+
+
+} // unnamed namespace
+
+
+SCENARIO("Draw sort keys compose fields in a 128 bits integer.")
+{
+    GIVEN("A key with fields in each half, and a field straddling both halves.")
+    {
+        DrawSortKey key;
+        key.insert(0xABCD, 0, 16);
+        key.insert(0x123456789, 56, 36);
+        key.insert(0xFFFFFFF, 100, 28);
+        key.insert(0x5, 92, 4);
+
+        THEN("Each field is extracted back.")
+        {
+            CHECK(key.extract(0, 16) == 0xABCD);
+            CHECK(key.extract(56, 36) == 0x123456789);
+            CHECK(key.extract(100, 28) == 0xFFFFFFF);
+            CHECK(key.extract(92, 4) == 0x5);
+            CHECK(key.extract(16, 40) == 0);
+        }
+
+        THEN("The halves hold the expected bits.")
+        {
+            CHECK(key.mLow == ((std::uint64_t{0x89} << 56) | 0xABCD));
+            CHECK(key.mHigh == ((std::uint64_t{0xFFFFFFF} << 36) | (std::uint64_t{0x5} << 28) | 0x1234567));
+        }
+    }
+
+    GIVEN("Keys differing in each half.")
+    {
+        const DrawSortKey small{.mHigh = 1, .mLow = ~std::uint64_t{0}};
+        const DrawSortKey large{.mHigh = 2, .mLow = 0};
+
+        THEN("They compare as 128 bits integers.")
+        {
+            CHECK(small < large);
+            CHECK(DrawSortKey{.mHigh = 1, .mLow = 1} < small);
+        }
+    }
+}
+
+
+SCENARIO("Draw entries are radix sorted in the order of std::stable_sort.")
+{
+    GIVEN("The default 64 bits layout, and a 128 bits layout with a depth dimension.")
+    {
+        const DrawSortKeyLayout layout = GENERATE(
+            DrawSortKeyLayout{},
+            DrawSortKeyLayout{
+                .mKeyBits = 128,
+                .mProgramBits = 24,
+                .mMaterialContextBits = 24,
+                .mVaoBits = 24,
+                .mDepthBits = 32,
+                .mDepthOrder = DrawSortKeyLayout::DepthOrder::BackToFront,
+            });
+        DrawEntryHelper helper{layout};
+
+        THEN("Entries with random keys, including equal keys, are sorted as by std::stable_sort.")
+        {
+            // Successive sorts of different sizes, with the same helper, reuse its scratch memory.
+            for(std::size_t count : {0, 1, 2, 1000, 100, 5000})
+            {
+                std::vector<PartDrawEntry> entries = makeEntries(count, 1 + count / 10, layout.getUsedBits(), 3);
+                std::vector<PartDrawEntry> expected = entries;
+                std::stable_sort(expected.begin(), expected.end());
+
+                helper.sortDrawEntries(entries);
+                CHECK(isSame(entries, expected));
+            }
+        }
+
+        THEN("Entries whose keys share most bytes are sorted as by std::stable_sort.")
+        {
+            // Most passes are skipped, because all keys have the same byte.
+            std::vector<PartDrawEntry> entries = makeEntries(500, 50, 8, 5);
+            for(PartDrawEntry & entry : entries)
+            {
+                entry.mKey.insert(0x3, layout.getUsedBits() - 2, 2);
+            }
+            std::vector<PartDrawEntry> expected = entries;
+            std::stable_sort(expected.begin(), expected.end());
+
+            helper.sortDrawEntries(entries);
+            CHECK(isSame(entries, expected));
+        }
+    }
+}
+
+
+SCENARIO("Invalid draw sort key layouts are rejected.")
+{
+    THEN("Dimensions overflowing the key are rejected.")
+    {
+        const DrawSortKeyLayout layout{.mProgramBits = 32, .mMaterialContextBits = 32};
+        CHECK_THROWS_AS(DrawEntryHelper{layout}, std::invalid_argument);
+    }
+
+    THEN("A depth dimension wider than a quantized float depth is rejected.")
+    {
+        DrawSortKeyLayout layout{
+            .mKeyBits = 128,
+            .mDepthBits = DrawSortKeyLayout::gMaxDepthBits + 1,
+            .mDepthOrder = DrawSortKeyLayout::DepthOrder::FrontToBack,
+        };
+        CHECK_THROWS_AS(layout.validate(), std::invalid_argument);
+
+        layout.mDepthBits = DrawSortKeyLayout::gMaxDepthBits;
+        CHECK_NOTHROW(layout.validate());
+    }
+
+    THEN("A depth order without depth bits is rejected.")
+    {
+        const DrawSortKeyLayout layout{.mDepthOrder = DrawSortKeyLayout::DepthOrder::FrontToBack};
+        CHECK_THROWS_AS(layout.validate(), std::invalid_argument);
+    }
+}
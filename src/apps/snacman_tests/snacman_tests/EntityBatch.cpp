@@ -0,0 +1,171 @@
+#include "catch.hpp"
+
+#include "Benchmark.h"
+
+#include <snacman/simulations/snacgame/EntityBatch.h>
+#include <snacman/simulations/snacgame/GameParameters.h>
+
+#include <snacman/simulations/snacgame/component/Collision.h>
+#include <snacman/simulations/snacgame/component/Geometry.h>
+#include <snacman/simulations/snacgame/component/GlobalPose.h>
+#include <snacman/simulations/snacgame/component/Speed.h>
+#include <snacman/simulations/snacgame/component/Tags.h>
+
+#include <entity/EntityManager.h>
+#include <entity/Query.h>
+
+#include <optional>
+#include <string>
+#include <vector>
+
+
+using namespace ad;
+using namespace ad::snacgame;
+namespace bench = ad::snac::bench;
+
+
+namespace {
+
+
+    // The component set of a pill, without its mesh (which requires the game resources).
+    void addPillComponents(Entity & aPill, const Pos3 & aPos)
+    {
+        aPill
+            .add(component::Geometry{.mPosition = aPos, .mScaling = 0.16f})
+            .add(component::GlobalPose{.mPosition = aPos, .mScaling = 0.16f})
+            .add(component::Speed{})
+            .add(component::Pill{})
+            .add(component::Collision{component::gPillHitbox})
+            .add(component::RoundTransient{});
+    }
+
+
+    Pos3 getTilePosition(std::size_t aTileIdx, std::size_t aStride)
+    {
+        return {(float)(aTileIdx % aStride), (float)(aTileIdx / aStride), gPillHeight};
+    }
+
+
+    EntityBatch makePillBatch(ent::EntityManager & aWorld)
+    {
+        return EntityBatch{aWorld, "pill blueprint",
+                           [](Entity & aBlueprint) { addPillComponents(aBlueprint, Pos3::Zero()); }};
+    }
+
+
+    EntHandle spawnPill(const EntityBatch & aPills, const Pos3 & aPos)
+    {
+        return aPills.spawn("pill", [&aPos](Entity & aPill)
+        {
+            aPill.get<component::Geometry>().mPosition = aPos;
+            aPill.get<component::GlobalPose>().mPosition = aPos;
+        });
+    }
+
+
+} // unnamed namespace
+
+
+SCENARIO("EntityBatch spawns entities with the blueprint components.")
+{
+    GIVEN("A world and a pill batch.")
+    {
+        ent::EntityManager world;
+        ent::Query<component::Pill, component::Geometry, component::Collision> pills{world};
+        std::optional<EntityBatch> batch;
+        batch.emplace(world, "pill blueprint",
+                      [](Entity & aBlueprint) { addPillComponents(aBlueprint, Pos3::Zero()); });
+
+        THEN("The blueprint is not matched by queries.")
+        {
+            CHECK(pills.countMatches() == 0);
+        }
+
+        WHEN("Pills are spawned, each written at its own position.")
+        {
+            std::vector<EntHandle> spawned;
+            for(std::size_t tileIdx = 0; tileIdx != 3; ++tileIdx)
+            {
+                spawned.push_back(spawnPill(*batch, getTilePosition(tileIdx, 15)));
+            }
+
+            THEN("Each pill has the full component set, with the blueprint values and its own position.")
+            {
+                CHECK(pills.countMatches() == 3);
+                for(std::size_t tileIdx = 0; tileIdx != spawned.size(); ++tileIdx)
+                {
+                    Entity pill = *spawned[tileIdx].get();
+                    CHECK(pill.has<component::GlobalPose>());
+                    CHECK(pill.has<component::Speed>());
+                    CHECK(pill.has<component::RoundTransient>());
+                    CHECK(pill.get<component::Geometry>().mScaling == 0.16f);
+                    CHECK(pill.get<component::Geometry>().mPosition == getTilePosition(tileIdx, 15));
+                    CHECK(pill.get<component::GlobalPose>().mPosition == getTilePosition(tileIdx, 15));
+                }
+            }
+
+            AND_WHEN("The batch is destroyed.")
+            {
+                batch.reset();
+
+                THEN("The pills outlive it.")
+                {
+                    CHECK(pills.countMatches() == spawned.size());
+                    for(EntHandle pill : spawned)
+                    {
+                        CHECK(pill.isValid());
+                    }
+                }
+            }
+        }
+    }
+}
+
+
+TEST_CASE("EntityBatch and component by component level spawning.", "[.benchmark]")
+{
+    constexpr std::size_t repetitions = 50;
+    constexpr std::size_t stride = 15;
+
+    // The level pills: 225 tiles is the size of the level measured in LevelManager::createLevel().
+    for(std::size_t pillCount : {225, 1000})
+    {
+        {
+            std::vector<bench::Clock::duration> durations;
+            for(std::size_t repetition = 0; repetition != repetitions; ++repetition)
+            {
+                // A fresh world for each repetition, destroyed after the measure.
+                ent::EntityManager world;
+                const bench::Clock::time_point begin = bench::Clock::now();
+                {
+                    Phase createLevel;
+                    for(std::size_t tileIdx = 0; tileIdx != pillCount; ++tileIdx)
+                    {
+                        Entity pill = *world.addEntity("pill").get(createLevel);
+                        addPillComponents(pill, getTilePosition(tileIdx, stride));
+                    }
+                }
+                durations.push_back(bench::Clock::now() - begin);
+            }
+            bench::report("Component by component, " + std::to_string(pillCount) + " pills", durations);
+        }
+
+        {
+            std::vector<bench::Clock::duration> durations;
+            for(std::size_t repetition = 0; repetition != repetitions; ++repetition)
+            {
+                ent::EntityManager world;
+                const bench::Clock::time_point begin = bench::Clock::now();
+                {
+                    EntityBatch pills = makePillBatch(world);
+                    for(std::size_t tileIdx = 0; tileIdx != pillCount; ++tileIdx)
+                    {
+                        spawnPill(pills, getTilePosition(tileIdx, stride));
+                    }
+                }
+                durations.push_back(bench::Clock::now() - begin);
+            }
+            bench::report("EntityBatch, " + std::to_string(pillCount) + " pills", durations);
+        }
+    }
+}
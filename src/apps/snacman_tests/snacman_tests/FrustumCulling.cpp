@@ -0,0 +1,240 @@
+#include "catch.hpp"
+
+#include <snac-renderer-V2/utilities/FrustumCulling.h>
+
+#include <math/Transformations.h>
+
+#include <algorithm>
+#include <array>
+#include <vector>
+
+
+using namespace ad;
+using namespace ad::renderer;
+
+
+namespace {
+
+
+    using Matrix = math::Matrix<4, 4, GLfloat>;
+    using Box = math::Box<GLfloat>;
+
+
+    /// @brief OpenGL perspective projection with a 90 degrees field of view, looking toward -Z,
+    /// with the near plane at 1 and the far plane at 10.
+    /// So the frustum is -10 <= z <= -1, |x| <= -z, |y| <= -z.
+    Matrix makePerspective()
+    {
+        constexpr GLfloat n = 1.f;
+        constexpr GLfloat f = 10.f;
+        // Row-vector convention: the transpose of the usual OpenGL matrix.
+        return Matrix{
+            1.f, 0.f, 0.f,                 0.f,
+            0.f, 1.f, 0.f,                 0.f,
+            0.f, 0.f, (n + f) / (n - f),   -1.f,
+            0.f, 0.f, 2 * n * f / (n - f), 0.f,
+        };
+    }
+
+
+    /// @brief OpenGL orthographic projection of the box -5 <= x, y <= 5, -20 <= z <= 0,
+    /// the kind of projection used by the shadow cascades.
+    Matrix makeOrthographic()
+    {
+        return Matrix{
+            0.2f, 0.f,  0.f,   0.f,
+            0.f,  0.2f, 0.f,   0.f,
+            0.f,  0.f,  -0.1f, 0.f,
+            0.f,  0.f,  -1.f,  1.f,
+        };
+    }
+
+
+    /// @brief A cube of side `aSide` centered on `aCenter`.
+    Box makeCube(math::Position<3, GLfloat> aCenter, GLfloat aSide = 1.f)
+    {
+        return Box{
+            aCenter - math::Vec<3, GLfloat>{aSide, aSide, aSide} / 2.f,
+            math::Size<3, GLfloat>{aSide, aSide, aSide},
+        };
+    }
+
+
+    /// @brief Cull a single box, returning whether it is visible.
+    bool isVisible(const Box & aBox, const Matrix & aViewProjection)
+    {
+        FrustumCuller culler;
+        culler.push_back(aBox);
+        std::vector<std::uint8_t> visible;
+        culler.cull({&aViewProjection, 1}, visible);
+        return visible.at(0) != 0;
+    }
+
+
+} // unnamed namespace
+
+
+SCENARIO("Frustum culling of bounding boxes.")
+{
+    GIVEN("A perspective frustum.")
+    {
+        const Matrix perspective = makePerspective();
+
+        THEN("A box inside the frustum is visible.")
+        {
+            CHECK(isVisible(makeCube({0.f, 0.f, -5.f}), perspective));
+            CHECK(isVisible(makeCube({3.f, -3.f, -5.f}), perspective));
+        }
+
+        THEN("A box outside of any plane is culled.")
+        {
+            CHECK_FALSE(isVisible(makeCube({-8.f, 0.f, -5.f}), perspective)); // left
+            CHECK_FALSE(isVisible(makeCube({8.f, 0.f, -5.f}), perspective));  // right
+            CHECK_FALSE(isVisible(makeCube({0.f, -8.f, -5.f}), perspective)); // bottom
+            CHECK_FALSE(isVisible(makeCube({0.f, 8.f, -5.f}), perspective));  // top
+            CHECK_FALSE(isVisible(makeCube({0.f, 0.f, -0.5f}, 0.4f), perspective)); // near
+            CHECK_FALSE(isVisible(makeCube({0.f, 0.f, 5.f}), perspective));   // behind the camera
+            CHECK_FALSE(isVisible(makeCube({0.f, 0.f, -12.f}), perspective)); // far
+        }
+
+        THEN("A box straddling any plane is visible.")
+        {
+            CHECK(isVisible(makeCube({-5.f, 0.f, -5.f}), perspective)); // left
+            CHECK(isVisible(makeCube({5.f, 0.f, -5.f}), perspective));  // right
+            CHECK(isVisible(makeCube({0.f, -5.f, -5.f}), perspective)); // bottom
+            CHECK(isVisible(makeCube({0.f, 5.f, -5.f}), perspective));  // top
+            CHECK(isVisible(makeCube({0.f, 0.f, -1.f}), perspective));  // near
+            CHECK(isVisible(makeCube({0.f, 0.f, -10.f}), perspective)); // far
+        }
+
+        THEN("A box containing the whole frustum is visible.")
+        {
+            CHECK(isVisible(makeCube({0.f, 0.f, 0.f}, 100.f), perspective));
+        }
+    }
+
+    GIVEN("An orthographic frustum, translated as a shadow cascade.")
+    {
+        // The cascade covers 95 <= x <= 105.
+        const Matrix cascade =
+            math::trans3d::translate(math::Vec<3, GLfloat>{-100.f, 0.f, 0.f}) * makeOrthographic();
+
+        THEN("A box inside the frustum is visible.")
+        {
+            CHECK(isVisible(makeCube({100.f, 0.f, -10.f}), cascade));
+            CHECK(isVisible(makeCube({104.f, 4.f, -1.f}), cascade));
+        }
+
+        THEN("A box outside of any plane is culled.")
+        {
+            CHECK_FALSE(isVisible(makeCube({0.f, 0.f, -10.f}), cascade));    // left, not translated
+            CHECK_FALSE(isVisible(makeCube({94.f, 0.f, -10.f}), cascade));   // left
+            CHECK_FALSE(isVisible(makeCube({106.f, 0.f, -10.f}), cascade));  // right
+            CHECK_FALSE(isVisible(makeCube({100.f, -6.f, -10.f}), cascade)); // bottom
+            CHECK_FALSE(isVisible(makeCube({100.f, 6.f, -10.f}), cascade));  // top
+            CHECK_FALSE(isVisible(makeCube({100.f, 0.f, 1.f}), cascade));    // near
+            CHECK_FALSE(isVisible(makeCube({100.f, 0.f, -21.f}), cascade));  // far
+        }
+
+        THEN("A box straddling any plane is visible.")
+        {
+            CHECK(isVisible(makeCube({95.f, 0.f, -10.f}), cascade));  // left
+            CHECK(isVisible(makeCube({105.f, 0.f, -10.f}), cascade)); // right
+            CHECK(isVisible(makeCube({100.f, -5.f, -10.f}), cascade)); // bottom
+            CHECK(isVisible(makeCube({100.f, 5.f, -10.f}), cascade));  // top
+            CHECK(isVisible(makeCube({100.f, 0.f, 0.f}), cascade));    // near
+            CHECK(isVisible(makeCube({100.f, 0.f, -20.f}), cascade));  // far
+        }
+    }
+
+    GIVEN("A batch of boxes, including unbounded entries, culled against both frusta.")
+    {
+        const std::array<Matrix, 2> frusta{
+            makePerspective(),
+            math::trans3d::translate(math::Vec<3, GLfloat>{-100.f, 0.f, 0.f}) * makeOrthographic(),
+        };
+
+        FrustumCuller culler;
+        culler.push_back(makeCube({0.f, 0.f, -5.f}));    // perspective only
+        culler.pushUnbounded();
+        culler.push_back(makeCube({0.f, 0.f, 50.f}));    // none
+        culler.push_back(makeCube({100.f, 0.f, -10.f})); // cascade only
+        culler.pushUnbounded();
+
+        std::vector<std::uint8_t> visible;
+
+        THEN("A box is visible when it intersects at least one frustum, and unbounded entries always pass.")
+        {
+            CHECK(culler.cull(frusta, visible) == 4);
+            CHECK(visible == std::vector<std::uint8_t>{1, 1, 0, 1, 1});
+        }
+
+        THEN("Unbounded entries pass each frustum on its own.")
+        {
+            for(const Matrix & frustum : frusta)
+            {
+                culler.cull({&frustum, 1}, visible);
+                CHECK(visible[1] == 1);
+                CHECK(visible[4] == 1);
+            }
+        }
+
+        THEN("Without any frustum, nothing is visible.")
+        {
+            CHECK(culler.cull({}, visible) == 0);
+            CHECK(visible == std::vector<std::uint8_t>(5, 0));
+        }
+    }
+}
+
+
+SCENARIO("Transformed bounding boxes.")
+{
+    GIVEN("A box, and transformations combining scale, rotation and translation.")
+    {
+        const Box box{{-1.f, 0.5f, 2.f}, {2.f, 3.f, 0.5f}};
+
+        const std::array<math::AffineMatrix<4, GLfloat>, 4> transforms{
+            math::AffineMatrix<4, GLfloat>::Identity(),
+            math::trans3d::translate(math::Vec<3, GLfloat>{10.f, -3.f, 7.f}),
+            math::trans3d::scale(2.f, -0.5f, 3.f)
+                * math::trans3d::rotateY(math::Radian<GLfloat>{0.6f})
+                * math::trans3d::translate(math::Vec<3, GLfloat>{1.f, 2.f, 3.f}),
+            math::trans3d::rotateX(math::Radian<GLfloat>{-1.2f})
+                * math::trans3d::rotateZ(math::Radian<GLfloat>{2.5f})
+                * math::trans3d::translate(math::Vec<3, GLfloat>{-4.f, 0.f, 0.f}),
+        };
+
+        THEN("The transformed box is the bounding box of the 8 transformed corners.")
+        {
+            for(const math::AffineMatrix<4, GLfloat> & transform : transforms)
+            {
+                math::Position<3, GLfloat> low{ 1E9f,  1E9f,  1E9f};
+                math::Position<3, GLfloat> high{-1E9f, -1E9f, -1E9f};
+                for(int cornerIdx = 0; cornerIdx != 8; ++cornerIdx)
+                {
+                    const math::Position<3, GLfloat> corner{
+                        (cornerIdx & 1) ? box.xMax() : box.xMin(),
+                        (cornerIdx & 2) ? box.yMax() : box.yMin(),
+                        (cornerIdx & 4) ? box.zMax() : box.zMin(),
+                    };
+                    const math::Position<3, GLfloat> transformed =
+                        math::homogeneous::homogenize(math::homogeneous::makePosition(corner) * transform).xyz();
+                    for(int axis = 0; axis != 3; ++axis)
+                    {
+                        low[axis] = std::min(low[axis], transformed[axis]);
+                        high[axis] = std::max(high[axis], transformed[axis]);
+                    }
+                }
+
+                const Box result = transformAabb(box, transform);
+                CHECK(result.xMin() == Approx(low.x()).margin(1E-4f));
+                CHECK(result.yMin() == Approx(low.y()).margin(1E-4f));
+                CHECK(result.zMin() == Approx(low.z()).margin(1E-4f));
+                CHECK(result.xMax() == Approx(high.x()).margin(1E-4f));
+                CHECK(result.yMax() == Approx(high.y()).margin(1E-4f));
+                CHECK(result.zMax() == Approx(high.z()).margin(1E-4f));
+            }
+        }
+    }
+}
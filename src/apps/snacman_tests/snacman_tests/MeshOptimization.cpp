@@ -0,0 +1,290 @@
+#include "catch.hpp"
+
+#include <file-processor/MeshOptimization.h>
+
+#include <algorithm>
+#include <array>
+#include <numbers>
+#include <span>
+#include <vector>
+
+#include <cmath>
+
+
+using namespace ad;
+using namespace ad::renderer;
+
+
+namespace {
+
+
+    struct Mesh
+    {
+        std::vector<aiVector3D> mPositions;
+        std::vector<unsigned int> mIndices;
+    };
+
+
+    /// @brief A square of `aQuads` x `aQuads` quads in the XY plane, with a side of `aSide`.
+    Mesh makeGrid(unsigned int aQuads, float aSide)
+    {
+        Mesh grid;
+        const unsigned int row = aQuads + 1;
+        for(unsigned int y = 0; y != row; ++y)
+        {
+            for(unsigned int x = 0; x != row; ++x)
+            {
+                grid.mPositions.push_back({aSide * x / aQuads, aSide * y / aQuads, 0.f});
+            }
+        }
+        for(unsigned int y = 0; y != aQuads; ++y)
+        {
+            for(unsigned int x = 0; x != aQuads; ++x)
+            {
+                const unsigned int corner = x + y * row;
+                grid.mIndices.insert(grid.mIndices.end(), {corner, corner + 1, corner + row + 1});
+                grid.mIndices.insert(grid.mIndices.end(), {corner, corner + row + 1, corner + row});
+            }
+        }
+        return grid;
+    }
+
+
+    /// @brief A closed sphere of radius `aRadius` centered on the origin, with `aRings` rings of `aSegments` quads.
+    Mesh makeSphere(unsigned int aRings, unsigned int aSegments, float aRadius)
+    {
+        Mesh sphere;
+        sphere.mPositions.push_back({0.f, 0.f, aRadius});
+        for(unsigned int ring = 1; ring != aRings; ++ring)
+        {
+            const double polar = std::numbers::pi * ring / aRings;
+            for(unsigned int segment = 0; segment != aSegments; ++segment)
+            {
+                const double azimuth = 2 * std::numbers::pi * segment / aSegments;
+                sphere.mPositions.push_back({
+                    (float)(aRadius * std::sin(polar) * std::cos(azimuth)),
+                    (float)(aRadius * std::sin(polar) * std::sin(azimuth)),
+                    (float)(aRadius * std::cos(polar)),
+                });
+            }
+        }
+        const unsigned int southPole = (unsigned int)sphere.mPositions.size();
+        sphere.mPositions.push_back({0.f, 0.f, -aRadius});
+
+        // The vertex of `aSegment` (wrapping around) on `aRing`, the poles being excluded.
+        auto vertex = [aSegments](unsigned int aRing, unsigned int aSegment)
+        {
+            return 1 + (aRing - 1) * aSegments + aSegment % aSegments;
+        };
+        for(unsigned int segment = 0; segment != aSegments; ++segment)
+        {
+            sphere.mIndices.insert(sphere.mIndices.end(), {0, vertex(1, segment), vertex(1, segment + 1)});
+            for(unsigned int ring = 1; ring + 1 != aRings; ++ring)
+            {
+                sphere.mIndices.insert(sphere.mIndices.end(),
+                                       {vertex(ring, segment), vertex(ring + 1, segment), vertex(ring + 1, segment + 1)});
+                sphere.mIndices.insert(sphere.mIndices.end(),
+                                       {vertex(ring, segment), vertex(ring + 1, segment + 1), vertex(ring, segment + 1)});
+            }
+            sphere.mIndices.insert(sphere.mIndices.end(),
+                                   {vertex(aRings - 1, segment), southPole, vertex(aRings - 1, segment + 1)});
+        }
+        return sphere;
+    }
+
+
+    /// @brief Sum of the cross products of the triangles edges, i.e. twice their area along each axis.
+    aiVector3D getDoubleAreaVector(std::span<const unsigned int> aIndices, std::span<const aiVector3D> aPositions)
+    {
+        aiVector3D result{0.f, 0.f, 0.f};
+        for(std::size_t indexIdx = 0; indexIdx != aIndices.size(); indexIdx += 3)
+        {
+            const aiVector3D & a = aPositions[aIndices[indexIdx]];
+            result += (aPositions[aIndices[indexIdx + 1]] - a) ^ (aPositions[aIndices[indexIdx + 2]] - a);
+        }
+        return result;
+    }
+
+
+    /// @brief The largest distance between a sphere centered on the origin and the planes of the triangles
+    /// approximating it.
+    float getSphereDeviation(std::span<const unsigned int> aIndices,
+                             std::span<const aiVector3D> aPositions,
+                             float aRadius)
+    {
+        float result = 0.f;
+        for(std::size_t indexIdx = 0; indexIdx != aIndices.size(); indexIdx += 3)
+        {
+            const aiVector3D & a = aPositions[aIndices[indexIdx]];
+            aiVector3D normal = (aPositions[aIndices[indexIdx + 1]] - a) ^ (aPositions[aIndices[indexIdx + 2]] - a);
+            normal = normal / normal.Length();
+            result = std::max(result, aRadius - normal * a);
+        }
+        return result;
+    }
+
+
+    /// @brief The triangles of `aIndices`, each rotated to start with its smallest index, then sorted.
+    std::vector<std::array<unsigned int, 3>> getSortedTriangles(std::span<const unsigned int> aIndices)
+    {
+        std::vector<std::array<unsigned int, 3>> triangles;
+        for(std::size_t indexIdx = 0; indexIdx != aIndices.size(); indexIdx += 3)
+        {
+            std::array<unsigned int, 3> triangle{aIndices[indexIdx], aIndices[indexIdx + 1], aIndices[indexIdx + 2]};
+            std::rotate(triangle.begin(), std::min_element(triangle.begin(), triangle.end()), triangle.end());
+            triangles.push_back(triangle);
+        }
+        std::sort(triangles.begin(), triangles.end());
+        return triangles;
+    }
+
+
+} // unnamed namespace
+
+
+SCENARIO("Triangles are reordered for the vertex cache and overdraw.")
+{
+    GIVEN("A grid mesh.")
+    {
+        Mesh grid = makeGrid(24, 1.f);
+        const std::vector<std::array<unsigned int, 3>> triangles = getSortedTriangles(grid.mIndices);
+        const VertexCacheStatistics initial = analyzeVertexCache(grid.mIndices, grid.mPositions.size());
+
+        WHEN("It is optimized for the vertex cache, then for overdraw.")
+        {
+            optimizeVertexCache(grid.mIndices, grid.mPositions.size());
+            const VertexCacheStatistics cacheOptimized = analyzeVertexCache(grid.mIndices, grid.mPositions.size());
+            optimizeOverdraw(grid.mIndices, grid.mPositions);
+            const VertexCacheStatistics overdrawOptimized = analyzeVertexCache(grid.mIndices, grid.mPositions.size());
+
+            THEN("It draws the same triangles, with the same winding.")
+            {
+                CHECK(getSortedTriangles(grid.mIndices) == triangles);
+            }
+
+            THEN("The vertex cache misses are reduced, and the overdraw pass degrades them by at most its threshold.")
+            {
+                CHECK(cacheOptimized.mAcmr < initial.mAcmr);
+                // Tolerance for the cache state carried between the reordered clusters.
+                CHECK(overdrawOptimized.mAcmr <= 1.05f * cacheOptimized.mAcmr + 0.05f);
+            }
+        }
+    }
+
+    GIVEN("A mesh whose first triangle is degenerate, so it does not start with a cold cache cluster.")
+    {
+        Mesh grid = makeGrid(4, 1.f);
+        // Only 2 cache misses for the leading triangle, the next one (first of the grid) has 3 misses.
+        grid.mIndices.insert(grid.mIndices.begin(), {20, 20, 21});
+        const std::vector<std::array<unsigned int, 3>> triangles = getSortedTriangles(grid.mIndices);
+
+        WHEN("It is optimized for overdraw.")
+        {
+            optimizeOverdraw(grid.mIndices, grid.mPositions);
+
+            THEN("All the triangles are still drawn, including the leading ones.")
+            {
+                CHECK(getSortedTriangles(grid.mIndices) == triangles);
+            }
+        }
+    }
+}
+
+
+SCENARIO("Meshes are simplified within an error expressed as a length.")
+{
+    GIVEN("A planar grid mesh.")
+    {
+        const Mesh grid = makeGrid(16, 1.f);
+
+        WHEN("It is simplified as much as possible, without deviating from the plane.")
+        {
+            const SimplifiedMesh simplified = simplify(grid.mIndices, grid.mPositions, 0, 1E-4f);
+
+            THEN("Most triangles are removed, with a null error.")
+            {
+                CHECK(simplified.mIndices.size() < grid.mIndices.size() / 4);
+                CHECK(simplified.mError == Approx(0.f).margin(1E-5f));
+            }
+
+            THEN("The simplified mesh still covers the grid, facing the same side.")
+            {
+                const aiVector3D doubleArea = getDoubleAreaVector(simplified.mIndices, grid.mPositions);
+                CHECK(doubleArea.z == Approx(2.f));
+                CHECK(doubleArea.x == Approx(0.f).margin(1E-5f));
+                CHECK(doubleArea.y == Approx(0.f).margin(1E-5f));
+            }
+        }
+
+        WHEN("The same grid, scaled up, is simplified with a proportional error budget.")
+        {
+            const float scale = 1024.f;
+            const Mesh scaled = makeGrid(16, scale);
+
+            THEN("It is simplified the same way.")
+            {
+                CHECK(simplify(scaled.mIndices, scaled.mPositions, 0, scale * 1E-4f).mIndices
+                      == simplify(grid.mIndices, grid.mPositions, 0, 1E-4f).mIndices);
+            }
+        }
+    }
+
+    GIVEN("Spheres of different radii.")
+    {
+        // A power of two, so the positions are scaled exactly.
+        const float radius = 128.f;
+        const Mesh unit = makeSphere(16, 32, 1.f);
+        const Mesh large = makeSphere(16, 32, radius);
+
+        WHEN("They are simplified to a quarter of their triangles, with a proportional error budget.")
+        {
+            const std::size_t target = unit.mIndices.size() / 12 * 3;
+            const SimplifiedMesh unitSimplified = simplify(unit.mIndices, unit.mPositions, target, 0.1f);
+            const SimplifiedMesh largeSimplified = simplify(large.mIndices, large.mPositions, target, radius * 0.1f);
+
+            THEN("They are simplified the same way, with errors proportional to the radius.")
+            {
+                CHECK(unitSimplified.mIndices.size() <= target);
+                CHECK(largeSimplified.mIndices == unitSimplified.mIndices);
+                CHECK(largeSimplified.mError == Approx(radius * unitSimplified.mError).epsilon(1E-4));
+            }
+
+            THEN("No triangle is flipped.")
+            {
+                CHECK(getSphereDeviation(unitSimplified.mIndices, unit.mPositions, 1.f) < 1.f);
+            }
+        }
+    }
+
+    GIVEN("Spheres of the same radius, with different tessellations.")
+    {
+        const Mesh coarse = makeSphere(16, 32, 1.f);
+        const Mesh fine = makeSphere(32, 64, 1.f);
+
+        WHEN("They are simplified as much as possible within the same error budget.")
+        {
+            const float maxError = 0.03f;
+            const SimplifiedMesh coarseSimplified = simplify(coarse.mIndices, coarse.mPositions, 0, maxError);
+            const SimplifiedMesh fineSimplified = simplify(fine.mIndices, fine.mPositions, 0, maxError);
+            const float coarseDeviation = getSphereDeviation(coarseSimplified.mIndices, coarse.mPositions, 1.f);
+            const float fineDeviation = getSphereDeviation(fineSimplified.mIndices, fine.mPositions, 1.f);
+
+            THEN("The errors are within the budget, and of the order of the distance to the sphere.")
+            {
+                CHECK(coarseSimplified.mError <= maxError);
+                CHECK(fineSimplified.mError <= maxError);
+
+                CHECK(coarseSimplified.mError <= coarseDeviation);
+                CHECK(coarseSimplified.mError >= coarseDeviation / 10.f);
+                CHECK(fineSimplified.mError <= fineDeviation);
+                CHECK(fineSimplified.mError >= fineDeviation / 10.f);
+            }
+
+            THEN("They deviate from the sphere by similar distances.")
+            {
+                CHECK(fineDeviation <= 2.f * coarseDeviation);
+                CHECK(coarseDeviation <= 2.f * fineDeviation);
+            }
+        }
+    }
+}
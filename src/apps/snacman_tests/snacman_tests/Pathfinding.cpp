@@ -0,0 +1,254 @@
+#include "catch.hpp"
+
+#include "Benchmark.h"
+
+#include <snacman/simulations/snacgame/system/Pathfinding.h>
+
+#include <deque>
+#include <random>
+#include <string>
+
+
+using namespace ad;
+using namespace ad::snacgame;
+namespace bench = ad::snac::bench;
+
+
+namespace {
+
+
+    using Pos2 = math::Position<2, float>;
+
+
+    /// @brief A level whose border is walled, and with a fraction of the inner nodes walled too.
+    component::Level makeLevel(int aWidth, int aHeight, unsigned int aSeed, float aWallRatio = 0.25f)
+    {
+        std::mt19937 engine{aSeed};
+        std::bernoulli_distribution isWall{aWallRatio};
+
+        component::Level level;
+        level.mSize = math::Size<3, int>{aWidth, aHeight, 1};
+        for(int y = 0; y != aHeight; ++y)
+        {
+            for(int x = 0; x != aWidth; ++x)
+            {
+                const bool border = (x == 0 || y == 0 || x == aWidth - 1 || y == aHeight - 1);
+                level.mNodes.push_back(component::PathfindNode{
+                    .mIndex = (std::size_t)(x + y * aWidth),
+                    .mPos = Pos2{(float)x, (float)y},
+                    .mPathable = !border && !isWall(engine),
+                });
+            }
+        }
+        return level;
+    }
+
+
+    std::size_t indexOf(const component::Level & aLevel, Pos2 aPosition)
+    {
+        return (std::size_t)aPosition.x() + (std::size_t)aPosition.y() * aLevel.mSize.width();
+    }
+
+
+    /// @brief Reference distances (in steps) to `aTargetIndex`, -1 for unreachable nodes.
+    std::vector<int> referenceDistances(const component::Level & aLevel, std::size_t aTargetIndex)
+    {
+        const int width = aLevel.mSize.width();
+        std::vector<int> distances(aLevel.mNodes.size(), -1);
+        std::deque<std::size_t> queue{aTargetIndex};
+        distances[aTargetIndex] = 0;
+        while(!queue.empty())
+        {
+            const std::size_t current = queue.front();
+            queue.pop_front();
+            for(math::Vec<2, int> offset : gDirections)
+            {
+                const int x = (int)(current % width) + offset.x();
+                const int y = (int)(current / width) + offset.y();
+                if(x >= 0 && x < width && y >= 0 && y < aLevel.mSize.height())
+                {
+                    const std::size_t neighbour = x + y * width;
+                    if(aLevel.mNodes[neighbour].mPathable && distances[neighbour] == -1)
+                    {
+                        distances[neighbour] = distances[current] + 1;
+                        queue.push_back(neighbour);
+                    }
+                }
+            }
+        }
+        return distances;
+    }
+
+
+    std::vector<std::size_t> getPathableIndices(const component::Level & aLevel)
+    {
+        std::vector<std::size_t> result;
+        for(const component::PathfindNode & node : aLevel.mNodes)
+        {
+            if(node.mPathable)
+            {
+                result.push_back(node.mIndex);
+            }
+        }
+        return result;
+    }
+
+
+} // unnamed namespace
+
+
+SCENARIO("DistanceFieldCache agents follow shortest paths.")
+{
+    GIVEN("A level with walls, and agents on each pathable node.")
+    {
+        const component::Level level = makeLevel(21, 17, 5);
+        const std::vector<std::size_t> pathable = getPathableIndices(level);
+        system::DistanceFieldCache cache;
+
+        THEN("Following the next steps, each agent reaches its target in the shortest number of steps.")
+        {
+            std::mt19937 engine{7};
+            std::uniform_int_distribution<std::size_t> pick{0, pathable.size() - 1};
+            // More targets than the cache capacity, to exercise the eviction.
+            for(int targetIdx = 0; targetIdx != 20; ++targetIdx)
+            {
+                const std::size_t target = pathable[pick(engine)];
+                const std::vector<int> distances = referenceDistances(level, target);
+
+                for(std::size_t source : pathable)
+                {
+                    Pos2 position = level.mNodes[source].mPos;
+                    int steps = 0;
+                    while(indexOf(level, position) != target && steps <= (int)level.mNodes.size())
+                    {
+                        std::optional<Pos2> next = cache.getNextStep(level, position, target);
+                        if(!next)
+                        {
+                            break;
+                        }
+                        position = *next;
+                        ++steps;
+                    }
+
+                    if(distances[source] == -1)
+                    {
+                        CHECK_FALSE(cache.getNextStep(level, level.mNodes[source].mPos, target));
+                    }
+                    else
+                    {
+                        CHECK(steps == distances[source]);
+                    }
+                }
+            }
+        }
+
+        THEN("An agent between two nodes steps to the node closer to the target.")
+        {
+            const std::size_t target = pathable.front();
+            const std::vector<int> distances = referenceDistances(level, target);
+            for(std::size_t source : pathable)
+            {
+                const std::size_t right = source + 1;
+                if(distances[source] > 0 && level.mNodes[right].mPathable)
+                {
+                    const Pos2 between = level.mNodes[source].mPos + math::Vec<2, float>{0.4f, 0.f};
+                    std::optional<Pos2> next = cache.getNextStep(level, between, target);
+                    REQUIRE(next);
+                    // Never a step away from the target, and the direct step whenever it shortens the path.
+                    CHECK(distances[indexOf(level, *next)] <= distances[source]);
+                    if(distances[right] < distances[source])
+                    {
+                        CHECK(indexOf(level, *next) == right);
+                    }
+                }
+            }
+        }
+    }
+
+    GIVEN("Distance fields computed for a level.")
+    {
+        component::Level level = makeLevel(9, 3, 0, 0.f);
+        system::DistanceFieldCache cache;
+        const std::size_t source = 1 + 9;
+        const std::size_t target = 7 + 9;
+        REQUIRE(cache.getNextStep(level, level.mNodes[source].mPos, target));
+
+        WHEN("The path is blocked, and the navigation generation advanced.")
+        {
+            level.mNodes[4 + 9].mPathable = false;
+            ++level.mNavigationGeneration;
+
+            THEN("The fields are recomputed.")
+            {
+                CHECK_FALSE(cache.getNextStep(level, level.mNodes[source].mPos, target));
+            }
+        }
+    }
+}
+
+
+TEST_CASE("DistanceFieldCache and per agent A* with hundreds of agents.", "[.benchmark]")
+{
+    constexpr std::size_t ticks = 500;
+    constexpr std::size_t targetCount = 4;
+    // Targets (e.g. the players) change node every few ticks, requiring new distance fields.
+    constexpr std::size_t ticksPerTargetMove = 8;
+
+    const component::Level level = makeLevel(31, 31, 11);
+    const std::vector<std::size_t> pathable = getPathableIndices(level);
+
+    for(std::size_t agentCount : {100, 300, 1000})
+    {
+        std::mt19937 engine{13};
+        std::uniform_int_distribution<std::size_t> pick{0, pathable.size() - 1};
+        std::vector<std::size_t> agents(agentCount);
+        for(std::size_t & agent : agents)
+        {
+            agent = pathable[pick(engine)];
+        }
+        std::vector<std::size_t> targetSequence(ticks / ticksPerTargetMove * targetCount + targetCount);
+        for(std::size_t & target : targetSequence)
+        {
+            target = pathable[pick(engine)];
+        }
+        auto targetAt = [&](std::size_t aTick, std::size_t aAgentIdx)
+        {
+            return targetSequence[(aTick / ticksPerTargetMove) * targetCount + aAgentIdx % targetCount];
+        };
+
+        // The agents do not move, only the query cost is measured.
+        // Counting the found paths keeps the queries from being optimized away.
+        std::size_t found = 0;
+        {
+            system::DistanceFieldCache cache;
+            std::size_t tick = 0;
+            std::vector<bench::Clock::duration> durations = bench::sample(ticks, [&]()
+            {
+                for(std::size_t agentIdx = 0; agentIdx != agents.size(); ++agentIdx)
+                {
+                    const Pos2 source = level.mNodes[agents[agentIdx]].mPos + math::Vec<2, float>{0.25f, 0.f};
+                    found += cache.getNextStep(level, source, targetAt(tick, agentIdx)).has_value();
+                }
+                ++tick;
+            });
+            bench::report("Distance fields, " + std::to_string(agentCount) + " agents, tick", durations);
+        }
+
+        {
+            system::GridAStar astar;
+            std::vector<Pos2> path;
+            std::size_t tick = 0;
+            std::vector<bench::Clock::duration> durations = bench::sample(ticks, [&]()
+            {
+                for(std::size_t agentIdx = 0; agentIdx != agents.size(); ++agentIdx)
+                {
+                    const Pos2 source = level.mNodes[agents[agentIdx]].mPos + math::Vec<2, float>{0.25f, 0.f};
+                    found += astar.findPath(level, source, level.mNodes[targetAt(tick, agentIdx)].mPos, path);
+                }
+                ++tick;
+            });
+            bench::report("A* per agent, " + std::to_string(agentCount) + " agents, tick", durations);
+        }
+        CHECK(found > 0);
+    }
+}
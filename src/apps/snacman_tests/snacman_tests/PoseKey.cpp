@@ -0,0 +1,154 @@
+#include "catch.hpp"
+
+#include "RigFixture.h"
+
+#include <snac-renderer-V2/Rigging.h>
+
+#include <iterator>
+#include <unordered_map>
+#include <vector>
+
+
+using namespace ad;
+using namespace ad::renderer;
+using namespace ad::snac::fixture;
+
+
+namespace {
+
+
+    constexpr float gQuantum = PoseKey::gTimeQuantum;
+    constexpr float gTolerance = 1e-4f;
+
+
+    std::vector<Rig::Pose> computePalette(const AnimatedRig & aRig, const RigAnimation & aAnimation, float aTimepoint)
+    {
+        std::vector<Rig::Pose> palette;
+        aRig.mRig.computeJointMatrices(std::back_inserter(palette),
+                                       animate(aAnimation, aTimepoint, aRig.mRig.mJointTree));
+        return palette;
+    }
+
+
+} // unnamed namespace
+
+
+SCENARIO("Pose keys identify the shared poses of rig instances.")
+{
+    const AnimatedRig rig = makeAnimatedRig(12, 9, 7);
+    const RigAnimation & animation = rig.mNameToAnimation.at("anim");
+
+    GIVEN("The default pose, and an animation with a single keyframe.")
+    {
+        RigAnimation still = animation;
+        still.mTimepoints.resize(1);
+        for(RigAnimation::NodeKeyframes & keyframes : still.mKeyframes)
+        {
+            keyframes.mTranslations.resize(1);
+            keyframes.mRotations.resize(1);
+            keyframes.mScales.resize(1);
+        }
+
+        THEN("Their key is the same whatever the time.")
+        {
+            for(float timepoint : {0.f, 0.3f, 1.f, 12.5f, -2.f})
+            {
+                CHECK(makePoseKey(rig.mRig, nullptr, timepoint) == makePoseKey(rig.mRig, nullptr, 0.f));
+                CHECK(makePoseKey(rig.mRig, &still, timepoint) == makePoseKey(rig.mRig, &still, 0.f));
+            }
+        }
+
+        THEN("Their keys are distinct, and distinct from the animated poses.")
+        {
+            CHECK(makePoseKey(rig.mRig, nullptr, 0.f) != makePoseKey(rig.mRig, &still, 0.f));
+            CHECK(makePoseKey(rig.mRig, nullptr, 0.f) != makePoseKey(rig.mRig, &animation, 0.f));
+            CHECK(makePoseKey(rig.mRig, &still, 0.f) != makePoseKey(rig.mRig, &animation, 0.f));
+        }
+    }
+
+    GIVEN("Instances of an animation, at different timepoints.")
+    {
+        const float center = 100 * gQuantum;
+
+        THEN("Instances within the same quantum share a key, with the same hash.")
+        {
+            const PoseKey key = makePoseKey(rig.mRig, &animation, center);
+            for(float offset : {-0.4f * gQuantum, -0.1f * gQuantum, 0.f, 0.1f * gQuantum, 0.4f * gQuantum})
+            {
+                const PoseKey other = makePoseKey(rig.mRig, &animation, center + offset);
+                CHECK(other == key);
+                CHECK(std::hash<PoseKey>{}(other) == std::hash<PoseKey>{}(key));
+            }
+            CHECK(key.timepoint() == Approx(center));
+        }
+
+        THEN("Instances in distinct quanta do not share a key.")
+        {
+            CHECK(makePoseKey(rig.mRig, &animation, center)
+                  != makePoseKey(rig.mRig, &animation, center + gQuantum));
+            CHECK(makePoseKey(rig.mRig, &animation, center + 0.4f * gQuantum)
+                  != makePoseKey(rig.mRig, &animation, center + 0.6f * gQuantum));
+            CHECK(makePoseKey(rig.mRig, &animation, center)
+                  != makePoseKey(rig.mRig, &animation, center - gQuantum));
+        }
+
+        THEN("The same timepoint of another rig does not share the key.")
+        {
+            const AnimatedRig other = makeAnimatedRig(12, 9, 7);
+            CHECK(makePoseKey(rig.mRig, &animation, center)
+                  != makePoseKey(other.mRig, &other.mNameToAnimation.at("anim"), center));
+        }
+    }
+
+    GIVEN("Palettes deduplicated by pose key, as the renderer does.")
+    {
+        // Some instances fall in the same quantum, some in neighbouring quanta.
+        std::vector<float> timepoints{
+            0.f, 0.1f * gQuantum, 0.25f, 0.25f + 0.3f * gQuantum, 0.5f, 0.5f + 0.6f * gQuantum, 0.77f, 1.f,
+        };
+
+        std::unordered_map<PoseKey, std::size_t> poseToPaletteOffset;
+        std::vector<Rig::Pose> palettes;
+        std::vector<std::size_t> instanceOffsets;
+        for(float timepoint : timepoints)
+        {
+            const PoseKey key = makePoseKey(rig.mRig, &animation, timepoint);
+            auto [found, isNewPose] = poseToPaletteOffset.try_emplace(key, palettes.size());
+            if(isNewPose)
+            {
+                std::vector<Rig::Pose> palette = computePalette(rig, animation, key.timepoint());
+                palettes.insert(palettes.end(), palette.begin(), palette.end());
+            }
+            instanceOffsets.push_back(found->second);
+        }
+
+        THEN("Instances in the same quantum share a palette.")
+        {
+            CHECK(poseToPaletteOffset.size() == 6);
+            CHECK(instanceOffsets[0] == instanceOffsets[1]);
+            CHECK(instanceOffsets[2] == instanceOffsets[3]);
+            CHECK(instanceOffsets[4] != instanceOffsets[5]);
+        }
+
+        THEN("Each instance palette matches its own animation at the key timepoint.")
+        {
+            const std::size_t jointCount = rig.mRig.countJoints();
+            AnimationSampler sampler;
+            Rig::FuturePose_type posed;
+            for(std::size_t instanceIdx = 0; instanceIdx != timepoints.size(); ++instanceIdx)
+            {
+                const PoseKey key = makePoseKey(rig.mRig, &animation, timepoints[instanceIdx]);
+                animate(animation, key.timepoint(), rig.mRig.mJointTree, sampler, posed);
+                std::vector<Rig::Pose> expected;
+                rig.mRig.computeJointMatrices(std::back_inserter(expected), posed);
+
+                REQUIRE(expected.size() == jointCount);
+                for(std::size_t jointIdx = 0; jointIdx != jointCount; ++jointIdx)
+                {
+                    CHECK(maxDifference(palettes[instanceOffsets[instanceIdx] + jointIdx], expected[jointIdx])
+                          <= gTolerance);
+                }
+            }
+        }
+    }
+}
@@ -0,0 +1,316 @@
+#include "catch.hpp"
+
+#include "Benchmark.h"
+
+#include <snac-renderer-V2/GlStateTracker.h>
+#include <snac-renderer-V2/IntrospectProgram.h>
+#include <snac-renderer-V2/Model.h>
+#include <snac-renderer-V2/Pass.h>
+#include <snac-renderer-V2/Profiling.h>
+#include <snac-renderer-V2/SetupDrawing.h>
+
+#include <graphics/ApplicationGlfw.h>
+
+#include <algorithm>
+#include <array>
+#include <string>
+#include <vector>
+
+
+using namespace ad;
+using namespace ad::renderer;
+namespace bench = ad::snac::bench;
+
+
+namespace {
+
+
+    // All blocks and samplers are used, so none is optimized out of the program interfaces.
+    constexpr const char * gComputeShader = R"#(
+        #version 430
+
+        layout(local_size_x = 1) in;
+
+        layout(std140, binding = 0) uniform ViewProjectionBlock
+        {
+            mat4 u_ViewProjection;
+        };
+
+        layout(std140, binding = 1) uniform FrameBlock
+        {
+            float u_Time;
+        };
+
+        layout(std430, binding = 0) readonly buffer EntitiesBlock
+        {
+            vec4 in_Entities[];
+        };
+
+        layout(std430, binding = 1) readonly buffer MaterialsBlock
+        {
+            vec4 in_Materials[];
+        };
+
+        layout(std430, binding = 2) writeonly buffer OutputBlock
+        {
+            vec4 out_Values[];
+        };
+
+        uniform sampler2D u_DiffuseTexture;
+        uniform sampler2D u_NormalTexture;
+        uniform sampler2D u_ShadowMap;
+
+        void main()
+        {
+            uint i = gl_GlobalInvocationID.x;
+            out_Values[i] = u_ViewProjection * in_Entities[i]
+                + u_Time * in_Materials[i]
+                + textureLod(u_DiffuseTexture, vec2(0.), 0.)
+                + textureLod(u_NormalTexture, vec2(0.), 0.)
+                + textureLod(u_ShadowMap, vec2(0.), 0.);
+        }
+    )#";
+
+
+    IntrospectProgram makeProgram()
+    {
+        return IntrospectProgram{
+            {
+                {GL_COMPUTE_SHADER, graphics::ShaderSource::Preprocess(std::string{gComputeShader}, "ProgramBindings.cpp")},
+            },
+            "ProgramBindings.cpp"
+        };
+    }
+
+
+    /// @brief The repositories of a pass, the material contexts providing the materials and their textures.
+    struct Repositories
+    {
+        explicit Repositories(std::size_t aContextCount) :
+            mMaterials(aContextCount),
+            mContexts(aContextCount)
+        {
+            // Reserved, so the handles to the textures stay valid.
+            mDiffuseTextures.reserve(aContextCount);
+            mNormalTextures.reserve(aContextCount);
+            for(std::size_t contextIdx = 0; contextIdx != aContextCount; ++contextIdx)
+            {
+                mDiffuseTextures.emplace_back(GL_TEXTURE_2D);
+                mNormalTextures.emplace_back(GL_TEXTURE_2D);
+            }
+
+            mUbos = {
+                {"ViewProjection", &mViewProjection},
+                {"Frame", &mFrame},
+                {"Entities", &mEntities},
+                {"Output", &mOutput},
+            };
+            mTextures = {
+                {"ShadowMap", &mShadowMap},
+            };
+
+            for(std::size_t contextIdx = 0; contextIdx != aContextCount; ++contextIdx)
+            {
+                mContexts[contextIdx] = MaterialContext{
+                    .mUboRepo = {{"Materials", &mMaterials[contextIdx]}},
+                    .mTextureRepo = {
+                        {"DiffuseTexture", &mDiffuseTextures[contextIdx]},
+                        {"NormalTexture", &mNormalTextures[contextIdx]},
+                    },
+                };
+            }
+        }
+
+        graphics::BufferAny mViewProjection;
+        graphics::BufferAny mFrame;
+        graphics::BufferAny mEntities;
+        graphics::BufferAny mOutput;
+        std::vector<graphics::BufferAny> mMaterials;
+
+        graphics::Texture mShadowMap{GL_TEXTURE_2D};
+        std::vector<graphics::Texture> mDiffuseTextures;
+        std::vector<graphics::Texture> mNormalTextures;
+
+        RepositoryUbo mUbos;
+        RepositoryTexture mTextures;
+        std::vector<MaterialContext> mContexts;
+    };
+
+
+    GLint getIndexed(GLenum aBinding, GLuint aIndex)
+    {
+        GLint result;
+        glGetIntegeri_v(aBinding, aIndex, &result);
+        return result;
+    }
+
+
+    GLint getTexture2D(GLuint aTextureUnit)
+    {
+        GLint result;
+        glActiveTexture(GL_TEXTURE0 + aTextureUnit);
+        glGetIntegerv(GL_TEXTURE_BINDING_2D, &result);
+        return result;
+    }
+
+
+} // unnamed namespace
+
+
+// Requires an OpenGL 4.3 context (e.g. Mesa llvmpipe), exclude with the ~[gl] filter on headless machines.
+SCENARIO("Program bindings are resolved once from the repositories, then applied.", "[gl]")
+{
+    graphics::ApplicationGlfw glfwApp{"snacman_tests", 64, 64,
+                                      graphics::ApplicationFlag::None,
+                                      4, 3,
+                                      { {GLFW_VISIBLE, GLFW_FALSE} }};
+
+    Guard renderProfiler = ProfilerRegistry::ScopeNewProfiler(gRenderProfiler, Profiler::Providers::All);
+
+    const IntrospectProgram program = makeProgram();
+    Repositories repositories{2};
+
+    GIVEN("The bindings resolved for a material context.")
+    {
+        MaterialContext & context = repositories.mContexts[1];
+        ProgramBindings bindings;
+        resolveProgramRepositories(&context, repositories.mUbos, repositories.mTextures, program, bindings);
+
+        THEN("Each block and sampler is resolved, from the pass or the context repositories.")
+        {
+            CHECK(bindings.mProgram == (GLuint)program);
+            CHECK(bindings.mUniformBuffers.size() == 2);
+            CHECK(bindings.mStorageBuffers.size() == 3);
+            CHECK(bindings.mTextures.size() == 3);
+
+            auto materials = std::find_if(bindings.mStorageBuffers.begin(), bindings.mStorageBuffers.end(),
+                                          [](const auto & aBuffer){ return aBuffer.mBindingIndex == 1; });
+            REQUIRE(materials != bindings.mStorageBuffers.end());
+            CHECK(materials->mRange.mBuffer == (GLuint)repositories.mMaterials[1]);
+        }
+
+        WHEN("The same bindings are resolved again, for another material context.")
+        {
+            resolveProgramRepositories(&repositories.mContexts[0],
+                                       repositories.mUbos, repositories.mTextures, program, bindings);
+
+            THEN("They are replaced, not appended to.")
+            {
+                CHECK(bindings.mUniformBuffers.size() == 2);
+                CHECK(bindings.mStorageBuffers.size() == 3);
+                CHECK(bindings.mTextures.size() == 3);
+
+                auto materials = std::find_if(bindings.mStorageBuffers.begin(), bindings.mStorageBuffers.end(),
+                                              [](const auto & aBuffer){ return aBuffer.mBindingIndex == 1; });
+                REQUIRE(materials != bindings.mStorageBuffers.end());
+                CHECK(materials->mRange.mBuffer == (GLuint)repositories.mMaterials[0]);
+            }
+        }
+
+        WHEN("They are applied.")
+        {
+            GlStateTracker state;
+            applyBindings(bindings, state);
+
+            THEN("The GL state is the one set by setupProgramRepositories().")
+            {
+                std::array<GLint, 2> uniformBuffers{
+                    getIndexed(GL_UNIFORM_BUFFER_BINDING, 0),
+                    getIndexed(GL_UNIFORM_BUFFER_BINDING, 1),
+                };
+                std::array<GLint, 3> storageBuffers{
+                    getIndexed(GL_SHADER_STORAGE_BUFFER_BINDING, 0),
+                    getIndexed(GL_SHADER_STORAGE_BUFFER_BINDING, 1),
+                    getIndexed(GL_SHADER_STORAGE_BUFFER_BINDING, 2),
+                };
+                std::array<GLint, 3> textures{getTexture2D(0), getTexture2D(1), getTexture2D(2)};
+
+                CHECK(uniformBuffers[0] == (GLint)(GLuint)repositories.mViewProjection);
+                CHECK(storageBuffers[1] == (GLint)(GLuint)repositories.mMaterials[1]);
+
+                // Reset the bindings, then set them the per-call way.
+                for(GLuint index = 0; index != 3; ++index)
+                {
+                    glBindBufferBase(GL_UNIFORM_BUFFER, index, 0);
+                    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, index, 0);
+                    glActiveTexture(GL_TEXTURE0 + index);
+                    glBindTexture(GL_TEXTURE_2D, 0);
+                }
+                setupProgramRepositories(&context, repositories.mUbos, repositories.mTextures, program);
+
+                CHECK(uniformBuffers == decltype(uniformBuffers){
+                    getIndexed(GL_UNIFORM_BUFFER_BINDING, 0),
+                    getIndexed(GL_UNIFORM_BUFFER_BINDING, 1),
+                });
+                CHECK(storageBuffers == decltype(storageBuffers){
+                    getIndexed(GL_SHADER_STORAGE_BUFFER_BINDING, 0),
+                    getIndexed(GL_SHADER_STORAGE_BUFFER_BINDING, 1),
+                    getIndexed(GL_SHADER_STORAGE_BUFFER_BINDING, 2),
+                });
+                CHECK(textures == decltype(textures){getTexture2D(0), getTexture2D(1), getTexture2D(2)});
+                for(const ProgramBindings::Texture & texture : bindings.mTextures)
+                {
+                    GLint unit;
+                    glGetUniformiv(program, texture.mSamplerLocation, &unit);
+                    CHECK(unit == (GLint)texture.mTextureUnit);
+                }
+            }
+        }
+    }
+}
+
+
+TEST_CASE("Program bindings lookup per draw call, and resolved per run of draw calls.", "[.benchmark][gl]")
+{
+    constexpr std::size_t frames = 1000;
+    constexpr std::size_t contextCount = 16;
+    // Sorted draw calls: runs of calls sharing the program and the material context (differing by VAO).
+    constexpr std::size_t callsPerContext = 64;
+
+    graphics::ApplicationGlfw glfwApp{"snacman_tests", 64, 64,
+                                      graphics::ApplicationFlag::None,
+                                      4, 3,
+                                      { {GLFW_VISIBLE, GLFW_FALSE} }};
+    Guard renderProfiler = ProfilerRegistry::ScopeNewProfiler(gRenderProfiler, Profiler::Providers::All);
+
+    const IntrospectProgram program = makeProgram();
+    Repositories repositories{contextCount};
+
+    {
+        std::vector<bench::Clock::duration> durations = bench::sample(frames, [&]()
+        {
+            Guard profilerFrame = scopeProfilerFrame(gRenderProfiler);
+            GlStateTracker state;
+            for(MaterialContext & context : repositories.mContexts)
+            {
+                for(std::size_t callIdx = 0; callIdx != callsPerContext; ++callIdx)
+                {
+                    setupProgramRepositories(&context, repositories.mUbos, repositories.mTextures, program, state);
+                    state.useProgram(program);
+                }
+            }
+            state.restore();
+        });
+        bench::report("Lookup per call, 1024 calls", durations);
+    }
+
+    {
+        ProgramBindings bindings;
+        std::vector<bench::Clock::duration> durations = bench::sample(frames, [&]()
+        {
+            Guard profilerFrame = scopeProfilerFrame(gRenderProfiler);
+            GlStateTracker state;
+            for(MaterialContext & context : repositories.mContexts)
+            {
+                resolveProgramRepositories(&context, repositories.mUbos, repositories.mTextures, program, bindings);
+                applyBindings(bindings, state);
+                for(std::size_t callIdx = 0; callIdx != callsPerContext; ++callIdx)
+                {
+                    state.useProgram(program);
+                }
+            }
+            state.restore();
+        });
+        bench::report("Resolved per run, 1024 calls", durations);
+    }
+}
@@ -0,0 +1,126 @@
+#include "catch.hpp"
+
+#include <file-processor/Quantization.h>
+
+#include <limits>
+
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+
+
+using namespace ad;
+using namespace ad::renderer;
+
+
+namespace {
+
+
+    /// @brief Reference decoding of an IEEE 754 binary16.
+    float fromHalf(std::uint16_t aHalf)
+    {
+        const float sign = (aHalf & 0x8000u) ? -1.f : 1.f;
+        const int exponent = (aHalf >> 10) & 0x1f;
+        const int mantissa = aHalf & 0x3ff;
+        if(exponent == 0)
+        {
+            return sign * std::ldexp((float)mantissa, -24);
+        }
+        else if(exponent == 0x1f)
+        {
+            return mantissa == 0 ? sign * std::numeric_limits<float>::infinity()
+                                 : std::numeric_limits<float>::quiet_NaN();
+        }
+        return sign * std::ldexp((float)(mantissa | 0x400), exponent - 25);
+    }
+
+
+} // unnamed namespace
+
+
+SCENARIO("Vertex attributes are quantized to normalized integers.")
+{
+    THEN("Unsigned normalized values cover the whole integer range, and are clamped.")
+    {
+        CHECK(toUnorm8(0.f) == 0);
+        CHECK(toUnorm8(1.f) == 255);
+        CHECK(toUnorm8(0.5f) == 128);
+        CHECK(toUnorm8(-1.f) == 0);
+        CHECK(toUnorm8(2.f) == 255);
+
+        CHECK(toUnorm16(0.f) == 0);
+        CHECK(toUnorm16(1.f) == 65535);
+        CHECK(toUnorm16(0.25f) == 16384);
+    }
+
+    THEN("Signed normalized values use the symmetric range, and are clamped.")
+    {
+        CHECK(toSnorm16(0.f) == 0);
+        CHECK(toSnorm16(1.f) == 32767);
+        CHECK(toSnorm16(-1.f) == -32767);
+        CHECK(toSnorm16(-2.f) == -32767);
+        CHECK(toSnorm16(0.5f) == 16384);
+    }
+
+    THEN("Quantization errors are within half a step.")
+    {
+        for(float value = 0.f; value <= 1.f; value += 0.001f)
+        {
+            CHECK(std::abs(toUnorm16(value) / 65535.f - value) <= 0.5f / 65535.f + 1E-7f);
+            CHECK(std::abs(toSnorm16(2.f * value - 1.f) / 32767.f - (2.f * value - 1.f)) <= 0.5f / 32767.f + 1E-6f);
+        }
+    }
+}
+
+
+SCENARIO("Floats are converted to half-floats.")
+{
+    THEN("Known values are converted exactly.")
+    {
+        CHECK(toHalf(0.f) == 0x0000);
+        CHECK(toHalf(-0.f) == 0x8000);
+        CHECK(toHalf(1.f) == 0x3c00);
+        CHECK(toHalf(-2.f) == 0xc000);
+        CHECK(toHalf(0.5f) == 0x3800);
+        CHECK(toHalf(65504.f) == 0x7bff);
+        // Smallest subnormal
+        CHECK(toHalf(std::ldexp(1.f, -24)) == 0x0001);
+    }
+
+    THEN("Values are rounded to the nearest, ties to even.")
+    {
+        CHECK(toHalf(0.1f) == 0x2e66);
+        // 1 + 2^-11 is halfway between 1 and the next half, whose mantissa is odd.
+        CHECK(toHalf(1.f + std::ldexp(1.f, -11)) == 0x3c00);
+        // 1 + 3 * 2^-11 is halfway between two halves, the upper one being even.
+        CHECK(toHalf(1.f + 3.f * std::ldexp(1.f, -11)) == 0x3c02);
+        // Half the smallest subnormal rounds to zero (even).
+        CHECK(toHalf(std::ldexp(1.f, -25)) == 0x0000);
+        // The largest float still rounding to the largest half.
+        CHECK(toHalf(65519.f) == 0x7bff);
+    }
+
+    THEN("Out of range values become infinities, NaNs stay NaNs.")
+    {
+        CHECK(toHalf(65520.f) == 0x7c00);
+        CHECK(toHalf(-1E10f) == 0xfc00);
+        CHECK(toHalf(std::numeric_limits<float>::infinity()) == 0x7c00);
+        const std::uint16_t nan = toHalf(std::numeric_limits<float>::quiet_NaN());
+        CHECK((nan & 0x7c00) == 0x7c00);
+        CHECK((nan & 0x03ff) != 0);
+    }
+
+    THEN("Each half-float value is converted back to itself.")
+    {
+        std::size_t mismatches = 0;
+        for(std::uint32_t half = 0; half != 0x10000; ++half)
+        {
+            const float value = fromHalf((std::uint16_t)half);
+            if(!std::isnan(value) && toHalf(value) != half)
+            {
+                ++mismatches;
+            }
+        }
+        CHECK(mismatches == 0);
+    }
+}
@@ -0,0 +1,81 @@
+#include "catch.hpp"
+
+#include <snac-renderer-V2/utilities/ResourceIdMap.h>
+
+#include <array>
+#include <stdexcept>
+
+
+using namespace ad;
+using namespace ad::renderer;
+
+
+SCENARIO("Resources are associated to sequential values fitting in a draw sort key field.")
+{
+    std::array<int, 4> resources{};
+
+    GIVEN("A map for a 2 bits field.")
+    {
+        ResourceIdMap<int> idMap{2};
+
+        THEN("The null resource is the zero value.")
+        {
+            CHECK(idMap.get(nullptr) == 0);
+            CHECK(idMap.reverseLookup(0) == nullptr);
+        }
+
+        WHEN("Resources are mapped.")
+        {
+            const std::uint64_t first = idMap.get(&resources[0]);
+            const std::uint64_t second = idMap.get(&resources[1]);
+
+            THEN("They are assigned sequential values, stable on successive gets.")
+            {
+                CHECK(first == 1);
+                CHECK(second == 2);
+                CHECK(idMap.get(&resources[0]) == first);
+                CHECK(idMap.get(&resources[1]) == second);
+            }
+
+            THEN("The values are looked up back to the resources.")
+            {
+                CHECK(idMap.reverseLookup(first) == &resources[0]);
+                CHECK(idMap.reverseLookup(second) == &resources[1]);
+                CHECK_THROWS_AS(idMap.reverseLookup(3), std::logic_error);
+            }
+
+            THEN("Resources beyond the field maximal value are rejected, without altering the map.")
+            {
+                CHECK(idMap.get(&resources[2]) == 3);
+                CHECK_THROWS_AS(idMap.get(&resources[3]), std::overflow_error);
+                CHECK_THROWS_AS(idMap.reverseLookup(4), std::logic_error);
+                CHECK_THROWS_AS(idMap.get(&resources[3]), std::overflow_error);
+                CHECK(idMap.get(&resources[2]) == 3);
+            }
+
+            WHEN("The map is cleared.")
+            {
+                idMap.clear();
+
+                THEN("Only the null resource remains, and values are reassigned from the start.")
+                {
+                    CHECK_THROWS_AS(idMap.reverseLookup(1), std::logic_error);
+                    CHECK(idMap.get(&resources[3]) == 1);
+                    CHECK(idMap.reverseLookup(1) == &resources[3]);
+                    CHECK(idMap.get(nullptr) == 0);
+                }
+            }
+        }
+    }
+
+    GIVEN("A map for a 64 bits field.")
+    {
+        ResourceIdMap<int> idMap{64};
+
+        THEN("The whole value range is available.")
+        {
+            CHECK(idMap.mMaxValue == ~std::uint64_t{0});
+            CHECK(idMap.get(&resources[0]) == 1);
+        }
+    }
+}
@@ -0,0 +1,265 @@
+#include "catch.hpp"
+
+#include "Benchmark.h"
+#include "RigFixture.h"
+
+#include <snac-renderer-V2/Json.h>
+#include <snac-renderer-V2/Profiling.h>
+#include <snac-renderer-V2/Rigging.h>
+
+#include <snac-renderer-V2/files/Loader.h>
+#include <snac-renderer-V2/graph/RigAnimationCompute.h>
+
+#include <graphics/ApplicationGlfw.h>
+
+#include <platform/Path.h>
+
+#include <renderer/ScopeGuards.h>
+#include <renderer/VertexSpecification.h>
+
+#include <resource/ResourceFinder.h>
+
+#include <algorithm>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+#include <cmath>
+
+
+using namespace ad;
+using namespace ad::renderer;
+using namespace ad::snac::fixture;
+namespace bench = ad::snac::bench;
+
+
+namespace {
+
+
+    // The GPU evaluates the poses in single precision with its own slerp and matrix products,
+    // the difference accumulates along the hierarchy.
+    constexpr float gTolerance = 1e-3f;
+
+
+    /// @brief The renderer resources (for the compute program) are listed in the assets.json generated by CMake.
+    resource::ResourceFinder makeResourceFinder()
+    {
+        filesystem::path assetConfig = platform::getExecutableFileDirectory() / "assets.json";
+        Json config = Json::parse(std::ifstream{assetConfig});
+        std::vector<std::string> prefixes{
+            config.at("prefixes").begin(),
+            config.at("prefixes").end()
+        };
+        return resource::ResourceFinder(prefixes.begin(), prefixes.end());
+    }
+
+
+    /// @brief Read back the `aCount` first matrices of a palette buffer written by RigAnimationCompute::dispatch().
+    std::vector<Rig::Pose> readPalettes(const graphics::BufferAny & aPalettes, std::size_t aCount)
+    {
+        // dispatch() only makes the writes visible to shader storage blocks.
+        glMemoryBarrier(GL_BUFFER_UPDATE_BARRIER_BIT);
+
+        std::vector<Rig::Pose> result(aCount);
+        graphics::ScopedBind bound{aPalettes, graphics::BufferType::Array};
+        glGetBufferSubData(GL_ARRAY_BUFFER, 0, aCount * sizeof(Rig::Pose), result.data());
+        return result;
+    }
+
+
+    /// @brief The palette computed on the CPU, as in the skinning jobs of the snacgame renderer.
+    Rig::MatrixPalette computeExpectedPalette(const Rig & aRig, const RigAnimation * aAnimation, float aTimepoint)
+    {
+        if(aAnimation == nullptr)
+        {
+            return aRig.computeJointMatrices(aRig.mJointTree);
+        }
+        return aRig.computeJointMatrices(animate(*aAnimation, aTimepoint, aRig.mJointTree));
+    }
+
+
+    struct Instance
+    {
+        const AnimatedRig * mRig;
+        // Null for the rig default pose.
+        const RigAnimation * mAnimation;
+        float mTimepoint;
+    };
+
+
+    /// @brief Animates instances on the GPU, and compares their palettes with the CPU palettes.
+    struct Animator
+    {
+        /// @return The largest difference between a GPU palette matrix and its CPU counterpart.
+        float dispatchAndCompare(const std::vector<Instance> & aInstances)
+        {
+            std::vector<RigAnimationCompute::AnimatedInstance> animated;
+            std::vector<Rig::Pose> expected;
+            for(const Instance & instance : aInstances)
+            {
+                animated.push_back(RigAnimationCompute::AnimatedInstance{
+                    .mAnimation = mCompute.getAnimationId(instance.mRig->mRig, instance.mAnimation),
+                    .mTimepoint = instance.mTimepoint,
+                    .mPaletteOffset = (GLuint)expected.size(),
+                });
+                Rig::MatrixPalette palette =
+                    computeExpectedPalette(instance.mRig->mRig, instance.mAnimation, instance.mTimepoint);
+                expected.insert(expected.end(), palette.begin(), palette.end());
+            }
+
+            {
+                Guard frame = scopeProfilerFrame(gRenderProfiler);
+                mCompute.dispatch(animated, expected.size(), mPalettes);
+            }
+
+            const std::vector<Rig::Pose> palettes = readPalettes(mPalettes, expected.size());
+            float result = 0.f;
+            for(std::size_t matrixIdx = 0; matrixIdx != expected.size(); ++matrixIdx)
+            {
+                result = std::max(result, maxDifference(palettes[matrixIdx], expected[matrixIdx]));
+            }
+            return result;
+        }
+
+        RigAnimationCompute mCompute;
+        graphics::BufferAny mPalettes;
+    };
+
+
+} // unnamed namespace
+
+
+// Requires an OpenGL 4.3 context (e.g. Mesa llvmpipe), exclude with the ~[gl] filter on headless machines.
+SCENARIO("RigAnimationCompute palettes match animate() and computeJointMatrices().", "[gl]")
+{
+    graphics::ApplicationGlfw glfwApp{"snacman_tests", 64, 64,
+                                      graphics::ApplicationFlag::None,
+                                      4, 3,
+                                      { {GLFW_VISIBLE, GLFW_FALSE} }};
+    // dispatch() profiles the GPU time, which requires the context.
+    Guard renderProfiler = ProfilerRegistry::ScopeNewProfiler(gRenderProfiler, Profiler::Providers::All);
+
+    Loader loader{.mFinder = makeResourceFinder()};
+    Animator animator{.mCompute{loader}};
+
+    GIVEN("Rigs smaller and larger than the compute work group.")
+    {
+        // Several rigs are packed in the same storage buffers.
+        const AnimatedRig small = makeAnimatedRig(24, 9, 3);
+        const AnimatedRig medium = makeAnimatedRig(40, 30, 4);
+        // More nodes than invocations in the work group, with deeper hierarchies.
+        const AnimatedRig large = makeAnimatedRig(150, 12, 6);
+
+        std::vector<Instance> instances;
+        for(const AnimatedRig * rig : {&small, &medium, &large})
+        {
+            const RigAnimation & animation = rig->mNameToAnimation.at("anim");
+            instances.push_back({rig, nullptr, 0.f});
+            // Before the first keyframe, in between and exactly on keyframes, and after the last keyframe.
+            for(float timepoint : {-0.1f, 0.f, 0.37f, animation.mTimepoints[3], 0.999f, 1.f, 1.2f})
+            {
+                instances.push_back({rig, &animation, timepoint});
+            }
+        }
+
+        THEN("The GPU palettes match the CPU palettes, for animated instances and default poses.")
+        {
+            CHECK(animator.dispatchAndCompare(instances) <= gTolerance);
+        }
+
+        WHEN("The instances were already dispatched.")
+        {
+            animator.dispatchAndCompare(instances);
+
+            THEN("Dispatching at other times, with the packed data already loaded, matches too.")
+            {
+                for(Instance & instance : instances)
+                {
+                    instance.mTimepoint += 0.13f;
+                }
+                CHECK(animator.dispatchAndCompare(instances) <= gTolerance);
+                CHECK(animator.mCompute.mAnimations.size() == 6);
+            }
+
+            THEN("Dispatching a subset of the instances matches.")
+            {
+                instances.erase(instances.begin(), instances.begin() + 5);
+                CHECK(animator.dispatchAndCompare(instances) <= gTolerance);
+            }
+        }
+    }
+}
+
+
+TEST_CASE("RigAnimationCompute and CPU animation frame duration.", "[.benchmark][gl]")
+{
+    constexpr std::size_t frames = 600;
+    constexpr std::size_t instanceCount = 100;
+    constexpr float frameDuration = 1.f / 60.f;
+
+    graphics::ApplicationGlfw glfwApp{"snacman_tests", 64, 64,
+                                      graphics::ApplicationFlag::None,
+                                      4, 3,
+                                      { {GLFW_VISIBLE, GLFW_FALSE} }};
+    Guard renderProfiler = ProfilerRegistry::ScopeNewProfiler(gRenderProfiler, Profiler::Providers::All);
+
+    const AnimatedRig rig = makeAnimatedRig(60, 30, 5);
+    const RigAnimation & animation = rig.mNameToAnimation.at("anim");
+    const std::size_t paletteSize = instanceCount * rig.mRig.countJoints();
+
+    auto instanceTime = [&](std::size_t aFrame, std::size_t aInstance)
+    {
+        return std::fmod(aFrame * frameDuration + aInstance * 0.037f, animation.mDuration);
+    };
+
+    // The CPU palettes are uploaded, as the GPU palettes are then available to the skinning shaders.
+    {
+        std::vector<AnimationSampler> samplers(instanceCount);
+        Rig::FuturePose_type posed;
+        std::vector<Rig::Pose> palettes;
+        palettes.reserve(paletteSize);
+        graphics::BufferAny paletteBuffer;
+        std::size_t frame = 0;
+        std::vector<bench::Clock::duration> durations = bench::sample(frames, [&]()
+        {
+            palettes.clear();
+            for(std::size_t instance = 0; instance != instanceCount; ++instance)
+            {
+                animate(animation, instanceTime(frame, instance), rig.mRig.mJointTree, samplers[instance], posed);
+                rig.mRig.computeJointMatrices(std::back_inserter(palettes), posed);
+            }
+            graphics::ScopedBind bound{paletteBuffer, graphics::BufferType::Array};
+            glBufferData(GL_ARRAY_BUFFER, palettes.size() * sizeof(Rig::Pose), palettes.data(), GL_STREAM_DRAW);
+            glFinish();
+            ++frame;
+        });
+        bench::report("CPU animation and upload, 100 instances", durations);
+    }
+
+    {
+        Loader loader{.mFinder = makeResourceFinder()};
+        RigAnimationCompute compute{loader};
+        const GLuint animationId = compute.getAnimationId(rig.mRig, &animation);
+        std::vector<RigAnimationCompute::AnimatedInstance> instances(instanceCount);
+        graphics::BufferAny paletteBuffer;
+        std::size_t frame = 0;
+        std::vector<bench::Clock::duration> durations = bench::sample(frames, [&]()
+        {
+            Guard profilerFrame = scopeProfilerFrame(gRenderProfiler);
+            for(std::size_t instance = 0; instance != instanceCount; ++instance)
+            {
+                instances[instance] = {
+                    .mAnimation = animationId,
+                    .mTimepoint = instanceTime(frame, instance),
+                    .mPaletteOffset = (GLuint)(instance * rig.mRig.countJoints()),
+                };
+            }
+            compute.dispatch(instances, paletteSize, paletteBuffer);
+            // Measures the GPU execution too (on llvmpipe, it runs on the CPU).
+            glFinish();
+            ++frame;
+        });
+        bench::report("RigAnimationCompute, 100 instances", durations);
+    }
+}
@@ -0,0 +1,122 @@
+#pragma once
+
+
+#include <snac-renderer-V2/Rigging.h>
+
+#include <math/Angle.h>
+#include <math/Transformations.h>
+
+#include <algorithm>
+#include <random>
+
+#include <cmath>
+#include <cstddef>
+
+
+// Synthetic rigs and animations, for the tests of skeletal animation.
+namespace ad::snac::fixture {
+
+
+using Pose = renderer::Rig::Pose;
+using NodeIndex = renderer::NodeTree<Pose>::Node::Index;
+
+
+struct Trs
+{
+    math::Vec<3, float> mTranslation;
+    math::Quaternion<float> mRotation;
+    math::Vec<3, float> mScale;
+};
+
+
+inline Trs randomTrs(std::mt19937 & aEngine)
+{
+    std::uniform_real_distribution<float> offset{-1.f, 1.f};
+    std::uniform_real_distribution<float> scale{0.8f, 1.25f};
+    std::uniform_real_distribution<float> turn{0.f, 1.f};
+    return Trs{
+        .mTranslation = {offset(aEngine), offset(aEngine), offset(aEngine)},
+        .mRotation = math::Quaternion<float>{
+            math::UnitVec<3, float>{{offset(aEngine), offset(aEngine), offset(aEngine) + 2.f}},
+            math::Turn<float>{turn(aEngine)}},
+        .mScale = {scale(aEngine), scale(aEngine), scale(aEngine)},
+    };
+}
+
+
+/// @brief The pose composed as in renderer::animate(): scale, then rotate, then translate (row vectors).
+inline Pose toPose(const Trs & aTrs)
+{
+    return math::trans3d::scale(aTrs.mScale.as<math::Size>())
+           * aTrs.mRotation.toRotationMatrix()
+           * math::trans3d::translate(aTrs.mTranslation);
+}
+
+
+/// @brief An animated rig with `aNodeCount` nodes, each node being a joint apart from the root.
+///
+/// Each node is parented to a random preceding node. The animation `"anim"` has `aKeyframeCount` evenly
+/// spaced keyframes, and animates all the joints but every fourth one, which keep their rig local pose.
+inline renderer::AnimatedRig makeAnimatedRig(std::size_t aNodeCount, std::size_t aKeyframeCount, unsigned int aSeed)
+{
+    std::mt19937 engine{aSeed};
+
+    renderer::AnimatedRig result;
+    renderer::Rig & rig = result.mRig;
+    rig.mArmatureName = "fixture";
+    rig.mJointTree.reserve(aNodeCount);
+    rig.mJointTree.mFirstRoot =
+        rig.mJointTree.addNode(renderer::NodeTree<Pose>::Node::gInvalidIndex, toPose(randomTrs(engine)));
+    for(std::size_t nodeIdx = 1; nodeIdx < aNodeCount; ++nodeIdx)
+    {
+        std::uniform_int_distribution<NodeIndex> parent{0, nodeIdx - 1};
+        rig.mJointTree.addNode(parent(engine), toPose(randomTrs(engine)));
+        rig.mJoints.mIndices.push_back(nodeIdx);
+        rig.mJoints.mInverseBindMatrices.push_back(toPose(randomTrs(engine)));
+    }
+
+    renderer::RigAnimation & animation = result.mNameToAnimation["anim"];
+    animation.mName = "anim";
+    animation.mDuration = 1.f;
+    for(std::size_t keyframeIdx = 0; keyframeIdx != aKeyframeCount; ++keyframeIdx)
+    {
+        animation.mTimepoints.push_back(animation.mDuration * keyframeIdx / (aKeyframeCount - 1));
+    }
+    for(std::size_t nodeIdx = 1; nodeIdx < aNodeCount; ++nodeIdx)
+    {
+        if(nodeIdx % 4 != 0)
+        {
+            animation.mNodes.push_back(nodeIdx);
+            renderer::RigAnimation::NodeKeyframes & keyframes = animation.mKeyframes.emplace_back();
+            keyframes.reserve(aKeyframeCount);
+            for(std::size_t keyframeIdx = 0; keyframeIdx != aKeyframeCount; ++keyframeIdx)
+            {
+                Trs trs = randomTrs(engine);
+                keyframes.mTranslations.push_back(trs.mTranslation);
+                keyframes.mRotations.push_back(trs.mRotation);
+                keyframes.mScales.push_back(trs.mScale);
+            }
+        }
+    }
+
+    return result;
+}
+
+
+/// @brief Largest absolute difference between the elements of two matrices.
+template <class T_matrix>
+float maxDifference(const T_matrix & aLhs, const T_matrix & aRhs)
+{
+    float result = 0.f;
+    for(std::size_t row = 0; row != 4; ++row)
+    {
+        for(std::size_t column = 0; column != 4; ++column)
+        {
+            result = std::max(result, std::abs(aLhs.at(row, column) - aRhs.at(row, column)));
+        }
+    }
+    return result;
+}
+
+
+} // namespace ad::snac::fixture
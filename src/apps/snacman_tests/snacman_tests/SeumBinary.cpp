@@ -0,0 +1,241 @@
+#include "catch.hpp"
+
+#include "Benchmark.h"
+
+#include <snac-renderer-V2/Model.h>
+#include <snac-renderer-V2/Profiling.h>
+
+#include <snac-renderer-V2/files/Loader.h>
+#include <snac-renderer-V2/files/Versioning.h>
+
+#include <graphics/ApplicationGlfw.h>
+
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <variant>
+#include <vector>
+
+#include <cstdint>
+
+
+using namespace ad;
+using namespace ad::renderer;
+namespace bench = ad::snac::bench;
+
+
+namespace {
+
+
+    /// @brief Raw bytes of a (possibly invalid) binary, written with the layout of the file-processor.
+    struct SeumBytes
+    {
+        template <class T>
+        SeumBytes & write(const T & aValue)
+        {
+            mBytes.append(reinterpret_cast<const char *>(&aValue), sizeof(T));
+            return *this;
+        }
+
+        /// @brief Write the bytes to a .seum file in the temporary directory, returning its path.
+        std::filesystem::path save(const std::string & aStem) const
+        {
+            std::filesystem::path path = std::filesystem::temp_directory_path() / (aStem + ".seum");
+            std::ofstream{path, std::ios::binary}.write(mBytes.data(), mBytes.size());
+            return path;
+        }
+
+        std::string mBytes;
+    };
+
+
+    // Magic, version and table of contents.
+    constexpr std::uint64_t gHeaderSize =
+        sizeof(gSeumMagic) + sizeof(gSeumVersion) + sizeof(SeumTableOfContents);
+
+
+    SeumBytes makeHeader(const SeumTableOfContents & aTableOfContents)
+    {
+        SeumBytes result;
+        result.write(gSeumMagic).write(gSeumVersion).write(aTableOfContents);
+        return result;
+    }
+
+
+    /// @brief The error code returned by prepareBinary(), or NoError if it succeeded.
+    SeumErrorCode prepareError(const std::filesystem::path & aBinaryFile)
+    {
+        std::variant<PreparedBinary, SeumErrorCode> prepared = prepareBinary(aBinaryFile);
+        if(const SeumErrorCode * errorCode = std::get_if<SeumErrorCode>(&prepared))
+        {
+            return *errorCode;
+        }
+        return SeumErrorCode::NoError;
+    }
+
+
+} // unnamed namespace
+
+
+SCENARIO("Truncated or corrupted binaries are rejected with an error code.")
+{
+    GIVEN("A binary whose table of contents is cut.")
+    {
+        SeumBytes bytes;
+        bytes.write(gSeumMagic).write(gSeumVersion).write(SeumSection{});
+        const std::filesystem::path binary = bytes.save("snacman_tests_cut_toc");
+
+        THEN("Preparing it returns TruncatedData.")
+        {
+            CHECK(prepareError(binary) == SeumErrorCode::TruncatedData);
+        }
+        std::filesystem::remove(binary);
+    }
+
+    GIVEN("A binary whose table of contents has a section past the end of the file.")
+    {
+        const std::filesystem::path binary = makeHeader(SeumTableOfContents{
+            .mNodes{.mOffset = gHeaderSize, .mSize = 1024},
+            .mAnimations{.mOffset = gHeaderSize, .mSize = 0},
+            .mMaterials{.mOffset = gHeaderSize, .mSize = 0},
+        }).save("snacman_tests_section_overflow");
+
+        THEN("Preparing it returns TruncatedData.")
+        {
+            CHECK(prepareError(binary) == SeumErrorCode::TruncatedData);
+        }
+        std::filesystem::remove(binary);
+    }
+
+    GIVEN("A binary whose materials count exceeds its materials section.")
+    {
+        SeumBytes bytes = makeHeader(SeumTableOfContents{
+            .mNodes{.mOffset = gHeaderSize, .mSize = 0},
+            .mAnimations{.mOffset = gHeaderSize, .mSize = 0},
+            .mMaterials{.mOffset = gHeaderSize, .mSize = sizeof(unsigned int)},
+        });
+        bytes.write(1000u);
+        const std::filesystem::path binary = bytes.save("snacman_tests_materials_overflow");
+
+        THEN("Preparing it returns TruncatedData, instead of reading past the mapping.")
+        {
+            CHECK(prepareError(binary) == SeumErrorCode::TruncatedData);
+        }
+        std::filesystem::remove(binary);
+    }
+
+    GIVEN("A binary with a wrong magic preamble.")
+    {
+        SeumBytes bytes;
+        bytes.write(std::uint16_t{0xBAD}).write(gSeumVersion);
+        const std::filesystem::path binary = bytes.save("snacman_tests_bad_magic");
+
+        THEN("Preparing it returns InvalidMagicPreamble.")
+        {
+            CHECK(prepareError(binary) == SeumErrorCode::InvalidMagicPreamble);
+        }
+        std::filesystem::remove(binary);
+    }
+
+    GIVEN("A binary older than the oldest supported version.")
+    {
+        SeumBytes bytes;
+        bytes.write(gSeumMagic).write(std::uint32_t{gSeumOldestSupportedVersion - 1});
+        const std::filesystem::path binary = bytes.save("snacman_tests_outdated");
+
+        THEN("Preparing it returns OutdatedVersion.")
+        {
+            CHECK(prepareError(binary) == SeumErrorCode::OutdatedVersion);
+        }
+        std::filesystem::remove(binary);
+    }
+
+    GIVEN("A binary more recent than the current version.")
+    {
+        SeumBytes bytes;
+        bytes.write(gSeumMagic).write(std::uint32_t{gSeumVersion + 1});
+        const std::filesystem::path binary = bytes.save("snacman_tests_newer");
+
+        THEN("Preparing it returns UnknownVersion.")
+        {
+            CHECK(prepareError(binary) == SeumErrorCode::UnknownVersion);
+        }
+        std::filesystem::remove(binary);
+    }
+}
+
+
+// The binary is taken from the SNACMAN_TESTS_SEUM environment variable (e.g. a level model from snac-assets).
+// The peak RSS never decreases, so each section should run in its own process, e.g.
+// `snacman_tests "Binary load duration and peak resident memory." -c "loadBinary() and uploads"`
+TEST_CASE("Binary load duration and peak resident memory.", "[.benchmark][gl]")
+{
+    const char * seumVariable = std::getenv("SNACMAN_TESTS_SEUM");
+    if(seumVariable == nullptr)
+    {
+        WARN("SNACMAN_TESTS_SEUM is not set, skipping the binary load benchmark.");
+        return;
+    }
+    const std::filesystem::path binary{seumVariable};
+    REQUIRE(std::filesystem::exists(binary));
+
+    constexpr std::size_t repetitions = 20;
+
+    graphics::ApplicationGlfw glfwApp{"snacman_tests", 64, 64,
+                                      graphics::ApplicationFlag::None,
+                                      4, 3,
+                                      { {GLFW_VISIBLE, GLFW_FALSE} }};
+    // loadBinary() profiles the uploads.
+    Guard renderProfiler = ProfilerRegistry::ScopeNewProfiler(gRenderProfiler, Profiler::Providers::All);
+
+    std::cout << binary.filename().string() << ": "
+              << std::filesystem::file_size(binary) / (1024. * 1024.) << " MiB\n";
+
+    const std::size_t peakBefore = bench::getPeakResidentBytes();
+
+    SECTION("prepareBinary()")
+    {
+        // Maps the file, loading its pages, and decodes the textures.
+        std::vector<bench::Clock::duration> durations = bench::sample(repetitions, [&]()
+        {
+            REQUIRE(std::holds_alternative<PreparedBinary>(prepareBinary(binary)));
+        });
+        bench::report("prepareBinary()", durations);
+        bench::reportPeakGrowth("prepareBinary()", peakBefore, bench::getPeakResidentBytes());
+    }
+
+    SECTION("loadBinary() and uploads")
+    {
+        std::vector<bench::Clock::duration> durations;
+        for(std::size_t repetition = 0; repetition != repetitions; ++repetition)
+        {
+            // A fresh storage for each repetition, releasing the GL objects of the previous one.
+            Storage storage;
+            const GenericStream instanceStream = makeInstanceStream(storage, 1);
+            const bench::Clock::time_point begin = bench::Clock::now();
+            REQUIRE(std::holds_alternative<Node>(loadBinary(binary, storage, nullptr, instanceStream)));
+            // Includes the completion of the uploads.
+            glFinish();
+            durations.push_back(bench::Clock::now() - begin);
+        }
+        bench::report("loadBinary() and uploads", durations);
+        bench::reportPeakGrowth("loadBinary() and uploads", peakBefore, bench::getPeakResidentBytes());
+    }
+
+    SECTION("Heap copy of the file (reference)")
+    {
+        // What a loader copying the file to the heap holds, before any upload.
+        std::size_t readBytes = 0;
+        std::vector<bench::Clock::duration> durations = bench::sample(repetitions, [&]()
+        {
+            std::ifstream in{binary, std::ios::binary};
+            const std::string content{std::istreambuf_iterator<char>{in}, std::istreambuf_iterator<char>{}};
+            readBytes += content.size();
+        });
+        CHECK(readBytes == repetitions * std::filesystem::file_size(binary));
+        bench::report("Heap copy of the file (reference)", durations);
+        bench::reportPeakGrowth("Heap copy of the file (reference)", peakBefore, bench::getPeakResidentBytes());
+    }
+}
@@ -0,0 +1,153 @@
+#include "catch.hpp"
+
+#include <snac-renderer-V2/GlStateTracker.h>
+#include <snac-renderer-V2/IntrospectProgram.h>
+#include <snac-renderer-V2/SetupDrawing.h>
+
+#include <graphics/ApplicationGlfw.h>
+
+#include <renderer/ScopeGuards.h>
+
+#include <algorithm>
+#include <numeric>
+#include <vector>
+
+#include <cstdint>
+
+
+using namespace ad;
+using namespace ad::renderer;
+
+
+namespace {
+
+
+    // Unsized arrays, so the element count is only bounded by the bound buffer range.
+    // The uniform block shares binding 1 with a storage block, since their binding points are distinct.
+    constexpr const char * gComputeShader = R"#(
+        #version 430
+
+        layout(local_size_x = 1) in;
+
+        layout(std140, binding = 1) uniform OffsetBlock
+        {
+            uint u_Offset;
+        };
+
+        layout(std430, binding = 1) readonly buffer SourceBlock
+        {
+            uint in_Values[];
+        };
+
+        layout(std430, binding = 2) writeonly buffer DestinationBlock
+        {
+            uint out_Values[];
+        };
+
+        void main()
+        {
+            out_Values[gl_GlobalInvocationID.x] = in_Values[gl_GlobalInvocationID.x] + u_Offset;
+        }
+    )#";
+
+
+    template <class T_value>
+    void loadBuffer(const graphics::BufferAny & aBuffer, const std::vector<T_value> & aValues)
+    {
+        graphics::ScopedBind bound{aBuffer, graphics::BufferType::Array};
+        glBufferData(GL_ARRAY_BUFFER, aValues.size() * sizeof(T_value), aValues.data(), GL_STATIC_DRAW);
+    }
+
+
+    const IntrospectProgram::ShaderStorageBlock * findBlock(const IntrospectProgram & aProgram,
+                                                            BlockSemantic aSemantic)
+    {
+        auto found = std::find_if(aProgram.mShaderStorageBlocks.begin(), aProgram.mShaderStorageBlocks.end(),
+                                  [aSemantic](const auto & aBlock){ return aBlock.mSemantic == aSemantic; });
+        return found != aProgram.mShaderStorageBlocks.end() ? &*found : nullptr;
+    }
+
+
+} // unnamed namespace
+
+
+// Requires an OpenGL 4.3 context (e.g. Mesa llvmpipe), exclude with the ~[gl] filter on headless machines.
+SCENARIO("Shader storage blocks are introspected and bound from the buffer repository.", "[gl]")
+{
+    graphics::ApplicationGlfw glfwApp{"snacman_tests", 64, 64,
+                                      graphics::ApplicationFlag::None,
+                                      4, 4,
+                                      { {GLFW_VISIBLE, GLFW_FALSE} }};
+
+    IntrospectProgram program{
+        {
+            {GL_COMPUTE_SHADER, graphics::ShaderSource::Preprocess(std::string{gComputeShader}, "ShaderStorageBlocks.cpp")},
+        },
+        "ShaderStorageBlocks.cpp"
+    };
+
+    GIVEN("A compute program with a uniform block and two shader storage blocks.")
+    {
+        THEN("Storage blocks are listed with their semantic and binding index, apart from uniform blocks.")
+        {
+            REQUIRE(program.mUniformBlocks.size() == 1);
+            CHECK(program.mUniformBlocks[0].mSemantic == BlockSemantic{"Offset"});
+            CHECK((GLuint)program.mUniformBlocks[0].mBindingIndex == 1);
+
+            REQUIRE(program.mShaderStorageBlocks.size() == 2);
+            const IntrospectProgram::ShaderStorageBlock * source = findBlock(program, BlockSemantic{"Source"});
+            const IntrospectProgram::ShaderStorageBlock * destination = findBlock(program, BlockSemantic{"Destination"});
+            REQUIRE(source != nullptr);
+            REQUIRE(destination != nullptr);
+            CHECK((GLuint)source->mBindingIndex == 1);
+            CHECK((GLuint)destination->mBindingIndex == 2);
+        }
+    }
+
+    GIVEN("Buffers in the repository, for each block semantic.")
+    {
+        // More elements than the 16KB guaranteed for a uniform block, which the storage blocks replaced.
+        constexpr std::size_t count = 8192;
+        constexpr std::uint32_t offset = 1000;
+
+        std::vector<std::uint32_t> values(count);
+        std::iota(values.begin(), values.end(), 0u);
+        graphics::BufferAny sourceBuffer;
+        loadBuffer(sourceBuffer, values);
+
+        graphics::BufferAny destinationBuffer;
+        loadBuffer(destinationBuffer, std::vector<std::uint32_t>(count, 0));
+
+        graphics::BufferAny offsetBuffer;
+        loadBuffer(offsetBuffer, std::vector<std::uint32_t>{offset, 0, 0, 0});
+
+        RepositoryUbo repository;
+        repository[BlockSemantic{"Offset"}] = BufferRange{offsetBuffer, 0, 0};
+        repository[BlockSemantic{"Source"}] = BufferRange{sourceBuffer, 0, 0};
+        // A range, the first half of the destination buffer.
+        repository[BlockSemantic{"Destination"}] =
+            BufferRange{destinationBuffer, 0, (GLsizeiptr)(count / 2 * sizeof(std::uint32_t))};
+
+        WHEN("The blocks are bound with setBufferBackedBlocks(), and the program dispatched.")
+        {
+            GlStateTracker state;
+            setBufferBackedBlocks(program, repository, nullptr, state);
+            {
+                graphics::ScopedBind boundProgram{program.mProgram};
+                glDispatchCompute((GLuint)(count / 2), 1, 1);
+            }
+            glMemoryBarrier(GL_BUFFER_UPDATE_BARRIER_BIT);
+
+            THEN("The storage blocks read and write the buffer ranges of their semantic.")
+            {
+                std::vector<std::uint32_t> result(count);
+                graphics::ScopedBind bound{destinationBuffer, graphics::BufferType::Array};
+                glGetBufferSubData(GL_ARRAY_BUFFER, 0, count * sizeof(std::uint32_t), result.data());
+
+                std::vector<std::uint32_t> expected(count, 0);
+                std::iota(expected.begin(), expected.begin() + count / 2, offset);
+                CHECK(result == expected);
+            }
+        }
+    }
+}
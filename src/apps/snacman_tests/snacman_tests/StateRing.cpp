@@ -0,0 +1,321 @@
+#include "catch.hpp"
+
+#include "Benchmark.h"
+
+#include <snacman/GraphicState.h>
+
+#include <atomic>
+#include <list>
+#include <mutex>
+#include <thread>
+
+
+using namespace ad::snac;
+
+
+namespace {
+
+
+    struct State
+    {
+        std::uint64_t mStep = 0;
+    };
+
+
+    /// @brief The mutex guarded list of heap allocated states replaced by StateRing, kept for comparison.
+    template <class T_state>
+    class StateFifo
+    {
+    public:
+        struct Entry
+        {
+            Clock::time_point pushTime;
+            std::unique_ptr<T_state> state;
+        };
+
+        void push(std::unique_ptr<T_state> aState)
+        {
+            std::lock_guard lock{mMutex};
+            mStore.push_back({Clock::now(), std::move(aState)});
+        }
+
+        Entry pop()
+        {
+            std::lock_guard lock{mMutex};
+            Entry result = std::move(mStore.front());
+            mStore.pop_front();
+            return result;
+        }
+
+        bool empty()
+        {
+            std::lock_guard lock{mMutex};
+            return mStore.empty();
+        }
+
+    private:
+        std::mutex mMutex;
+        std::list<Entry> mStore;
+    };
+
+
+    constexpr std::uint64_t gHandoffSteps = 200'000;
+
+
+    bench::Clock::duration sinceCalled(Clock::time_point aPushTime)
+    {
+        return std::chrono::duration_cast<bench::Clock::duration>(Clock::now() - aPushTime);
+    }
+
+
+} // unnamed namespace
+
+
+SCENARIO("StateRing hands states over in publication order.")
+{
+    GIVEN("An empty state ring.")
+    {
+        StateRing<State, 4> ring;
+        CHECK(ring.empty());
+        CHECK_FALSE(ring.pop());
+
+        WHEN("States are published.")
+        {
+            for(std::uint64_t step = 0; step != 3; ++step)
+            {
+                State * state = ring.acquire();
+                REQUIRE(state != nullptr);
+                state->mStep = step;
+                ring.push(state);
+            }
+
+            THEN("They are popped in the same order.")
+            {
+                CHECK(ring.size() == 3);
+                for(std::uint64_t step = 0; step != 3; ++step)
+                {
+                    std::optional<StateRing<State, 4>::Entry> entry = ring.pop();
+                    REQUIRE(entry);
+                    CHECK(entry->state->mStep == step);
+                    ring.release(entry->state);
+                }
+                CHECK_FALSE(ring.pop());
+                CHECK(ring.getReclaimedCount() == 0);
+            }
+        }
+    }
+}
+
+
+SCENARIO("StateRing reclaims the oldest published state when its pool is exhausted.")
+{
+    GIVEN("A state ring whose whole pool is published, without the consumer popping.")
+    {
+        constexpr std::size_t poolSize = 4;
+        StateRing<State, poolSize> ring;
+        std::vector<State *> published;
+        for(std::uint64_t step = 0; step != poolSize; ++step)
+        {
+            State * state = ring.acquire();
+            REQUIRE(state != nullptr);
+            state->mStep = step;
+            ring.push(state);
+            published.push_back(state);
+        }
+
+        WHEN("The producer acquires a state for the next step.")
+        {
+            State * state = ring.acquire();
+
+            THEN("The oldest published state is recycled.")
+            {
+                REQUIRE(state == published.front());
+                CHECK(ring.getReclaimedCount() == 1);
+
+                state->mStep = poolSize;
+                ring.push(state);
+
+                AND_THEN("The consumer pops the most recent states, in order.")
+                {
+                    for(std::uint64_t step = 1; step != poolSize + 1; ++step)
+                    {
+                        std::optional<StateRing<State, poolSize>::Entry> entry = ring.pop();
+                        REQUIRE(entry);
+                        CHECK(entry->state->mStep == step);
+                        ring.release(entry->state);
+                    }
+                    CHECK_FALSE(ring.pop());
+                }
+            }
+        }
+    }
+
+    GIVEN("A state ring whose consumer holds the whole pool.")
+    {
+        StateRing<State, 2> ring;
+        ring.push(ring.acquire());
+        ring.push(ring.acquire());
+        std::optional<StateRing<State, 2>::Entry> first = ring.pop();
+        std::optional<StateRing<State, 2>::Entry> second = ring.pop();
+        REQUIRE((first && second));
+
+        THEN("There is no state to acquire.")
+        {
+            CHECK(ring.acquire() == nullptr);
+
+            ring.release(first->state);
+            CHECK(ring.acquire() == first->state);
+        }
+    }
+}
+
+
+SCENARIO("StateRing concurrent producer and consumer.")
+{
+    GIVEN("A producer thread publishing consecutive steps, reclaiming states when the consumer lags.")
+    {
+        StateRing<State, 8> ring;
+        std::atomic<bool> done{false};
+        // Catch assertions are not thread safe, the producer reports to the main thread.
+        std::atomic<bool> acquireFailed{false};
+
+        std::thread producer{[&]()
+        {
+            for(std::uint64_t step = 1; step <= gHandoffSteps; ++step)
+            {
+                if(State * state = ring.acquire())
+                {
+                    state->mStep = step;
+                    ring.push(state);
+                }
+                else
+                {
+                    acquireFailed = true;
+                }
+            }
+            done = true;
+        }};
+
+        THEN("The consumer (holding two states, as the render thread) sees strictly increasing steps, up to the last one.")
+        {
+            std::array<State *, 2> held{nullptr, nullptr};
+            std::size_t front = 0;
+            std::uint64_t lastStep = 0;
+            bool increasing = true;
+            while(!done || !ring.empty())
+            {
+                if(std::optional<StateRing<State, 8>::Entry> entry = ring.pop())
+                {
+                    increasing &= (entry->state->mStep > lastStep);
+                    lastStep = entry->state->mStep;
+                    front = (front + 1) % 2;
+                    ring.release(held[front]);
+                    held[front] = entry->state;
+                }
+            }
+            producer.join();
+
+            // The consumer never holds more than 2 states, so there is always a state to acquire.
+            CHECK_FALSE(acquireFailed);
+            CHECK(increasing);
+            CHECK(lastStep == gHandoffSteps);
+        }
+    }
+}
+
+
+TEST_CASE("StateRing and StateFifo hand-off latency.", "[.benchmark]")
+{
+    // The producer publishes at a steady period (as the simulation does, albeit much faster),
+    // the consumer pops as soon as it sees a state.
+    constexpr std::uint64_t steps = 50'000;
+    static constexpr auto period = std::chrono::microseconds{20};
+
+    auto waitNextStep = [](bench::Clock::time_point & aNextStep)
+    {
+        aNextStep += period;
+        while(bench::Clock::now() < aNextStep)
+        {}
+    };
+
+    std::vector<bench::Clock::duration> pushDurations(steps);
+    std::vector<bench::Clock::duration> popDurations;
+    std::vector<bench::Clock::duration> handoffLatencies;
+    popDurations.reserve(steps);
+    handoffLatencies.reserve(steps);
+
+    {
+        StateRing<State, 8> ring;
+        std::thread producer{[&]()
+        {
+            bench::Clock::time_point nextStep = bench::Clock::now();
+            for(std::uint64_t step = 1; step <= steps; ++step)
+            {
+                const bench::Clock::time_point begin = bench::Clock::now();
+                State * state = ring.acquire();
+                state->mStep = step;
+                ring.push(state);
+                pushDurations[step - 1] = bench::Clock::now() - begin;
+                waitNextStep(nextStep);
+            }
+        }};
+
+        std::uint64_t lastStep = 0;
+        State * held = nullptr;
+        while(lastStep != steps)
+        {
+            const bench::Clock::time_point begin = bench::Clock::now();
+            if(std::optional<StateRing<State, 8>::Entry> entry = ring.pop())
+            {
+                popDurations.push_back(bench::Clock::now() - begin);
+                handoffLatencies.push_back(sinceCalled(entry->pushTime));
+                lastStep = entry->state->mStep;
+                ring.release(held);
+                held = entry->state;
+            }
+        }
+        producer.join();
+
+        std::cout << "StateRing: " << ring.getReclaimedCount() << " states reclaimed.\n";
+        bench::report("StateRing acquire + push", pushDurations);
+        bench::report("StateRing pop", popDurations);
+        bench::report("StateRing push to pop", handoffLatencies);
+    }
+
+    popDurations.clear();
+    handoffLatencies.clear();
+    {
+        StateFifo<State> fifo;
+        std::thread producer{[&]()
+        {
+            bench::Clock::time_point nextStep = bench::Clock::now();
+            for(std::uint64_t step = 1; step <= steps; ++step)
+            {
+                const bench::Clock::time_point begin = bench::Clock::now();
+                auto state = std::make_unique<State>();
+                state->mStep = step;
+                fifo.push(std::move(state));
+                pushDurations[step - 1] = bench::Clock::now() - begin;
+                waitNextStep(nextStep);
+            }
+        }};
+
+        std::uint64_t lastStep = 0;
+        while(lastStep != steps)
+        {
+            const bench::Clock::time_point begin = bench::Clock::now();
+            if(!fifo.empty())
+            {
+                StateFifo<State>::Entry entry = fifo.pop();
+                popDurations.push_back(bench::Clock::now() - begin);
+                handoffLatencies.push_back(sinceCalled(entry.pushTime));
+                lastStep = entry.state->mStep;
+            }
+        }
+        producer.join();
+
+        bench::report("StateFifo allocate + push", pushDurations);
+        bench::report("StateFifo empty + pop", popDurations);
+        bench::report("StateFifo push to pop", handoffLatencies);
+    }
+}
@@ -0,0 +1,137 @@
+#include "catch.hpp"
+
+#include <snac-renderer-V2/utilities/StreamingBuffer.h>
+
+#include <graphics/ApplicationGlfw.h>
+
+#include <numeric>
+#include <span>
+#include <vector>
+
+#include <cstdint>
+
+
+using namespace ad;
+using namespace ad::renderer;
+
+
+namespace {
+
+
+    /// @brief Read the content of `aRange` through GL, i.e. what the GPU would read.
+    std::vector<std::uint32_t> readBack(const StreamingBuffer::Range & aRange)
+    {
+        std::vector<std::uint32_t> result(aRange.mSize / sizeof(std::uint32_t));
+        glBindBuffer(GL_COPY_READ_BUFFER, aRange.mBuffer);
+        glGetBufferSubData(GL_COPY_READ_BUFFER, aRange.mOffset, aRange.mSize, result.data());
+        glBindBuffer(GL_COPY_READ_BUFFER, 0);
+        return result;
+    }
+
+
+    std::vector<std::uint32_t> writeSequence(const StreamingBuffer::Range & aRange, std::uint32_t aFirst)
+    {
+        std::span<std::uint32_t> mapped = aRange.as<std::uint32_t>();
+        std::iota(mapped.begin(), mapped.end(), aFirst);
+        return {mapped.begin(), mapped.end()};
+    }
+
+
+} // unnamed namespace
+
+
+// Requires an OpenGL 4.4 context (e.g. Mesa llvmpipe), exclude with the ~[gl] filter on headless machines.
+SCENARIO("StreamingBuffer sub-allocates per-frame ranges from a persistently mapped buffer.", "[gl]")
+{
+    graphics::ApplicationGlfw glfwApp{"snacman_tests", 64, 64,
+                                      graphics::ApplicationFlag::None,
+                                      4, 4,
+                                      { {GLFW_VISIBLE, GLFW_FALSE} }};
+
+    GLint uniformAlignment;
+    glGetIntegerv(GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, &uniformAlignment);
+    GLint shaderStorageAlignment;
+    glGetIntegerv(GL_SHADER_STORAGE_BUFFER_OFFSET_ALIGNMENT, &shaderStorageAlignment);
+
+    constexpr GLsizeiptr capacity = 4096;
+    StreamingBuffer buffer{capacity};
+    const GLsizeiptr regionCapacity = buffer.getRegionCapacity();
+    REQUIRE(regionCapacity >= capacity);
+
+    GIVEN("Ranges allocated during a frame.")
+    {
+        buffer.beginFrame();
+        const StreamingBuffer::Range first = buffer.allocateShaderStorage<std::uint32_t>(3);
+        const StreamingBuffer::Range second = buffer.allocateShaderStorage<std::uint32_t>(5);
+        const StreamingBuffer::Range uniform = buffer.allocateUniform<std::uint32_t>(4);
+
+        THEN("They are aligned, disjoint, and inside the region of the frame.")
+        {
+            CHECK(first.mOffset % shaderStorageAlignment == 0);
+            CHECK(second.mOffset % shaderStorageAlignment == 0);
+            CHECK(uniform.mOffset % uniformAlignment == 0);
+
+            CHECK(second.mOffset >= first.mOffset + first.mSize);
+            CHECK(uniform.mOffset >= second.mOffset + second.mSize);
+            CHECK(uniform.mOffset + uniform.mSize <= regionCapacity);
+
+            CHECK(first.binding() == BufferRange{first.mBuffer, first.mOffset, 3 * sizeof(std::uint32_t)});
+        }
+
+        THEN("The values written through the mapping are read by GL.")
+        {
+            const std::vector<std::uint32_t> firstValues = writeSequence(first, 10);
+            const std::vector<std::uint32_t> secondValues = writeSequence(second, 100);
+            CHECK(readBack(first) == firstValues);
+            CHECK(readBack(second) == secondValues);
+        }
+        buffer.endFrame();
+    }
+
+    GIVEN("Successive frames.")
+    {
+        THEN("They use the regions in turn, in the same buffer.")
+        {
+            buffer.beginFrame();
+            const GLuint name = buffer.allocate(16, 16).mBuffer;
+            buffer.endFrame();
+
+            for(std::size_t frame = 1; frame != 2 * StreamingBuffer::gFrameRegions + 1; ++frame)
+            {
+                buffer.beginFrame();
+                const StreamingBuffer::Range range = buffer.allocate(16, 16);
+                CHECK(range.mBuffer == name);
+                CHECK(range.mOffset == (GLintptr)(frame % StreamingBuffer::gFrameRegions) * regionCapacity);
+                buffer.endFrame();
+            }
+        }
+    }
+
+    GIVEN("A frame overflowing its region.")
+    {
+        buffer.beginFrame();
+        const StreamingBuffer::Range before = buffer.allocateShaderStorage<std::uint32_t>(capacity / 8);
+        const std::vector<std::uint32_t> beforeValues = writeSequence(before, 7);
+        const StreamingBuffer::Range overflowing = buffer.allocateShaderStorage<std::uint32_t>(capacity);
+
+        THEN("The buffer is replaced by a larger one, the ranges allocated before remaining valid until the frame end.")
+        {
+            CHECK(overflowing.mBuffer != before.mBuffer);
+            CHECK(buffer.getRegionCapacity() >= overflowing.mSize);
+            CHECK(overflowing.mOffset + overflowing.mSize <= buffer.getRegionCapacity());
+
+            const std::vector<std::uint32_t> overflowingValues = writeSequence(overflowing, 1000);
+            CHECK(readBack(before) == beforeValues);
+            CHECK(readBack(overflowing) == overflowingValues);
+        }
+        buffer.endFrame();
+
+        THEN("The next frames keep the larger buffer.")
+        {
+            buffer.beginFrame();
+            const StreamingBuffer::Range next = buffer.allocateShaderStorage<std::uint32_t>(capacity);
+            CHECK(next.mBuffer == overflowing.mBuffer);
+            buffer.endFrame();
+        }
+    }
+}
@@ -0,0 +1,61 @@
+#include "catch.hpp"
+
+#include <snac-renderer-V2/StringId.h>
+
+#include <string>
+
+
+using namespace ad;
+using namespace ad::renderer;
+
+
+SCENARIO("String identifiers compare as hashes, and keep their names for display.")
+{
+    GIVEN("An identifier computed at compile time, and the same string interned at runtime.")
+    {
+        constexpr StringId compileTime{"snacman_tests_compile_time"};
+        const std::string runtimeString{"snacman_tests_compile_time"};
+        const StringId interned = StringId::Intern(runtimeString);
+
+        THEN("They are equal, and hash the same.")
+        {
+            CHECK(compileTime == interned);
+            CHECK(compileTime == StringId{runtimeString});
+            CHECK(std::hash<StringId>{}(compileTime) == std::hash<StringId>{}(interned));
+            CHECK(compileTime != StringId{"snacman_tests_other"});
+        }
+
+        THEN("Both are displayed by their name, whatever the build type.")
+        {
+            CHECK(to_string(interned) == runtimeString);
+            CHECK(to_string(compileTime) == runtimeString);
+        }
+    }
+
+    GIVEN("An identifier constructed at runtime, without interning.")
+    {
+        const std::string runtimeString{"snacman_tests_constructed"};
+        const StringId constructed{runtimeString};
+
+        THEN("It is only displayed by its name in debug builds.")
+        {
+#if !defined(NDEBUG)
+            CHECK(to_string(constructed) == runtimeString);
+#else
+            CHECK(std::stoull(to_string(constructed), nullptr, 16) == constructed.value());
+#endif
+        }
+    }
+
+    GIVEN("An identifier only ever computed at compile time.")
+    {
+        constexpr StringId compileTimeOnly{"snacman_tests_never_interned"};
+
+        THEN("It is displayed by its hexadecimal value.")
+        {
+            const std::string displayed = to_string(compileTimeOnly);
+            CHECK(displayed.starts_with("0x"));
+            CHECK(std::stoull(displayed, nullptr, 16) == compileTimeOnly.value());
+        }
+    }
+}
@@ -0,0 +1,355 @@
+#include "catch.hpp"
+
+#include "Benchmark.h"
+
+#include <snacman/Profiling.h>
+#include <snacman/simulations/snacgame/SystemScheduler.h>
+#include <snacman/simulations/snacgame/component/Speed.h>
+
+#include <entity/EntityManager.h>
+
+#include <utilities/JobPool.h>
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <string>
+#include <thread>
+#include <utility>
+
+
+using namespace ad;
+using namespace ad::snacgame;
+namespace bench = ad::snac::bench;
+
+
+namespace {
+
+
+    // Stand-ins for components, only their types matter to the SystemAccess.
+    template <std::size_t N_index>
+    struct Data
+    {};
+
+
+    /// @brief Records when a system started and ended, on a sequence shared by all systems.
+    struct Span
+    {
+        std::size_t mBegin = 0;
+        std::size_t mEnd = 0;
+    };
+
+
+    struct Recorder
+    {
+        SystemScheduler::Task record(std::size_t aSystemIdx)
+        {
+            return [this, aSystemIdx]()
+            {
+                // Each system writes its own span, the sequence orders them.
+                mSpans[aSystemIdx].mBegin = mSequence++;
+                mSpans[aSystemIdx].mEnd = mSequence++;
+            };
+        }
+
+        bool runsBefore(std::size_t aFirst, std::size_t aSecond) const
+        { return mSpans[aFirst].mEnd < mSpans[aSecond].mBegin; }
+
+        std::atomic<std::size_t> mSequence{1};
+        std::array<Span, 8> mSpans{};
+    };
+
+
+    /// @brief The SystemScheduler reports the concurrent systems durations to the Main profiler,
+    /// which is otherwise scoped by the simulation.
+    Guard scopeMainProfiler()
+    {
+        return renderer::ProfilerRegistry::ScopeNewProfiler(snac::ProfilerMap_V2::Main,
+                                                            renderer::Profiler::Providers::CpuOnly);
+    }
+
+
+    /// @brief Synthetic system work, integrating positions from speeds (as MovementIntegration).
+    struct Integration
+    {
+        void operator()()
+        {
+            for(std::size_t i = 0; i != mPositions.size(); ++i)
+            {
+                mSpeeds[i] += 9.81f * gDelta;
+                mPositions[i] += mSpeeds[i] * gDelta;
+            }
+        }
+
+        static constexpr float gDelta = 1.f / 60.f;
+        static constexpr std::size_t gEntities = 20'000;
+
+        std::vector<float> mPositions = std::vector<float>(gEntities, 0.f);
+        std::vector<float> mSpeeds = std::vector<float>(gEntities, 0.f);
+    };
+
+
+    // Each system writes its own component, so all of them are independent.
+    template <std::size_t... VN_system>
+    void addIndependent(SystemScheduler & aScheduler,
+                        std::array<Integration, sizeof...(VN_system)> & aSystems,
+                        std::index_sequence<VN_system...>)
+    {
+        (aScheduler.add("Integration", SystemAccess{}.writes<Data<VN_system>>(), std::ref(aSystems[VN_system])), ...);
+    }
+
+
+} // unnamed namespace
+
+
+SCENARIO("SystemScheduler preserves the declaration order of conflicting systems.")
+{
+    Guard mainProfiler = scopeMainProfiler();
+    JobPool jobPool{3};
+    SystemScheduler scheduler{jobPool};
+    Recorder recorder;
+
+    GIVEN("Systems writing, reading, then writing again the same component, interleaved with independent systems.")
+    {
+        scheduler.add("write 0", SystemAccess{}.writes<Data<0>>(), recorder.record(0));
+        scheduler.add("write 1", SystemAccess{}.writes<Data<1>>(), recorder.record(1));
+        scheduler.add("read 0", SystemAccess{}.reads<Data<0>>().writes<Data<2>>(), recorder.record(2));
+        scheduler.add("read 0 bis", SystemAccess{}.reads<Data<0>>(), recorder.record(3));
+        scheduler.add("write 0 again", SystemAccess{}.writes<Data<0>>(), recorder.record(4));
+
+        WHEN("They are run.")
+        {
+            {
+                Guard frame = renderer::scopeProfilerFrame(snac::ProfilerMap_V2::Main);
+                scheduler.run();
+            }
+
+            THEN("Each reader runs after the preceding writer, and before the following writer.")
+            {
+                CHECK(recorder.runsBefore(0, 2));
+                CHECK(recorder.runsBefore(0, 3));
+                CHECK(recorder.runsBefore(2, 4));
+                CHECK(recorder.runsBefore(3, 4));
+            }
+
+            THEN("The systems are kept, and run again in the same order on the next run.")
+            {
+                const std::size_t sequence = recorder.mSequence;
+                Guard frame = renderer::scopeProfilerFrame(snac::ProfilerMap_V2::Main);
+                scheduler.run();
+                CHECK(recorder.mSequence == sequence + 10);
+                CHECK(recorder.mSpans[0].mBegin > sequence);
+                CHECK(recorder.runsBefore(0, 2));
+                CHECK(recorder.runsBefore(2, 4));
+                CHECK(recorder.runsBefore(3, 4));
+            }
+
+            WHEN("A system is added after the run.")
+            {
+                scheduler.add("read 1", SystemAccess{}.reads<Data<1>>(), recorder.record(5));
+                Guard frame = renderer::scopeProfilerFrame(snac::ProfilerMap_V2::Main);
+                scheduler.run();
+
+                THEN("The dependencies are rebuilt to include it.")
+                {
+                    CHECK(recorder.runsBefore(1, 5));
+                    CHECK(recorder.runsBefore(0, 2));
+                }
+            }
+        }
+    }
+
+    GIVEN("An exclusive system between independent systems.")
+    {
+        scheduler.add("before 0", SystemAccess{}.writes<Data<0>>(), recorder.record(0));
+        scheduler.add("before 1", SystemAccess{}.writes<Data<1>>(), recorder.record(1));
+        scheduler.add("exclusive", SystemAccess::Exclusive(), recorder.record(2));
+        scheduler.add("after 0", SystemAccess{}.writes<Data<0>>(), recorder.record(3));
+        scheduler.add("after 1", SystemAccess{}.writes<Data<1>>(), recorder.record(4));
+
+        WHEN("They are run.")
+        {
+            Guard frame = renderer::scopeProfilerFrame(snac::ProfilerMap_V2::Main);
+            scheduler.run();
+
+            THEN("The exclusive system acts as a merge point.")
+            {
+                CHECK(recorder.runsBefore(0, 2));
+                CHECK(recorder.runsBefore(1, 2));
+                CHECK(recorder.runsBefore(2, 3));
+                CHECK(recorder.runsBefore(2, 4));
+            }
+        }
+    }
+}
+
+
+SCENARIO("SystemScheduler starts a system as soon as the systems it depends on completed.")
+{
+    Guard mainProfiler = scopeMainProfiler();
+    JobPool jobPool{3};
+    SystemScheduler scheduler{jobPool};
+
+    GIVEN("A long system, and an independent chain of two systems.")
+    {
+        std::atomic<bool> chainCompleted{false};
+        bool chainCompletedDuringLongSystem = false;
+
+        scheduler.add("long", SystemAccess{}.writes<Data<0>>(), [&]()
+        {
+            // Without the dependency graph, the second system of the chain would wait for this one.
+            const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds{5};
+            while(!chainCompleted && std::chrono::steady_clock::now() < deadline)
+            {
+                std::this_thread::yield();
+            }
+            chainCompletedDuringLongSystem = chainCompleted;
+        });
+        scheduler.add("chain write", SystemAccess{}.writes<Data<1>>(), [](){});
+        scheduler.add("chain read", SystemAccess{}.reads<Data<1>>(), [&]() { chainCompleted = true; });
+
+        WHEN("They are run.")
+        {
+            Guard frame = renderer::scopeProfilerFrame(snac::ProfilerMap_V2::Main);
+            scheduler.run();
+
+            THEN("The chain completes while the long system runs.")
+            {
+                CHECK(chainCompletedDuringLongSystem);
+            }
+        }
+    }
+}
+
+
+SCENARIO("SystemScheduler applies the deferred structural changes at the merge points.")
+{
+    Guard mainProfiler = scopeMainProfiler();
+    JobPool jobPool{3};
+    SystemScheduler scheduler{jobPool};
+
+    ent::EntityManager world;
+    EntHandle entity = world.addEntity("deferred");
+
+    GIVEN("A system deferring a component addition, followed by a dependent system, then an exclusive system.")
+    {
+        bool seenByDependent = true;
+        bool seenAtMergePoint = false;
+
+        scheduler.add("add", SystemAccess{}.writes<Data<0>>(), [entity](DeferredChanges & aChanges)
+        {
+            aChanges.record([entity](Phase & aPhase) mutable
+            {
+                entity.get(aPhase)->add(component::Speed{});
+            });
+        });
+        scheduler.add("dependent", SystemAccess{}.reads<Data<0>>(), [&]()
+        {
+            seenByDependent = entity.get()->has<component::Speed>();
+        });
+        scheduler.add("exclusive", SystemAccess::Exclusive(), [&]()
+        {
+            seenAtMergePoint = entity.get()->has<component::Speed>();
+        });
+        scheduler.add("erase", SystemAccess{}.writes<Data<0>>(), [entity](DeferredChanges & aChanges)
+        {
+            aChanges.erase(entity);
+        });
+
+        WHEN("They are run.")
+        {
+            Guard frame = renderer::scopeProfilerFrame(snac::ProfilerMap_V2::Main);
+            scheduler.run();
+
+            THEN("The addition is only observed from the merge point.")
+            {
+                CHECK_FALSE(seenByDependent);
+                CHECK(seenAtMergePoint);
+            }
+
+            THEN("The changes deferred after the last merge point are applied at the end of the run.")
+            {
+                CHECK_FALSE(entity.isValid());
+            }
+        }
+    }
+}
+
+
+SCENARIO("SystemScheduler access conflicts.")
+{
+    GIVEN("Declared accesses.")
+    {
+        const SystemAccess reader = SystemAccess{}.reads<Data<0>>();
+        const SystemAccess otherReader = SystemAccess{}.reads<const Data<0>>();
+        const SystemAccess writer = SystemAccess{}.writes<Data<0>>();
+        const SystemAccess unrelated = SystemAccess{}.reads<Data<1>>().writes<Data<2>>();
+
+        THEN("Only readers can share a component.")
+        {
+            CHECK_FALSE(reader.conflictsWith(otherReader));
+            CHECK(reader.conflictsWith(writer));
+            CHECK(writer.conflictsWith(reader));
+            CHECK(writer.conflictsWith(writer));
+            CHECK_FALSE(unrelated.conflictsWith(writer));
+        }
+
+        THEN("Exclusive systems conflict with any system.")
+        {
+            CHECK(SystemAccess::Exclusive().conflictsWith(SystemAccess{}));
+            CHECK(unrelated.conflictsWith(SystemAccess::Exclusive()));
+        }
+    }
+}
+
+
+TEST_CASE("SystemScheduler and sequential systems step duration.", "[.benchmark]")
+{
+    constexpr std::size_t steps = 2'000;
+    constexpr std::size_t systemCount = 4;
+
+    Guard mainProfiler = scopeMainProfiler();
+    std::array<Integration, systemCount> systems;
+
+    std::cout << "Hardware concurrency: " << std::thread::hardware_concurrency() << "\n";
+
+    {
+        std::vector<bench::Clock::duration> durations = bench::sample(steps, [&]()
+        {
+            for(Integration & system : systems)
+            {
+                system();
+            }
+        });
+        bench::report("Sequential step", durations);
+    }
+
+    for(unsigned int workerCount : {0u, 1u, JobPool::DefaultWorkerCount()})
+    {
+        JobPool jobPool{workerCount};
+        SystemScheduler scheduler{jobPool};
+        addIndependent(scheduler, systems, std::make_index_sequence<systemCount>{});
+        std::vector<bench::Clock::duration> durations = bench::sample(steps, [&]()
+        {
+            Guard frame = renderer::scopeProfilerFrame(snac::ProfilerMap_V2::Main);
+            scheduler.run();
+        });
+        bench::report("Scheduled step, " + std::to_string(workerCount) + " worker(s)", durations);
+    }
+
+    // The scheduler overhead alone: dispatching and profiling empty systems.
+    {
+        JobPool jobPool;
+        SystemScheduler scheduler{jobPool};
+        scheduler.add("empty 0", SystemAccess{}.writes<Data<0>>(), [](){});
+        scheduler.add("empty 1", SystemAccess{}.writes<Data<1>>(), [](){});
+        scheduler.add("empty 2", SystemAccess{}.reads<Data<0>>(), [](){});
+        scheduler.add("empty 3", SystemAccess{}.reads<Data<1>>(), [](){});
+        std::vector<bench::Clock::duration> durations = bench::sample(steps, [&]()
+        {
+            Guard frame = renderer::scopeProfilerFrame(snac::ProfilerMap_V2::Main);
+            scheduler.run();
+        });
+        bench::report("Scheduled empty step", durations);
+    }
+}
@@ -19,11 +19,12 @@ constexpr std::size_t gMaxDrawInstances = 2048;
 // Note: It is likely that this class will need to be specialized for concrete graph classes.
 struct GraphControls
 {
+    // Interned, as they are displayed by the GUI.
     inline static const std::vector<StringKey> gForwardKeys{
-        "forward",
-        "forward_pbr",
-        "forward_phong",
-        "forward_debug",
+        StringKey::Intern("forward"),
+        StringKey::Intern("forward_pbr"),
+        StringKey::Intern("forward_phong"),
+        StringKey::Intern("forward_debug"),
     };
 
     std::vector<StringKey>::const_iterator mForwardPassKey = gForwardKeys.begin() + 1;
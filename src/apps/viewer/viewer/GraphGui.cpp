@@ -22,7 +22,7 @@ void GraphGui::present(TheGraph & aGraph)
             aGraph.mControls.mForwardPassKey,
             GraphControls::gForwardKeys.begin(),
             GraphControls::gForwardKeys.end(),
-            [](auto aKeyIt){return *aKeyIt;});
+            [](auto aKeyIt){return to_string(*aKeyIt);});
 
         imguiui::addCombo("Forward polygon mode",
             aGraph.mControls.mForwardPolygonMode,
@@ -23,7 +23,7 @@ ViewerPassCache prepareViewerPass(AnnotationsSelector aAnnotations,
     //
     {
         PROFILER_SCOPE_RECURRING_SECTION(gRenderProfiler, "sort_draw_entries", CpuTime);
-        std::sort(entries.begin(), entries.end());
+        helper.sortDrawEntries(entries);
     }
 
     //
@@ -37,10 +37,10 @@ ViewerPassCache prepareViewerPass(AnnotationsSelector aAnnotations,
         const VertexStream & vertexStream = *part.mVertexStream;
 
         // If true: this is the start of a new DrawCall
-        if(entry.mKey != drawKey)
+        if(helper.getDrawCallKey(entry) != drawKey)
         {
             // Record the new drawkey
-            drawKey = entry.mKey;
+            drawKey = helper.getDrawCallKey(entry);
             // Push the new DrawCall
             result.mCalls.push_back(helper.generateDrawCall(entry, part, vertexStream));
         }
@@ -3,6 +3,8 @@
 
 #include <snac-renderer-V2/Pass.h>
 
+#include <unordered_map>
+
 
 // Note: This file with everithing prefixed by Viewer is a good argument to change
 // the namespace of this application code to "viewer"
@@ -18,6 +20,8 @@ struct ViewerPartList : public PartList
 
     // All the palettes are concatenated in a single unidimensionnal container.
     std::vector<Rig::Pose> mRiggingPalettes;
+    // The offset of the palette of each distinct pose, so instances in the same pose share it.
+    std::unordered_map<PoseKey, GLsizei> mPoseToPaletteOffset;
 
     // SOA, continued
     std::vector<GLsizei> mTransformIdx;
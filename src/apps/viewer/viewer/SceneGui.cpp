@@ -312,7 +312,7 @@ void SceneGui::showPartWindow(const Part & aPart)
     {
         const VertexStream & vertexStream = *aPart.mVertexStream;
         // Sort the vertex attributes per divisor
-        std::array<std::vector<const std::string *>, 2> perDivisor;
+        std::array<std::vector<const Semantic *>, 2> perDivisor;
         for(const auto & [semantic, accessor] : vertexStream.mSemanticToAttribute)
         {
             perDivisor[getInstanceDivisor(vertexStream, accessor)].push_back(&semantic);
@@ -321,17 +321,17 @@ void SceneGui::showPartWindow(const Part & aPart)
         {
             ImGui::BulletText("per vertex");
             ImGui::TreePush("per vertex");
-            for(const std::string * semantic : perDivisor[0])
+            for(const Semantic * semantic : perDivisor[0])
             {
-                ImGui::BulletText("%s", semantic->c_str());
+                ImGui::BulletText("%s", to_string(*semantic).c_str());
             }
             ImGui::TreePop();
 
             ImGui::BulletText("per instance");
             ImGui::TreePush("per instance");
-            for(const std::string * semantic : perDivisor[1])
+            for(const Semantic * semantic : perDivisor[1])
             {
-                ImGui::BulletText("%s", semantic->c_str());
+                ImGui::BulletText("%s", to_string(*semantic).c_str());
             }
             ImGui::TreePop();
         }
@@ -371,7 +371,7 @@ void SceneGui::presentEffect(Handle<const Effect> aEffect)
                     for(const auto & [key, value] : technique.mAnnotations)
                     {
                         ImGui::SetCursorPosX(ImGui::GetCursorPosX() + ImGui::GetTreeNodeToLabelSpacing());
-                        ImGui::Text("%s: %s", key.c_str(), value.c_str());
+                        ImGui::Text("%s: %s", to_string(key).c_str(), to_string(value).c_str());
                     }
                     ImGui::TreePop();
                 }
@@ -163,7 +163,8 @@ void TheGraph::renderFrame(const Scene & aScene,
             .mLightViewProjectionUbo = aGraphShared.mUbos.mLightViewProjectionUbo,
             .mShadowCascadeUbo = aGraphShared.mUbos.mShadowCascadeUbo,
         },
-        [&aGraphShared, &aPartList, &textureRepository, &aStorage](DepthMethod aMethod)
+        [&aGraphShared, &aPartList, &textureRepository, &aStorage]
+        (DepthMethod aMethod, std::span<const math::Matrix<4, 4, GLfloat>> /*aViewProjections*/)
         {
             passOpaqueDepth(aGraphShared, aPartList, textureRepository, aStorage, aMethod);
         });
@@ -249,7 +250,7 @@ void TheGraph::renderFrame(const Scene & aScene,
         proto::load(*glyphPart.mInstanceToStringEntityBuffer,
                     std::span{glyphInstanceToStringEntity},
                     graphics::BufferHint::StreamDraw);
-        proto::load(*glyphPart.mStringEntitiesUbo,
+        proto::load(*glyphPart.mStringEntitiesSsbo,
                     std::span{stringEntities},
                     graphics::BufferHint::StreamDraw);
         const GLsizei glyphCount = (GLsizei)allGlyphInstances.size();
@@ -46,7 +46,7 @@ namespace ad::renderer {
 
 
 const char * gVertexShader = R"#(
-    #version 420
+    #version 430
 
     in vec3 ve_Position_local;
     in vec4 ve_Color;
@@ -60,10 +60,9 @@ const char * gVertexShader = R"#(
         mat4 viewingProjection;
     };
 
-    // TODO #ssbo Use a shader storage block, due to the unbounded nature of the number of instances
-    layout(std140, binding = 0) uniform LocalToWorldBlock
+    layout(std430, binding = 0) readonly buffer LocalToWorldBlock
     {
-        mat4 localToWorld[CLIENT_MAX_ENTITIES];
+        mat4 localToWorld[];
     };
 
     out vec4 ex_Color;
@@ -202,18 +201,34 @@ namespace {
             {
                 PROFILER_SCOPE_RECURRING_SECTION(gRenderProfiler, "compute_joint_matrices", CpuTime);
 
-                // TODO Ad 2024/03/20 #perf #animation:
-                // We could share the matrix palette for all no-animation (i.e. default rig pose),
-                // or even for "static animations" (i.e. single keyframe, defining a static pose)
-                // instead of currently always producing a matrix palette for each object with a rig.
-                paletteOffset = (GLsizei)aPartList.mRiggingPalettes.size();
-
                 const Rig & rig = animatedRig->mRig;
-                aPartList.mRiggingPalettes.reserve(aPartList.mRiggingPalettes.size() + rig.countJoints());
-                rig.computeJointMatrices(
-                        std::back_inserter(aPartList.mRiggingPalettes), 
-                        aNode.mInstance.mAnimationState ? aNode.mInstance.mAnimationState->mPosedTree 
-                                                   : animatedRig->mRig.mJointTree);
+                const auto & animationState = aNode.mInstance.mAnimationState;
+
+                // Instances in the same pose (default pose, static animation, or same animation time)
+                // share a single matrix palette.
+                const PoseKey poseKey = animationState ? animationState->mPoseKey
+                                                       : makePoseKey(rig, nullptr, 0.f);
+                auto [found, isNewPose] = 
+                    aPartList.mPoseToPaletteOffset.try_emplace(poseKey,
+                                                               (GLsizei)aPartList.mRiggingPalettes.size());
+                paletteOffset = found->second;
+
+                if(isNewPose)
+                {
+                    if(animationState)
+                    {
+                        aPartList.mRiggingPalettes.reserve(aPartList.mRiggingPalettes.size() + rig.countJoints());
+                        rig.computeJointMatrices(
+                                std::back_inserter(aPartList.mRiggingPalettes), 
+                                animationState->mPosedTree);
+                    }
+                    else
+                    {
+                        aPartList.mRiggingPalettes.insert(aPartList.mRiggingPalettes.end(),
+                                                          rig.mDefaultPalette.begin(),
+                                                          rig.mDefaultPalette.end());
+                    }
+                }
             }
 
             for(const Part & part: object->mParts)
@@ -229,7 +244,8 @@ namespace {
             }
 
             aPartList.mInstanceTransforms.push_back(
-                math::trans3d::scaleUniform(absolutePose.mUniformScale)
+                static_cast<math::AffineMatrix<4, GLfloat>>(object->mPositionDequantization)
+                * math::trans3d::scaleUniform(absolutePose.mUniformScale)
                 * absolutePose.mOrientation.toRotationMatrix()
                 * math::trans3d::translate(absolutePose.mPosition));
         }
@@ -512,10 +528,18 @@ void handleAnimations(Node & aNode,
         {
             assert(object->mAnimatedRig);
             const RigAnimation & animation = *animationState->mAnimation;
-            animationState->mPosedTree = animate(
+            const Rig & rig = object->mAnimatedRig->mRig;
+            // Sampled at the quantized timepoint, so instances with the same key are in the exact same pose.
+            animationState->mPoseKey = makePoseKey(
+                rig,
+                &animation,
+                (float)std::fmod(aTime.mSimulationTimepoint - animationState->mStartTimepoint, (double)animation.mDuration));
+            animate(
                 animation,
-                (float)std::fmod(aTime.mSimulationTimepoint - animationState->mStartTimepoint, (double)animation.mDuration),
-                object->mAnimatedRig->mRig.mJointTree);
+                animationState->mPoseKey.timepoint(),
+                rig.mJointTree,
+                animationState->mSampler,
+                animationState->mPosedTree);
         }
 
         // Draw the rig (potentially posed by animation)
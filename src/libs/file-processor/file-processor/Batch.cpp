@@ -0,0 +1,402 @@
+#include "Batch.h"
+
+#include "BatchCache.h"
+#include "Logging.h"
+
+#include <assimp/Importer.hpp>
+
+#include <utilities/JobPool.h>
+#include <utilities/Time.h>
+
+#include <algorithm>
+#include <atomic>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <mutex>
+#include <optional>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+
+
+namespace ad::renderer {
+
+namespace {
+
+
+    /// @brief Record the model and its dependencies, after a successful processing.
+    std::optional<CacheEntry> recordEntry(const std::filesystem::path & aModel,
+                                          const ProcessResult & aResult,
+                                          ContentHash aSettings)
+    {
+        std::vector<std::filesystem::path> dependencies;
+        for(const std::filesystem::path & dependency : aResult.mDependencies)
+        {
+            dependencies.push_back(std::filesystem::absolute(dependency).lexically_normal());
+        }
+        std::sort(dependencies.begin(), dependencies.end());
+        dependencies.erase(std::unique(dependencies.begin(), dependencies.end()), dependencies.end());
+
+        CacheEntry entry{.mSettings = aSettings, .mFiles = {}};
+        if(auto record = recordFile(aModel)) entry.mFiles.push_back(*record);
+        else return std::nullopt;
+
+        for(const std::filesystem::path & dependency : dependencies)
+        {
+            if(dependency == aModel)
+            {
+                continue;
+            }
+            // A model without its dependencies could not be considered up to date.
+            if(auto record = recordFile(dependency)) entry.mFiles.push_back(*record);
+            else return std::nullopt;
+        }
+        return entry;
+    }
+
+
+    //
+    // Inputs
+    //
+
+    void collectInput(const std::filesystem::path & aInput,
+                      const Assimp::Importer & aImporter,
+                      std::vector<std::filesystem::path> & aModels)
+    {
+        const std::string input = aInput.string();
+        if(!input.empty() && input.front() == '@')
+        {
+            std::filesystem::path manifest{input.substr(1)};
+            std::ifstream in{manifest};
+            if(!in)
+            {
+                throw std::runtime_error{"Cannot read manifest '" + manifest.string() + "'."};
+            }
+
+            std::string line;
+            while(std::getline(in, line))
+            {
+                // Tolerate manifests with CRLF line endings
+                if(!line.empty() && line.back() == '\r')
+                {
+                    line.pop_back();
+                }
+                if(line.empty() || line.front() == '#')
+                {
+                    continue;
+                }
+                collectInput(manifest.parent_path() / line, aImporter, aModels);
+            }
+        }
+        else if(is_directory(aInput))
+        {
+            for(const auto & entry : std::filesystem::recursive_directory_iterator{aInput})
+            {
+                if(entry.is_regular_file()
+                   && aImporter.IsExtensionSupported(entry.path().extension().string()))
+                {
+                    aModels.push_back(entry.path());
+                }
+            }
+        }
+        else if(is_regular_file(aInput))
+        {
+            aModels.push_back(aInput);
+        }
+        else
+        {
+            throw std::runtime_error{"Input '" + input + "' is neither a file, a directory nor a manifest."};
+        }
+    }
+
+
+    //
+    // Report
+    //
+
+    enum class Status
+    {
+        Processed,
+        UpToDate,
+        Failed,
+    };
+
+    std::string_view to_string(Status aStatus)
+    {
+        switch(aStatus)
+        {
+            case Status::Processed: return "processed";
+            case Status::UpToDate: return "up-to-date";
+            case Status::Failed: return "failed";
+        }
+        return "";
+    }
+
+    struct ModelOutcome
+    {
+        Status mStatus = Status::Failed;
+        double mSeconds = 0.;
+        /// @brief The cache entry to record for the model, if any.
+        std::optional<CacheEntry> mEntry;
+        std::string mError;
+    };
+
+    void writeJsonString(std::ostream & aOut, std::string_view aString)
+    {
+        aOut << '"';
+        for(char c : aString)
+        {
+            switch(c)
+            {
+                case '"': aOut << "\\\""; break;
+                case '\\': aOut << "\\\\"; break;
+                case '\n': aOut << "\\n"; break;
+                case '\t': aOut << "\\t"; break;
+                default:
+                    if((unsigned char)c < 0x20)
+                    {
+                        aOut << "\\u" << std::hex << std::setw(4) << std::setfill('0') << (int)c
+                             << std::dec << std::setfill(' ');
+                    }
+                    else
+                    {
+                        aOut << c;
+                    }
+            }
+        }
+        aOut << '"';
+    }
+
+    void writeReport(const std::filesystem::path & aReportFile,
+                     std::span<const std::filesystem::path> aModels,
+                     std::span<const ModelOutcome> aOutcomes,
+                     unsigned int aJobs,
+                     double aSeconds,
+                     const BatchResult & aResult)
+    {
+        std::ofstream out{aReportFile};
+        out << "{\n"
+            << "  \"jobs\": " << aJobs << ",\n"
+            << "  \"seconds\": " << aSeconds << ",\n"
+            << "  \"processed\": " << aResult.mProcessed << ",\n"
+            << "  \"up_to_date\": " << aResult.mUpToDate << ",\n"
+            << "  \"failed\": " << aResult.mFailed << ",\n"
+            << "  \"models\": [";
+        for(std::size_t modelIdx = 0; modelIdx != aModels.size(); ++modelIdx)
+        {
+            const ModelOutcome & outcome = aOutcomes[modelIdx];
+            out << (modelIdx == 0 ? "\n" : ",\n")
+                << "    {\"input\": ";
+            writeJsonString(out, aModels[modelIdx].string());
+            out << ", \"status\": \"" << to_string(outcome.mStatus) << "\""
+                << ", \"seconds\": " << outcome.mSeconds;
+            if(!outcome.mError.empty())
+            {
+                out << ", \"error\": ";
+                writeJsonString(out, outcome.mError);
+            }
+            out << "}";
+        }
+        out << "\n  ]\n}\n";
+
+        if(!out)
+        {
+            SELOG(error)("Could not write report '{}'.", aReportFile.string());
+        }
+    }
+
+
+} // unnamed namespace
+
+
+std::vector<std::filesystem::path> collectModels(std::span<const std::filesystem::path> aInputs)
+{
+    // Only used to query the supported extensions.
+    Assimp::Importer importer;
+
+    std::vector<std::filesystem::path> models;
+    for(const std::filesystem::path & input : aInputs)
+    {
+        collectInput(input, importer, models);
+    }
+
+    for(std::filesystem::path & model : models)
+    {
+        model = std::filesystem::absolute(model).lexically_normal();
+    }
+    std::sort(models.begin(), models.end());
+    models.erase(std::unique(models.begin(), models.end()), models.end());
+    return models;
+}
+
+
+BatchResult processBatch(std::span<const std::filesystem::path> aModels, const BatchOptions & aOptions)
+{
+    const Clock::time_point batchStart = Clock::now();
+
+    const unsigned int jobs = (unsigned int)std::clamp<std::size_t>(
+        aOptions.mJobs == 0 ? JobPool::DefaultWorkerCount() + 1 : aOptions.mJobs,
+        1,
+        std::max<std::size_t>(1, aModels.size()));
+
+    const bool useCache = !aOptions.mCacheFile.empty();
+    // Read concurrently by the jobs, then updated once all jobs completed.
+    BatchCache cache = useCache ? loadCache(aOptions.mCacheFile) : BatchCache{};
+    const ContentHash settings = hashSettings(aOptions.mProcessor);
+
+    std::vector<ModelOutcome> outcomes(aModels.size());
+
+    // Models sharing a directory and a stem (e.g. foo.gltf and foo.fbx) would write the same output
+    // from concurrent jobs. None of them is processed, since the output could not be attributed.
+    std::vector<std::string> outputConflicts(aModels.size());
+    {
+        std::map<std::filesystem::path, std::vector<std::size_t>> modelsByOutput;
+        for(std::size_t modelIdx = 0; modelIdx != aModels.size(); ++modelIdx)
+        {
+            const std::filesystem::path model = std::filesystem::absolute(aModels[modelIdx]).lexically_normal();
+            modelsByOutput[getOutputPath(model)].push_back(modelIdx);
+        }
+        for(const auto & [output, modelIndices] : modelsByOutput)
+        {
+            if(modelIndices.size() > 1)
+            {
+                for(std::size_t modelIdx : modelIndices)
+                {
+                    outputConflicts[modelIdx] = "Output '" + output.string() + "' would be written by "
+                        + std::to_string(modelIndices.size()) + " models, rename the inputs.";
+                }
+            }
+        }
+    }
+
+    std::mutex outputMutex;
+    std::atomic<std::size_t> completed{0};
+
+    auto processOne = [&](std::size_t aModelIdx)
+    {
+        const Clock::time_point start = Clock::now();
+        const std::filesystem::path model = std::filesystem::absolute(aModels[aModelIdx]).lexically_normal();
+        ModelOutcome & outcome = outcomes[aModelIdx];
+        std::ostringstream report;
+
+        try
+        {
+            if(!outputConflicts[aModelIdx].empty())
+            {
+                throw std::runtime_error{outputConflicts[aModelIdx]};
+            }
+
+            if(useCache && !aOptions.mForce)
+            {
+                if(auto found = cache.find(model); found != cache.end())
+                {
+                    CacheEntry entry = found->second;
+                    if(isUpToDate(entry, settings, getOutputPath(model)))
+                    {
+                        outcome.mStatus = Status::UpToDate;
+                        outcome.mEntry = std::move(entry);
+                    }
+                }
+            }
+
+            if(outcome.mStatus != Status::UpToDate)
+            {
+                ProcessorOptions processorOptions = aOptions.mProcessor;
+                processorOptions.mReport = &report;
+                // The Assimp logger is global, and it writes directly to stdout.
+                processorOptions.mImporterLog = aOptions.mProcessor.mImporterLog && aOptions.mVerbose && jobs == 1;
+
+                ProcessResult result = processModel(model, processorOptions);
+                if(result.mSuccess)
+                {
+                    outcome.mStatus = Status::Processed;
+                    if(useCache)
+                    {
+                        outcome.mEntry = recordEntry(model, result, settings);
+                    }
+                }
+                else
+                {
+                    outcome.mError = "Processing failed, see the log for details.";
+                }
+            }
+        }
+        catch(std::exception & aException)
+        {
+            outcome.mStatus = Status::Failed;
+            outcome.mError = aException.what();
+        }
+
+        outcome.mSeconds = asFractionalSeconds(Clock::now() - start);
+
+        std::lock_guard lock{outputMutex};
+        if(aOptions.mVerbose)
+        {
+            std::cout << report.str();
+        }
+        std::cout << "[" << ++completed << "/" << aModels.size() << "] "
+                  << to_string(outcome.mStatus) << " '" << model.string() << "'";
+        if(outcome.mStatus == Status::Processed)
+        {
+            std::cout << " in " << outcome.mSeconds << " s";
+        }
+        else if(outcome.mStatus == Status::Failed)
+        {
+            std::cout << ": " << outcome.mError;
+        }
+        std::cout << "\n";
+    };
+
+    JobPool pool{jobs - 1};
+    pool.parallelFor(aModels.size(), processOne);
+
+    BatchResult result;
+    for(std::size_t modelIdx = 0; modelIdx != aModels.size(); ++modelIdx)
+    {
+        ModelOutcome & outcome = outcomes[modelIdx];
+        switch(outcome.mStatus)
+        {
+            case Status::Processed: ++result.mProcessed; break;
+            case Status::UpToDate: ++result.mUpToDate; break;
+            case Status::Failed: ++result.mFailed; break;
+        }
+
+        if(useCache)
+        {
+            // Entries of models outside this batch are preserved.
+            const std::filesystem::path model = std::filesystem::absolute(aModels[modelIdx]).lexically_normal();
+            if(outcome.mEntry)
+            {
+                cache[model] = std::move(*outcome.mEntry);
+            }
+            else
+            {
+                cache.erase(model);
+            }
+        }
+    }
+
+    if(useCache)
+    {
+        saveCache(cache, aOptions.mCacheFile);
+    }
+
+    const double seconds = asFractionalSeconds(Clock::now() - batchStart);
+    std::cout << "Batch of " << aModels.size() << " model(s) on " << jobs << " job(s) in " << seconds << " s: "
+              << result.mProcessed << " processed, "
+              << result.mUpToDate << " up to date, "
+              << result.mFailed << " failed.\n";
+
+    if(!aOptions.mReportFile.empty())
+    {
+        writeReport(aOptions.mReportFile, aModels, outcomes, jobs, seconds, result);
+    }
+
+    return result;
+}
+
+
+} // namespace ad::renderer
@@ -0,0 +1,60 @@
+#pragma once
+
+
+#include "Processor.h"
+
+#include <filesystem>
+#include <span>
+#include <vector>
+
+
+namespace ad::renderer {
+
+
+struct BatchOptions
+{
+    ProcessorOptions mProcessor;
+
+    /// @brief Number of models processed concurrently, 0 for the hardware concurrency.
+    unsigned int mJobs = 0;
+
+    /// @brief Persistent record of the processed models, used to skip those whose inputs did not change.
+    /// No cache is used if empty.
+    std::filesystem::path mCacheFile;
+    /// @brief Process all models, even those the cache considers up to date (the cache is still updated).
+    bool mForce = false;
+
+    /// @brief Machine-readable (JSON) report of the batch timings. Not written if empty.
+    std::filesystem::path mReportFile;
+    /// @brief Forward the complete report of each model to std::cout, instead of one summary line.
+    bool mVerbose = false;
+};
+
+
+struct BatchResult
+{
+    std::size_t mProcessed = 0;
+    std::size_t mUpToDate = 0;
+    std::size_t mFailed = 0;
+};
+
+
+/// @brief List the model files designated by `aInputs`, sorted and without duplicates.
+///
+/// Each input might be:
+/// * a model file,
+/// * a directory, recursively searched for files with an extension supported by the importer,
+/// * a manifest file, prefixed with '@', listing one input per line (relative to the manifest directory).
+///   Empty lines and lines starting with '#' are ignored.
+std::vector<std::filesystem::path> collectModels(std::span<const std::filesystem::path> aInputs);
+
+
+/// @brief Process `aModels` concurrently, skipping those that are up to date according to the cache.
+///
+/// A model is up to date when its output exists, it was produced with the same processor version and options,
+/// and the content of the model and of each of its dependencies (see ProcessResult) did not change.
+/// Models that would write the same output (same directory and stem) all fail, without being processed.
+BatchResult processBatch(std::span<const std::filesystem::path> aModels, const BatchOptions & aOptions);
+
+
+} // namespace ad::renderer
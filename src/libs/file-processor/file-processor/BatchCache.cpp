@@ -0,0 +1,223 @@
+#include "BatchCache.h"
+
+#include "Logging.h"
+
+#include <snac-renderer-V2/files/Versioning.h>
+
+#include <array>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <type_traits>
+
+
+namespace ad::renderer {
+
+namespace {
+
+
+    // FNV-1a, 64 bits
+    constexpr ContentHash gFnvOffsetBasis = 0xcbf29ce484222325;
+    constexpr ContentHash gFnvPrime = 0x100000001b3;
+
+    ContentHash hashBytes(const char * aData, std::size_t aSize, ContentHash aHash = gFnvOffsetBasis)
+    {
+        for(std::size_t i = 0; i != aSize; ++i)
+        {
+            aHash ^= (unsigned char)aData[i];
+            aHash *= gFnvPrime;
+        }
+        return aHash;
+    }
+
+    template <class T_value>
+    ContentHash hashValue(const T_value & aValue, ContentHash aHash)
+    {
+        static_assert(std::is_trivially_copyable_v<T_value>);
+        return hashBytes(reinterpret_cast<const char *>(&aValue), sizeof(aValue), aHash);
+    }
+
+    constexpr std::string_view gCacheHeader = "asset_processor cache 1";
+
+
+} // unnamed namespace
+
+
+std::optional<ContentHash> hashFile(const std::filesystem::path & aFile)
+{
+    std::ifstream in{aFile, std::ios::binary};
+    if(!in)
+    {
+        return std::nullopt;
+    }
+
+    std::array<char, 64 * 1024> buffer;
+    ContentHash hash = gFnvOffsetBasis;
+    while(in)
+    {
+        in.read(buffer.data(), buffer.size());
+        hash = hashBytes(buffer.data(), (std::size_t)in.gcount(), hash);
+    }
+    return hash;
+}
+
+
+ContentHash hashSettings(const ProcessorOptions & aOptions)
+{
+    ContentHash hash = gFnvOffsetBasis;
+    hash = hashValue(gProcessorVersion, hash);
+    hash = hashValue(gSeumVersion, hash);
+    hash = hashValue(aOptions.mCompactVertices, hash);
+    hash = hashValue(aOptions.mLodCount, hash);
+    hash = hashValue(aOptions.mLodMaxError, hash);
+    return hash;
+}
+
+
+std::optional<FileRecord> recordFile(const std::filesystem::path & aFile)
+{
+    std::error_code ec;
+    std::uintmax_t size = file_size(aFile, ec);
+    if(ec) return std::nullopt;
+    std::filesystem::file_time_type writeTime = last_write_time(aFile, ec);
+    if(ec) return std::nullopt;
+
+    if(std::optional<ContentHash> hash = hashFile(aFile))
+    {
+        return FileRecord{
+            .mPath = aFile,
+            .mHash = *hash,
+            .mSize = size,
+            .mWriteTime = (std::int64_t)writeTime.time_since_epoch().count(),
+        };
+    }
+    return std::nullopt;
+}
+
+
+bool isUnchanged(FileRecord & aRecord)
+{
+    std::error_code ec;
+    std::uintmax_t size = file_size(aRecord.mPath, ec);
+    if(ec || size != aRecord.mSize)
+    {
+        return false;
+    }
+    std::filesystem::file_time_type writeTime = last_write_time(aRecord.mPath, ec);
+    if(ec)
+    {
+        return false;
+    }
+    else if((std::int64_t)writeTime.time_since_epoch().count() == aRecord.mWriteTime)
+    {
+        return true;
+    }
+    else if(hashFile(aRecord.mPath) == aRecord.mHash)
+    {
+        aRecord.mWriteTime = (std::int64_t)writeTime.time_since_epoch().count();
+        return true;
+    }
+    return false;
+}
+
+
+bool isUpToDate(CacheEntry & aEntry, ContentHash aSettings, const std::filesystem::path & aOutput)
+{
+    if(aEntry.mSettings != aSettings || !is_regular_file(aOutput))
+    {
+        return false;
+    }
+    for(FileRecord & file : aEntry.mFiles)
+    {
+        if(!isUnchanged(file))
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+
+BatchCache loadCache(const std::filesystem::path & aCacheFile)
+{
+    std::ifstream in{aCacheFile};
+    if(!in)
+    {
+        return {};
+    }
+
+    std::string line;
+    if(!std::getline(in, line) || line != gCacheHeader)
+    {
+        SELOG(warn)("Ignoring cache '{}', which has an unknown format.", aCacheFile.string());
+        return {};
+    }
+
+    BatchCache cache;
+    CacheEntry * current = nullptr;
+    while(std::getline(in, line))
+    {
+        std::istringstream fields{line};
+        std::string kind;
+        fields >> kind;
+        if(kind == "model")
+        {
+            ContentHash settings;
+            std::string path;
+            fields >> std::hex >> settings >> std::ws;
+            if(fields && std::getline(fields, path))
+            {
+                current = &cache[path];
+                *current = CacheEntry{.mSettings = settings, .mFiles = {}};
+                continue;
+            }
+        }
+        else if(kind == "file" && current != nullptr)
+        {
+            FileRecord record;
+            std::string path;
+            fields >> std::hex >> record.mHash >> std::dec >> record.mSize >> record.mWriteTime >> std::ws;
+            if(fields && std::getline(fields, path))
+            {
+                record.mPath = path;
+                current->mFiles.push_back(std::move(record));
+                continue;
+            }
+        }
+
+        SELOG(warn)("Ignoring cache '{}', which is corrupted.", aCacheFile.string());
+        return {};
+    }
+    return cache;
+}
+
+
+void saveCache(const BatchCache & aCache, const std::filesystem::path & aCacheFile)
+{
+    std::filesystem::path temporary = aCacheFile;
+    temporary += ".tmp";
+    {
+        std::ofstream out{temporary};
+        out << gCacheHeader << "\n";
+        for(const auto & [model, entry] : aCache)
+        {
+            out << "model " << std::hex << entry.mSettings << std::dec << " " << model.string() << "\n";
+            for(const FileRecord & file : entry.mFiles)
+            {
+                out << "file " << std::hex << file.mHash << std::dec
+                    << " " << file.mSize << " " << file.mWriteTime
+                    << " " << file.mPath.string() << "\n";
+            }
+        }
+        if(!out)
+        {
+            SELOG(error)("Could not write cache '{}'.", temporary.string());
+            return;
+        }
+    }
+    std::filesystem::rename(temporary, aCacheFile);
+}
+
+
+} // namespace ad::renderer
@@ -0,0 +1,76 @@
+#pragma once
+
+
+#include "Processor.h"
+
+#include <filesystem>
+#include <map>
+#include <optional>
+#include <vector>
+
+#include <cstdint>
+
+
+namespace ad::renderer {
+
+
+/// @brief FNV-1a 64 bits hash, of file contents or of processor settings.
+using ContentHash = std::uint64_t;
+
+
+std::optional<ContentHash> hashFile(const std::filesystem::path & aFile);
+
+/// @brief Hash everything, except the inputs, that determines the output of processModel().
+/// @important Must be completed when an option affecting the output is added to ProcessorOptions.
+ContentHash hashSettings(const ProcessorOptions & aOptions);
+
+
+struct FileRecord
+{
+    std::filesystem::path mPath;
+    ContentHash mHash;
+    std::uintmax_t mSize;
+    /// @brief Ticks of std::filesystem::file_time_type, only used to avoid hashing unchanged files.
+    std::int64_t mWriteTime;
+
+    bool operator==(const FileRecord &) const = default;
+};
+
+
+struct CacheEntry
+{
+    ContentHash mSettings;
+    /// @brief The model first, then its dependencies.
+    std::vector<FileRecord> mFiles;
+
+    bool operator==(const CacheEntry &) const = default;
+};
+
+
+/// @brief Cache entries, by absolute model path.
+using BatchCache = std::map<std::filesystem::path, CacheEntry>;
+
+
+/// @brief Record the current content of `aFile`, or nothing if it cannot be read.
+std::optional<FileRecord> recordFile(const std::filesystem::path & aFile);
+
+/// @brief Check that the file still has its recorded content.
+///
+/// The file is only hashed if its write time changed (in which case the record time is refreshed).
+bool isUnchanged(FileRecord & aRecord);
+
+/// @brief Check that `aOutput` exists, and that the entry was recorded with `aSettings` from unchanged files.
+bool isUpToDate(CacheEntry & aEntry, ContentHash aSettings, const std::filesystem::path & aOutput);
+
+
+/// @brief Load the cache written by saveCache().
+///
+/// A missing file gives an empty cache, as does a file with an unknown format or a corrupted content
+/// (with a warning), so all models are processed again.
+BatchCache loadCache(const std::filesystem::path & aCacheFile);
+
+/// @brief Write the cache aside, then move it in place, so an interrupted batch does not corrupt it.
+void saveCache(const BatchCache & aCache, const std::filesystem::path & aCacheFile);
+
+
+} // namespace ad::renderer
@@ -0,0 +1,727 @@
+#include "MeshOptimization.h"
+
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <cmath>
+#include <map>
+#include <numeric>
+
+
+namespace ad::renderer {
+
+
+namespace {
+
+
+    constexpr unsigned int gInvalidIndex = ~0u;
+
+    /// @brief Cosine of the largest rotation of a triangle normal allowed by a collapse (60 degrees).
+    constexpr float gMinNormalCosine = 0.5f;
+
+
+    /// @brief FIFO vertex cache, where each vertex remembers when it entered the cache.
+    class FifoCache
+    {
+    public:
+        FifoCache(std::size_t aVerticesCount, unsigned int aCacheSize) :
+            mTimestamps(aVerticesCount, 0),
+            mCacheSize{aCacheSize},
+            mTime{aCacheSize + 1}
+        {}
+
+        /// @return true on a cache miss, inserting the vertex.
+        bool access(unsigned int aVertex)
+        {
+            if(mTime - mTimestamps[aVertex] > mCacheSize)
+            {
+                mTimestamps[aVertex] = mTime++;
+                return true;
+            }
+            return false;
+        }
+
+        /// @brief Evict all vertices.
+        void flush()
+        {
+            mTime += mCacheSize + 1;
+        }
+
+    private:
+        std::vector<unsigned int> mTimestamps;
+        unsigned int mCacheSize;
+        unsigned int mTime;
+    };
+
+
+    unsigned int countMisses(FifoCache & aCache, std::span<const unsigned int> aTriangle)
+    {
+        return (unsigned int)aCache.access(aTriangle[0])
+             + (unsigned int)aCache.access(aTriangle[1])
+             + (unsigned int)aCache.access(aTriangle[2]);
+    }
+
+
+    /// @brief For each vertex, the list of triangles using it (compressed in a single array).
+    struct TriangleAdjacency
+    {
+        TriangleAdjacency(std::span<const unsigned int> aIndices, std::size_t aVerticesCount) :
+            mOffsets(aVerticesCount + 1, 0),
+            mTriangles(aIndices.size())
+        {
+            for(unsigned int vertex : aIndices)
+            {
+                ++mOffsets[vertex + 1];
+            }
+            std::partial_sum(mOffsets.begin(), mOffsets.end(), mOffsets.begin());
+
+            std::vector<unsigned int> cursors{mOffsets.begin(), mOffsets.end() - 1};
+            for(std::size_t indexIdx = 0; indexIdx != aIndices.size(); ++indexIdx)
+            {
+                mTriangles[cursors[aIndices[indexIdx]]++] = (unsigned int)(indexIdx / 3);
+            }
+        }
+
+        std::span<const unsigned int> getTriangles(unsigned int aVertex) const
+        {
+            return std::span{mTriangles}.subspan(mOffsets[aVertex], mOffsets[aVertex + 1] - mOffsets[aVertex]);
+        }
+
+        std::vector<unsigned int> mOffsets;
+        std::vector<unsigned int> mTriangles;
+    };
+
+
+    /// @brief Symmetric 4x4 matrix, evaluating the weighted sum of squared distances to a set of planes.
+    struct Quadric
+    {
+        /// @param aNormal Unit normal of the plane.
+        static Quadric fromPlane(const aiVector3D & aNormal, double aDistance, double aWeight)
+        {
+            const double x = aNormal.x, y = aNormal.y, z = aNormal.z, w = aDistance;
+            return Quadric{
+                aWeight * x * x, aWeight * x * y, aWeight * x * z, aWeight * x * w,
+                aWeight * y * y, aWeight * y * z, aWeight * y * w,
+                aWeight * z * z, aWeight * z * w,
+                aWeight * w * w,
+                aWeight,
+            };
+        }
+
+        Quadric & operator+=(const Quadric & aRhs)
+        {
+            mXX += aRhs.mXX; mXY += aRhs.mXY; mXZ += aRhs.mXZ; mXW += aRhs.mXW;
+            mYY += aRhs.mYY; mYZ += aRhs.mYZ; mYW += aRhs.mYW;
+            mZZ += aRhs.mZZ; mZW += aRhs.mZW;
+            mWW += aRhs.mWW;
+            mWeight += aRhs.mWeight;
+            return *this;
+        }
+
+        Quadric operator+(const Quadric & aRhs) const
+        {
+            Quadric result{*this};
+            return result += aRhs;
+        }
+
+        double evaluate(const aiVector3D & aPosition) const
+        {
+            const double x = aPosition.x, y = aPosition.y, z = aPosition.z;
+            double result =
+                mXX * x * x + 2. * mXY * x * y + 2. * mXZ * x * z + 2. * mXW * x
+                + mYY * y * y + 2. * mYZ * y * z + 2. * mYW * y
+                + mZZ * z * z + 2. * mZW * z
+                + mWW;
+            // Rounding errors could make it slightly negative.
+            return std::max(result, 0.);
+        }
+
+        /// @brief The weighted mean of the squared distances to the planes.
+        /// @note Contrary to evaluate(), it is a squared length whatever the weights
+        /// (so it does not depend on the area or the count of the planes).
+        double evaluateMean(const aiVector3D & aPosition) const
+        {
+            return (mWeight > 0.) ? evaluate(aPosition) / mWeight : 0.;
+        }
+
+        double mXX = 0., mXY = 0., mXZ = 0., mXW = 0.;
+        double mYY = 0., mYZ = 0., mYW = 0.;
+        double mZZ = 0., mZW = 0.;
+        double mWW = 0.;
+        double mWeight = 0.;
+    };
+
+
+} // unnamed namespace
+
+
+VertexCacheStatistics analyzeVertexCache(std::span<const unsigned int> aIndices,
+                                         std::size_t aVerticesCount,
+                                         unsigned int aCacheSize)
+{
+    assert(aIndices.size() % 3 == 0);
+    if(aIndices.empty())
+    {
+        return {};
+    }
+
+    FifoCache cache{aVerticesCount, aCacheSize};
+    std::vector<bool> referenced(aVerticesCount, false);
+    std::size_t misses = 0;
+    std::size_t referencedCount = 0;
+    for(unsigned int vertex : aIndices)
+    {
+        misses += cache.access(vertex);
+        if(!referenced[vertex])
+        {
+            referenced[vertex] = true;
+            ++referencedCount;
+        }
+    }
+
+    return VertexCacheStatistics{
+        .mAcmr = (float)misses / (aIndices.size() / 3),
+        .mAtvr = (float)misses / referencedCount,
+    };
+}
+
+
+void optimizeVertexCache(std::span<unsigned int> aIndices,
+                         std::size_t aVerticesCount,
+                         unsigned int aCacheSize)
+{
+    assert(aIndices.size() % 3 == 0);
+    if(aIndices.empty())
+    {
+        return;
+    }
+
+    const TriangleAdjacency adjacency{aIndices, aVerticesCount};
+
+    // Count of triangles not yet emitted, for each vertex.
+    std::vector<unsigned int> liveTriangles(aVerticesCount);
+    for(unsigned int vertex = 0; vertex != aVerticesCount; ++vertex)
+    {
+        liveTriangles[vertex] = (unsigned int)adjacency.getTriangles(vertex).size();
+    }
+
+    std::vector<unsigned int> cacheTimestamps(aVerticesCount, 0);
+    unsigned int time = aCacheSize + 1;
+    std::vector<bool> emitted(aIndices.size() / 3, false);
+    // Recently referenced vertices, to restart from when the fanning vertex has no candidate.
+    std::vector<unsigned int> deadEndStack;
+    std::vector<unsigned int> result;
+    result.reserve(aIndices.size());
+
+    // Scans the vertices in order, when the dead-end stack is exhausted.
+    unsigned int cursor = 0;
+    auto skipDeadEnd = [&]() -> unsigned int
+    {
+        while(!deadEndStack.empty())
+        {
+            unsigned int vertex = deadEndStack.back();
+            deadEndStack.pop_back();
+            if(liveTriangles[vertex] > 0)
+            {
+                return vertex;
+            }
+        }
+        for(; cursor != aVerticesCount; ++cursor)
+        {
+            if(liveTriangles[cursor] > 0)
+            {
+                return cursor;
+            }
+        }
+        return gInvalidIndex;
+    };
+
+    unsigned int fanning = skipDeadEnd();
+    while(fanning != gInvalidIndex)
+    {
+        // The candidates are the vertices of the triangles emitted around the fanning vertex.
+        // They are pushed on the dead-end stack, so they are the top entries.
+        const std::size_t candidatesBegin = deadEndStack.size();
+
+        for(unsigned int triangle : adjacency.getTriangles(fanning))
+        {
+            if(emitted[triangle])
+            {
+                continue;
+            }
+
+            for(unsigned int vertex : aIndices.subspan(3 * triangle, 3))
+            {
+                result.push_back(vertex);
+                deadEndStack.push_back(vertex);
+                --liveTriangles[vertex];
+                if(time - cacheTimestamps[vertex] > aCacheSize)
+                {
+                    cacheTimestamps[vertex] = time++;
+                }
+            }
+            emitted[triangle] = true;
+        }
+
+        // Prefer the oldest candidate that will still be in the cache after its remaining triangles are emitted
+        // (each triangle might insert up to 2 other vertices).
+        unsigned int next = gInvalidIndex;
+        int bestPriority = -1;
+        for(std::size_t candidateIdx = candidatesBegin; candidateIdx != deadEndStack.size(); ++candidateIdx)
+        {
+            unsigned int candidate = deadEndStack[candidateIdx];
+            if(liveTriangles[candidate] > 0)
+            {
+                int priority = 0;
+                unsigned int age = time - cacheTimestamps[candidate];
+                if(age + 2 * liveTriangles[candidate] <= aCacheSize)
+                {
+                    priority = (int)age;
+                }
+                if(priority > bestPriority)
+                {
+                    bestPriority = priority;
+                    next = candidate;
+                }
+            }
+        }
+
+        fanning = (next != gInvalidIndex) ? next : skipDeadEnd();
+    }
+
+    assert(result.size() == aIndices.size());
+    std::copy(result.begin(), result.end(), aIndices.begin());
+}
+
+
+void optimizeOverdraw(std::span<unsigned int> aIndices,
+                      std::span<const aiVector3D> aPositions,
+                      float aThreshold,
+                      unsigned int aCacheSize)
+{
+    assert(aIndices.size() % 3 == 0);
+    const std::size_t trianglesCount = aIndices.size() / 3;
+    if(trianglesCount == 0)
+    {
+        return;
+    }
+
+    auto triangle = [&](std::size_t aTriangleIdx)
+    {
+        return std::span<const unsigned int>{aIndices}.subspan(3 * aTriangleIdx, 3);
+    };
+
+    // Hard boundaries, where the cache is cold: all the vertices of the triangle are misses.
+    // The first triangle always starts a cluster, even if it has less than 3 misses (e.g. degenerate).
+    std::vector<std::size_t> hardBoundaries{0};
+    {
+        FifoCache cache{aPositions.size(), aCacheSize};
+        for(std::size_t triangleIdx = 0; triangleIdx != trianglesCount; ++triangleIdx)
+        {
+            if(countMisses(cache, triangle(triangleIdx)) == 3 && triangleIdx != 0)
+            {
+                hardBoundaries.push_back(triangleIdx);
+            }
+        }
+    }
+    hardBoundaries.push_back(trianglesCount);
+
+    // Soft boundaries split the hard clusters further, as soon as the ACMR of the current cluster
+    // is within the threshold of the ACMR of the whole hard cluster.
+    // This gives more freedom to the sort, at a bounded cost for the vertex cache.
+    std::vector<std::size_t> boundaries;
+    {
+        FifoCache cache{aPositions.size(), aCacheSize};
+        for(std::size_t hardIdx = 0; hardIdx + 1 != hardBoundaries.size(); ++hardIdx)
+        {
+            const std::size_t begin = hardBoundaries[hardIdx];
+            const std::size_t end = hardBoundaries[hardIdx + 1];
+
+            cache.flush();
+            unsigned int hardMisses = 0;
+            for(std::size_t triangleIdx = begin; triangleIdx != end; ++triangleIdx)
+            {
+                hardMisses += countMisses(cache, triangle(triangleIdx));
+            }
+            const float maxMisses = aThreshold * hardMisses / (end - begin);
+
+            boundaries.push_back(begin);
+            cache.flush();
+            unsigned int misses = 0;
+            std::size_t clusterBegin = begin;
+            for(std::size_t triangleIdx = begin; triangleIdx != end; ++triangleIdx)
+            {
+                misses += countMisses(cache, triangle(triangleIdx));
+                if(triangleIdx + 1 != end && misses <= maxMisses * (triangleIdx + 1 - clusterBegin))
+                {
+                    boundaries.push_back(triangleIdx + 1);
+                    clusterBegin = triangleIdx + 1;
+                    misses = 0;
+                    cache.flush();
+                }
+            }
+        }
+    }
+    boundaries.push_back(trianglesCount);
+    const std::size_t clustersCount = boundaries.size() - 1;
+
+    // Area weighted centroid and normal of each cluster.
+    // (the length of the cross product is twice the area of the triangle)
+    std::vector<aiVector3D> clusterCentroids(clustersCount);
+    std::vector<aiVector3D> clusterNormals(clustersCount);
+    aiVector3D meshCentroid{0.f, 0.f, 0.f};
+    float meshArea = 0.f;
+    for(std::size_t clusterIdx = 0; clusterIdx != clustersCount; ++clusterIdx)
+    {
+        aiVector3D centroid{0.f, 0.f, 0.f};
+        aiVector3D normal{0.f, 0.f, 0.f};
+        float area = 0.f;
+        for(std::size_t triangleIdx = boundaries[clusterIdx];
+            triangleIdx != boundaries[clusterIdx + 1];
+            ++triangleIdx)
+        {
+            std::span<const unsigned int> vertices = triangle(triangleIdx);
+            const aiVector3D & a = aPositions[vertices[0]];
+            const aiVector3D & b = aPositions[vertices[1]];
+            const aiVector3D & c = aPositions[vertices[2]];
+
+            aiVector3D crossProduct = (b - a) ^ (c - a);
+            float triangleArea = crossProduct.Length();
+            centroid += (a + b + c) * (triangleArea / 3.f);
+            normal += crossProduct;
+            area += triangleArea;
+        }
+
+        meshCentroid += centroid;
+        meshArea += area;
+        clusterCentroids[clusterIdx] = (area > 0.f) ? centroid / area : aPositions[aIndices[3 * boundaries[clusterIdx]]];
+        clusterNormals[clusterIdx] = normal;
+    }
+    if(meshArea > 0.f)
+    {
+        meshCentroid /= meshArea;
+    }
+
+    // Clusters facing outward, far from the centroid, are the most likely to occlude the rest of the mesh.
+    std::vector<float> sortKeys(clustersCount);
+    for(std::size_t clusterIdx = 0; clusterIdx != clustersCount; ++clusterIdx)
+    {
+        float normalLength = clusterNormals[clusterIdx].Length();
+        sortKeys[clusterIdx] = (normalLength > 0.f) ?
+            (clusterCentroids[clusterIdx] - meshCentroid) * clusterNormals[clusterIdx] / normalLength
+            : 0.f;
+    }
+
+    std::vector<std::size_t> order(clustersCount);
+    std::iota(order.begin(), order.end(), 0);
+    std::stable_sort(order.begin(), order.end(),
+                     [&](std::size_t aLhs, std::size_t aRhs)
+                     {
+                         return sortKeys[aLhs] > sortKeys[aRhs];
+                     });
+
+    std::vector<unsigned int> result;
+    result.reserve(aIndices.size());
+    for(std::size_t clusterIdx : order)
+    {
+        result.insert(result.end(),
+                      aIndices.begin() + 3 * boundaries[clusterIdx],
+                      aIndices.begin() + 3 * boundaries[clusterIdx + 1]);
+    }
+    assert(result.size() == aIndices.size());
+    std::copy(result.begin(), result.end(), aIndices.begin());
+}
+
+
+std::vector<unsigned int> optimizeVertexFetch(std::span<unsigned int> aIndices,
+                                              std::size_t aVerticesCount)
+{
+    std::vector<unsigned int> remap(aVerticesCount, gInvalidIndex);
+    unsigned int nextVertex = 0;
+    for(unsigned int & vertex : aIndices)
+    {
+        if(remap[vertex] == gInvalidIndex)
+        {
+            remap[vertex] = nextVertex++;
+        }
+        vertex = remap[vertex];
+    }
+
+    // Keep the unreferenced vertices, so the vertex count does not change.
+    for(unsigned int & newIndex : remap)
+    {
+        if(newIndex == gInvalidIndex)
+        {
+            newIndex = nextVertex++;
+        }
+    }
+    return remap;
+}
+
+
+SimplifiedMesh simplify(std::span<const unsigned int> aIndices,
+                        std::span<const aiVector3D> aPositions,
+                        std::size_t aTargetIndicesCount,
+                        float aMaxError)
+{
+    assert(aIndices.size() % 3 == 0);
+
+    // Vertices at the same position form a group, which is the unit of the collapses.
+    std::vector<unsigned int> groupOf(aPositions.size());
+    std::vector<aiVector3D> groupPositions;
+    {
+        std::map<std::array<float, 3>, unsigned int> positionToGroup;
+        for(std::size_t vertexIdx = 0; vertexIdx != aPositions.size(); ++vertexIdx)
+        {
+            const aiVector3D & position = aPositions[vertexIdx];
+            auto [found, inserted] = positionToGroup.try_emplace({position.x, position.y, position.z},
+                                                                 (unsigned int)groupPositions.size());
+            if(inserted)
+            {
+                groupPositions.push_back(position);
+            }
+            groupOf[vertexIdx] = found->second;
+        }
+    }
+    const std::size_t groupsCount = groupPositions.size();
+
+    auto isDegenerate = [&](std::span<const unsigned int> aTriangle)
+    {
+        unsigned int a = groupOf[aTriangle[0]], b = groupOf[aTriangle[1]], c = groupOf[aTriangle[2]];
+        return a == b || b == c || c == a;
+    };
+
+    SimplifiedMesh result;
+    result.mIndices.reserve(aIndices.size());
+    for(std::size_t indexIdx = 0; indexIdx != aIndices.size(); indexIdx += 3)
+    {
+        if(!isDegenerate(aIndices.subspan(indexIdx, 3)))
+        {
+            result.mIndices.insert(result.mIndices.end(), aIndices.begin() + indexIdx, aIndices.begin() + indexIdx + 3);
+        }
+    }
+    std::vector<unsigned int> & indices = result.mIndices;
+
+    // The quadrics of the original surface, accumulated by each collapse into its destination.
+    // The planes are weighted by the area of their triangle, and the costs are their weighted means:
+    // an area weighted mean of squared distances, i.e. a squared length comparable to aMaxError.
+    std::vector<Quadric> quadrics(groupsCount);
+    for(std::size_t indexIdx = 0; indexIdx != indices.size(); indexIdx += 3)
+    {
+        const aiVector3D & a = aPositions[indices[indexIdx]];
+        const aiVector3D & b = aPositions[indices[indexIdx + 1]];
+        const aiVector3D & c = aPositions[indices[indexIdx + 2]];
+        aiVector3D normal = (b - a) ^ (c - a);
+        const float doubleArea = normal.Length();
+        if(doubleArea > 0.f)
+        {
+            normal = normal / doubleArea;
+            Quadric plane = Quadric::fromPlane(normal, -(normal * a), doubleArea / 2.);
+            for(std::size_t cornerIdx = 0; cornerIdx != 3; ++cornerIdx)
+            {
+                quadrics[groupOf[indices[indexIdx + cornerIdx]]] += plane;
+            }
+        }
+    }
+
+    struct Collapse
+    {
+        double mCost;
+        unsigned int mFrom;
+        unsigned int mTo;
+    };
+
+    const double maxCost = (double)aMaxError * aMaxError;
+    double worstCost = 0.;
+
+    // Storage reused by each pass.
+    std::vector<std::vector<unsigned int>> groupTriangles(groupsCount);
+    std::map<std::pair<unsigned int, unsigned int>, unsigned int> edgeUses;
+    std::vector<bool> locked(groupsCount);
+    std::vector<bool> touched(groupsCount);
+    std::vector<Collapse> collapses;
+    std::vector<unsigned int> remap(aPositions.size());
+    std::vector<std::pair<unsigned int, unsigned int>> wedges;
+
+    // Each pass collapses independent edges (not sharing any triangle), by increasing cost.
+    while(indices.size() > aTargetIndicesCount)
+    {
+        const std::size_t trianglesCount = indices.size() / 3;
+
+        for(std::vector<unsigned int> & triangles : groupTriangles)
+        {
+            triangles.clear();
+        }
+        edgeUses.clear();
+        for(std::size_t triangleIdx = 0; triangleIdx != trianglesCount; ++triangleIdx)
+        {
+            for(std::size_t cornerIdx = 0; cornerIdx != 3; ++cornerIdx)
+            {
+                unsigned int group = groupOf[indices[3 * triangleIdx + cornerIdx]];
+                unsigned int next = groupOf[indices[3 * triangleIdx + (cornerIdx + 1) % 3]];
+                groupTriangles[group].push_back((unsigned int)triangleIdx);
+                ++edgeUses[std::minmax(group, next)];
+            }
+        }
+
+        // Border (and non-manifold) edges lock their vertices, so the silhouette of open meshes is preserved.
+        std::fill(locked.begin(), locked.end(), false);
+        for(const auto & [edge, uses] : edgeUses)
+        {
+            if(uses != 2)
+            {
+                locked[edge.first] = true;
+                locked[edge.second] = true;
+            }
+        }
+
+        collapses.clear();
+        for(const auto & [edge, uses] : edgeUses)
+        {
+            for(auto [from, to] : {edge, std::pair{edge.second, edge.first}})
+            {
+                if(!locked[from])
+                {
+                    double cost = (quadrics[from] + quadrics[to]).evaluateMean(groupPositions[to]);
+                    if(cost <= maxCost)
+                    {
+                        collapses.push_back({cost, from, to});
+                    }
+                }
+            }
+        }
+        std::sort(collapses.begin(), collapses.end(),
+                  [](const Collapse & aLhs, const Collapse & aRhs)
+                  {
+                      return aLhs.mCost < aRhs.mCost;
+                  });
+
+        std::fill(touched.begin(), touched.end(), false);
+        std::iota(remap.begin(), remap.end(), 0);
+        const std::size_t trianglesToRemove = trianglesCount - aTargetIndicesCount / 3;
+        std::size_t removedTriangles = 0;
+        bool collapsed = false;
+
+        for(const Collapse & collapse : collapses)
+        {
+            if(removedTriangles >= trianglesToRemove)
+            {
+                break;
+            }
+            if(touched[collapse.mFrom] || touched[collapse.mTo])
+            {
+                continue;
+            }
+
+            // Each vertex of the source group has to be mapped to a vertex of the destination group it shares an edge with.
+            // (otherwise the collapse would move across an attribute seam)
+            // The triangles not containing the edge must not flip.
+            wedges.clear();
+            bool valid = true;
+            std::size_t edgeTriangles = 0;
+            for(unsigned int triangleIdx : groupTriangles[collapse.mFrom])
+            {
+                std::span<const unsigned int> triangle = std::span{indices}.subspan(3 * triangleIdx, 3);
+                unsigned int fromCorner = 0, toCorner = 3;
+                for(unsigned int cornerIdx = 0; cornerIdx != 3; ++cornerIdx)
+                {
+                    unsigned int group = groupOf[triangle[cornerIdx]];
+                    if(group == collapse.mFrom)
+                    {
+                        fromCorner = cornerIdx;
+                    }
+                    else if(group == collapse.mTo)
+                    {
+                        toCorner = cornerIdx;
+                    }
+                }
+
+                if(toCorner != 3)
+                {
+                    ++edgeTriangles;
+                    if(std::none_of(wedges.begin(), wedges.end(),
+                                    [&](auto aWedge){ return aWedge.first == triangle[fromCorner]; }))
+                    {
+                        wedges.emplace_back(triangle[fromCorner], triangle[toCorner]);
+                    }
+                }
+                else
+                {
+                    const aiVector3D & b = aPositions[triangle[(fromCorner + 1) % 3]];
+                    const aiVector3D & c = aPositions[triangle[(fromCorner + 2) % 3]];
+                    aiVector3D normal = (b - aPositions[triangle[fromCorner]]) ^ (c - aPositions[triangle[fromCorner]]);
+                    aiVector3D collapsedNormal = (b - groupPositions[collapse.mTo]) ^ (c - groupPositions[collapse.mTo]);
+                    // Also reject large rotations, which could accumulate over the passes up to a flip.
+                    if(normal * collapsedNormal <= gMinNormalCosine * normal.Length() * collapsedNormal.Length())
+                    {
+                        valid = false;
+                        break;
+                    }
+                }
+            }
+
+            valid = valid && std::all_of(
+                groupTriangles[collapse.mFrom].begin(), groupTriangles[collapse.mFrom].end(),
+                [&](unsigned int aTriangleIdx)
+                {
+                    for(unsigned int vertex : std::span{indices}.subspan(3 * aTriangleIdx, 3))
+                    {
+                        if(groupOf[vertex] == collapse.mFrom)
+                        {
+                            return std::any_of(wedges.begin(), wedges.end(),
+                                               [&](auto aWedge){ return aWedge.first == vertex; });
+                        }
+                    }
+                    return false;
+                });
+            if(!valid)
+            {
+                continue;
+            }
+
+            for(auto [from, to] : wedges)
+            {
+                remap[from] = to;
+            }
+            quadrics[collapse.mTo] += quadrics[collapse.mFrom];
+            worstCost = std::max(worstCost, collapse.mCost);
+            removedTriangles += edgeTriangles;
+            collapsed = true;
+
+            // The neighbours must not move during this pass, the flip test relied on their positions.
+            for(unsigned int triangleIdx : groupTriangles[collapse.mFrom])
+            {
+                for(unsigned int vertex : std::span{indices}.subspan(3 * triangleIdx, 3))
+                {
+                    touched[groupOf[vertex]] = true;
+                }
+            }
+        }
+
+        if(!collapsed)
+        {
+            break;
+        }
+
+        // Apply the collapses, removing the triangles that became degenerate.
+        std::size_t kept = 0;
+        for(std::size_t indexIdx = 0; indexIdx != indices.size(); indexIdx += 3)
+        {
+            std::array<unsigned int, 3> triangle{
+                remap[indices[indexIdx]], remap[indices[indexIdx + 1]], remap[indices[indexIdx + 2]]
+            };
+            if(!isDegenerate(triangle))
+            {
+                std::copy(triangle.begin(), triangle.end(), indices.begin() + kept);
+                kept += 3;
+            }
+        }
+        indices.resize(kept);
+    }
+
+    result.mError = (float)std::sqrt(worstCost);
+    return result;
+}
+
+
+} // namespace ad::renderer
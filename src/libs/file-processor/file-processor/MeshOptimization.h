@@ -0,0 +1,86 @@
+#pragma once
+
+
+#include <assimp/vector3.h>
+
+#include <span>
+#include <vector>
+
+
+namespace ad::renderer {
+
+
+/// @brief Size of the FIFO post-transform vertex cache, for which the index buffers are optimized.
+/// @note Conservative value, it is smaller than the cache of recent GPUs.
+constexpr unsigned int gVertexCacheSize = 16;
+
+
+/// @brief Efficiency of an index buffer, for a simulated FIFO post-transform vertex cache.
+struct VertexCacheStatistics
+{
+    /// @brief Average cache miss ratio: vertex shader invocations per triangle, in [0.5, 3].
+    float mAcmr = 0.f;
+    /// @brief Average transformed vertex ratio: vertex shader invocations per vertex, 1 is optimal.
+    float mAtvr = 0.f;
+};
+
+
+/// @brief Simulate a FIFO vertex cache of size `aCacheSize` while rendering the triangle list `aIndices`.
+VertexCacheStatistics analyzeVertexCache(std::span<const unsigned int> aIndices,
+                                         std::size_t aVerticesCount,
+                                         unsigned int aCacheSize = gVertexCacheSize);
+
+
+/// @brief Reorder the triangles of `aIndices` in place, to reduce the post-transform vertex cache misses.
+///
+/// Implements Tipsify, from "Fast Triangle Reordering for Vertex Locality and Reduced Overdraw"
+/// (Sander, Nehab & Barczak, 2007).
+void optimizeVertexCache(std::span<unsigned int> aIndices,
+                         std::size_t aVerticesCount,
+                         unsigned int aCacheSize = gVertexCacheSize);
+
+
+/// @brief Reorder clusters of triangles of `aIndices` in place, drawing first the clusters most likely
+/// to occlude the others.
+/// @param aThreshold Factor by which the ACMR of each cluster may degrade when it is split in smaller clusters.
+/// @note Should be applied after optimizeVertexCache(), whose output is cut in clusters where the cache is cold.
+///
+/// Clusters are sorted by how much they face away from the mesh centroid, which does not depend on the view point
+/// (the linear-speed sort from the same paper as Tipsify).
+void optimizeOverdraw(std::span<unsigned int> aIndices,
+                      std::span<const aiVector3D> aPositions,
+                      float aThreshold = 1.05f,
+                      unsigned int aCacheSize = gVertexCacheSize);
+
+
+/// @brief Renumber the vertices in order of first use by `aIndices`, which is rewritten in place.
+/// @return The new index of each vertex, unreferenced vertices being moved to the end.
+/// The vertex attributes have to be permuted accordingly by the caller.
+std::vector<unsigned int> optimizeVertexFetch(std::span<unsigned int> aIndices,
+                                              std::size_t aVerticesCount);
+
+
+/// @brief Index buffer of a simplified version of a mesh, still indexing the original vertices.
+struct SimplifiedMesh
+{
+    std::vector<unsigned int> mIndices;
+    /// @brief Largest deviation introduced by the simplification, as a length in the positions space.
+    /// @note The deviation of a collapse is the root of the area weighted mean of the squared distances
+    /// from the destination vertex to the planes of the original triangles around both vertices.
+    float mError = 0.f;
+};
+
+
+/// @brief Simplify the triangle list `aIndices` by collapsing edges onto existing vertices,
+/// ordered by a quadric error metric (Garland & Heckbert, 1997),
+/// until it has at most `aTargetIndicesCount` indices or no collapse keeps the deviation under `aMaxError`.
+///
+/// Vertices on borders are locked. Vertices on attribute seams (i.e. distinct vertices at the same position)
+/// only collapse along the seam, so all their attributes stay continuous.
+SimplifiedMesh simplify(std::span<const unsigned int> aIndices,
+                        std::span<const aiVector3D> aPositions,
+                        std::size_t aTargetIndicesCount,
+                        float aMaxError);
+
+
+} // namespace ad::renderer
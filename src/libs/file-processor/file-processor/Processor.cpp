@@ -2,8 +2,11 @@
 
 #include "AssimpUtils.h"
 #include "Logging.h"
+#include "MeshOptimization.h"
 #include "ProcessAnimation.h"
+#include "Quantization.h"
 
+#include <assimp/DefaultIOSystem.h>
 #include <assimp/DefaultLogger.hpp>
 #include <assimp/Importer.hpp>      // C++ importer interface
 #include <assimp/scene.h>           // Output data structure
@@ -19,13 +22,22 @@
 #include <snac-renderer-V2/files/BinaryArchive.h>
 #include <snac-renderer-V2/files/Flags.h>
 #include <snac-renderer-V2/files/Versioning.h>
+#include <snac-renderer-V2/files/VertexEncoding.h>
 
 #include <fmt/ostream.h>
 
+#include <algorithm>
+#include <array>
 #include <fstream>
+#include <functional>
 #include <iostream>
 #include <optional>
+#include <set>
 #include <span>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
 
 
 namespace ad::renderer {
@@ -33,16 +45,220 @@ namespace ad::renderer {
 namespace {
 
 
+    // Thread local, so models can be processed concurrently, each job reporting to its own stream.
+    thread_local std::ostream * gReport = &std::cout;
+
+    std::ostream & report()
+    {
+        return *gReport;
+    }
+
+
+    /// @brief Record the files successfully opened by the importer, which are dependencies of the output.
+    class RecordingIOSystem : public Assimp::DefaultIOSystem
+    {
+    public:
+        explicit RecordingIOSystem(std::vector<std::filesystem::path> & aOpenedFiles) :
+            mOpenedFiles{aOpenedFiles}
+        {}
+
+        Assimp::IOStream * Open(const char * aFile, const char * aMode) override
+        {
+            Assimp::IOStream * stream = DefaultIOSystem::Open(aFile, aMode);
+            if(stream != nullptr)
+            {
+                mOpenedFiles.push_back(aFile);
+            }
+            return stream;
+        }
+
+    private:
+        std::vector<std::filesystem::path> & mOpenedFiles;
+    };
+
+
     struct FileWriter
     {
-        FileWriter(std::filesystem::path aDestinationFile) :
+        FileWriter(std::filesystem::path aDestinationFile, const VertexEncoding & aVertexEncoding) :
             mArchive{
                 .mOut = std::ofstream{aDestinationFile, std::ios::binary},
                 .mParentPath = aDestinationFile.parent_path(),
-            }
+            },
+            mVertexEncoding{aVertexEncoding}
         {
             mArchive.write(gSeumMagic);
             mArchive.write(gSeumVersion);
+            // Reserve the table of contents, completed by completeTableOfContents()
+            mTableOfContentsPosition = mArchive.getPosition();
+            mArchive.write(std::span{&mTableOfContents, 1});
+        }
+
+        /// @brief Start the section `aSection` at the current position, ending the previous section.
+        void beginSection(SeumSection SeumTableOfContents::* aSection)
+        {
+            endSection();
+            mCurrentSection = &(mTableOfContents.*aSection);
+            mCurrentSection->mOffset = (std::uint64_t)mArchive.getPosition();
+        }
+
+        void completeTableOfContents()
+        {
+            endSection();
+            auto initialPosition = mArchive.getPosition();
+            mArchive.mOut.seekp(mTableOfContentsPosition);
+            mArchive.write(std::span{&mTableOfContents, 1});
+            mArchive.mOut.seekp(initialPosition);
+        }
+
+        /// @brief Pad up to the alignment of data blobs, to be called before writing each blob.
+        void alignBlob()
+        {
+            static constexpr std::array<char, gSeumBlobAlignment> gPadding{};
+            const auto position = (std::size_t)mArchive.getPosition();
+            mArchive.write(std::span{gPadding.data(),
+                                     (gSeumBlobAlignment - position % gSeumBlobAlignment) % gSeumBlobAlignment});
+        }
+
+        template <class T_element>
+        void writeBlob(std::span<T_element> aData)
+        {
+            alignBlob();
+            mArchive.write(aData);
+        }
+
+        /// @brief Write the blob of `aSource` elements, each converted to `T_encoded` by `aEncode`.
+        template <class T_encoded, class T_source, class F_encode>
+        void writeEncodedBlob(std::span<T_source> aSource, F_encode aEncode)
+        {
+            std::vector<T_encoded> encoded;
+            encoded.reserve(aSource.size());
+            std::transform(aSource.begin(), aSource.end(), std::back_inserter(encoded), aEncode);
+            writeBlob(std::span{encoded});
+        }
+
+        void writePositions(std::span<const aiVector3D> aPositions)
+        {
+            if(mVertexEncoding.hasQuantizedPositions())
+            {
+                assert(mVertexEncoding.mPosition.mComponentType == GL_UNSIGNED_SHORT);
+                writeEncodedBlob<std::array<std::uint16_t, 3>>(
+                    aPositions,
+                    [this](const aiVector3D & aPosition)
+                    {
+                        auto quantized = (toVec(aPosition) - mQuantizationOffset) / mQuantizationScale;
+                        return std::array<std::uint16_t, 3>{
+                            toUnorm16(quantized.x()), toUnorm16(quantized.y()), toUnorm16(quantized.z())
+                        };
+                    });
+            }
+            else
+            {
+                writeBlob(aPositions);
+            }
+        }
+
+        /// @brief Write normals, tangents or bitangents.
+        void writeDirections(const AttributeEncoding & aEncoding, std::span<const aiVector3D> aDirections)
+        {
+            if(aEncoding.mComponentType == GL_SHORT)
+            {
+                writeEncodedBlob<std::array<std::int16_t, 3>>(
+                    aDirections,
+                    [](const aiVector3D & aDirection)
+                    {
+                        return std::array<std::int16_t, 3>{
+                            toSnorm16(aDirection.x), toSnorm16(aDirection.y), toSnorm16(aDirection.z)
+                        };
+                    });
+            }
+            else
+            {
+                assert(aEncoding.mComponentType == GL_FLOAT);
+                writeBlob(aDirections);
+            }
+        }
+
+        void writeColors(std::span<const aiColor4D> aColors)
+        {
+            if(mVertexEncoding.mColor.mComponentType == GL_UNSIGNED_BYTE)
+            {
+                writeEncodedBlob<std::array<std::uint8_t, 4>>(
+                    aColors,
+                    [](const aiColor4D & aColor)
+                    {
+                        return std::array<std::uint8_t, 4>{
+                            toUnorm8(aColor.r), toUnorm8(aColor.g), toUnorm8(aColor.b), toUnorm8(aColor.a)
+                        };
+                    });
+            }
+            else
+            {
+                writeBlob(aColors);
+            }
+        }
+
+        /// @brief Write the first two coordinates of each texture coordinates.
+        void writeUvs(std::span<const aiVector3D> aUvs)
+        {
+            if(mVertexEncoding.mUv.mComponentType == GL_HALF_FLOAT)
+            {
+                writeEncodedBlob<std::array<std::uint16_t, 2>>(
+                    aUvs,
+                    [](const aiVector3D & aUv)
+                    {
+                        return std::array<std::uint16_t, 2>{toHalf(aUv.x), toHalf(aUv.y)};
+                    });
+            }
+            else
+            {
+                writeEncodedBlob<std::array<float, 2>>(
+                    aUvs,
+                    [](const aiVector3D & aUv)
+                    {
+                        return std::array<float, 2>{aUv.x, aUv.y};
+                    });
+            }
+        }
+
+        void writeJointData(std::span<const VertexJointData> aJointData)
+        {
+            // Converts to the interleaved compact layout, with indices of type T_index.
+            auto writeCompact = [this, aJointData]<class T_index>(T_index)
+            {
+                struct CompactJointData
+                {
+                    std::array<T_index, VertexJointData::gMaxBones> mBoneIndices;
+                    std::array<std::uint16_t, VertexJointData::gMaxBones> mBoneWeights;
+                };
+                static_assert(sizeof(CompactJointData) == VertexJointData::gMaxBones * (sizeof(T_index) + 2));
+
+                writeEncodedBlob<CompactJointData>(
+                    aJointData,
+                    [](const VertexJointData & aData)
+                    {
+                        CompactJointData result;
+                        for(std::size_t boneIdx = 0; boneIdx != VertexJointData::gMaxBones; ++boneIdx)
+                        {
+                            assert(aData.mBoneIndices[boneIdx] <= std::numeric_limits<T_index>::max());
+                            result.mBoneIndices[boneIdx] = (T_index)aData.mBoneIndices[boneIdx];
+                            result.mBoneWeights[boneIdx] = toUnorm16(aData.mBoneWeights[boneIdx]);
+                        }
+                        return result;
+                    });
+            };
+
+            switch(mVertexEncoding.mJointIndices.mComponentType)
+            {
+                case GL_UNSIGNED_BYTE:
+                    writeCompact(std::uint8_t{});
+                    break;
+                case GL_UNSIGNED_SHORT:
+                    writeCompact(std::uint16_t{});
+                    break;
+                default:
+                    assert(mVertexEncoding.mJointIndices.mComponentType == GL_UNSIGNED_INT);
+                    writeBlob(aJointData);
+            }
         }
 
         void write(const aiNode * aNode)
@@ -55,7 +271,31 @@ namespace {
             mArchive.write(extractAffinePart(aNode));
         }
 
-        void write(const aiMesh * aMesh)
+        /// @brief Set the box to which the positions of the following meshes are quantized,
+        /// writing the transformation to dequantize them.
+        /// @note Has no effect when positions are not quantized.
+        void setPositionQuantization(const math::Box<float> & aBox)
+        {
+            if(mVertexEncoding.hasQuantizedPositions())
+            {
+                // A cube, so the dequantization is a uniform scale (that does not distort normals)
+                mQuantizationOffset = aBox.mPosition.as<math::Vec>();
+                mQuantizationScale = std::max({aBox.mDimension.width(), aBox.mDimension.height(), aBox.mDimension.depth()});
+                if(mQuantizationScale == 0.f)
+                {
+                    mQuantizationScale = 1.f;
+                }
+                forward(mQuantizationOffset);
+                forward(mQuantizationScale);
+            }
+        }
+
+        void writeVertexEncoding()
+        {
+            forward(std::span{&mVertexEncoding, 1});
+        }
+
+        void write(const aiMesh * aMesh, std::span<const SimplifiedMesh> aLods)
         {
             mArchive.write(std::string{aMesh->mName.C_Str()});
 
@@ -84,24 +324,24 @@ namespace {
 
             // Vertices
             mArchive.write(aMesh->mNumVertices);
-            mArchive.write(std::span{aMesh->mVertices, aMesh->mNumVertices});
+            writePositions(std::span{aMesh->mVertices, aMesh->mNumVertices});
 
             assert(aMesh->mNormals != nullptr);
-            mArchive.write(std::span{aMesh->mNormals, aMesh->mNumVertices});
+            writeDirections(mVertexEncoding.mNormal, std::span{aMesh->mNormals, aMesh->mNumVertices});
 
             if(tangents)
             {
-                mArchive.write(std::span{tangents, aMesh->mNumVertices});
+                writeDirections(mVertexEncoding.mTangent, std::span{tangents, aMesh->mNumVertices});
             }
             if(bitangents)
             {
-                mArchive.write(std::span{bitangents, aMesh->mNumVertices});
+                writeDirections(mVertexEncoding.mBitangent, std::span{bitangents, aMesh->mNumVertices});
             }
 
             mArchive.write(aMesh->GetNumColorChannels());
             for (unsigned int colorIdx = 0; colorIdx != aMesh->GetNumColorChannels(); ++colorIdx)
             {
-                mArchive.write(std::span{aMesh->mColors[colorIdx], aMesh->mNumVertices});
+                writeColors(std::span{aMesh->mColors[colorIdx], aMesh->mNumVertices});
             }
 
             mArchive.write(aMesh->GetNumUVChannels());
@@ -112,21 +352,28 @@ namespace {
                 //assert(aMesh->mNumUVComponents[uvIdx] == 2);
                 // TODO Interleave the odd channel with their preceding even channel
                 // (i.e. better usage of the 4 components of each vertex attribute)
-                for(unsigned int vertexIdx = 0; vertexIdx != aMesh->mNumVertices; ++vertexIdx)
-                {
-                    mArchive.write(std::span{&(aMesh->mTextureCoords[uvIdx][vertexIdx].x), 2});
-                    // Even the assertion below does not hold true for teapot.obj
-                    //assert(aMesh->mTextureCoords[uvIdx][vertexIdx].z == 0);
-                }
+                // Even the assertion below does not hold true for teapot.obj
+                //assert(aMesh->mTextureCoords[uvIdx][vertexIdx].z == 0);
+                writeUvs(std::span{aMesh->mTextureCoords[uvIdx], aMesh->mNumVertices});
             }
 
             // Faces
             mArchive.write(aMesh->mNumFaces);
+            alignBlob();
             for(std::size_t faceIdx = 0; faceIdx != aMesh->mNumFaces; ++faceIdx)
             {
                 const aiFace & face = aMesh->mFaces[faceIdx];
                 mArchive.write(std::span{face.mIndices, 3});
             }
+
+            // Levels of detail, indexing the same vertices
+            forward((unsigned int)aLods.size());
+            for(const SimplifiedMesh & lod : aLods)
+            {
+                forward(lod.mError);
+                forward((unsigned int)(lod.mIndices.size() / 3));
+                writeBlob(std::span{lod.mIndices});
+            }
         }
 
 
@@ -134,14 +381,16 @@ namespace {
         {
             forward(aAnimation.mName);
             forward(aAnimation.mDuration);
-            writeRaw(std::span{aAnimation.mTimepoints});
-            writeRaw(std::span{aAnimation.mNodes});
+            forward((unsigned int)aAnimation.mTimepoints.size());
+            writeBlob(std::span{aAnimation.mTimepoints});
+            forward((unsigned int)aAnimation.mNodes.size());
+            writeBlob(std::span{aAnimation.mNodes});
 
             for(const RigAnimation::NodeKeyframes & keyframes : aAnimation.mKeyframes)
             {
-                forward(std::span{keyframes.mTranslations});
-                forward(std::span{keyframes.mRotations});
-                forward(std::span{keyframes.mScales});
+                writeBlob(std::span{keyframes.mTranslations});
+                writeBlob(std::span{keyframes.mRotations});
+                writeBlob(std::span{keyframes.mScales});
             }
         }
 
@@ -177,6 +426,23 @@ namespace {
         }
 
         BinaryOutArchive mArchive;
+
+    private:
+        VertexEncoding mVertexEncoding;
+        math::Vec<3, float> mQuantizationOffset = math::Vec<3, float>::Zero();
+        float mQuantizationScale = 1.f;
+
+        void endSection()
+        {
+            if(mCurrentSection != nullptr)
+            {
+                mCurrentSection->mSize = (std::uint64_t)mArchive.getPosition() - mCurrentSection->mOffset;
+            }
+        }
+
+        SeumTableOfContents mTableOfContents{};
+        BinaryOutArchive::Position_t mTableOfContentsPosition;
+        SeumSection * mCurrentSection = nullptr;
     };
     
 
@@ -190,6 +456,10 @@ namespace {
         std::unordered_map<std::string, NodeTree<Rig::Pose>::Node::Index> mNameToTreeNode;
     };
 
+    /// @brief The levels of detail of each mesh, indexed as the scene meshes.
+    using SceneLods = std::vector<std::vector<SimplifiedMesh>>;
+
+
     /// @brief Return type on "visiting" a node (i.e. recurseNode())
     struct NodeResult
     {
@@ -228,18 +498,25 @@ namespace {
 
 
     // Current binary format as of 2023/07/25:
+    //  (since version 5: table of contents, i.e. offset and size of the node, animation and material sections)
+    //  (since version 5: each [blob] below is preceded by zero padding, aligning it to gSeumBlobAlignment)
     //  vertices count
     //  indices count
+    //  (since version 6: vertex encoding, i.e. component type, count, and normalization of each vertex stream)
     //  Node:
     //    node.name
     //    node.numMeshes
     //    node.numChildren
     //    node.transformation
+    //    <if node.numMeshes and positions are quantized>:
+    //      positions dequantization offset (3 floats), then scale (float)
     //    each node.mesh:
     //      mesh.name
     //      mesh.materialIndex
     //      mesh.vertexAttributesFlags
     //      mesh.numVertices
+    //      (since version 6: the vertex streams below are stored according to the vertex encoding,
+    //       the element types given here correspond to the float encoding)
     //      [mesh.vertices(i.e. positions, 3 floats per vertex)]
     //      [mesh.normals(3 floats per vertex)]
     //      <if mesh.hasTangents>: [mesh.tangents(3 floats per vertex)]
@@ -252,6 +529,12 @@ namespace {
     //        [UVChannel.coordinates(2 floats per vertex)]
     //      mesh.numFaces
     //      [mesh.faces(i.e. 3 unsigned int per face)]
+    //      (since version 7:)
+    //      mesh.numLods (simplified levels of detail, coarser with each level)
+    //      each mesh.lod:
+    //        lod.error (float, largest deviation from the mesh, in the node space)
+    //        lod.numFaces
+    //        [lod.faces(i.e. 3 unsigned int per face, indexing the mesh vertices)]
     //      mesh.numBones
     //      <if mesh.hasBones>:
     //          [mesh.jointData (i.e 4 bone indices (unsigned int) then 4 bone weights (float), per vertex)]
@@ -279,9 +562,9 @@ namespace {
     //    name string characters
     //    duration
     //    num keyframes (== num of timepoints)
-    //    raw dump of timepoints
+    //    [raw dump of timepoints]
     //    num nodes
-    //    raw dump of node indices
+    //    [raw dump of node indices]
     //    each node:
     //      [keyframes.positions (3 floats per keyframe)]
     //      [keyframes.rotations (4 floats per keyframe)]
@@ -306,17 +589,28 @@ namespace {
     /// @return AABB of the node, as the union of nested nodes and meshes AABBs.
     NodeResult recurseNodes(aiNode * aNode,
                             const aiScene * aScene,
+                            const SceneLods & aLods,
                             FileWriter & aWriter,
                             unsigned int level = 0)
     {
-        std::cout << std::string(2 * level, ' ') << "'" << aNode->mName.C_Str() << "'"
-                  << ", " << aNode->mNumMeshes << " mesh(es)"
-                  << ", " << aNode->mNumChildren << " child(ren)"
-                  << "\n"
+        report() << std::string(2 * level, ' ') << "'" << aNode->mName.C_Str() << "'"
+                 << ", " << aNode->mNumMeshes << " mesh(es)"
+                 << ", " << aNode->mNumChildren << " child(ren)"
+                 << "\n"
                   ;
 
         aWriter.write(aNode);
 
+        if(aNode->mNumMeshes != 0)
+        {
+            math::Box<float> meshesAabb = extractAabb(aScene->mMeshes[aNode->mMeshes[0]]);
+            for(std::size_t meshIdx = 1; meshIdx != aNode->mNumMeshes; ++meshIdx)
+            {
+                meshesAabb.uniteAssign(extractAabb(aScene->mMeshes[aNode->mMeshes[meshIdx]]));
+            }
+            aWriter.setPositionQuantization(meshesAabb);
+        }
+
         NodeResult result;
         // Prime this node's bounding box
         if(aNode->mNumMeshes != 0)
@@ -341,8 +635,12 @@ namespace {
             result.mAabb.uniteAssign(meshAabb);
             result.mVerticesCount += mesh->mNumVertices;
             result.mIndicesCount += mesh->mNumFaces * 3;
+            for(const SimplifiedMesh & lod : aLods[globalMeshIndex])
+            {
+                result.mIndicesCount += (unsigned int)lod.mIndices.size();
+            }
 
-            std::cout << std::string(2 * level, ' ')
+            report() << std::string(2 * level, ' ')
                 << "- Mesh " << globalMeshIndex << " '" << mesh->mName.C_Str() << "'" 
                     << " with " << mesh->mNumVertices << " vertices, " << mesh->mNumFaces << " triangles"
                     << ", material '" << aScene->mMaterials[mesh->mMaterialIndex]->GetName().C_Str() 
@@ -360,7 +658,7 @@ namespace {
                 << "\n"
                 ;
 
-            aWriter.write(mesh);
+            aWriter.write(mesh, aLods[globalMeshIndex]);
 
             //
             // Skeletal animation data
@@ -397,7 +695,7 @@ namespace {
                                       nodeRig->mAiNodeToTreeNode,
                                       nodeRig->mCommonArmature);
 
-                aWriter.forward(std::span{jointData});
+                aWriter.writeJointData(std::span{jointData});
             }
 
             aWriter.forward(meshAabb);
@@ -460,7 +758,7 @@ namespace {
         for(std::size_t childIdx = 0; childIdx != aNode->mNumChildren; ++childIdx)
         {
             NodeResult childResult = 
-                recurseNodes(aNode->mChildren[childIdx], aScene, aWriter, level + 1);
+                recurseNodes(aNode->mChildren[childIdx], aScene, aLods, aWriter, level + 1);
             if(childIdx == 0 && aNode->mNumMeshes == 0) // The box was not primed yet
             {
                 result.mAabb = childResult.mAabb;
@@ -513,7 +811,7 @@ namespace {
             assert(animation->mTicksPerSecond != 0); // Means it would be absent from the imported file
 
             const float duration = (float)(animation->mDuration / animation->mTicksPerSecond);
-            std::cout << "Animation '" << animation->mName.C_Str() << "'"
+            report() << "Animation '" << animation->mName.C_Str() << "'"
                 << ", " << "duration " << duration << "s"
                 << " (at " << animation->mTicksPerSecond << " ticks/s)"
                 << "\n"
@@ -611,7 +909,7 @@ namespace {
                 rigAnimation.mTimepoints.push_back(0.);
             }
 
-            std::cout << "  * " << animationNumKeyframes << " keyframes posing " << animatedNodes << " nodes\n";
+            report() << "  * " << animationNumKeyframes << " keyframes posing " << animatedNodes << " nodes\n";
         }
         aWriter.write(animations);
     }
@@ -632,7 +930,7 @@ namespace {
         if(aMaterial->Get(aArgs..., aiColor) == AI_SUCCESS)
         {
             set(aiColor, aDestination);
-            std::cout << "  color '" << std::get<0>(std::forward_as_tuple(aArgs...)) << "': " << aDestination << "\n";
+            report() << "  color '" << std::get<0>(std::forward_as_tuple(aArgs...)) << "': " << aDestination << "\n";
         }
     }
 
@@ -667,7 +965,19 @@ namespace {
                 SELOG(info)("Resampling image {} to {}.", *imagePath, fmt::streamed(commonDimensions));
 
                 path = path.parent_path() / aUpsampledDir / path.filename();
-                resampleImage(image, commonDimensions).saveFile(aParentPath / path);
+                // Only created when an image is actually upsampled, so no empty directory is left behind.
+                create_directories((aParentPath / path).parent_path());
+
+                // Models sharing textures might be processed concurrently:
+                // the complete image is moved in place, so it is never read while partially written.
+                filesystem::path destination = aParentPath / path;
+                filesystem::path temporary = destination;
+                temporary.replace_filename(
+                    "~" + std::to_string(std::hash<std::thread::id>{}(std::this_thread::get_id()))
+                    + "_" + path.filename().string());
+                resampleImage(image, commonDimensions).saveFile(temporary);
+                filesystem::rename(temporary, destination);
+
                 *imagePath = path.string();
             }
         }
@@ -682,12 +992,20 @@ namespace {
     // the path of upsampled images in `aTexturePaths`.
     // The complexity got out of hand with the implementation of a cache mechanism,
     // not resampling images that already were.
-    void dumpTextures(std::vector<std::string> & aTexturePaths, FileWriter & aWriter)
+    // The source images, and the upsampled images, are appended to `aDependencies`.
+    void dumpTextures(std::vector<std::string> & aTexturePaths,
+                      FileWriter & aWriter,
+                      std::vector<std::filesystem::path> & aDependencies)
     {
         using Image = arte::Image<math::sdr::Rgba>;
 
         filesystem::path basePath = aWriter.mArchive.mParentPath;
 
+        for(const auto & texture : aTexturePaths)
+        {
+            aDependencies.push_back(basePath / texture);
+        }
+
         math::Size<2, int> commonDimensions;
         std::optional<math::Size<2, int>> upsampledDimensions;
 
@@ -737,11 +1055,18 @@ namespace {
 
             if(!notAlreadyUpsampled.empty())
             {
-                create_directory(upsampledDirAbsolute); // Does nothing if the dir already exists
+                const std::vector<std::string> sources = notAlreadyUpsampled;
                 commonDimensions = resampleImages(notAlreadyUpsampled, basePath, upsampledDir);
                 assert(!upsampledDimensions || commonDimensions == *upsampledDimensions);
-                std::error_code ec;
-                filesystem::remove(upsampledDirAbsolute, ec); // this function only removes empty directories
+                // Patch the paths of the images upsampled by this invocation, so the output does not depend
+                // on whether they already existed.
+                for(auto & texture : aTexturePaths)
+                {
+                    if(auto found = std::find(sources.begin(), sources.end(), texture); found != sources.end())
+                    {
+                        texture = notAlreadyUpsampled[found - sources.begin()];
+                    }
+                }
             }
             else
             {
@@ -750,6 +1075,15 @@ namespace {
             }
         }
 
+        // The upsampled images are read in place of their source when the output is loaded.
+        for(const auto & texture : aTexturePaths)
+        {
+            if(filesystem::path{texture}.parent_path().filename() == "upsampled")
+            {
+                aDependencies.push_back(basePath / texture);
+            }
+        }
+
         aWriter.forward(commonDimensions);
         aWriter.write(aTexturePaths);
     }
@@ -769,7 +1103,7 @@ namespace {
         aiString texPath;
         if(aAiMaterial->Get(_AI_MATKEY_TEXTURE_BASE, aTextureType, indexInStack, texPath) == AI_SUCCESS)
         {
-            std::cout << "  " << aiTextureTypeToString(aTextureType) << " texture: path '" << texPath.C_Str() << "'";
+            report() << "  " << aiTextureTypeToString(aTextureType) << " texture: path '" << texPath.C_Str() << "'";
 
             result = {
                 .mTextureIndex = (TextureInput::Index)aTexturePaths.size(),
@@ -782,20 +1116,22 @@ namespace {
             if(aAiMaterial->Get(_AI_MATKEY_UVWSRC_BASE, aTextureType, indexInStack, aiIndex) == AI_SUCCESS)
             {
                 result.mUVAttributeIndex = aiIndex;
-                std::cout << ", explicit UV channel " << aiIndex;
+                report() << ", explicit UV channel " << aiIndex;
             }
             else
             {
-                std::cout << ", implicit UV channel " << result.mUVAttributeIndex;
+                report() << ", implicit UV channel " << result.mUVAttributeIndex;
             }
 
-            std::cout << "\n"; // Terminate the output which started entering this scope
+            report() << "\n"; // Terminate the output which started entering this scope
         }
         return result;
     }
 
 
-    void dumpMaterials(const aiScene * aScene, FileWriter & aWriter)
+    void dumpMaterials(const aiScene * aScene,
+                       FileWriter & aWriter,
+                       std::vector<std::filesystem::path> & aDependencies)
     {
         std::vector<GenericMaterial> materials;
         materials.reserve(aScene->mNumMaterials);
@@ -814,7 +1150,7 @@ namespace {
 
             materialNames.emplace_back(material->GetName().C_Str());
 
-            std::cout << "Material '" << material->GetName().C_Str()
+            report() << "Material '" << material->GetName().C_Str()
                 << "' Diffuse tex:" << material->GetTextureCount(aiTextureType_DIFFUSE)
                 << " Specular tex:" << material->GetTextureCount(aiTextureType_SPECULAR)
                 << " Ambient tex:" << material->GetTextureCount(aiTextureType_AMBIENT)
@@ -858,16 +1194,16 @@ namespace {
                                 gSpecularExponent);
                     genericMaterial.mSpecularExponent = gSpecularExponent;
                 }
-                std::cout << "  specular exponent: " << genericMaterial.mSpecularExponent << "\n";
+                report() << "  specular exponent: " << genericMaterial.mSpecularExponent << "\n";
             }
 
             if(material->Get(AI_MATKEY_OPACITY, genericMaterial.mDiffuseColor.a()) == AI_SUCCESS)
             {
-                std::cout << "  opacity factor: " << genericMaterial.mDiffuseColor.a() << "\n";
+                report() << "  opacity factor: " << genericMaterial.mDiffuseColor.a() << "\n";
             }
             else if(material->Get(AI_MATKEY_TRANSPARENCYFACTOR, genericMaterial.mDiffuseColor.a()) == AI_SUCCESS)
             {
-                std::cout << "  transparency factor: " << genericMaterial.mDiffuseColor.a() << "\n";
+                report() << "  transparency factor: " << genericMaterial.mDiffuseColor.a() << "\n";
                 genericMaterial.mDiffuseColor.a() = 1 - genericMaterial.mDiffuseColor.a();
             }
 
@@ -876,21 +1212,259 @@ namespace {
 
         aWriter.writeRaw(std::span{materials});
         aWriter.write(materialNames);
-        dumpTextures(diffuseTexturePaths, aWriter);
-        dumpTextures(normalTexturePaths, aWriter);
-        dumpTextures(mraoTexturePaths, aWriter);
+        dumpTextures(diffuseTexturePaths, aWriter, aDependencies);
+        dumpTextures(normalTexturePaths, aWriter, aDependencies);
+        dumpTextures(mraoTexturePaths, aWriter, aDependencies);
+    }
+
+
+    /// @brief Select the encoding of the vertex streams, which is common to all meshes in the scene.
+    VertexEncoding selectVertexEncoding(const aiScene * aScene, const ProcessorOptions & aOptions)
+    {
+        if(!aOptions.mCompactVertices)
+        {
+            return gFloatVertexEncoding;
+        }
+
+        VertexEncoding result = gCompactVertexEncoding;
+
+        // Bones are deduplicated by the node they target (see JointDataDeduplicate)
+        std::set<const aiNode *> jointNodes;
+        for(unsigned int meshIdx = 0; meshIdx != aScene->mNumMeshes; ++meshIdx)
+        {
+            const aiMesh * mesh = aScene->mMeshes[meshIdx];
+            for(unsigned int boneIdx = 0; boneIdx != mesh->mNumBones; ++boneIdx)
+            {
+                jointNodes.insert(mesh->mBones[boneIdx]->mNode);
+            }
+        }
+
+        if(!jointNodes.empty())
+        {
+            // Skinning applies to the vertex positions before the model transform,
+            // which thus cannot dequantize the positions.
+            result.mPosition = gFloatVertexEncoding.mPosition;
+
+            if(jointNodes.size() > std::numeric_limits<std::uint8_t>::max() + 1)
+            {
+                result.mJointIndices.mComponentType = GL_UNSIGNED_SHORT;
+            }
+        }
+
+        return result;
+    }
+
+
+    /// @brief Write the attribute of each vertex at its new index in `aRemap`.
+    template <class T_attribute>
+    void permuteVertices(T_attribute * aAttribute, std::span<const unsigned int> aRemap)
+    {
+        if(aAttribute != nullptr)
+        {
+            std::vector<T_attribute> source{aAttribute, aAttribute + aRemap.size()};
+            for(std::size_t vertexIdx = 0; vertexIdx != aRemap.size(); ++vertexIdx)
+            {
+                aAttribute[aRemap[vertexIdx]] = source[vertexIdx];
+            }
+        }
+    }
+
+
+    template <class T_mesh /* aiMesh or aiAnimMesh */>
+    void permuteVertices(T_mesh * aMesh, std::span<const unsigned int> aRemap)
+    {
+        permuteVertices(aMesh->mVertices, aRemap);
+        permuteVertices(aMesh->mNormals, aRemap);
+        permuteVertices(aMesh->mTangents, aRemap);
+        permuteVertices(aMesh->mBitangents, aRemap);
+        for(aiColor4D * colors : aMesh->mColors)
+        {
+            permuteVertices(colors, aRemap);
+        }
+        for(aiVector3D * textureCoords : aMesh->mTextureCoords)
+        {
+            permuteVertices(textureCoords, aRemap);
+        }
     }
 
+
+    /// @brief Totals of the vertex cache misses, over all the meshes of a scene.
+    struct VertexCacheReport
+    {
+        void accumulate(const VertexCacheStatistics & aBefore,
+                        const VertexCacheStatistics & aAfter,
+                        unsigned int aTrianglesCount)
+        {
+            mMissesBefore += aBefore.mAcmr * aTrianglesCount;
+            mMissesAfter += aAfter.mAcmr * aTrianglesCount;
+            mTrianglesCount += aTrianglesCount;
+        }
+
+        double mMissesBefore = 0.;
+        double mMissesAfter = 0.;
+        std::size_t mTrianglesCount = 0;
+    };
+
+
+    /// @brief Reorder the triangles of each mesh for the post-transform vertex cache and overdraw,
+    /// then the vertices in order of first use (for vertex fetch locality).
+    /// @note This happens in place, on the scene owned by the importer, before anything is written.
+    VertexCacheReport optimizeMeshes(const aiScene * aScene)
+    {
+        VertexCacheReport cacheReport;
+
+        report() << "Optimizing meshes for a FIFO vertex cache of " << gVertexCacheSize << " entries:\n";
+        for(unsigned int meshIdx = 0; meshIdx != aScene->mNumMeshes; ++meshIdx)
+        {
+            aiMesh * mesh = aScene->mMeshes[meshIdx];
+
+            // The binary only stores triangles.
+            std::vector<unsigned int> indices;
+            indices.reserve(3 * mesh->mNumFaces);
+            for(unsigned int faceIdx = 0; faceIdx != mesh->mNumFaces; ++faceIdx)
+            {
+                const aiFace & face = mesh->mFaces[faceIdx];
+                if(face.mNumIndices != 3)
+                {
+                    break;
+                }
+                indices.insert(indices.end(), face.mIndices, face.mIndices + 3);
+            }
+            if(indices.size() != 3 * mesh->mNumFaces)
+            {
+                SELOG(warn)("Mesh '{}' is not only made of triangles, it is not optimized.", mesh->mName.C_Str());
+                continue;
+            }
+
+            const VertexCacheStatistics before = analyzeVertexCache(indices, mesh->mNumVertices);
+
+            optimizeVertexCache(indices, mesh->mNumVertices);
+            optimizeOverdraw(indices, std::span{mesh->mVertices, mesh->mNumVertices});
+            std::vector<unsigned int> remap = optimizeVertexFetch(indices, mesh->mNumVertices);
+
+            permuteVertices(mesh, remap);
+            for(unsigned int animMeshIdx = 0; animMeshIdx != mesh->mNumAnimMeshes; ++animMeshIdx)
+            {
+                permuteVertices(mesh->mAnimMeshes[animMeshIdx], remap);
+            }
+            for(unsigned int boneIdx = 0; boneIdx != mesh->mNumBones; ++boneIdx)
+            {
+                const aiBone * bone = mesh->mBones[boneIdx];
+                for(unsigned int weightIdx = 0; weightIdx != bone->mNumWeights; ++weightIdx)
+                {
+                    bone->mWeights[weightIdx].mVertexId = remap[bone->mWeights[weightIdx].mVertexId];
+                }
+            }
+            for(unsigned int faceIdx = 0; faceIdx != mesh->mNumFaces; ++faceIdx)
+            {
+                std::copy_n(indices.begin() + 3 * faceIdx, 3, mesh->mFaces[faceIdx].mIndices);
+            }
+
+            const VertexCacheStatistics after = analyzeVertexCache(indices, mesh->mNumVertices);
+            cacheReport.accumulate(before, after, mesh->mNumFaces);
+
+            report() << "  '" << mesh->mName.C_Str() << "'"
+                     << ": ACMR " << before.mAcmr << " -> " << after.mAcmr
+                     << ", ATVR " << before.mAtvr << " -> " << after.mAtvr
+                     << "\n";
+        }
+
+        return cacheReport;
+    }
+
+
+    /// @brief Generate a chain of simplified index buffers for each mesh of the scene,
+    /// each level targeting half the triangles of the previous one.
+    /// @note Must run after optimizeMeshes(), since the levels index the (reordered) mesh vertices.
+    SceneLods generateLods(const aiScene * aScene, const ProcessorOptions & aOptions)
+    {
+        SceneLods result(aScene->mNumMeshes);
+        if(aOptions.mLodCount == 0)
+        {
+            return result;
+        }
+
+        report() << "Generating levels of detail:\n";
+        for(unsigned int meshIdx = 0; meshIdx != aScene->mNumMeshes; ++meshIdx)
+        {
+            aiMesh * mesh = aScene->mMeshes[meshIdx];
+            if(!hasTrianglesOnly(mesh))
+            {
+                continue;
+            }
+
+            const math::Box<float> aabb = extractAabb(mesh);
+            const float maxError = aOptions.mLodMaxError * aabb.mDimension.as<math::Vec>().getNorm();
+            const std::span<const aiVector3D> positions{mesh->mVertices, mesh->mNumVertices};
+
+            std::vector<unsigned int> indices;
+            indices.reserve(3 * mesh->mNumFaces);
+            for(unsigned int faceIdx = 0; faceIdx != mesh->mNumFaces; ++faceIdx)
+            {
+                indices.insert(indices.end(), mesh->mFaces[faceIdx].mIndices, mesh->mFaces[faceIdx].mIndices + 3);
+            }
+
+            report() << "  '" << mesh->mName.C_Str() << "': " << mesh->mNumFaces << " triangles";
+            float error = 0.f;
+            for(unsigned int lodIdx = 0; lodIdx != aOptions.mLodCount; ++lodIdx)
+            {
+                // Each level is simplified from the previous one, its remaining error budget decreases.
+                SimplifiedMesh lod = simplify(indices, positions, indices.size() / 6 * 3, maxError - error);
+
+                // Stop the chain when the simplification is not worth the memory.
+                if(lod.mIndices.empty() || lod.mIndices.size() > indices.size() * 3 / 4)
+                {
+                    break;
+                }
+
+                optimizeVertexCache(lod.mIndices, mesh->mNumVertices);
+                error += lod.mError;
+                lod.mError = error;
+                indices = lod.mIndices;
+
+                report() << " -> " << lod.mIndices.size() / 3 << " (error " << lod.mError << ")";
+                result[meshIdx].push_back(std::move(lod));
+            }
+            report() << "\n";
+        }
+
+        return result;
+    }
+
+
 } // unnamed namespace
 
 
-void processModel(const std::filesystem::path & aFile)
+std::filesystem::path getOutputPath(const std::filesystem::path & aFile)
 {
-    // Comment out to get verbose output from the importer, to stdout.
-    Assimp::DefaultLogger::create("", Assimp::Logger::VERBOSE, aiDefaultLogStream_STDOUT);
+    return aFile.parent_path() / aFile.stem().replace_extension(".seum");
+}
+
+
+ProcessResult processModel(const std::filesystem::path & aFile, const ProcessorOptions & aOptions)
+{
+    ProcessResult result;
+
+    std::ostream * const previousReport = std::exchange(gReport,
+                                                        aOptions.mReport ? aOptions.mReport : &std::cout);
+    struct RestoreReport
+    {
+        ~RestoreReport()
+        { gReport = mPrevious; }
+        std::ostream * mPrevious;
+    } restoreReport{previousReport};
+
+    if(aOptions.mImporterLog)
+    {
+        // Verbose output from the importer, to stdout.
+        Assimp::DefaultLogger::create("", Assimp::Logger::VERBOSE, aiDefaultLogStream_STDOUT);
+    }
 
     // Create an instance of the Importer class
     Assimp::Importer importer;
+    // The importer takes ownership of the IO system, which records into openedFiles (declared first, outliving it).
+    std::vector<std::filesystem::path> openedFiles;
+    importer.SetIOHandler(new RecordingIOSystem{openedFiles});
 
     // This is really extra verbose, usually the default logger verbository
     //importer.SetExtraVerbose(true); 
@@ -928,7 +1502,16 @@ void processModel(const std::filesystem::path & aFile)
     if(!scene)
     {
         SELOG(critical)(importer.GetErrorString());
-        return;
+        return result;
+    }
+
+    for(const std::filesystem::path & opened : openedFiles)
+    {
+        std::error_code ec;
+        if(!std::filesystem::equivalent(opened, aFile, ec))
+        {
+            result.mDependencies.push_back(opened);
+        }
     }
 
     // Uncomment to get a list of all metadata keys and their type
@@ -957,17 +1540,24 @@ void processModel(const std::filesystem::path & aFile)
         SELOG(warn)("Unit scale factor is {}.", unitScaleFactor);
     }
 
-    std::filesystem::path output = aFile.parent_path() / aFile.stem().replace_extension(".seum");
-    FileWriter writer{output};
+    VertexCacheReport vertexCacheReport = optimizeMeshes(scene);
+    SceneLods lods = generateLods(scene, aOptions);
+
+    std::filesystem::path output = getOutputPath(aFile);
+    FileWriter writer{output, selectVertexEncoding(scene, aOptions)};
+
+    writer.beginSection(&SeumTableOfContents::mNodes);
 
     // Reserve room for the total vertex count
     auto preamblePosition = reservePreamble(writer);
+    writer.writeVertexEncoding();
 
     // Now we can access the file's contents. 
-    NodeResult topResult = recurseNodes(scene->mRootNode, scene, writer);
+    NodeResult topResult = recurseNodes(scene->mRootNode, scene, lods, writer);
 
     completePreamble(writer, preamblePosition, topResult);
 
+    writer.beginSection(&SeumTableOfContents::mAnimations);
     if(auto nodeRig = topResult.mNodeRig)
     {
         dumpAnimations(scene, *nodeRig, writer);
@@ -978,16 +1568,29 @@ void processModel(const std::filesystem::path & aFile)
         writer.forward((unsigned int)0);
     }
 
-    dumpMaterials(scene, writer);
+    writer.beginSection(&SeumTableOfContents::mMaterials);
+    dumpMaterials(scene, writer, result.mDependencies);
 
-    std::cout << "\nResult: Dumped model with "
-              << topResult.mVerticesCount << " vertices and " 
-              << topResult.mIndicesCount << " indices, "
-              << scene->mNumMaterials << " materials."
-              << "\n  " << "bounding box: " << topResult.mAabb
-              << "\n";
+    writer.completeTableOfContents();
+
+    report() << "\nResult: Dumped model with "
+             << topResult.mVerticesCount << " vertices and " 
+             << topResult.mIndicesCount << " indices, "
+             << scene->mNumMaterials << " materials."
+             << "\n  " << "bounding box: " << topResult.mAabb
+             << "\n";
+    if(vertexCacheReport.mTrianglesCount != 0)
+    {
+        report() << "  vertex cache ACMR: "
+                 << vertexCacheReport.mMissesBefore / vertexCacheReport.mTrianglesCount << " -> "
+                 << vertexCacheReport.mMissesAfter / vertexCacheReport.mTrianglesCount
+                 << "\n";
+    }
 
+    result.mSuccess = static_cast<bool>(writer.mArchive.mOut);
+    result.mOutput = output;
     // We're done. Everything will be cleaned up by the importer destructor
+    return result;
 }
 
 
@@ -2,14 +2,55 @@
 
 
 #include <filesystem>
+#include <iosfwd>
 #include <string_view>
+#include <vector>
+
+#include <cstdint>
 
 
 namespace ad::renderer {
 
 
+/// @brief Incremented each time the processor output changes for the same inputs and options,
+/// which invalidates the batch cache.
+inline constexpr std::uint32_t gProcessorVersion = 2;
+
+
+struct ProcessorOptions
+{
+    /// @brief Store the vertex attributes with gCompactVertexEncoding instead of gFloatVertexEncoding.
+    bool mCompactVertices = false;
+
+    /// @brief Maximum number of simplified levels of detail generated for each mesh.
+    unsigned int mLodCount = 3;
+    /// @brief Maximum deviation of the coarsest level of detail, relative to the diagonal of the mesh bounding box.
+    float mLodMaxError = 0.02f;
+
+    /// @brief Receives the human readable report of the processing, std::cout if null.
+    std::ostream * mReport = nullptr;
+    /// @brief Install the verbose Assimp logger, to stdout.
+    /// @note The Assimp logger is global: it must be disabled when models are processed concurrently.
+    bool mImporterLog = true;
+};
+
+
+struct ProcessResult
+{
+    bool mSuccess = false;
+    std::filesystem::path mOutput;
+    /// @brief The files read to produce the output, other than the processed model itself
+    /// (e.g. material libraries, textures, including the upsampled textures referenced by the output).
+    std::vector<std::filesystem::path> mDependencies;
+};
+
+
+/// @brief The .seum file produced by processModel() for `aFile`, placed next to it.
+std::filesystem::path getOutputPath(const std::filesystem::path & aFile);
+
+
 // TODO Rewrite as a class, there is state to be maintained accross the implementating functions.
-void processModel(const std::filesystem::path & aFile);
+ProcessResult processModel(const std::filesystem::path & aFile, const ProcessorOptions & aOptions = {});
 
 
-} // namespace ad::renderer
\ No newline at end of file
+} // namespace ad::renderer
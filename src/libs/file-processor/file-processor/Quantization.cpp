@@ -0,0 +1,75 @@
+#include "Quantization.h"
+
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <limits>
+
+
+namespace ad::renderer {
+
+
+namespace {
+
+
+    template <class T_integer>
+    T_integer toUnorm(float aValue)
+    {
+        constexpr float max = std::numeric_limits<T_integer>::max();
+        return (T_integer)std::lround(std::clamp(aValue, 0.f, 1.f) * max);
+    }
+
+
+} // unnamed namespace
+
+
+std::uint8_t toUnorm8(float aValue)
+{
+    return toUnorm<std::uint8_t>(aValue);
+}
+
+
+std::uint16_t toUnorm16(float aValue)
+{
+    return toUnorm<std::uint16_t>(aValue);
+}
+
+
+std::int16_t toSnorm16(float aValue)
+{
+    // GL maps both -32768 and -32767 to -1, only the symmetric range is used.
+    return (std::int16_t)std::lround(std::clamp(aValue, -1.f, 1.f) * 32767.f);
+}
+
+
+std::uint16_t toHalf(float aValue)
+{
+    const std::uint32_t bits = std::bit_cast<std::uint32_t>(aValue);
+    const std::uint32_t sign = (bits >> 16) & 0x8000u;
+    const std::uint32_t absolute = bits & 0x7fffffffu;
+
+    // NaN and infinities
+    if(absolute >= 0x7f800000u)
+    {
+        return (std::uint16_t)(sign | 0x7c00u | (absolute > 0x7f800000u ? 0x200u : 0u));
+    }
+    // Overflows to infinity (65520 is the first value rounding above the largest half, 65504)
+    if(absolute >= 0x477ff000u)
+    {
+        return (std::uint16_t)(sign | 0x7c00u);
+    }
+    // Normal half
+    if(absolute >= 0x38800000u)
+    {
+        // Rebias the exponent from 127 to 15, then round the 13 dropped mantissa bits to nearest even.
+        std::uint32_t rebiased = absolute - 0x38000000u;
+        rebiased += 0x0fffu + ((rebiased >> 13) & 1u);
+        return (std::uint16_t)(sign | (rebiased >> 13));
+    }
+    // Subnormal half (or zero): the value is a multiple of 2^-24
+    const float magnitude = std::bit_cast<float>(absolute);
+    return (std::uint16_t)(sign | (std::uint32_t)std::nearbyint(magnitude * 16777216.f));
+}
+
+
+} // namespace ad::renderer
@@ -0,0 +1,22 @@
+#pragma once
+
+
+#include <cstdint>
+
+
+namespace ad::renderer {
+
+
+/// @brief Map `aValue` from [0, 1] to the full range of an unsigned normalized integer (clamping).
+std::uint8_t toUnorm8(float aValue);
+std::uint16_t toUnorm16(float aValue);
+
+/// @brief Map `aValue` from [-1, 1] to the range of a signed normalized integer (clamping).
+std::int16_t toSnorm16(float aValue);
+
+/// @brief Convert to IEEE 754 binary16, rounding to nearest even.
+/// Values out of range become infinities, NaNs are preserved.
+std::uint16_t toHalf(float aValue);
+
+
+} // namespace ad::renderer
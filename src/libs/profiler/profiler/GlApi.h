@@ -31,11 +31,34 @@ public:
         std::size_t bufferMemoryWritten() const
         { return mBufferMemory.mWritten ; }
 
+        unsigned int visibleCount() const
+        { return mVisibleCount; }
+
+        unsigned int culledCount() const
+        { return mCulledCount; }
+
+        unsigned int bindsIssued() const
+        { return mBindsIssued; }
+
+        unsigned int bindsSkipped() const
+        { return mBindsSkipped; }
+
+        unsigned int fenceWaits() const
+        { return mFenceWaits; }
+
         unsigned int mBufferBindCount{0};
         unsigned int mDrawCount{0};
         unsigned int mFboAttachCount{0};
         Memory mBufferMemory;
         Memory mTextureMemory;
+        // Not GL calls, but reported alongside the draws they save.
+        unsigned int mVisibleCount{0};
+        unsigned int mCulledCount{0};
+        // Bindings requested through a state tracker, either issued to GL or skipped as redundant.
+        unsigned int mBindsIssued{0};
+        unsigned int mBindsSkipped{0};
+        // Fences the CPU had to block on, because the GPU was still using the memory to be written.
+        unsigned int mFenceWaits{0};
     };
 
     void BindBuffer(GLenum target, GLuint buffer);
@@ -67,6 +90,18 @@ public:
     void TexStorage3D(GLenum target, GLsizei levels, GLenum internalformat, GLsizei width, GLsizei height, GLsizei depth);
     void TexSubImage3D(GLenum target, GLint level, GLint xoffset, GLint yoffset, GLint zoffset, GLsizei width, GLsizei height, GLsizei depth, GLenum format, GLenum type, const void *pixels);
 
+    /// @brief Account for the result of CPU visibility culling, which is not issuing GL calls.
+    void countCulling(unsigned int aVisible, unsigned int aCulled);
+
+    /// @brief Account for a binding requested through a state tracker, which either issued it or skipped it.
+    void countStateBind(bool aIssued);
+
+    /// @brief Account for memory written by the CPU directly in a mapped buffer, which is not issuing GL calls.
+    void countMappedWrite(std::size_t aSize);
+
+    /// @brief Account for a client wait on a fence that was not signaled yet.
+    void countFenceWait();
+
 
     // Note: Give access to the Metrics even if the instrumentation is not macro enabled
     // (this way the reporting code can still compile)
@@ -391,4 +426,38 @@ inline void GlApi::CompressedTexSubImage3D(GLenum target, GLint level, GLint xof
 }
 
 
+
+inline void GlApi::countCulling(unsigned int aVisible, unsigned int aCulled)
+{
+#if defined(SE_INSTRUMENT_GL)
+    v().mVisibleCount += aVisible;
+    v().mCulledCount += aCulled;
+#endif
+}
+
+
+inline void GlApi::countStateBind(bool aIssued)
+{
+#if defined(SE_INSTRUMENT_GL)
+    ++(aIssued ? v().mBindsIssued : v().mBindsSkipped);
+#endif
+}
+
+
+inline void GlApi::countMappedWrite(std::size_t aSize)
+{
+#if defined(SE_INSTRUMENT_GL)
+    v().mBufferMemory.mWritten += aSize;
+#endif
+}
+
+
+inline void GlApi::countFenceWait()
+{
+#if defined(SE_INSTRUMENT_GL)
+    ++v().mFenceWaits;
+#endif
+}
+
+
 } // namespace ad::renderer
\ No newline at end of file
@@ -88,6 +88,11 @@ Profiler::Profiler(Providers aProviderFeatures)
         mMetricProviders.push_back(std::make_unique<ProviderGL>());
         mMetricProviders.push_back(std::make_unique<ProviderApi<&GlApi::Metrics::drawCount>>("draw", ""));
         mMetricProviders.push_back(std::make_unique<ProviderApi<&GlApi::Metrics::bufferMemoryWritten>>("buffer w", "B"));
+        mMetricProviders.push_back(std::make_unique<ProviderApi<&GlApi::Metrics::visibleCount>>("visible", ""));
+        mMetricProviders.push_back(std::make_unique<ProviderApi<&GlApi::Metrics::culledCount>>("culled", ""));
+        mMetricProviders.push_back(std::make_unique<ProviderApi<&GlApi::Metrics::bindsIssued>>("binds", ""));
+        mMetricProviders.push_back(std::make_unique<ProviderApi<&GlApi::Metrics::bindsSkipped>>("skipped binds", ""));
+        mMetricProviders.push_back(std::make_unique<ProviderApi<&GlApi::Metrics::fenceWaits>>("fence waits", ""));
     }
 
     resize(gInitialEntries);
@@ -325,6 +330,23 @@ void Profiler::endSection(EntryIndex aIndex)
 }
 
 
+void Profiler::recordDuration(const char * aName, ProviderIndex aProvider, std::chrono::nanoseconds aDuration)
+{
+    EntryIndex entryIdx = beginSection(EntryNature::Recurring, aName, {aProvider});
+    endSection(entryIdx);
+
+    if(entryIdx != Entry::gInvalidEntry)
+    {
+        ProviderInterface & provider = *mMetricProviders.at(aProvider);
+        if(!provider.recordDuration(entryIdx, currentSubframe(EntryNature::Recurring), aDuration))
+        {
+            SELOG(warn)("Provider '{}' cannot record durations for section '{}'.",
+                        provider.mQuantityName, aName);
+        }
+    }
+}
+
+
 void Profiler::popCurrentSection()
 {
     endSection(mFrameState.mCurrentParent);
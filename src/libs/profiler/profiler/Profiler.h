@@ -2,6 +2,7 @@
 
 
 #include <array>
+#include <chrono>
 #include <memory>
 #include <numeric>
 #include <ostream>
@@ -115,6 +116,11 @@ public:
     // TODO make generic regarding provided type
     virtual bool provide(EntryIndex aEntryIndex, std::uint32_t aQueryFrame, Sample_t & aSampleResult) = 0;
 
+    /// @brief Record a duration that was measured outside of beginSection() / endSection().
+    /// @return false if this provider does not measure durations.
+    virtual bool recordDuration(EntryIndex /*aEntryIndex*/, std::uint32_t /*aCurrentFrame*/, std::chrono::nanoseconds /*aDuration*/)
+    { return false; }
+
     virtual void resize(std::size_t aNewEntriesCount) = 0;
 
     Sample_t scale(Sample_t aInput) const
@@ -175,6 +181,13 @@ public:
     EntryIndex beginSection(EntryNature aNature, const char * aName, std::initializer_list<ProviderIndex> aProviders);
     void endSection(EntryIndex aIndex);
 
+    /// @brief Add a recurring section, child of the current section, with a duration measured by the client.
+    ///
+    /// Sections have to be opened from the thread owning the profiler.
+    /// This allows to report work that was executed on other threads (e.g. a job pool),
+    /// once it completed.
+    void recordDuration(const char * aName, ProviderIndex aProvider, std::chrono::nanoseconds aDuration);
+
     // I am not sure this is a good idea, as it relies on a Profiler global state (mCurrentParent), which might not be a good idea.
     // The current assumption is that sections should always be strictly nested, and that they are created on a single thread
     // (or at least that there is an independent copy of the Profiler state per thread).
@@ -15,6 +15,11 @@ enum
     GpuPrimitiveGen,
     DrawCalls,
     BufferMemoryWritten,
+    VisibleInstances,
+    CulledInstances,
+    BindsIssued,
+    BindsSkipped,
+    FenceWaits,
 };
 
 
@@ -77,6 +82,10 @@ using Profiler_t = Profiler;
 #define PROFILER_SCOPE_SINGLESHOT_SECTION(profiler, name, ...) \
     const auto profilerScopedSection_ ## __LINE__ = ::ad::renderer::ProfilerRegistry::Get(profiler).scopeSection(::ad::renderer::EntryNature::SingleShot, name, {__VA_ARGS__})
 
+/// @brief Record a section whose duration was measured by the client (e.g. work done on another thread).
+#define PROFILER_RECORD_RECURRING_DURATION(profiler, name, provider, duration) \
+    ::ad::renderer::ProfilerRegistry::Get(profiler).recordDuration(name, provider, duration)
+
 #define PROFILER_PRINT_TO_STREAM(profiler, ostream) \
     ::ad::renderer::ProfilerRegistry::Get(profiler).prettyPrint(ostream);
 
@@ -96,6 +105,8 @@ using Profiler_t = Profiler;
 
 #define PROFILER_SCOPE_SINGLESHOT_SECTION(profiler, name, ...)
 
+#define PROFILER_RECORD_RECURRING_DURATION(profiler, name, provider, duration)
+
 #define PROFILER_PRINT_TO_STREAM(profiler, ostream)
 #endif
 
@@ -35,4 +35,12 @@ bool ProviderCPUTime::provide(EntryIndex aEntryIndex, uint32_t aQueryFrame, Samp
 }
 
 
+bool ProviderCPUTime::recordDuration(EntryIndex aEntryIndex, std::uint32_t aCurrentFrame, std::chrono::nanoseconds aDuration)
+{
+    auto & interval = getInterval(aEntryIndex, aCurrentFrame);
+    interval.mEnd = interval.mBegin + std::chrono::duration_cast<Clock::duration>(aDuration);
+    return true;
+}
+
+
 } // namespace ad::renderer
\ No newline at end of file
@@ -24,6 +24,8 @@ struct ProviderCPUTime : public ProviderInterface {
 
     bool provide(EntryIndex aEntryIndex, uint32_t aQueryFrame, Sample_t & aSampleResult) override;
 
+    bool recordDuration(EntryIndex aEntryIndex, std::uint32_t aCurrentFrame, std::chrono::nanoseconds aDuration) override;
+
     void resize(std::size_t aNewEntriesCount) override
     { mTimePoints.resize(aNewEntriesCount * Profiler::CountSubframes() ); }
 
@@ -35,6 +35,8 @@ struct ProviderCpuRdtsc : public ProviderInterface
 
     bool provide(EntryIndex aEntryIndex, uint32_t aQueryFrame, Sample_t & aSampleResult) override;
 
+    bool recordDuration(EntryIndex aEntryIndex, std::uint32_t aCurrentFrame, std::chrono::nanoseconds aDuration) override;
+
     void resize(std::size_t aNewEntriesCount) override
     { mIntervals.resize(aNewEntriesCount * Profiler::CountSubframes() ); }
 
@@ -79,4 +81,13 @@ inline bool ProviderCpuRdtsc::provide(EntryIndex aEntryIndex, uint32_t aQueryFra
     return true;
 }
 
+
+inline bool ProviderCpuRdtsc::recordDuration(EntryIndex aEntryIndex, std::uint32_t aCurrentFrame, std::chrono::nanoseconds aDuration)
+{
+    // The scale factor converts ticks to microseconds, apply its inverse.
+    getInterval(aEntryIndex, aCurrentFrame) =
+        (TickCount_t)aDuration.count() * mScaleFactor.den / (mScaleFactor.num * 1000);
+    return true;
+}
+
 } // namespace ad::renderer
\ No newline at end of file
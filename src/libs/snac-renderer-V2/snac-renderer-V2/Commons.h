@@ -1,14 +1,15 @@
 #pragma once
 
 
+#include "StringId.h"
+
 #include <string>
 
 
 namespace ad::renderer {
 
 
-// TODO replace with actual string ids (hashes)
-using StringKey = std::string;
+using StringKey = StringId;
 
 
 // Initially designed as an enum, but the closed-values might be too inflexible for clients.
@@ -16,10 +17,6 @@ using Semantic = StringKey;
 using BlockSemantic = StringKey;
 
 
-inline std::string to_string(Semantic aSemantic)
-{ return aSemantic; }
-
-
 using Feature = std::string;
 
 
@@ -9,14 +9,21 @@
 namespace ad::renderer {
 
 
-const std::vector<graphics::MacroDefine> gClientConstantDefines{
-    "CLIENT_MAX_ENTITIES " + std::to_string(gMaxEntities),
-    "CLIENT_MAX_JOINTS " + std::to_string(gMaxJoints),
-    "CLIENT_SDF_DOUBLE_SPREAD " + std::to_string(2 * arte::gSdfSpread),
-    "CLIENT_MAX_LIGHTS " + std::to_string(gMaxLights),
-    "CLIENT_MAX_SHADOW_LIGHTS " + std::to_string(gMaxShadowLights),
-    "CLIENT_CASCADES_PER_SHADOW " + std::to_string(gCascadesPerShadow),
-};
+const std::vector<graphics::MacroDefine> gClientConstantDefines = []()
+{
+    std::vector<graphics::MacroDefine> defines{
+        "CLIENT_SDF_DOUBLE_SPREAD " + std::to_string(2 * arte::gSdfSpread),
+        "CLIENT_MAX_LIGHTS " + std::to_string(gMaxLights),
+        "CLIENT_MAX_SHADOW_LIGHTS " + std::to_string(gMaxShadowLights),
+        "CLIENT_CASCADES_PER_SHADOW " + std::to_string(gCascadesPerShadow),
+    };
+
+    std::vector<graphics::MacroDefine> unpackEntityMaterial =
+        PackedEntityMaterial::makeGlslUnpackDefines({"CLIENT_UNPACK_ENTITY_IDX", "CLIENT_UNPACK_MATERIAL_IDX"});
+    defines.insert(defines.end(), unpackEntityMaterial.begin(), unpackEntityMaterial.end());
+
+    return defines;
+}();
 
 
 } // namespace ad::renderer
\ No newline at end of file
@@ -1,6 +1,8 @@
 #pragma once
 
 
+#include "utilities/BitPacking.h"
+
 #include <renderer/commons.h>
 
 #include <string>
@@ -10,8 +12,9 @@
 namespace ad::renderer {
 
 
-constexpr unsigned int gMaxEntities = 512;
-constexpr unsigned int gMaxJoints   = 512;
+/// @brief The entity index and material parameters index of an instance, packed in a single instance attribute.
+/// @note Unpacked in shaders with UNPACK_ENTITY_IDX() and UNPACK_MATERIAL_IDX(), see Constants.glsl.
+using PackedEntityMaterial = BitPack<20, 12>;
 
 
 extern const std::vector<graphics::MacroDefine> gClientConstantDefines;
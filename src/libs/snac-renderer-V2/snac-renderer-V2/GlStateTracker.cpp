@@ -0,0 +1,121 @@
+#include "GlStateTracker.h"
+
+#include <profiler/GlApi.h>
+
+
+namespace ad::renderer {
+
+
+template <class T_value>
+bool GlStateTracker::update(T_value & aShadow, const T_value & aValue)
+{
+    const bool issue = !(aShadow == aValue);
+    aShadow = aValue;
+    gl.countStateBind(issue);
+    return issue;
+}
+
+
+void GlStateTracker::useProgram(GLuint aProgram)
+{
+    if(update(mProgram, aProgram))
+    {
+        glUseProgram(aProgram);
+    }
+}
+
+
+void GlStateTracker::bindVertexArray(GLuint aVertexArray)
+{
+    if(update(mVertexArray, aVertexArray))
+    {
+        glBindVertexArray(aVertexArray);
+    }
+}
+
+
+template <std::size_t N_bindings>
+void GlStateTracker::bindBuffer(GLenum aTarget,
+                                std::array<BufferRange, N_bindings> & aShadows,
+                                GLuint aBindingIndex,
+                                const BufferRange & aRange)
+{
+    if(aBindingIndex >= aShadows.size() || update(aShadows[aBindingIndex], aRange))
+    {
+        if(aRange.mSize == 0)
+        {
+            glBindBufferBase(aTarget, aBindingIndex, aRange.mBuffer);
+        }
+        else
+        {
+            glBindBufferRange(aTarget, aBindingIndex, aRange.mBuffer, aRange.mOffset, aRange.mSize);
+        }
+    }
+}
+
+
+void GlStateTracker::bindUniformBuffer(GLuint aBindingIndex, const BufferRange & aRange)
+{
+    bindBuffer(GL_UNIFORM_BUFFER, mUniformBuffers, aBindingIndex, aRange);
+}
+
+
+void GlStateTracker::bindStorageBuffer(GLuint aBindingIndex, const BufferRange & aRange)
+{
+    bindBuffer(GL_SHADER_STORAGE_BUFFER, mStorageBuffers, aBindingIndex, aRange);
+}
+
+
+void GlStateTracker::activateTextureUnit(GLuint aTextureUnit)
+{
+    if(update(mActiveTextureUnit, aTextureUnit))
+    {
+        glActiveTexture(GL_TEXTURE0 + aTextureUnit);
+    }
+}
+
+
+void GlStateTracker::bindTexture(GLuint aTextureUnit, GLenum aTarget, GLuint aTexture)
+{
+    const TextureBinding binding{.mTarget = aTarget, .mTexture = aTexture};
+    if(aTextureUnit >= mTextures.size() || update(mTextures[aTextureUnit], binding))
+    {
+        activateTextureUnit(aTextureUnit);
+        glBindTexture(aTarget, aTexture);
+    }
+}
+
+
+void GlStateTracker::setSamplerUnit(GLuint aProgram, GLint aLocation, GLint aTextureUnit)
+{
+    const std::uint64_t key = ((std::uint64_t)aProgram << 32) | (std::uint32_t)aLocation;
+    // -1 is never a texture unit, so the first request for a uniform is issued.
+    GLint & unit = mSamplerUnits.try_emplace(key, -1).first->second;
+    if(update(unit, aTextureUnit))
+    {
+        glProgramUniform1i(aProgram, aLocation, aTextureUnit);
+    }
+}
+
+
+void GlStateTracker::restore()
+{
+    if(mVertexArray != gUnknown && mVertexArray != 0)
+    {
+        glBindVertexArray(0);
+        mVertexArray = 0;
+    }
+    if(mProgram != gUnknown && mProgram != 0)
+    {
+        glUseProgram(0);
+        mProgram = 0;
+    }
+    if(mActiveTextureUnit != gUnknown && mActiveTextureUnit != 0)
+    {
+        glActiveTexture(GL_TEXTURE0);
+        mActiveTextureUnit = 0;
+    }
+}
+
+
+} // namespace ad::renderer
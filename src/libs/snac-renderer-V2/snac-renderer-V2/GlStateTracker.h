@@ -0,0 +1,91 @@
+#pragma once
+
+
+#include "Repositories.h"
+
+#include <renderer/GL_Loader.h>
+
+#include <array>
+#include <limits>
+#include <unordered_map>
+
+#include <cstdint>
+
+
+namespace ad::renderer {
+
+
+/// @brief Shadows the GL bindings made through it, so requests that would not change the state are skipped.
+///
+/// A tracker starts with an unknown state, so the first request for each binding point is always issued.
+/// It is intended to live for a sequence of draws (e.g. a pass): the shadowed state is only valid
+/// as long as no other code modifies those bindings.
+///
+/// Issued and skipped requests are reported to GlApi metrics.
+class GlStateTracker
+{
+public:
+    GlStateTracker()
+    {
+        mUniformBuffers.fill(BufferRange{gUnknown, 0, 0});
+        mStorageBuffers.fill(BufferRange{gUnknown, 0, 0});
+    }
+
+    void useProgram(GLuint aProgram);
+    void bindVertexArray(GLuint aVertexArray);
+    /// @brief Bind the whole buffer if `aRange` size is zero, the range otherwise.
+    void bindUniformBuffer(GLuint aBindingIndex, const BufferRange & aRange);
+    /// @brief Bind the whole buffer if `aRange` size is zero, the range otherwise.
+    void bindStorageBuffer(GLuint aBindingIndex, const BufferRange & aRange);
+    void bindTexture(GLuint aTextureUnit, GLenum aTarget, GLuint aTexture);
+
+    /// @brief Set the value of a sampler uniform (i.e. the texture unit it samples).
+    /// @note Uniforms are program state, so it does not require the program to be in use.
+    void setSamplerUnit(GLuint aProgram, GLint aLocation, GLint aTextureUnit);
+
+    /// @brief Unbind the program and vertex array, and activate texture unit 0,
+    /// if the tracker changed them (this is the state left by scoped binds and texture unit guards).
+    void restore();
+
+private:
+    static constexpr GLuint gUnknown = std::numeric_limits<GLuint>::max();
+    // Minimal values required by OpenGL 4.3 for GL_MAX_UNIFORM_BUFFER_BINDINGS,
+    // GL_MAX_SHADER_STORAGE_BUFFER_BINDINGS and GL_MAX_COMBINED_TEXTURE_IMAGE_UNITS.
+    // Binding points above are not tracked.
+    static constexpr std::size_t gTrackedUniformBuffers = 72;
+    static constexpr std::size_t gTrackedStorageBuffers = 8;
+    static constexpr std::size_t gTrackedTextureUnits = 80;
+
+    struct TextureBinding
+    {
+        bool operator==(const TextureBinding &) const = default;
+
+        GLenum mTarget = GL_NONE;
+        GLuint mTexture = gUnknown;
+    };
+
+    /// @brief Record `aValue` in `aShadow`.
+    /// @return `true` if the GL call has to be issued.
+    template <class T_value>
+    static bool update(T_value & aShadow, const T_value & aValue);
+
+    template <std::size_t N_bindings>
+    static void bindBuffer(GLenum aTarget,
+                           std::array<BufferRange, N_bindings> & aShadows,
+                           GLuint aBindingIndex,
+                           const BufferRange & aRange);
+
+    void activateTextureUnit(GLuint aTextureUnit);
+
+    GLuint mProgram = gUnknown;
+    GLuint mVertexArray = gUnknown;
+    GLuint mActiveTextureUnit = gUnknown;
+    std::array<BufferRange, gTrackedUniformBuffers> mUniformBuffers;
+    std::array<BufferRange, gTrackedStorageBuffers> mStorageBuffers;
+    std::array<TextureBinding, gTrackedTextureUnits> mTextures{};
+    // Keyed by program name in the high bits, uniform location in the low bits.
+    std::unordered_map<std::uint64_t, GLint> mSamplerUnits;
+};
+
+
+} // namespace ad::renderer
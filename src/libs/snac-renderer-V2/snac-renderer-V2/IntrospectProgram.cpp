@@ -145,7 +145,7 @@ namespace {
         }
         else
         {
-            return std::string{body};
+            return Semantic::Intern(body);
         }
     }
 
@@ -161,7 +161,7 @@ namespace {
         else if(aBlockName.ends_with("Block"))
         {
             aBlockName.remove_suffix(5);
-            return std::string{aBlockName};
+            return BlockSemantic::Intern(aBlockName);
         }
         else
         {
@@ -199,6 +199,7 @@ std::ostream & operator<<(std::ostream & aOut, const IntrospectProgram & aProgra
     lister("attribute", aProgram.mAttributes);
     lister("uniform", aProgram.mUniforms);
     lister("uniform block", aProgram.mUniformBlocks);
+    lister("shader storage block", aProgram.mShaderStorageBlocks);
     return aOut;
 }
 
@@ -304,6 +305,22 @@ IntrospectProgram::IntrospectProgram(graphics::Program aProgram, std::string aNa
             return true;
         };
         assert(checkDuplicateIndex(mUniformBlocks));
+
+        // Shader storage blocks
+        // Note: the binding points are distinct from the uniform buffer binding points,
+        // so duplicates are only checked among storage blocks.
+        for (auto it = Iterator(mProgram, GL_SHADER_STORAGE_BLOCK);
+            it != Iterator::makeEnd(mProgram, GL_SHADER_STORAGE_BLOCK);
+            ++it)
+        {
+            mShaderStorageBlocks.push_back(ShaderStorageBlock{
+                .mBlockIndex = it->mIndex,
+                .mBindingIndex = graphics::BindingIndex{(GLuint)(*it)[0]},
+                .mSemantic = to_blockSemantic(it->mName),
+                .mName = it->mName,
+            });
+        }
+        assert(checkDuplicateIndex(mShaderStorageBlocks));
     }
 
     // All uniforms ("normal" non-block uniforms, as well as within uniform blocks)
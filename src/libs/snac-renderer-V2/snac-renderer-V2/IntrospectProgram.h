@@ -79,10 +79,14 @@ struct IntrospectProgram
         //std::vector<Resource> mUniforms; // Uniform blocks contain uniform variables
     };
 
+    /// @brief Shader storage blocks are described like uniform blocks, only their buffer target differs.
+    using ShaderStorageBlock = UniformBlock;
+
     graphics::Program mProgram;
     std::vector<Attribute> mAttributes;
     std::vector<Resource> mUniforms;
     std::vector<UniformBlock> mUniformBlocks;
+    std::vector<ShaderStorageBlock> mShaderStorageBlocks;
     std::string mName;
     std::vector<TypedShaderSource> mSources; // Notably usefull for productivity tooling / hot-reloading.
 };
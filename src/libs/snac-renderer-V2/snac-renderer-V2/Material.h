@@ -21,7 +21,7 @@ struct TextureInput
 
 
 // Note: 16-aligned, because it is intended to be stored as an array in a buffer object
-// and then the elements are accessed via a std140 uniform block 
+// and then the elements are accessed via a std430 shader storage block
 /// \brief Attempts to cover both Phong and Pbr materials, to simplify development
 struct alignas(16) GenericMaterial 
 {
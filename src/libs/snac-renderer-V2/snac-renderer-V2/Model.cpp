@@ -16,6 +16,21 @@ Pose::operator math::AffineMatrix<4, float> () const
 }
 
 
+PositionDequantization::operator math::AffineMatrix<4, GLfloat> () const
+{
+    return math::trans3d::scaleUniform(mScale) * math::trans3d::translate(mOffset);
+}
+
+
+math::Box<GLfloat> PositionDequantization::quantize(const math::Box<GLfloat> & aBox) const
+{
+    return math::Box<GLfloat>{
+        .mPosition = ((aBox.mPosition.as<math::Vec>() - mOffset) / mScale).as<math::Position>(),
+        .mDimension = aBox.mDimension / mScale,
+    };
+}
+
+
 Pose interpolate(const Pose & aLeft, const Pose & aRight, float aInterpolant)
 {
     return Pose{
@@ -21,6 +21,7 @@
 #include <map>
 #include <optional>
 #include <set>
+#include <unordered_map>
 #include <vector>
 
 
@@ -73,16 +74,11 @@ struct VertexStream;
 /// The remaining key to lookup is the buffer array data format / source buffer, that we map to VertexStream identity.
 struct ProgramConfig
 {
-    struct Entry
-    {
-        // TODO: When moving to VAB (separate format), reuse the VAO for distinct buffers
-        // all buffer sets with the same format (attribute size, component type, relative offset) can share a VAO.
-        // (and the buffer would be bound to the VAO)
-        Handle<const VertexStream> mVertexStream; // The lookup key
-        Handle<graphics::VertexArrayObject> mVao; // The cached VAO
-    };
-    // Note: The cache is implemented as a vector, lookup is made by visiting elements and comparing VertexStream handles.
-    std::vector<Entry> mEntries;
+    // TODO: When moving to VAB (separate format), reuse the VAO for distinct buffers
+    // all buffer sets with the same format (attribute size, component type, relative offset) can share a VAO.
+    // (and the buffer would be bound to the VAO)
+    // Note: The cache is hashed on the VertexStream handles, each VAO being prepared once for its stream.
+    std::unordered_map<Handle<const VertexStream>, Handle<graphics::VertexArrayObject>> mVaos;
 };
 
 
@@ -103,6 +99,8 @@ struct Technique
 {
     struct Annotation
     {
+        bool operator==(const Annotation &) const = default;
+
         StringKey mCategory;
         StringKey mValue;
     };
@@ -157,6 +155,9 @@ struct AttributeAccessor
 {
     std::vector<BufferView>::size_type mBufferViewIndex;
     graphics::ClientAttribute mClientDataFormat;
+    // The client data are normalized integers, to be converted to floating point by GL.
+    // (In addition to the attributes explicitly marked normalized in the shader, see IntrospectProgram)
+    bool mNormalized = false;
 };
 
 
@@ -205,6 +206,16 @@ inline const renderer::BufferView & getBufferView(const GenericStream & aStream,
 //// (anyway, feature order should not be important)
 //using FeatureSet = std::set<Feature>;
 
+/// @brief A simplified version of a Part, drawing a distinct range of indices into the same vertices.
+struct PartLod
+{
+    GLuint mIndexFirst = 0;
+    GLuint mIndicesCount = 0;
+    // Largest deviation from the full Part geometry, in the Part space.
+    GLfloat mError = 0.f;
+};
+
+
 struct Part
 {
     Name mName;
@@ -222,6 +233,8 @@ struct Part
     GLuint mIndexFirst = 0; // The offset (as a count of indices) of this part indices into the index buffer view
     GLuint mIndicesCount = 0;
     math::Box<GLfloat> mAabb;
+    // The coarser levels of detail, by increasing error (the Part index range is the finest level).
+    std::vector<PartLod> mLods;
     //FeatureSet mFeatures;
 };
 
@@ -239,10 +252,26 @@ inline bool useElementIndices(const Part & aPart)
 { return useElementIndices(*aPart.mVertexStream); }
 
 
+/// @brief Uniform scaling then translation, mapping quantized vertex positions to their Object space.
+struct PositionDequantization
+{
+    explicit operator math::AffineMatrix<4, GLfloat> () const;
+
+    /// @brief Return `aBox`, from the Object space, expressed in the quantized space.
+    math::Box<GLfloat> quantize(const math::Box<GLfloat> & aBox) const;
+
+    math::Vec<3, GLfloat> mOffset = math::Vec<3, GLfloat>::Zero();
+    GLfloat mScale = 1.f;
+};
+
+
 struct Object
 {
     std::vector<Part> mParts;
     math::Box<GLfloat> mAabb;
+    // Must be applied to the vertex positions before the model transform (i.e. prepended, with row vectors).
+    // The AABBs of the Object and its Parts are expressed in the dequantized space.
+    PositionDequantization mPositionDequantization;
     // TODO #animation should we only store the Rig?
     // Storing both is convenient to enumerate in the viewer GUI.
     // Yet the pure animation feature only require the Rig data.
@@ -306,6 +335,10 @@ struct AnimationState
     // Actually, we do not know what we are doing with the design of the rigging system in Model
     // What the renderer actually needs is a NodeTree "pose", so let us give it that.
     NodeTree<Rig::Pose> mPosedTree;
+    // Keyframe cursor and buffers, reused each time the instance is animated.
+    AnimationSampler mSampler;
+    // Identifies the pose in mPosedTree, so instances in the same pose can share a joint matrix palette.
+    PoseKey mPoseKey;
 };
 
 
@@ -380,6 +413,9 @@ struct Storage
     std::list<graphics::VertexArrayObject> mVaos;
     std::list<MaterialContext> mMaterialContexts;
     std::list<AnimatedRig> mAnimatedRigs;
+    // Incremented each time the effects are recompiled, which replaces their techniques (and programs).
+    // Caches derived from the techniques are only valid for a given generation.
+    std::uint64_t mEffectsGeneration = 0;
     // Used for random access (DOD)
     std::vector<Name> mMaterialNames{"<no-material>",}; // This is a hack, so the name at index zero can be used when there are no material parameters
 
@@ -1,11 +1,21 @@
 #include "Pass.h"
 
+#include "GlStateTracker.h"
 #include "Profiling.h"
 #include "SetupDrawing.h"
 #include "Logging.h"
 
+#include "utilities/ResourceIdMap.h"
+
 #include <profiler/GlApi.h>
 
+#include <algorithm>
+#include <array>
+#include <stdexcept>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
 
 namespace ad::renderer {
 
@@ -18,7 +28,8 @@ namespace {
     constexpr std::uint64_t makeMask(unsigned int aBitCount)
     {
         assert(aBitCount <= 64);
-        return (1 << aBitCount) - 1;
+        return aBitCount == 64 ? std::numeric_limits<std::uint64_t>::max()
+                               : (std::uint64_t{1} << aBitCount) - 1;
     }
 
 
@@ -51,51 +62,12 @@ namespace {
     }
 
 
-    // TODO Ad 2023/10/05: for OpenGL resource, maybe we should directly use the GL name?
-    // or do we want to reimplement Handle<> in term of index in storage containers?
-    /// @brief Hackish class, associating a resource to an integer value.
-    ///
-    /// The value is suitable to compose a DrawEntry::Key via bitwise operations.
-    template <class T_resource, unsigned int N_valueBits>
-    struct ResourceIdMap
+    /// @brief Return the byte of the key at position `aByte`, counting from the least significant.
+    std::uint8_t getKeyByte(const DrawSortKey & aKey, unsigned int aByte)
     {
-        static_assert(N_valueBits <= 16);
-        static constexpr std::uint16_t gMaxValue = (std::uint16_t)((1 << N_valueBits) - 1);
-
-        ResourceIdMap()
-        {
-            // By adding the nullptr as the zero value, this helps debugging
-            get(nullptr);
-            assert(get(nullptr)== 0);
-        }
-
-        /// @brief Get the value associated to provided resource.
-        /// A given map instance will always return the same value for the same resource.
-        std::uint16_t get(Handle<T_resource> aResource)
-        {
-            assert(mResourceToId.size() < gMaxValue);
-            auto [iterator, didInsert] = mResourceToId.try_emplace(aResource,
-                                                                   (std::uint16_t)mResourceToId.size());
-            return iterator->second;
-        }
-
-        /// @brief Return the resource from it value.
-        Handle<T_resource> reverseLookup(std::uint16_t aValue)
-        {
-            if(auto found = std::find_if(mResourceToId.begin(), mResourceToId.end(),
-                                         [aValue](const auto & aPair)
-                                         {
-                                             return aPair.second == aValue;
-                                         });
-               found != mResourceToId.end())
-            {
-                return found->first;
-            }
-            throw std::logic_error{"The provided value is not present in this ResourceIdMap."};
-        }
-
-        std::unordered_map<Handle<T_resource>, std::uint16_t> mResourceToId;
-    };
+        return (std::uint8_t)(aByte < 8 ? (aKey.mLow >> (8 * aByte))
+                                        : (aKey.mHigh >> (8 * (aByte - 8))));
+    }
 
 
 
@@ -118,36 +90,106 @@ Handle<graphics::VertexArrayObject> getVao(const ConfiguredProgram & aProgram,
     assert(aProgram.mConfig);
 
     // Note: the config is via "handle", hosted by in cache that is mutable, so loosing the constness is correct.
-    return
-        [&, &entries = aProgram.mConfig->mEntries]() 
-        -> graphics::VertexArrayObject *
+    auto [found, inserted] = aProgram.mConfig->mVaos.try_emplace(aPart.mVertexStream, gNullHandle);
+    if(inserted)
+    {
+        aStorage.mVaos.push_back(prepareVAO(aProgram.mProgram, *aPart.mVertexStream));
+        found->second = &aStorage.mVaos.back();
+    }
+    return found->second;
+}
+
+
+std::uint64_t DrawSortKey::extract(unsigned int aOffset, unsigned int aBitCount) const
+{
+    assert(aBitCount <= 64 && aOffset + aBitCount <= 128);
+
+    std::uint64_t value;
+    if(aOffset >= 64)
+    {
+        value = mHigh >> (aOffset - 64);
+    }
+    else
+    {
+        value = mLow >> aOffset;
+        if(aOffset != 0)
         {
-            if(auto foundConfig = std::find_if(entries.begin(), entries.end(),
-                                            [&aPart](const auto & aEntry)
-                                            {
-                                                return aEntry.mVertexStream == aPart.mVertexStream;
-                                            });
-                foundConfig != entries.end())
-            {
-                return foundConfig->mVao;
-            }
-            else
-            {
-                aStorage.mVaos.push_back(prepareVAO(aProgram.mProgram, *aPart.mVertexStream));
-                entries.push_back(
-                    ProgramConfig::Entry{
-                        .mVertexStream = aPart.mVertexStream,
-                        .mVao = &aStorage.mVaos.back(),
-                    });
-                return entries.back().mVao;
-            }
-        }();
+            value |= mHigh << (64 - aOffset);
+        }
+    }
+    return value & makeMask(aBitCount);
 }
 
 
-DrawEntryHelper::DrawEntryHelper() :
-    mImpl{std::make_unique<Opaque>()}
-{}
+void DrawSortKey::insert(std::uint64_t aValue, unsigned int aOffset, unsigned int aBitCount)
+{
+    assert(aBitCount <= 64 && aOffset + aBitCount <= 128);
+    assert((aValue & ~makeMask(aBitCount)) == 0);
+
+    if(aOffset >= 64)
+    {
+        mHigh |= aValue << (aOffset - 64);
+    }
+    else
+    {
+        mLow |= aValue << aOffset;
+        // The field straddles both halves
+        if(aOffset != 0 && aOffset + aBitCount > 64)
+        {
+            mHigh |= aValue >> (64 - aOffset);
+        }
+    }
+}
+
+
+void DrawSortKeyLayout::validate() const
+{
+    if(mKeyBits != 64 && mKeyBits != 128)
+    {
+        throw std::invalid_argument{"Draw sort keys must be 64 or 128 bits, not " + std::to_string(mKeyBits) + "."};
+    }
+
+    for(unsigned int fieldBits : {mProgramBits, mMaterialContextBits, mVaoBits, mDepthBits})
+    {
+        if(fieldBits > 64)
+        {
+            throw std::invalid_argument{"Draw sort key fields are limited to 64 bits."};
+        }
+    }
+
+    // The null resource is always assigned a value, a single bit field could not hold any other resource.
+    if(mProgramBits < 2 || mMaterialContextBits < 2 || mVaoBits < 2)
+    {
+        throw std::invalid_argument{"Draw sort key state fields require at least 2 bits."};
+    }
+
+    // The depths are floats, more bits would not add precision.
+    // (it also keeps the quantized depth convertible from double without overflow)
+    if(mDepthBits > gMaxDepthBits)
+    {
+        throw std::invalid_argument{
+            "Draw sort key depth is limited to " + std::to_string(gMaxDepthBits) + " bits."};
+    }
+
+    if((mDepthOrder == DepthOrder::None) != (mDepthBits == 0))
+    {
+        throw std::invalid_argument{"Draw sort key depth bits must be provided iff a depth order is."};
+    }
+
+    if(getUsedBits() > mKeyBits)
+    {
+        throw std::invalid_argument{
+            "Draw sort key layout requires " + std::to_string(getUsedBits()) 
+            + " bits, which overflows the " + std::to_string(mKeyBits) + " bits key."};
+    }
+}
+
+
+DrawEntryHelper::DrawEntryHelper(DrawSortKeyLayout aLayout)
+{
+    aLayout.validate();
+    mImpl = std::make_unique<Opaque>(aLayout);
+}
 
 
 DrawEntryHelper::~DrawEntryHelper() = default;
@@ -155,40 +197,99 @@ DrawEntryHelper::~DrawEntryHelper() = default;
 
 struct DrawEntryHelper::Opaque
 {
-    static constexpr unsigned int gProgramIdBits = 16;
-    static constexpr std::uint64_t gProgramIdMask = makeMask(gProgramIdBits);
+    explicit Opaque(DrawSortKeyLayout aLayout) :
+        mLayout{aLayout},
+        mProgramToId{aLayout.mProgramBits},
+        mVaoToId{aLayout.mVaoBits},
+        mMaterialContextToId{aLayout.mMaterialContextBits}
+    {
+        // Offsets from the least significant bit
+        const unsigned int stateOffset =
+            (mLayout.mDepthOrder == DrawSortKeyLayout::DepthOrder::FrontToBack) ? mLayout.mDepthBits : 0;
+        mVaoOffset = stateOffset;
+        mMaterialContextOffset = mVaoOffset + mLayout.mVaoBits;
+        mProgramOffset = mMaterialContextOffset + mLayout.mMaterialContextBits;
+        mDepthOffset =
+            (mLayout.mDepthOrder == DrawSortKeyLayout::DepthOrder::BackToFront) ? 
+                mProgramOffset + mLayout.mProgramBits
+                : 0;
+    }
 
-    static constexpr unsigned int gVaoBits = 10;
-    static constexpr std::uint64_t gVaoIdMask = makeMask(gVaoBits);
+    DrawSortKeyLayout mLayout;
+    unsigned int mVaoOffset;
+    unsigned int mMaterialContextOffset;
+    unsigned int mProgramOffset;
+    unsigned int mDepthOffset;
 
-    static constexpr unsigned int gMaterialContextBits = 10;
-    static constexpr std::uint64_t gMaterialContextIdMask = makeMask(gMaterialContextBits);
+    ResourceIdMap<ConfiguredProgram> mProgramToId;
+    ResourceIdMap<graphics::VertexArrayObject> mVaoToId;
+    ResourceIdMap<MaterialContext> mMaterialContextToId;
 
-    ResourceIdMap<ConfiguredProgram, gProgramIdBits> mProgramToId;
-    ResourceIdMap<graphics::VertexArrayObject, gVaoBits> mVaoToId;
-    ResourceIdMap<MaterialContext, gMaterialContextBits> mMaterialContextToId;
+    // Reused by each sort, so it is only allocated when the number of entries grows.
+    std::vector<PartDrawEntry> mSortScratch;
+
+    // The program of each effect for mCachedAnnotations, valid for mCachedEffectsGeneration.
+    std::unordered_map<Handle<const Effect>, Handle<ConfiguredProgram>> mEffectToProgram;
+    std::vector<Technique::Annotation> mCachedAnnotations;
+    std::uint64_t mCachedEffectsGeneration = 0;
+
+    /// @brief Clear the caches that are not valid for `aAnnotations` and the current effects generation.
+    void validateCaches(AnnotationsSelector aAnnotations, const Storage & aStorage)
+    {
+        if(aStorage.mEffectsGeneration != mCachedEffectsGeneration)
+        {
+            // Recompilation replaced the programs, and their VAOs are cached by the new programs.
+            // Note: it invalidates the entries previously generated by this helper.
+            mEffectToProgram.clear();
+            mProgramToId.clear();
+            mVaoToId.clear();
+            mCachedEffectsGeneration = aStorage.mEffectsGeneration;
+        }
+
+        if(!std::equal(aAnnotations.begin(), aAnnotations.end(),
+                       mCachedAnnotations.begin(), mCachedAnnotations.end()))
+        {
+            mEffectToProgram.clear();
+            mCachedAnnotations.assign(aAnnotations.begin(), aAnnotations.end());
+        }
+    }
+
+    Handle<ConfiguredProgram> lookupProgram(const Effect & aEffect, AnnotationsSelector aAnnotations)
+    {
+        auto [found, inserted] = mEffectToProgram.try_emplace(&aEffect, gNullHandle);
+        if(inserted)
+        {
+            found->second = getProgram(aEffect, aAnnotations.begin(), aAnnotations.end());
+        }
+        return found->second;
+    }
+
+    std::uint64_t quantizeDepth(GLfloat aDepth) const
+    {
+        const std::uint64_t maxDepth = makeMask(mLayout.mDepthBits);
+        const std::uint64_t depth = (std::uint64_t)((double)std::clamp(aDepth, 0.f, 1.f) * (double)maxDepth);
+        // Far entries get the smaller values when drawing back to front.
+        return (mLayout.mDepthOrder == DrawSortKeyLayout::DepthOrder::BackToFront) ? 
+            maxDepth - depth : depth;
+    }
 
     std::vector<PartDrawEntry> generateDrawEntries(AnnotationsSelector aAnnotations,
                                                    const PartList & aPartList,
-                                                   Storage & aStorage)
+                                                   Storage & aStorage,
+                                                   std::span<const GLfloat> aDepths)
     {
         PROFILER_SCOPE_RECURRING_SECTION(gRenderProfiler, "generate_draw_entries", CpuTime);
 
         auto aParts = aPartList.mParts;
         auto aMaterials = aPartList.mMaterials;
 
-        using ProgramId = std::uint16_t;
-        assert(aStorage.mPrograms.size() < (1 << gProgramIdBits));
+        assert(mLayout.mDepthBits == 0 || aDepths.size() == aParts.size());
+
+        validateCaches(aAnnotations, aStorage);
 
         //constexpr unsigned int gPrimitiveModes = 12; // I counted 12 primitive modes
         //unsigned int gPrimitiveModeIdBits = (unsigned int)std::ceil(std::log2(gPrimitiveModes));
 
-        using VaoId = std::uint16_t;
-        assert(aStorage.mVaos.size() < (1 << gVaoBits));
-
-        using MaterialContextId = std::uint16_t;
-        assert(aStorage.mMaterialContexts.size() < (1 << gMaterialContextBits));
-
         //
         // For each part, associated it to its sort key and store them in an array
         // (this will already prune parts for which there is no program for aPass)
@@ -205,18 +306,21 @@ struct DrawEntryHelper::Opaque
             assert(part.mPrimitiveMode == GL_TRIANGLES);
             assert(part.mVertexStream->mIndicesType == GL_UNSIGNED_INT);
             
-            if(Handle<ConfiguredProgram> configuredProgram = getProgram(*material.mEffect, aAnnotations);
+            if(Handle<ConfiguredProgram> configuredProgram = lookupProgram(*material.mEffect, aAnnotations);
                 configuredProgram)
             {
                 Handle<graphics::VertexArrayObject> vao = getVao(*configuredProgram, part, aStorage);
 
-                ProgramId programId = mProgramToId.get(configuredProgram);
-                VaoId vaoId = mVaoToId.get(vao);
-                MaterialContextId materialContextId = mMaterialContextToId.get(material.mContext);
-
-                std::uint64_t key = vaoId ;
-                key |= materialContextId << gVaoBits;
-                key |= programId << (gVaoBits + gMaterialContextBits);
+                PartDrawEntry::Key key;
+                key.insert(mVaoToId.get(vao), mVaoOffset, mLayout.mVaoBits);
+                key.insert(mMaterialContextToId.get(material.mContext),
+                           mMaterialContextOffset,
+                           mLayout.mMaterialContextBits);
+                key.insert(mProgramToId.get(configuredProgram), mProgramOffset, mLayout.mProgramBits);
+                if(mLayout.mDepthBits != 0)
+                {
+                    key.insert(quantizeDepth(aDepths[partIdx]), mDepthOffset, mLayout.mDepthBits);
+                }
 
                 entries.push_back(PartDrawEntry{.mKey = key, .mPartListIdx = partIdx});
             }
@@ -225,17 +329,78 @@ struct DrawEntryHelper::Opaque
         return entries;
     }
 
+    void sortDrawEntries(std::vector<PartDrawEntry> & aEntries)
+    {
+        PROFILER_SCOPE_RECURRING_SECTION(gRenderProfiler, "radix_sort_draw_entries", CpuTime);
+
+        if(aEntries.size() < 2)
+        {
+            return;
+        }
+
+        // Each pass is a stable counting sort on one byte, from the least significant.
+        mSortScratch.resize(aEntries.size());
+        const unsigned int keyBytes = (mLayout.getUsedBits() + 7) / 8;
+        std::array<std::size_t, 256> offsets;
+        for(unsigned int byte = 0; byte != keyBytes; ++byte)
+        {
+            offsets.fill(0);
+            for(const PartDrawEntry & entry : aEntries)
+            {
+                ++offsets[getKeyByte(entry.mKey, byte)];
+            }
+
+            // When all keys share this byte, the pass would not change the order.
+            if(offsets[getKeyByte(aEntries.front().mKey, byte)] == aEntries.size())
+            {
+                continue;
+            }
+
+            // Exclusive prefix sum, giving the first position of each byte value.
+            std::size_t position = 0;
+            for(std::size_t & offset : offsets)
+            {
+                const std::size_t count = offset;
+                offset = position;
+                position += count;
+            }
+
+            for(const PartDrawEntry & entry : aEntries)
+            {
+                mSortScratch[offsets[getKeyByte(entry.mKey, byte)]++] = entry;
+            }
+            aEntries.swap(mSortScratch);
+        }
+    }
+
+    PartDrawEntry::Key getDrawCallKey(const PartDrawEntry & aEntry) const
+    {
+        if(mLayout.mDepthBits == 0)
+        {
+            return aEntry.mKey;
+        }
+
+        PartDrawEntry::Key result;
+        result.insert(aEntry.mKey.extract(mVaoOffset, mLayout.mVaoBits), mVaoOffset, mLayout.mVaoBits);
+        result.insert(aEntry.mKey.extract(mMaterialContextOffset, mLayout.mMaterialContextBits),
+                      mMaterialContextOffset,
+                      mLayout.mMaterialContextBits);
+        result.insert(aEntry.mKey.extract(mProgramOffset, mLayout.mProgramBits), mProgramOffset, mLayout.mProgramBits);
+        return result;
+    }
+
     DrawCall generateDrawCall(const PartDrawEntry & aEntry, const Part & aPart, const VertexStream & aVertexStream)
     {
-        PartDrawEntry::Key drawKey = aEntry.mKey;
+        const PartDrawEntry::Key & drawKey = aEntry.mKey;
         return DrawCall{
             .mPrimitiveMode = aPart.mPrimitiveMode,
             .mIndicesType = aVertexStream.mIndicesType,
             .mProgram = 
-                &mProgramToId.reverseLookup(gProgramIdMask & (drawKey >> (gVaoBits + gMaterialContextBits)))
+                &mProgramToId.reverseLookup(drawKey.extract(mProgramOffset, mLayout.mProgramBits))
                     ->mProgram,
-            .mVao = mVaoToId.reverseLookup(gVaoIdMask & drawKey),
-            .mCallContext = mMaterialContextToId.reverseLookup(gMaterialContextIdMask & (drawKey >> gVaoBits)),
+            .mVao = mVaoToId.reverseLookup(drawKey.extract(mVaoOffset, mLayout.mVaoBits)),
+            .mCallContext = mMaterialContextToId.reverseLookup(
+                drawKey.extract(mMaterialContextOffset, mLayout.mMaterialContextBits)),
             .mDrawCount = 0,
         };
     }
@@ -244,9 +409,22 @@ struct DrawEntryHelper::Opaque
 
 std::vector<PartDrawEntry> DrawEntryHelper::generateDrawEntries(AnnotationsSelector aAnnotations,
                                                                 const PartList & aPartList,
-                                                                Storage & aStorage)
+                                                                Storage & aStorage,
+                                                                std::span<const GLfloat> aDepths)
+{
+    return mImpl->generateDrawEntries(aAnnotations, aPartList, aStorage, aDepths);
+}
+
+
+void DrawEntryHelper::sortDrawEntries(std::vector<PartDrawEntry> & aEntries)
+{
+    mImpl->sortDrawEntries(aEntries);
+}
+
+
+PartDrawEntry::Key DrawEntryHelper::getDrawCallKey(const PartDrawEntry & aEntry) const
 {
-    return mImpl->generateDrawEntries(aAnnotations, aPartList, aStorage);
+    return mImpl->getDrawCallKey(aEntry);
 }
 
 
@@ -260,12 +438,12 @@ DrawCall DrawEntryHelper::generateDrawCall(const PartDrawEntry & aEntry,
 
 namespace {
 
-    template <class T_semantic, class T_handled>
-    std::vector<T_semantic> findIdenticalKeys(
-        const std::map<T_semantic, Handle<T_handled>> & aMap1,
-        const std::map<T_semantic, Handle<T_handled>> & aMap2)
+    template <class T_repository>
+    std::vector<typename T_repository::key_type> findIdenticalKeys(
+        const T_repository & aMap1,
+        const T_repository & aMap2)
     {
-        std::vector<T_semantic> identicalKeys;
+        std::vector<typename T_repository::key_type> identicalKeys;
         auto it1 = aMap1.begin();
         auto it2 = aMap2.begin();
 
@@ -293,54 +471,93 @@ namespace {
         return identicalKeys;
     }
 
-} // unnamed namespace
 
-void setupProgramRepositories(Handle<MaterialContext> aContext,
-                              RepositoryUbo aUboRepository,
-                              RepositoryTexture aTextureRepository,
-                              const IntrospectProgram & aIntrospectProgram)
-{
+    /// @brief Log the semantics present both in the explicit repositories and in those of `aContext`.
+    void logDuplicateSemantics([[maybe_unused]] Handle<MaterialContext> aContext,
+                               [[maybe_unused]] const RepositoryUbo & aUboRepository,
+                               [[maybe_unused]] const RepositoryTexture & aTextureRepository,
+                               [[maybe_unused]] const IntrospectProgram & aIntrospectProgram)
     {
-        PROFILER_SCOPE_RECURRING_SECTION(gRenderProfiler, "set_buffer_backed_blocks", CpuTime);
         // TODO #repos This should be consolidated
+#if !defined(NDEBUG)
         if(aContext)
         {
-#if !defined(NDEBUG)
-            auto identicalSemantics = findIdenticalKeys(aUboRepository, aContext->mUboRepo);
-            for(const auto & duplicate : identicalSemantics)
+            auto identicalUbos = findIdenticalKeys(aUboRepository, aContext->mUboRepo);
+            for(const auto & duplicate : identicalUbos)
             {
                 SELOG(error)(
                     "Duplicate UBO semantic '{}' when setting up program '{}'.",
-                    duplicate,
+                    to_string(duplicate),
                     aIntrospectProgram.mName);
             }
-#endif
-            RepositoryUbo callRepo{aContext->mUboRepo};
-            aUboRepository.merge(callRepo);
-        }
-        setBufferBackedBlocks(aIntrospectProgram, aUboRepository);
-    }
 
-    {
-        PROFILER_SCOPE_RECURRING_SECTION(gRenderProfiler, "set_textures", CpuTime);
-        // TODO #repos This should be consolidated
-        if(aContext)
-        {
-#if !defined(NDEBUG)
-            auto identicalSemantics = findIdenticalKeys(aTextureRepository, aContext->mTextureRepo);
-            for(const auto & duplicate : identicalSemantics)
+            auto identicalTextures = findIdenticalKeys(aTextureRepository, aContext->mTextureRepo);
+            for(const auto & duplicate : identicalTextures)
             {
                 SELOG(error)(
                     "Duplicate Texture semantic '{}' when setting up program '{}'.",
-                    duplicate,
+                    to_string(duplicate),
                     aIntrospectProgram.mName);
             }
-#endif
-            RepositoryTexture callRepo{aContext->mTextureRepo};
-            aTextureRepository.merge(callRepo);
         }
-        setTextures(aIntrospectProgram, aTextureRepository);
+#endif
     }
+
+} // unnamed namespace
+
+void setupProgramRepositories(Handle<MaterialContext> aContext,
+                              const RepositoryUbo & aUboRepository,
+                              const RepositoryTexture & aTextureRepository,
+                              const IntrospectProgram & aIntrospectProgram)
+{
+    GlStateTracker state;
+    setupProgramRepositories(aContext, aUboRepository, aTextureRepository, aIntrospectProgram, state);
+    state.restore();
+}
+
+
+void setupProgramRepositories(Handle<MaterialContext> aContext,
+                              const RepositoryUbo & aUboRepository,
+                              const RepositoryTexture & aTextureRepository,
+                              const IntrospectProgram & aIntrospectProgram,
+                              GlStateTracker & aState)
+{
+    logDuplicateSemantics(aContext, aUboRepository, aTextureRepository, aIntrospectProgram);
+
+    // The context repositories are looked up as a fallback (instead of being merged in a copy):
+    // the explicit repositories take precedence, as they did when merging.
+    {
+        PROFILER_SCOPE_RECURRING_SECTION(gRenderProfiler, "set_buffer_backed_blocks", CpuTime);
+        setBufferBackedBlocks(aIntrospectProgram,
+                              aUboRepository,
+                              aContext ? &aContext->mUboRepo : nullptr,
+                              aState);
+    }
+
+    {
+        PROFILER_SCOPE_RECURRING_SECTION(gRenderProfiler, "set_textures", CpuTime);
+        setTextures(aIntrospectProgram,
+                    aTextureRepository,
+                    aContext ? &aContext->mTextureRepo : nullptr,
+                    aState);
+    }
+}
+
+
+void resolveProgramRepositories(Handle<MaterialContext> aContext,
+                                const RepositoryUbo & aUboRepository,
+                                const RepositoryTexture & aTextureRepository,
+                                const IntrospectProgram & aIntrospectProgram,
+                                ProgramBindings & aBindings)
+{
+    logDuplicateSemantics(aContext, aUboRepository, aTextureRepository, aIntrospectProgram);
+
+    resolveBindings(aIntrospectProgram,
+                    aUboRepository,
+                    aContext ? &aContext->mUboRepo : nullptr,
+                    aTextureRepository,
+                    aContext ? &aContext->mTextureRepo : nullptr,
+                    aBindings);
 }
 
 
@@ -354,6 +571,18 @@ void draw(const PassCache & aPassCache,
     // (We could even separate actual texture from the "format", allowing to change an underlying texture without revisiting the program)
     // This would address the warnings repetitions (only issued when the compiled state is (re-)generated), and be better for perfs.
 
+    // Since the draw calls are sorted, consecutive calls usually share most of their state:
+    // the tracker skips the binds that would not change it.
+    GlStateTracker state;
+
+    // The calls are sorted by program, then material context: the repositories are resolved
+    // (and the bindings applied) once for each run of calls sharing both,
+    // instead of looking up each semantic for each call.
+    const IntrospectProgram * boundProgram = nullptr;
+    Handle<MaterialContext> boundContext = nullptr;
+    // Resolved again for each run, its storage is reused.
+    ProgramBindings bindings;
+
     GLuint firstInstance = 0; 
     for (const DrawCall & call : aPassCache.mCalls)
     {
@@ -362,18 +591,23 @@ void draw(const PassCache & aPassCache,
         const IntrospectProgram & selectedProgram = *call.mProgram;
         const graphics::VertexArrayObject & vao = *call.mVao;
 
-        // TODO Ad 2023/10/05: #perf #azdo 
-        // Only change what is necessary, instead of rebiding everything each time.
-        // Since we sorted our draw calls, it is very likely that program remain the same, and VAO changes.
         {
             auto bindVaoProfiling = PROFILER_BEGIN_RECURRING_SECTION(gRenderProfiler, "bind_VAO", CpuTime);
-            graphics::ScopedBind vaoScope{vao};
+            state.bindVertexArray(vao);
             PROFILER_END_SECTION(bindVaoProfiling);
-            
-            setupProgramRepositories(call.mCallContext, aUboRepository, aTextureRepository, selectedProgram);
+
+            if(call.mProgram != boundProgram || call.mCallContext != boundContext)
+            {
+                PROFILER_SCOPE_RECURRING_SECTION(gRenderProfiler, "resolve_bindings", CpuTime);
+                resolveProgramRepositories(call.mCallContext, aUboRepository, aTextureRepository, selectedProgram,
+                                           bindings);
+                applyBindings(bindings, state);
+                boundProgram = call.mProgram;
+                boundContext = call.mCallContext;
+            }
 
             auto bindProgramProfiling = PROFILER_BEGIN_RECURRING_SECTION(gRenderProfiler, "bind_program", CpuTime);
-            graphics::ScopedBind programScope{selectedProgram};
+            state.useProgram(selectedProgram);
             PROFILER_END_SECTION(bindProgramProfiling);
 
             {
@@ -402,6 +636,8 @@ void draw(const PassCache & aPassCache,
         }
         firstInstance += call.mDrawCount;
     }
+
+    state.restore();
 }
 
 
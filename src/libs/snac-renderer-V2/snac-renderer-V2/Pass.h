@@ -5,10 +5,17 @@
 
 #include "Model.h"
 
+#include <compare>
+#include <span>
+
 
 namespace ad::renderer {
 
 
+class GlStateTracker;
+struct ProgramBindings;
+
+
 /// @brief A list of all instanciated parts to be drawn, each associated to a Material.
 /// SoA whose major dimension is the cartesian product of renderer::Object's instances, times the number of parts in each Object.
 /// It is intended to be reused accross distinct passes inside a frame (or even accross frames for static parts).
@@ -23,14 +30,67 @@ struct PartList
 };
 
 
+/// @brief An unsigned integer sort key of up to 128 bits, `mHigh` holding the most significant half.
+struct DrawSortKey
+{
+    // Lexicographic comparison of (mHigh, mLow) is the comparison of the 128 bits integer.
+    auto operator<=>(const DrawSortKey &) const = default;
+
+    /// @brief Return the `aBitCount` bits starting at bit `aOffset` (counting from the least significant bit).
+    std::uint64_t extract(unsigned int aOffset, unsigned int aBitCount) const;
+
+    /// @brief Set the `aBitCount` bits starting at bit `aOffset` to `aValue`, assuming they are zero.
+    void insert(std::uint64_t aValue, unsigned int aOffset, unsigned int aBitCount);
+
+    std::uint64_t mHigh = 0;
+    std::uint64_t mLow = 0;
+};
+
+
+/// @brief The dimensions composing a DrawSortKey, and their bit widths.
+///
+/// The state dimensions are ordered from the most significant as: program, material context, VAO.
+/// The optional depth dimension is placed below them for front-to-back ordering (e.g. opaque, to reduce overdraw),
+/// or above them for back-to-front ordering (e.g. blended transparency, which requires it).
+struct DrawSortKeyLayout
+{
+    enum class DepthOrder
+    {
+        None,
+        FrontToBack,
+        BackToFront,
+    };
+
+    static constexpr unsigned int gMaxDepthBits = 32;
+
+    /// @brief Throw std::invalid_argument if the dimensions do not fit in mKeyBits,
+    /// or if the layout is otherwise invalid.
+    void validate() const;
+
+    /// @brief The number of bits actually used by the dimensions.
+    unsigned int getUsedBits() const
+    { return mProgramBits + mMaterialContextBits + mVaoBits + mDepthBits; }
+
+    unsigned int mKeyBits = 64; // Either 64 or 128.
+    unsigned int mProgramBits = 16;
+    unsigned int mMaterialContextBits = 16;
+    unsigned int mVaoBits = 16;
+    unsigned int mDepthBits = 0; // Must be zero iff mDepthOrder is None, at most gMaxDepthBits.
+    DepthOrder mDepthOrder = DepthOrder::None;
+};
+
+
 /// @brief Associate an integer key to a the index of a Part in a PartList.
 /// It allows to sort an array with one entry for each part,
 /// by manually composing a key by sort dimensions.
 /// @see https://realtimecollisiondetection.net/blog/?p=86
 struct PartDrawEntry
 {
-    using Key = std::uint64_t;
-    static constexpr Key gInvalidKey = std::numeric_limits<Key>::max();
+    using Key = DrawSortKey;
+    static constexpr Key gInvalidKey{
+        .mHigh = std::numeric_limits<std::uint64_t>::max(),
+        .mLow = std::numeric_limits<std::uint64_t>::max(),
+    };
 
     /// @brief Order purely by key.
     /// @param aRhs The other entry, whose key will be compared against this key.
@@ -40,7 +100,7 @@ struct PartDrawEntry
         return mKey < aRhs.mKey;
     }
 
-    Key mKey = 0;
+    Key mKey{};
     std::size_t mPartListIdx;
 };
 
@@ -48,6 +108,8 @@ struct PartDrawEntry
 /// @brief Entry to populate the GL_DRAW_INDIRECT_BUFFER used with indexed (glDrawElements) geometry.
 struct DrawElementsIndirectCommand
 {
+    bool operator==(const DrawElementsIndirectCommand &) const = default;
+
     GLuint  mCount;
     GLuint  mInstanceCount;
     GLuint  mFirstIndex;
@@ -118,16 +180,29 @@ using AnnotationsSelector = std::span<const Technique::Annotation>;
 // we might be able to use their values directly as integer part of the key, and get rid of this struct.
 struct DrawEntryHelper
 {
-    DrawEntryHelper();
+    /// @brief Throw std::invalid_argument if `aLayout` is not valid.
+    explicit DrawEntryHelper(DrawSortKeyLayout aLayout = {});
 
     // Must be defaulted in the implementation file, where Opaque definition is available 
     ~DrawEntryHelper();
 
     /// @brief Returns an array with one DrawEntry per-part in the input PartList.
     /// The DrawEntries can be sorted in order to minimize state changes.
+    /// @param aDepths The view depth of each entry in the PartList, normalized to [0, 1].
+    /// Only used (and then required) if the layout has a depth dimension.
+    /// @throw std::overflow_error if there are more distinct resources than a dimension can represent.
     std::vector<PartDrawEntry> generateDrawEntries(AnnotationsSelector aAnnotations,
                                                    const PartList & aPartList,
-                                                   Storage & aStorage);
+                                                   Storage & aStorage,
+                                                   std::span<const GLfloat> aDepths = {});
+
+    /// @brief Stable sort of the entries by key, with a LSD radix sort.
+    /// @note The scratch memory is kept by the helper, so it is only allocated when the entry count grows.
+    void sortDrawEntries(std::vector<PartDrawEntry> & aEntries);
+
+    /// @brief Return the part of the key that determines the draw call (i.e. excluding depth).
+    /// Consecutive sorted entries with the same draw call key can be drawn by the same DrawCall.
+    PartDrawEntry::Key getDrawCallKey(const PartDrawEntry & aEntry) const;
 
     DrawCall generateDrawCall(const PartDrawEntry & aEntry,
                               const Part & aPart,
@@ -155,11 +230,27 @@ Handle<graphics::VertexArrayObject> getVao(const ConfiguredProgram & aProgram,
 
 
 /// @brief Setup the repositories on `aIntrospectProgram`.
-/// @attention Takes repositories by value, since the copies will be mutated in the function.
+/// The repositories of `aContext` are only looked up for semantics absent from the explicit repositories.
 void setupProgramRepositories(Handle<MaterialContext> aContext,
-                              RepositoryUbo aUboRepository,
-                              RepositoryTexture aTextureRepository,
+                              const RepositoryUbo & aUboRepository,
+                              const RepositoryTexture & aTextureRepository,
                               const IntrospectProgram & aIntrospectProgram);
 
+/// @brief Setup the repositories on `aIntrospectProgram`, skipping the binds already made through `aState`.
+void setupProgramRepositories(Handle<MaterialContext> aContext,
+                              const RepositoryUbo & aUboRepository,
+                              const RepositoryTexture & aTextureRepository,
+                              const IntrospectProgram & aIntrospectProgram,
+                              GlStateTracker & aState);
+
+/// @brief Resolve the bindings of `aIntrospectProgram` from the repositories, with the precedence of setupProgramRepositories(),
+/// so they can be applied to successive draws.
+/// @param aBindings Receives the bindings, its storage is reused.
+void resolveProgramRepositories(Handle<MaterialContext> aContext,
+                                const RepositoryUbo & aUboRepository,
+                                const RepositoryTexture & aTextureRepository,
+                                const IntrospectProgram & aIntrospectProgram,
+                                ProgramBindings & aBindings);
+
 
 } // namespace ad::renderer
\ No newline at end of file
@@ -4,18 +4,51 @@
 #include "Commons.h"
 #include "Handle.h"
 
+#include "utilities/FlatMap.h"
+
 #include <renderer/Texture.h>
 #include <renderer/UniformBuffer.h>
 
-#include <map>
-
 
 namespace ad::renderer {
 
 
+/// @brief Buffer storage bound to an indexed binding point: either a whole buffer, or a range of it
+/// (e.g. allocated from a StreamingBuffer).
+struct BufferRange
+{
+    BufferRange() = default;
+
+    /// @brief Designate the whole `aUbo`, implicitly, so repositories can still be populated with UBO handles.
+    BufferRange(Handle<const graphics::UniformBufferObject> aUbo) :
+        mBuffer{*aUbo}
+    {}
+
+    /// @brief Designate the whole `aBuffer`, typically backing a shader storage block.
+    BufferRange(Handle<const graphics::BufferAny> aBuffer) :
+        mBuffer{*aBuffer}
+    {}
+
+    BufferRange(GLuint aBuffer, GLintptr aOffset, GLsizeiptr aSize) :
+        mBuffer{aBuffer},
+        mOffset{aOffset},
+        mSize{aSize}
+    {}
+
+    bool operator==(const BufferRange &) const = default;
+
+    GLuint mBuffer = 0;
+    GLintptr mOffset = 0;
+    // Zero designates the whole buffer.
+    GLsizeiptr mSize = 0;
+};
+
+
 // TODO the UBO should also be stored in some Storage instance, not an ad-hoc repo
-using RepositoryUbo = std::map<BlockSemantic, Handle<const graphics::UniformBufferObject>>;
-using RepositoryTexture = std::map<Semantic, Handle<const graphics::Texture>>;
+// Looked up for each draw call, hence the flat maps keyed by integer ids.
+// Backs both the uniform blocks and the shader storage blocks of programs.
+using RepositoryUbo = FlatMap<BlockSemantic, BufferRange>;
+using RepositoryTexture = FlatMap<Semantic, Handle<const graphics::Texture>>;
 
 
 } // namespace ad::renderer
\ No newline at end of file
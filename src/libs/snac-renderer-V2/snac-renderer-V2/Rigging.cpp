@@ -3,30 +3,46 @@
 #include <math/Transformations.h>
 #include <math/Interpolation/QuaternionInterpolation.h>
 
+#include <algorithm>
+
+#include <cmath>
+
 
 namespace ad::renderer {
 
 
 namespace {
 
-    math::AffineMatrix<4, float> computeInterpolatedMatrix(
-        const RigAnimation::NodeKeyframes & aKeyframes,
-        std::size_t aPreviousStep, std::size_t aNextStep,
-        float aInterpolant)
+    /// @brief Return the index of the first timepoint strictly greater than `aTimepoint`
+    /// (the count of timepoints if there is none).
+    /// @param aCursor The result of the previous search, tested first and updated to the result.
+    std::size_t findNextKeyframe(const std::vector<float> & aTimepoints,
+                                 float aTimepoint,
+                                 std::size_t & aCursor)
     {
-        return 
-            math::trans3d::scale(
-                math::lerp(aKeyframes.mScales[aPreviousStep].as<math::Size>(),
-                           aKeyframes.mScales[aNextStep].as<math::Size>(),
-                           aInterpolant))
-            * math::slerp(aKeyframes.mRotations[aPreviousStep],
-                          aKeyframes.mRotations[aNextStep],
-                          aInterpolant).toRotationMatrix()
-            * math::trans3d::translate(
-                math::lerp(aKeyframes.mTranslations[aPreviousStep],
-                           aKeyframes.mTranslations[aNextStep],
-                           aInterpolant))
-            ;
+        const std::size_t count = aTimepoints.size();
+        auto isNext = [&](std::size_t aIdx)
+        {
+            return (aIdx == count || aTimepoints[aIdx] > aTimepoint)
+                && (aIdx == 0 || aTimepoints[aIdx - 1] <= aTimepoint);
+        };
+
+        // Time advancing monotonically usually remains in the same keyframe interval, or moves to the next one.
+        if(aCursor <= count && isNext(aCursor))
+        {
+            return aCursor;
+        }
+        else if(aCursor < count && isNext(aCursor + 1))
+        {
+            return ++aCursor;
+        }
+        else
+        {
+            // Time jumped (e.g. looping animation, or a new animation), binary search.
+            aCursor = std::upper_bound(aTimepoints.begin(), aTimepoints.end(), aTimepoint) 
+                      - aTimepoints.begin();
+            return aCursor;
+        }
     }
 
 } // unnamed namespace
@@ -38,18 +54,20 @@ Rig::FuturePose_type animate(const RigAnimation & aAnimation,
                              float aTimepoint,
                              const NodeTree<Rig::Pose> & aAnimatedTree)
 {
-    using Node = NodeTree<Rig::Pose>::Node;
-
-    // The posed nodes are only used for a list of global poses
-    // (which has to be in the same order as the Rig.)
+    AnimationSampler sampler;
     NodeTree<Rig::Pose> posedNodes;
-    posedNodes.mGlobalPose.reserve(aAnimatedTree.size());
+    animate(aAnimation, aTimepoint, aAnimatedTree, sampler, posedNodes);
+    return posedNodes;
+}
+
 
-    // Internal use only:
-    // Copy the local poses of the rig:
-    // some will be overwritten by the animation, but the one not targeted
-    // by the animation should have the rig base value.
-    auto localPoses = aAnimatedTree.mLocalPose;
+void animate(const RigAnimation & aAnimation,
+             float aTimepoint,
+             const NodeTree<Rig::Pose> & aAnimatedTree,
+             AnimationSampler & aSampler,
+             Rig::FuturePose_type & aPosedNodes)
+{
+    using Node = NodeTree<Rig::Pose>::Node;
 
     const auto & timepoints = aAnimation.mTimepoints;
     assert(!timepoints.empty());
@@ -58,64 +76,114 @@ Rig::FuturePose_type animate(const RigAnimation & aAnimation,
     // Find the indices of the timepoints around the current time,
     // and the interpolation value.
     //
-    auto timepointAfter =
-        std::find_if(timepoints.begin(), timepoints.end(),
-                     [aTimepoint](float aTime){return aTime > aTimepoint;});
-    
+    // Note: All nodes of a RigAnimation share the same timepoints,
+    // so a single cursor is enough for the whole animation.
+    const std::size_t nextKeyframe = findNextKeyframe(timepoints, aTimepoint, aSampler.mKeyframeCursor);
+
     std::size_t previousIdx, nextIdx;
     float interpolant = 0.f;
-    if (timepointAfter == timepoints.begin())
+    if (nextKeyframe == 0)
     {
         previousIdx = nextIdx = 0;
     }
-    else if(timepointAfter == timepoints.end())
+    else if(nextKeyframe == timepoints.size())
     {
         previousIdx = nextIdx = timepoints.size() - 1;
     }
     else
     {
-        nextIdx = timepointAfter - timepoints.begin();
+        nextIdx = nextKeyframe;
         previousIdx = nextIdx - 1;
         interpolant = (aTimepoint - timepoints[previousIdx]) 
-                       / (*timepointAfter - timepoints[previousIdx]);
+                       / (timepoints[nextIdx] - timepoints[previousIdx]);
     }
 
     //
-    // Compute the new local pose of each animated node
+    // Sample the local transformations of each animated node
     // (Important: This might only touch a subset of the bone hierarchy,
     //  since an animation does not have to touch all bones)
     //
     const auto & nodes = aAnimation.mNodes;
+    const auto & keyframes = aAnimation.mKeyframes;
+    const std::size_t animatedCount = nodes.size();
+    // Note: resize does not reallocate once the sampler has been used for an animation this large.
+    aSampler.mTranslations.resize(animatedCount);
+    aSampler.mRotations.resize(animatedCount);
+    aSampler.mScales.resize(animatedCount);
+
+    // Each component is interpolated in its own loop, over contiguous outputs.
     // Note: The joint index is the index in the RigAnimation list of joints.
     // This will be different from the node index in the NodeTree hierarchy, 
     // this hierarchy index is looked up in RigAnimation.mNodes.
-    for(std::size_t jointIdx = 0; jointIdx != nodes.size(); ++jointIdx)
+    for(std::size_t jointIdx = 0; jointIdx != animatedCount; ++jointIdx)
+    {
+        aSampler.mTranslations[jointIdx] = math::lerp(keyframes[jointIdx].mTranslations[previousIdx],
+                                                      keyframes[jointIdx].mTranslations[nextIdx],
+                                                      interpolant);
+    }
+    for(std::size_t jointIdx = 0; jointIdx != animatedCount; ++jointIdx)
+    {
+        aSampler.mScales[jointIdx] = math::lerp(keyframes[jointIdx].mScales[previousIdx],
+                                                keyframes[jointIdx].mScales[nextIdx],
+                                                interpolant);
+    }
+    for(std::size_t jointIdx = 0; jointIdx != animatedCount; ++jointIdx)
     {
-        Node::Index hierarchyIdx = nodes[jointIdx];
-        const RigAnimation::NodeKeyframes & keyframes = aAnimation.mKeyframes[jointIdx];
+        aSampler.mRotations[jointIdx] = math::slerp(keyframes[jointIdx].mRotations[previousIdx],
+                                                    keyframes[jointIdx].mRotations[nextIdx],
+                                                    interpolant);
+    }
 
-        localPoses[hierarchyIdx] = 
-            computeInterpolatedMatrix(keyframes, previousIdx, nextIdx, interpolant);
+    //
+    // Compute the new local pose of each animated node
+    //
+    // The nodes not targeted by the animation keep the rig base value.
+    // Note: assign() does not reallocate when the capacity is sufficient.
+    aSampler.mLocalPoses.assign(aAnimatedTree.mLocalPose.begin(), aAnimatedTree.mLocalPose.end());
+    for(std::size_t jointIdx = 0; jointIdx != animatedCount; ++jointIdx)
+    {
+        aSampler.mLocalPoses[nodes[jointIdx]] = 
+            math::trans3d::scale(aSampler.mScales[jointIdx].as<math::Size>())
+            * aSampler.mRotations[jointIdx].toRotationMatrix()
+            * math::trans3d::translate(aSampler.mTranslations[jointIdx]);
     }
 
     //
     // Traverse the *whole* node tree hierarchy to compute the global pose of each node
     //
+    // The posed nodes are only used for a list of global poses
+    // (which has to be in the same order as the Rig.)
+    const std::vector<Rig::Pose> & localPoses = aSampler.mLocalPoses;
+    std::vector<Rig::Pose> & globalPoses = aPosedNodes.mGlobalPose;
+    globalPoses.resize(aAnimatedTree.mHierarchy.size());
     for(Node::Index hierarchyIdx = 0; hierarchyIdx != aAnimatedTree.mHierarchy.size(); ++hierarchyIdx)
     {
+        // Parents are always stored before their children, see NodeTree::addNode()
         if(Node::Index parentIdx = aAnimatedTree.mHierarchy[hierarchyIdx].mParent;
            parentIdx != Node::gInvalidIndex)
         {
-            posedNodes.mGlobalPose.push_back(
-                localPoses[hierarchyIdx] * posedNodes.mGlobalPose[parentIdx]);
+            globalPoses[hierarchyIdx] = localPoses[hierarchyIdx] * globalPoses[parentIdx];
         }
         else
         {
-            posedNodes.mGlobalPose.push_back(localPoses[hierarchyIdx]);
+            globalPoses[hierarchyIdx] = localPoses[hierarchyIdx];
         }
     }
+}
 
-    return posedNodes;
+
+PoseKey makePoseKey(const Rig & aRig, const RigAnimation * aAnimation, float aTimepoint)
+{
+    PoseKey key{
+        .mRig = &aRig,
+        .mAnimation = aAnimation,
+    };
+    // A static animation poses the rig the same way at all times.
+    if(aAnimation != nullptr && aAnimation->mTimepoints.size() > 1)
+    {
+        key.mQuantizedTime = (std::int64_t)std::floor(aTimepoint / PoseKey::gTimeQuantum + 0.5f);
+    }
+    return key;
 }
 
 
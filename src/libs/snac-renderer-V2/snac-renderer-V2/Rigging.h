@@ -14,6 +14,7 @@
 #include <vector>
 
 #include <cassert>
+#include <cstdint>
 
 
 namespace ad::renderer {
@@ -151,6 +152,10 @@ struct Rig
 
     // With Assimp, I do not know any better name for the rig as a whole than its armature
     std::string mArmatureName;
+
+    // The joint matrices of the default pose (mJointTree), computed once when the rig is loaded,
+    // so instances in the default pose can share it.
+    MatrixPalette mDefaultPalette;
 };
 
 
@@ -190,6 +195,27 @@ struct RigAnimation
 };
 
 
+/// @brief Caller-owned state to sample RigAnimations without allocating once warmed up.
+///
+/// It is intended to be kept by the client for each animated instance, across frames:
+/// the keyframe cursor makes the lookup amortized constant time when the sampled time advances monotonically,
+/// and the buffers keep their capacity between samplings.
+/// @note A sampler can be reused with a different animation, the cursor is validated on each use.
+struct AnimationSampler
+{
+    // Index of the first timepoint strictly after the last sampled time (in [0, timepoints count]).
+    std::size_t mKeyframeCursor = 0;
+
+    // SOA sampled local transformations, in the order of RigAnimation::mNodes.
+    std::vector<math::Vec<3, float>> mTranslations;
+    std::vector<math::Quaternion<float>> mRotations;
+    std::vector<math::Vec<3, float>> mScales;
+
+    // The local poses of the whole animated tree.
+    std::vector<Rig::Pose> mLocalPoses;
+};
+
+
 // TODO Redesign the API, the coupling between the Rig and its Animation is awkward
 // and so is this function signature.
 // TODO & IMPORTANT NOTE: The returned value is not a correct NodeTree (and does not need to be),
@@ -198,16 +224,53 @@ struct RigAnimation
 //    Yet at the moment we use it interchangeably with the Rig's JointTree, depending whether we
 //    have an actual animation (the future type), or we just have the default rig pose available (a plain NodeTree)
 //    (In these situation, using the same type is convenient, as we can ternary-operator).
+/// @note Allocates the returned value and its intermediate buffers,
+/// prefer the overload taking an AnimationSampler when animating each frame.
 Rig::FuturePose_type animate(const RigAnimation & aAnimation,
                              float aTimepoint,
                              const NodeTree<Rig::Pose> & aAnimatedTree);
 
+/// @brief Write the global pose of each node of `aAnimatedTree` at `aTimepoint` into `aPosedNodes`,
+/// using `aSampler` state and buffers.
+/// @note Only `aPosedNodes.mGlobalPose` is written, and it does not reallocate if its capacity is sufficient.
+void animate(const RigAnimation & aAnimation,
+             float aTimepoint,
+             const NodeTree<Rig::Pose> & aAnimatedTree,
+             AnimationSampler & aSampler,
+             Rig::FuturePose_type & aPosedNodes);
+
+
+/// @brief Identify a pose of a Rig, so instances in the same pose can share a joint matrix palette.
+///
+/// The animation time is quantized: instances whose timepoints fall in the same quantum share the pose,
+/// which should be sampled at timepoint() for all of them.
+struct PoseKey
+{
+    static constexpr float gTimeQuantum = 1.f / 240.f;
+
+    /// @brief The timepoint at which the pose should be sampled.
+    float timepoint() const
+    { return (float)mQuantizedTime * gTimeQuantum; }
+
+    bool operator==(const PoseKey &) const = default;
+
+    const Rig * mRig = nullptr;
+    // Null for the default pose of the rig.
+    const RigAnimation * mAnimation = nullptr;
+    std::int64_t mQuantizedTime = 0;
+};
+
+
+/// @param aAnimation Null for the default pose of `aRig`.
+/// @note The default pose, and animations with a single keyframe, always have the same key whatever the time.
+PoseKey makePoseKey(const Rig & aRig, const RigAnimation * aAnimation, float aTimepoint);
+
 
 /// @brief Associated RigAnimations to the Rig they target
 struct AnimatedRig
 {
     Rig mRig;
-    std::unordered_map<StringKey/*name*/, RigAnimation> mNameToAnimation;
+    std::unordered_map<std::string/*name*/, RigAnimation> mNameToAnimation;
 };
 
 
@@ -347,4 +410,17 @@ typename NodeTree<T_Pose>::Node::Index NodeTree<T_Pose>::addNode(typename Node::
 }
 
 
-} // namespace ad::renderer
\ No newline at end of file
+} // namespace ad::renderer
+
+
+template <>
+struct std::hash<ad::renderer::PoseKey>
+{
+    std::size_t operator()(const ad::renderer::PoseKey & aKey) const noexcept
+    {
+        std::size_t seed = std::hash<const void *>{}(aKey.mRig);
+        seed ^= std::hash<const void *>{}(aKey.mAnimation) + 0x9e3779b9 + (seed << 6) + (seed >> 2);
+        seed ^= std::hash<std::int64_t>{}(aKey.mQuantizedTime) + 0x9e3779b9 + (seed << 6) + (seed >> 2);
+        return seed;
+    }
+};
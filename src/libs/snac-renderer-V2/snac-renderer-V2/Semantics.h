@@ -1,51 +1,56 @@
 #pragma once
 
 
+#include "Commons.h"
+
+
 namespace ad::renderer {
 
 
+/// @brief The semantics known by the renderer, their StringId are computed at compile time.
 namespace semantic
 {
-    #define SEM(s) const Semantic g ## s{#s}
+    #define SEM(s) inline constexpr Semantic g ## s{#s}
 
-    const Semantic g_builtin = "_builtin";
-    const Semantic gPosition{"Position"};
+    inline constexpr Semantic g_builtin{"_builtin"};
+    inline constexpr Semantic gPosition{"Position"};
     SEM(ModelTransform);
-    const Semantic gNormal{"Normal"};
-    const Semantic gTangent{"Tangent"};
+    inline constexpr Semantic gNormal{"Normal"};
+    inline constexpr Semantic gTangent{"Tangent"};
     SEM(Bitangent);
-    const Semantic gColor{"Color"};
-    const Semantic gUv{"Uv"};
+    inline constexpr Semantic gColor{"Color"};
+    inline constexpr Semantic gUv{"Uv"};
     SEM(GlyphAtlas);
     SEM(GlyphIdx);
     SEM(ShadowMap);
     SEM(Joints0);
     SEM(Weights0);
-    const Semantic gDiffuseTexture{"DiffuseTexture"};
-    const Semantic gNormalTexture{"NormalTexture"};
+    inline constexpr Semantic gDiffuseTexture{"DiffuseTexture"};
+    inline constexpr Semantic gNormalTexture{"NormalTexture"};
     SEM(MetallicRoughnessAoTexture);
     SEM(EnvironmentTexture);
     SEM(FilteredRadianceEnvironmentTexture);
     SEM(IntegratedEnvironmentBrdf);
     SEM(FilteredIrradianceEnvironmentTexture);
     SEM(EntityIdx);
-    const Semantic gModelTransformIdx{"ModelTransformIdx"};
-    const Semantic gMaterialIdx{"MaterialIdx"};
+    SEM(PackedEntityMaterial);
+    inline constexpr Semantic gModelTransformIdx{"ModelTransformIdx"};
+    inline constexpr Semantic gMaterialIdx{"MaterialIdx"};
     SEM(MatrixPaletteOffset);
 
     #undef SEM
 
-    #define BLOCK_SEM(s) const BlockSemantic g ## s{#s}
+    #define BLOCK_SEM(s) inline constexpr BlockSemantic g ## s{#s}
 
     BLOCK_SEM(Entities);
     BLOCK_SEM(TextEntities);
-    const BlockSemantic gFrame{"Frame"};
+    inline constexpr BlockSemantic gFrame{"Frame"};
     BLOCK_SEM(GlyphMetrics);
     BLOCK_SEM(JointMatrices);
     BLOCK_SEM(Lights);
     BLOCK_SEM(LightViewProjection);
-    const BlockSemantic gLocalToWorld{"LocalToWorld"};
-    const BlockSemantic gMaterials{"Materials"};
+    inline constexpr BlockSemantic gLocalToWorld{"LocalToWorld"};
+    inline constexpr BlockSemantic gMaterials{"Materials"};
     BLOCK_SEM(ShadowCascade);
     BLOCK_SEM(ViewProjection);
 
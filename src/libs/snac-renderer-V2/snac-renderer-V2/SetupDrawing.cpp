@@ -1,5 +1,6 @@
 #include "SetupDrawing.h"
 
+#include "GlStateTracker.h"
 #include "Logging.h"
 #include "Model.h"
 #include "Semantics.h"
@@ -22,6 +23,7 @@ namespace {
     /// (dimensions, etc.)
     void attachAttribute(const IntrospectProgram::Attribute & aShaderAttribute,
                          graphics::ClientAttribute aClientAttribute, // taken by copy because we need to mutate locally
+                         bool aNormalizedClientData,
                          const BufferView & aVertexBufferView,
                          std::string_view aProgramName /* for log messages */)
     {
@@ -58,8 +60,10 @@ namespace {
             // The client attribute, as provided by the VertexStream, contains the offset from the start of the BufferView
             // We need to add the offset of the BufferView from the start of the Buffer, before calling attachBoundVertexBuffer()
             aClientAttribute.mOffset += aVertexBufferView.mOffset;
+            graphics::ShaderParameter shaderParameter = aShaderAttribute.toShaderParameter();
+            shaderParameter.mNormalize = shaderParameter.mNormalize || aNormalizedClientData;
             graphics::attachBoundVertexBuffer(
-                {aShaderAttribute.toShaderParameter(), aClientAttribute},
+                {shaderParameter, aClientAttribute},
                 aVertexBufferView.mStride,
                 aVertexBufferView.mInstanceDivisor);
     }
@@ -98,6 +102,7 @@ graphics::VertexArrayObject prepareVAO(const IntrospectProgram & aProgram,
             //assert(vertexBufferView.mInstanceDivisor == 0); // should always be 0 for the VertexStream as far as I imagine
             attachAttribute(shaderAttribute,
                             accessor.mClientDataFormat,
+                            accessor.mNormalized,
                             vertexBufferView,
                             aProgram.name());
         }
@@ -117,77 +122,232 @@ graphics::VertexArrayObject prepareVAO(const IntrospectProgram & aProgram,
 }
 
 
-void setBufferBackedBlocks(const IntrospectProgram & aProgram,
-                           const RepositoryUbo & aUniformBufferObjects)
-{
-    for (const IntrospectProgram::UniformBlock & shaderBlock : aProgram.mUniformBlocks)
+namespace {
+
+    /// @brief Find `aSemantic` in `aRepository`, then in `aFallback` (if not null).
+    /// @return A pointer to the mapped value, or null if the semantic is in neither.
+    template <class T_repository>
+    const typename T_repository::mapped_type * lookup(const typename T_repository::key_type & aSemantic,
+                                                      const T_repository & aRepository,
+                                                      const T_repository * aFallback)
     {
-        if(auto found = aUniformBufferObjects.find(shaderBlock.mSemantic);
-           found != aUniformBufferObjects.end())
+        if(auto found = aRepository.find(aSemantic); found != aRepository.end())
         {
-            bind(*found->second, shaderBlock.mBindingIndex);
+            return &found->second;
         }
-        else
+        else if(aFallback)
         {
-            // TODO since this function is currently called before each draw
-            // this is much too verbose for a warning...
-            SELOG_LG(gPipelineDiag, warn)(
-                "{}: Could not find an a block uniform for block semantic '{}' in program '{}'.", 
-                __func__,
-                to_string(shaderBlock.mSemantic),
-                aProgram.name());
+            if(auto fallback = aFallback->find(aSemantic); fallback != aFallback->end())
+            {
+                return &fallback->second;
+            }
         }
+        return nullptr;
     }
-}
 
-
-void setTextures(const IntrospectProgram & aProgram,
-                 const RepositoryTexture & aTextures)
-{
-    GLint textureImageUnit = 0;
-    for (const IntrospectProgram::Resource & shaderUniform : aProgram.mUniforms)
+    /// @brief Call `aUniformVisitor` or `aStorageVisitor` with the binding index and the buffer range of each block
+    /// of `aProgram`, looked up in `aUniformBufferObjects` then `aFallbackUniformBufferObjects`.
+    template <class F_uniformVisitor, class F_storageVisitor>
+    void visitBufferBackedBlocks(const IntrospectProgram & aProgram,
+                                 const RepositoryUbo & aUniformBufferObjects,
+                                 const RepositoryUbo * aFallbackUniformBufferObjects,
+                                 F_uniformVisitor && aUniformVisitor,
+                                 F_storageVisitor && aStorageVisitor)
     {
-        if (graphics::isResourceSamplerType(shaderUniform.mType))
+        for (const IntrospectProgram::UniformBlock & shaderBlock : aProgram.mUniformBlocks)
         {
-            if(auto found = aTextures.find(shaderUniform.mSemantic);
-               found != aTextures.end())
+            if(auto found = lookup(shaderBlock.mSemantic, aUniformBufferObjects, aFallbackUniformBufferObjects))
             {
-                if (shaderUniform.mArraySize != 1)
-                {
-                    SELOG_LG(gPipelineDiag, error)(
-                        "{}: '{}' program uniform '{}'({}) is a sampler array of size {}, setting uniform arrays is not supported.",
-                        __func__,
-                        aProgram.name(),
-                        shaderUniform.mName,
-                        to_string(shaderUniform.mSemantic),
-                        shaderUniform.mArraySize
-                    );
-                }
-
-                // TODO assertions regarding texture-sampler compatibility
-                auto guardImageUnit = graphics::activateTextureUnitGuard(textureImageUnit);
-                bind(*found->second); // should not be unbound when we exit the current scope.
-                // TODO Ad 2023/11/30: Currently, we are assigning texture image units to sampler uniforms of the shader program
-                // and binding the texture to the texture unit each time.
-                // Assuming we will bind the texture to the TU each time, we can set the uniforms only once for the shader program lifetime 
-                // (as long as the texture is bound to the same unit).
-                graphics::setUniform(aProgram, shaderUniform.mLocation, textureImageUnit);
-                ++textureImageUnit;
+                aUniformVisitor(shaderBlock.mBindingIndex, *found);
             }
             else
             {
                 // TODO since this function is currently called before each draw
-                // this is much to verbose for a warning...
-                // In the case of samplers thought this is likely an error:
-                // the sampler being available means it is probably used.
-                SELOG_LG(gPipelineDiag, error)(
-                    "{}: Could not find a texture for semantic '{}' in program '{}'.", 
+                // this is much too verbose for a warning...
+                SELOG_LG(gPipelineDiag, warn)(
+                    "{}: Could not find an a block uniform for block semantic '{}' in program '{}'.", 
+                    __func__,
+                    to_string(shaderBlock.mSemantic),
+                    aProgram.name());
+            }
+        }
+
+        // Shader storage blocks are backed by buffers from the same repository.
+        for (const IntrospectProgram::ShaderStorageBlock & shaderBlock : aProgram.mShaderStorageBlocks)
+        {
+            if(auto found = lookup(shaderBlock.mSemantic, aUniformBufferObjects, aFallbackUniformBufferObjects))
+            {
+                aStorageVisitor(shaderBlock.mBindingIndex, *found);
+            }
+            else
+            {
+                SELOG_LG(gPipelineDiag, warn)(
+                    "{}: Could not find a buffer for shader storage block semantic '{}' in program '{}'.", 
                     __func__,
-                    to_string(shaderUniform.mSemantic),
+                    to_string(shaderBlock.mSemantic),
                     aProgram.name());
             }
         }
     }
+
+
+    /// @brief Call `aVisitor` with each sampler uniform of `aProgram`, its assigned texture image unit,
+    /// and its texture looked up in `aTextures` then `aFallbackTextures`.
+    template <class F_visitor>
+    void visitTextures(const IntrospectProgram & aProgram,
+                       const RepositoryTexture & aTextures,
+                       const RepositoryTexture * aFallbackTextures,
+                       F_visitor && aVisitor)
+    {
+        GLint textureImageUnit = 0;
+        for (const IntrospectProgram::Resource & shaderUniform : aProgram.mUniforms)
+        {
+            if (graphics::isResourceSamplerType(shaderUniform.mType))
+            {
+                if(auto found = lookup(shaderUniform.mSemantic, aTextures, aFallbackTextures))
+                {
+                    if (shaderUniform.mArraySize != 1)
+                    {
+                        SELOG_LG(gPipelineDiag, error)(
+                            "{}: '{}' program uniform '{}'({}) is a sampler array of size {}, setting uniform arrays is not supported.",
+                            __func__,
+                            aProgram.name(),
+                            shaderUniform.mName,
+                            to_string(shaderUniform.mSemantic),
+                            shaderUniform.mArraySize
+                        );
+                    }
+
+                    // TODO assertions regarding texture-sampler compatibility
+                    aVisitor(shaderUniform, textureImageUnit, **found);
+                    ++textureImageUnit;
+                }
+                else
+                {
+                    // TODO since this function is currently called before each draw
+                    // this is much to verbose for a warning...
+                    // In the case of samplers thought this is likely an error:
+                    // the sampler being available means it is probably used.
+                    SELOG_LG(gPipelineDiag, error)(
+                        "{}: Could not find a texture for semantic '{}' in program '{}'.", 
+                        __func__,
+                        to_string(shaderUniform.mSemantic),
+                        aProgram.name());
+                }
+            }
+        }
+    }
+
+} // unnamed namespace
+
+
+void setBufferBackedBlocks(const IntrospectProgram & aProgram,
+                           const RepositoryUbo & aUniformBufferObjects)
+{
+    GlStateTracker state;
+    setBufferBackedBlocks(aProgram, aUniformBufferObjects, nullptr, state);
+}
+
+
+void setBufferBackedBlocks(const IntrospectProgram & aProgram,
+                           const RepositoryUbo & aUniformBufferObjects,
+                           const RepositoryUbo * aFallbackUniformBufferObjects,
+                           GlStateTracker & aState)
+{
+    visitBufferBackedBlocks(
+        aProgram, aUniformBufferObjects, aFallbackUniformBufferObjects,
+        [&aState](GLuint aBindingIndex, const BufferRange & aRange)
+        {
+            aState.bindUniformBuffer(aBindingIndex, aRange);
+        },
+        [&aState](GLuint aBindingIndex, const BufferRange & aRange)
+        {
+            aState.bindStorageBuffer(aBindingIndex, aRange);
+        });
+}
+
+
+void setTextures(const IntrospectProgram & aProgram,
+                 const RepositoryTexture & aTextures)
+{
+    GlStateTracker state;
+    setTextures(aProgram, aTextures, nullptr, state);
+    state.restore();
+}
+
+
+void setTextures(const IntrospectProgram & aProgram,
+                 const RepositoryTexture & aTextures,
+                 const RepositoryTexture * aFallbackTextures,
+                 GlStateTracker & aState)
+{
+    visitTextures(
+        aProgram, aTextures, aFallbackTextures,
+        [&aState, &aProgram](const IntrospectProgram::Resource & aSampler,
+                             GLint aTextureImageUnit,
+                             const graphics::Texture & aTexture)
+        {
+            // Textures are not unbound when we exit the current scope.
+            aState.bindTexture(aTextureImageUnit, aTexture.mTarget, aTexture);
+            // Texture image units are assigned to sampler uniforms in order,
+            // so the tracker usually skips this for consecutive draws with the same program.
+            aState.setSamplerUnit(aProgram, aSampler.mLocation, aTextureImageUnit);
+        });
+}
+
+
+void resolveBindings(const IntrospectProgram & aProgram,
+                     const RepositoryUbo & aUniformBufferObjects,
+                     const RepositoryUbo * aFallbackUniformBufferObjects,
+                     const RepositoryTexture & aTextures,
+                     const RepositoryTexture * aFallbackTextures,
+                     ProgramBindings & aBindings)
+{
+    aBindings.clear();
+    aBindings.mProgram = aProgram;
+
+    visitBufferBackedBlocks(
+        aProgram, aUniformBufferObjects, aFallbackUniformBufferObjects,
+        [&aBindings](GLuint aBindingIndex, const BufferRange & aRange)
+        {
+            aBindings.mUniformBuffers.push_back({.mBindingIndex = aBindingIndex, .mRange = aRange});
+        },
+        [&aBindings](GLuint aBindingIndex, const BufferRange & aRange)
+        {
+            aBindings.mStorageBuffers.push_back({.mBindingIndex = aBindingIndex, .mRange = aRange});
+        });
+
+    visitTextures(
+        aProgram, aTextures, aFallbackTextures,
+        [&aBindings](const IntrospectProgram::Resource & aSampler,
+                     GLint aTextureImageUnit,
+                     const graphics::Texture & aTexture)
+        {
+            aBindings.mTextures.push_back({
+                .mTextureUnit = (GLuint)aTextureImageUnit,
+                .mTarget = aTexture.mTarget,
+                .mTexture = aTexture,
+                .mSamplerLocation = aSampler.mLocation,
+            });
+        });
+}
+
+
+void applyBindings(const ProgramBindings & aBindings, GlStateTracker & aState)
+{
+    for(const ProgramBindings::Buffer & buffer : aBindings.mUniformBuffers)
+    {
+        aState.bindUniformBuffer(buffer.mBindingIndex, buffer.mRange);
+    }
+    for(const ProgramBindings::Buffer & buffer : aBindings.mStorageBuffers)
+    {
+        aState.bindStorageBuffer(buffer.mBindingIndex, buffer.mRange);
+    }
+    for(const ProgramBindings::Texture & texture : aBindings.mTextures)
+    {
+        aState.bindTexture(texture.mTextureUnit, texture.mTarget, texture.mTexture);
+        aState.setSamplerUnit(aBindings.mProgram, texture.mSamplerLocation, (GLint)texture.mTextureUnit);
+    }
 }
 
 
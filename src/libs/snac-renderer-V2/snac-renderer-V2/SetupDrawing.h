@@ -5,10 +5,13 @@
 
 #include <renderer/VertexSpecification.h>
 
+#include <vector>
+
 
 namespace ad::renderer {
 
 
+class GlStateTracker;
 struct VertexStream;
 struct InstanceStream;
 struct IntrospectProgram;
@@ -22,9 +25,71 @@ graphics::VertexArrayObject prepareVAO(const IntrospectProgram & aProgram,
 void setBufferBackedBlocks(const IntrospectProgram & aProgram,
                            const RepositoryUbo & aUniformBufferObjects);
 
+/// @brief Bind through `aState`, looking up each block semantic in `aUniformBufferObjects`,
+/// then in `aFallbackUniformBufferObjects` (if not null).
+void setBufferBackedBlocks(const IntrospectProgram & aProgram,
+                           const RepositoryUbo & aUniformBufferObjects,
+                           const RepositoryUbo * aFallbackUniformBufferObjects,
+                           GlStateTracker & aState);
+
 
 void setTextures(const IntrospectProgram & aProgram,
                  const RepositoryTexture & aTextures);
 
+/// @brief Bind through `aState`, looking up each sampler semantic in `aTextures`,
+/// then in `aFallbackTextures` (if not null).
+void setTextures(const IntrospectProgram & aProgram,
+                 const RepositoryTexture & aTextures,
+                 const RepositoryTexture * aFallbackTextures,
+                 GlStateTracker & aState);
+
+
+/// @brief The buffer and texture bindings of a program, resolved from repositories.
+///
+/// Resolving looks up each block and sampler semantic once (with the same rules as setBufferBackedBlocks()
+/// and setTextures()), so successive draws with the same program and repositories only apply the bindings.
+/// @attention Only valid as long as the repositories designate the same buffers and textures.
+/// @note Intended to be kept as scratch storage, resolved again for each program and repositories,
+/// so the vectors keep their capacity.
+struct ProgramBindings
+{
+    struct Buffer
+    {
+        GLuint mBindingIndex;
+        BufferRange mRange;
+    };
+
+    struct Texture
+    {
+        GLuint mTextureUnit;
+        GLenum mTarget;
+        GLuint mTexture;
+        GLint mSamplerLocation;
+    };
+
+    void clear()
+    {
+        mUniformBuffers.clear();
+        mStorageBuffers.clear();
+        mTextures.clear();
+    }
+
+    GLuint mProgram = 0;
+    std::vector<Buffer> mUniformBuffers;
+    std::vector<Buffer> mStorageBuffers;
+    std::vector<Texture> mTextures;
+};
+
+/// @brief Replace the content of `aBindings` with the bindings of `aProgram`, reusing its storage.
+void resolveBindings(const IntrospectProgram & aProgram,
+                     const RepositoryUbo & aUniformBufferObjects,
+                     const RepositoryUbo * aFallbackUniformBufferObjects,
+                     const RepositoryTexture & aTextures,
+                     const RepositoryTexture * aFallbackTextures,
+                     ProgramBindings & aBindings);
+
+/// @brief Bind through `aState`, which skips the bindings already in place.
+void applyBindings(const ProgramBindings & aBindings, GlStateTracker & aState);
+
 
 } // namespace ad::renderer
\ No newline at end of file
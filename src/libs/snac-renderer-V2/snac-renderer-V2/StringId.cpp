@@ -0,0 +1,58 @@
+#include "StringId.h"
+
+#include <mutex>
+#include <unordered_map>
+
+#include <cassert>
+#include <cstdio>
+
+
+namespace ad::renderer {
+
+
+namespace {
+
+    struct InternedStrings
+    {
+        std::mutex mMutex;
+        std::unordered_map<StringId::Value, std::string> mValueToString;
+    };
+
+    InternedStrings & getInternedStrings()
+    {
+        // Function local static, so interning is safe during static initialization of other translation units.
+        static InternedStrings gInterned;
+        return gInterned;
+    }
+
+} // unnamed namespace
+
+
+void StringId::intern(Value aValue, std::string_view aString)
+{
+    InternedStrings & interned = getInternedStrings();
+    std::lock_guard lock{interned.mMutex};
+    [[maybe_unused]] auto [iterator, didInsert] = interned.mValueToString.try_emplace(aValue, aString);
+    assert((didInsert || iterator->second == aString) && "StringId hash collision.");
+}
+
+
+std::string to_string(StringId aId)
+{
+    {
+        InternedStrings & interned = getInternedStrings();
+        std::lock_guard lock{interned.mMutex};
+        if(auto found = interned.mValueToString.find(aId.value());
+           found != interned.mValueToString.end())
+        {
+            return found->second;
+        }
+    }
+
+    char buffer[2 + 16 + 1];
+    std::snprintf(buffer, sizeof(buffer), "0x%016llx", (unsigned long long)aId.value());
+    return buffer;
+}
+
+
+} // namespace ad::renderer
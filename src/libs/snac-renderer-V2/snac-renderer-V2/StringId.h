@@ -0,0 +1,108 @@
+#pragma once
+
+
+#include <compare>
+#include <functional>
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <type_traits>
+
+#include <cstdint>
+
+
+namespace ad::renderer {
+
+
+/// @brief Identifier for a string, comparing and hashing as an integer.
+///
+/// The value is the 64 bits FNV-1a hash of the string, so identifiers of literals
+/// (e.g. the semantics) can be computed at compile time.
+///
+/// The strings of interned identifiers are kept in a global registry, which provides the reverse lookup for to_string().
+/// Intern() interns in all builds, for the names read at load time or by introspection (displayed by the GUIs).
+/// In debug builds, the constructors also intern runtime strings, which detects hash collisions.
+/// In release builds, the constructors do not lock the registry, so keys can be built on the draw path.
+/// to_string() returns the hexadecimal value of identifiers that were not interned.
+class StringId
+{
+public:
+    using Value = std::uint64_t;
+
+    /// @brief The identifier of the empty string.
+    constexpr StringId() = default;
+
+    constexpr StringId(std::string_view aString) :
+        mValue{Hash(aString)}
+    {
+#if !defined(NDEBUG)
+        if(!std::is_constant_evaluated())
+        {
+            intern(mValue, aString);
+        }
+#endif
+    }
+
+    constexpr StringId(const char * aString) :
+        StringId{std::string_view{aString}}
+    {}
+
+    StringId(const std::string & aString) :
+        StringId{std::string_view{aString}}
+    {}
+
+    /// @brief Identify `aString`, and register it for to_string() in all builds.
+    /// @note Locks the registry, so it should not be used on the draw path.
+    static StringId Intern(std::string_view aString)
+    {
+        StringId result;
+        result.mValue = Hash(aString);
+        intern(result.mValue, aString);
+        return result;
+    }
+
+    constexpr Value value() const
+    { return mValue; }
+
+    constexpr auto operator<=>(const StringId &) const = default;
+
+    static constexpr Value Hash(std::string_view aString)
+    {
+        Value hash = gOffsetBasis;
+        for(char character : aString)
+        {
+            hash ^= static_cast<unsigned char>(character);
+            hash *= gPrime;
+        }
+        return hash;
+    }
+
+private:
+    static constexpr Value gOffsetBasis = 0xcbf29ce484222325;
+    static constexpr Value gPrime = 0x100000001b3;
+
+    static void intern(Value aValue, std::string_view aString);
+
+    Value mValue{gOffsetBasis};
+};
+
+
+/// @brief Return the string of the identifier if it was interned, its hexadecimal value otherwise.
+std::string to_string(StringId aId);
+
+
+inline std::ostream & operator<<(std::ostream & aOut, StringId aId)
+{
+    return aOut << to_string(aId);
+}
+
+
+} // namespace ad::renderer
+
+
+template <>
+struct std::hash<ad::renderer::StringId>
+{
+    std::size_t operator()(ad::renderer::StringId aId) const noexcept
+    { return static_cast<std::size_t>(aId.value()); }
+};
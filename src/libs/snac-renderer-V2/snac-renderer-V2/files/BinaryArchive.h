@@ -4,8 +4,11 @@
 #include <math/Box.h>
 #include <math/Matrix.h>
 
+#include <cstring>
 #include <fstream>
 #include <span>
+#include <stdexcept>
+#include <string>
 
 
 //
@@ -168,8 +171,151 @@ struct BinaryInArchive
 };
 
 
-template <class T_value>
-T_value readAs(BinaryInArchive & aIn)
+/// @brief Thrown by MappedInArchive when reading or seeking past the end of its data,
+/// e.g. because the file is truncated or corrupted.
+struct ArchiveOverrun : public std::out_of_range
+{
+    using std::out_of_range::out_of_range;
+};
+
+
+/// @brief Reads from an in-memory image of the file (typically a MappedFile),
+/// with the same interface as BinaryInArchive.
+///
+/// Additionally, raw data blobs can be viewed in place (without copy) through view().
+///
+/// @note Reading or seeking past the end of the data throws ArchiveOverrun.
+struct MappedInArchive
+{
+    template <class T> requires std::is_arithmetic_v<T>
+    MappedInArchive & read(T & aValue)
+    {
+        return readRaw(&aValue, sizeof(T));
+    }
+
+    std::string readString()
+    {
+        unsigned int stringSize;
+        read(stringSize);
+        std::string buffer(stringSize, '\0');
+        readRaw(buffer.data(), stringSize);
+        return buffer;
+    }
+
+    MappedInArchive & read(std::string & aString)
+    {
+        aString = readString();
+        return *this;
+    }
+
+    template <class T>
+    MappedInArchive & read(std::span<T> aData)
+    {
+        return readRaw(aData.data(), aData.size_bytes());
+    }
+
+    template <class T_derived, int N_rows, int N_cols, class T_number>
+    MappedInArchive & read(math::MatrixBase<T_derived, N_rows, N_cols, T_number> & aMatrix)
+    {
+        return read(std::span{aMatrix});
+    }
+
+    template <class T_number>
+    MappedInArchive & read(math::Box<T_number> & aBox)
+    {
+        read(aBox.mPosition);
+        read(aBox.mDimension);
+        return *this;
+    }
+
+    template <int N_dimension, class T_number>
+    MappedInArchive & read(math::Size<N_dimension, T_number> & aSize)
+    {
+        for(std::size_t idx = 0; idx != aSize.Dimension; ++idx)
+        { 
+            read(aSize[idx]);
+        }
+        return *this;
+    }
+
+    template <class T_key, class T_value>
+    MappedInArchive & read(std::unordered_map<T_key, T_value> & aMap)
+    {
+        unsigned int mapSize;
+        read(mapSize);
+        T_key key;
+        T_value value;
+        for(unsigned int i = 0; i != mapSize; ++i)
+        {
+            read(key);
+            read(value);
+            aMap.emplace(key, value);
+        }
+        return *this;
+    }
+
+    /// @brief Return a view on the next `aCount` bytes, advancing past them.
+    std::span<const std::byte> view(std::size_t aCount)
+    {
+        // Written to not overflow on the large counts that can be read from a corrupted file.
+        if(mCursor > mData.size() || aCount > mData.size() - mCursor)
+        {
+            throw ArchiveOverrun{"Reading " + std::to_string(aCount) + " bytes at position "
+                                 + std::to_string(mCursor) + " overruns the archive of "
+                                 + std::to_string(mData.size()) + " bytes."};
+        }
+        std::span<const std::byte> result = mData.subspan(mCursor, aCount);
+        mCursor += aCount;
+        return result;
+    }
+
+    /// @brief Advance to the next multiple of `aAlignment`, relative to the beginning of the data.
+    MappedInArchive & align(std::size_t aAlignment)
+    {
+        mCursor = (mCursor + aAlignment - 1) / aAlignment * aAlignment;
+        return *this;
+    }
+
+    /// @brief Skip the padding preceding a data blob, according to mBlobAlignment.
+    MappedInArchive & alignBlob()
+    {
+        return align(mBlobAlignment);
+    }
+
+    MappedInArchive & seek(std::size_t aPosition)
+    {
+        if(aPosition > mData.size())
+        {
+            throw ArchiveOverrun{"Seeking to position " + std::to_string(aPosition)
+                                 + " overruns the archive of " + std::to_string(mData.size()) + " bytes."};
+        }
+        mCursor = aPosition;
+        return *this;
+    }
+
+    std::size_t getPosition() const
+    {
+        return mCursor;
+    }
+
+    std::span<const std::byte> mData;
+    std::filesystem::path mParentPath;
+    // Alignment of the data blobs in the format being read, set by the client (1 means no padding).
+    std::size_t mBlobAlignment = 1;
+    std::size_t mCursor = 0;
+
+private:
+    MappedInArchive & readRaw(void * aDestination, std::size_t aCount)
+    {
+        std::span<const std::byte> source = view(aCount);
+        std::memcpy(aDestination, source.data(), source.size());
+        return *this;
+    }
+};
+
+
+template <class T_value, class T_archive>
+T_value readAs(T_archive & aIn)
 {
     T_value v;
     aIn.read(v);
@@ -177,8 +323,8 @@ T_value readAs(BinaryInArchive & aIn)
 }
 
 
-template <class T_element>
-std::vector<T_element> readAsVector(BinaryInArchive & aIn,
+template <class T_element, class T_archive>
+std::vector<T_element> readAsVector(T_archive & aIn,
                                     std::size_t aElementCount,
                                     T_element aDefaultValue = {})
 {
@@ -188,9 +334,9 @@ std::vector<T_element> readAsVector(BinaryInArchive & aIn,
 }
 
 
-template <class T_element>
+template <class T_element, class T_archive>
 void assignVector(std::vector<T_element> & aVector,
-                  BinaryInArchive & aIn,
+                  T_archive & aIn,
                   std::size_t aElementCount,
                   T_element aDefaultValue = {})
 {
@@ -198,4 +344,4 @@ void assignVector(std::vector<T_element> & aVector,
 }
 
 
-} // namespace ad::renderer
\ No newline at end of file
+} // namespace ad::renderer
@@ -3,7 +3,9 @@
 #include "BinaryArchive.h" 
 #include "Dds.h" 
 #include "Flags.h" 
+#include "MappedFile.h" 
 #include "Versioning.h" 
+#include "VertexEncoding.h" 
 
 #include "../Constants.h"
 #include "../Cube.h"
@@ -27,6 +29,9 @@
 #include <renderer/utilities/FileLookup.h>
 
 #include <cassert>
+#include <fstream>
+#include <optional>
+#include <sstream>
 
 
 namespace ad::renderer {
@@ -83,19 +88,25 @@ namespace {
     };
 
 
-    // TODO Ad 2023/10/11: #loader Get rid of those hardcoded types when the binary streams are dynamic.
-    constexpr auto gPositionSize = 3 * sizeof(float); // TODO that is crazy coupling
-    constexpr auto gNormalSize = gPositionSize;
-    constexpr auto gTangentSize = gPositionSize;
-    constexpr auto gBitangentSize = gPositionSize;
-    constexpr auto gUvSize = 2 * sizeof(float);
-    constexpr auto gColorSize = 4 * sizeof(float);
+    // TODO Ad 2023/10/11: #loader Get rid of this hardcoded type when the index type is in the binary.
     constexpr auto gIndexSize = sizeof(unsigned int);
-    constexpr auto gJointDataSize = sizeof(VertexJointData);
+
+
+    AttributeDescription describe(Semantic aSemantic, const AttributeEncoding & aEncoding)
+    {
+        return AttributeDescription{
+            .mSemantic = aSemantic,
+            .mDimension = (GLuint)aEncoding.mComponentCount,
+            .mComponentType = aEncoding.mComponentType,
+            .mNormalized = aEncoding.mNormalized != 0,
+        };
+    }
 
     // TODO Do we want attribute interleaving, or are we content with one distinct buffer per attribute ?
     // (the attribute interleaving should then be done on the exporter side).
-    Part loadMesh(BinaryInArchive & aIn, 
+    Part loadMesh(MappedInArchive & aIn, 
+                  unsigned int aVersion,
+                  const VertexEncoding & aEncoding,
                   const VertexStream & aVertexStream,
                   // TODO #inout replace this inout by something more sane
                   GLuint & aVertexFirst,
@@ -110,8 +121,9 @@ namespace {
                    std::size_t aElementCount)
             {
                 std::size_t bufferSize = aElementCount * aElementSize;
-                std::unique_ptr<char[]> cpuBuffer = aIn.readBytes(bufferSize);
-                loadBuffer(aBuffer, aElementFirst * aElementSize, std::span{cpuBuffer.get(), bufferSize});
+                aIn.alignBlob();
+                // Sourced directly from the mapped file, without intermediate copy.
+                loadBuffer(aBuffer, aElementFirst * aElementSize, aIn.view(bufferSize));
             };
 
         // TODO #loader Those hardcoded indices are smelly, hard-coupled to the attribute streams structure in the binary.
@@ -138,22 +150,22 @@ namespace {
         aIn.read(verticesCount);
         
         // load positions
-        loadBufferFromArchive(positionBuffer, aVertexFirst, gPositionSize, verticesCount);
+        loadBufferFromArchive(positionBuffer, aVertexFirst, aEncoding.mPosition.getByteSize(), verticesCount);
         // load normals
-        loadBufferFromArchive(normalBuffer, aVertexFirst, gNormalSize, verticesCount);
+        loadBufferFromArchive(normalBuffer, aVertexFirst, aEncoding.mNormal.getByteSize(), verticesCount);
         // load tangents & bitangents, if present
         // #assetprocessor This assert should go away if we start supporting dynamic list of attributes
         assert(has(vertexAttributesFlags, gVertexTangent));
         // Has to be true atm
         if(has(vertexAttributesFlags, gVertexTangent)) 
         {
-            loadBufferFromArchive(tangentBuffer, aVertexFirst, gTangentSize, verticesCount);
+            loadBufferFromArchive(tangentBuffer, aVertexFirst, aEncoding.mTangent.getByteSize(), verticesCount);
         }
         assert(has(vertexAttributesFlags, gVertexBitangent));
         // Has to be true atm
         if(has(vertexAttributesFlags, gVertexBitangent)) 
         {
-            loadBufferFromArchive(bitangentBuffer, aVertexFirst, gBitangentSize, verticesCount);
+            loadBufferFromArchive(bitangentBuffer, aVertexFirst, aEncoding.mBitangent.getByteSize(), verticesCount);
         }
 
         unsigned int colorChannelsCount;
@@ -161,7 +173,7 @@ namespace {
         assert(colorChannelsCount <= 1);
         for(unsigned int colorIdx = 0; colorIdx != colorChannelsCount; ++colorIdx)
         {
-            loadBufferFromArchive(colorBuffer, aVertexFirst, gColorSize, verticesCount);
+            loadBufferFromArchive(colorBuffer, aVertexFirst, aEncoding.mColor.getByteSize(), verticesCount);
         }
 
         unsigned int uvChannelsCount;
@@ -173,7 +185,7 @@ namespace {
 
         for(unsigned int uvIdx = 0; uvIdx != uvChannelsCount; ++uvIdx)
         {
-            loadBufferFromArchive(uvBuffer, aVertexFirst, gUvSize, verticesCount);
+            loadBufferFromArchive(uvBuffer, aVertexFirst, aEncoding.mUv.getByteSize(), verticesCount);
         }
 
         unsigned int primitiveCount;
@@ -181,13 +193,34 @@ namespace {
         const unsigned int indicesCount = 3 * primitiveCount;
         loadBufferFromArchive(indexBuffer, aIndexFirst, gIndexSize, indicesCount);
 
+        // The levels of detail indices follow the part indices in the index buffer.
+        std::vector<PartLod> lods;
+        GLuint lodIndexFirst = aIndexFirst + indicesCount;
+        if(aVersion >= 7)
+        {
+            unsigned int lodsCount;
+            aIn.read(lodsCount);
+            lods.reserve(lodsCount);
+            for(unsigned int lodIdx = 0; lodIdx != lodsCount; ++lodIdx)
+            {
+                PartLod & lod = lods.emplace_back();
+                aIn.read(lod.mError);
+                unsigned int lodPrimitiveCount;
+                aIn.read(lodPrimitiveCount);
+                lod.mIndexFirst = lodIndexFirst;
+                lod.mIndicesCount = 3 * lodPrimitiveCount;
+                loadBufferFromArchive(indexBuffer, lod.mIndexFirst, gIndexSize, lod.mIndicesCount);
+                lodIndexFirst += lod.mIndicesCount;
+            }
+        }
+
         {
             unsigned int bonesCount;
             aIn.read(bonesCount);
 
             if(bonesCount != 0)
             {
-                loadBufferFromArchive(jointDataBuffer, aVertexFirst, gJointDataSize, verticesCount);
+                loadBufferFromArchive(jointDataBuffer, aVertexFirst, aEncoding.getJointDataStride(), verticesCount);
             }
         }
 
@@ -206,12 +239,13 @@ namespace {
             .mVertexCount = verticesCount,
             .mIndexFirst = aIndexFirst,
             .mIndicesCount = indicesCount,
+            .mLods = std::move(lods),
         };
 
         aIn.read(part.mAabb);
 
         aVertexFirst += verticesCount;
-        aIndexFirst += indicesCount;
+        aIndexFirst = lodIndexFirst;
         return part;
     }
 
@@ -223,7 +257,9 @@ namespace {
     }
 
 
-    Node loadNode(BinaryInArchive & aIn,
+    Node loadNode(MappedInArchive & aIn,
+                  unsigned int aVersion,
+                  const VertexEncoding & aEncoding,
                   Storage & aStorage,
                   const Material & aBaseMaterial, // Common values are set, not the specific phong material index (it is set by each part)
                   const VertexStream & aVertexStream,
@@ -244,10 +280,16 @@ namespace {
         {
             Handle<Object> result = (meshesCount > 0) ? addObject(aStorage) : gNullHandle;
 
+            if(meshesCount > 0 && aEncoding.hasQuantizedPositions())
+            {
+                aIn.read(result->mPositionDequantization.mOffset);
+                aIn.read(result->mPositionDequantization.mScale);
+            }
+
             for(std::size_t meshIdx = 0; meshIdx != meshesCount; ++meshIdx)
             {
                 result->mParts.push_back(
-                    loadMesh(aIn, aVertexStream, aVertexFirst, aIndexFirst, aBaseMaterial)
+                    loadMesh(aIn, aVersion, aEncoding, aVertexStream, aVertexFirst, aIndexFirst, aBaseMaterial)
                 );
             }
 
@@ -300,6 +342,8 @@ namespace {
             // Name
             rig.mArmatureName = aIn.readString();
 
+            rig.mDefaultPalette = rig.computeJointMatrices(rig.mJointTree);
+
             aStorage.mAnimatedRigs.push_back({.mRig = std::move(rig)});
             object->mAnimatedRig = &aStorage.mAnimatedRigs.back();
         }
@@ -314,7 +358,7 @@ namespace {
 
         for(std::size_t childIdx = 0; childIdx != childrenCount; ++childIdx)
         {
-            node.mChildren.push_back(loadNode(aIn, aStorage, aBaseMaterial, aVertexStream, aVertexFirst, aIndexFirst));
+            node.mChildren.push_back(loadNode(aIn, aVersion, aEncoding, aStorage, aBaseMaterial, aVertexStream, aVertexFirst, aIndexFirst));
         }
 
         aIn.read(node.mAabb);
@@ -323,7 +367,17 @@ namespace {
     }
 
 
-    std::vector<RigAnimation> loadAnimations(BinaryInArchive & aIn)
+    template <class T_element>
+    std::vector<T_element> readBlobAsVector(MappedInArchive & aIn,
+                                            std::size_t aElementCount,
+                                            T_element aDefaultValue = {})
+    {
+        aIn.alignBlob();
+        return readAsVector<T_element>(aIn, aElementCount, aDefaultValue);
+    }
+
+
+    std::vector<RigAnimation> loadAnimations(MappedInArchive & aIn)
     {
         auto animationsCount = readAs<unsigned int>(aIn);
 
@@ -338,18 +392,18 @@ namespace {
             });
 
             auto keyframesCount = readAs<unsigned int>(aIn);
-            rigAnimation.mTimepoints = readAsVector<float>(aIn, keyframesCount);
+            rigAnimation.mTimepoints = readBlobAsVector<float>(aIn, keyframesCount);
 
             auto nodesCount = readAs<unsigned int>(aIn);
-            rigAnimation.mNodes = readAsVector<NodeTree<Rig::Pose>::Node::Index>(aIn, nodesCount);
+            rigAnimation.mNodes = readBlobAsVector<NodeTree<Rig::Pose>::Node::Index>(aIn, nodesCount);
 
             for(unsigned int nodeIdx = 0; nodeIdx != nodesCount; ++nodeIdx)
             {
                 rigAnimation.mKeyframes.emplace_back(RigAnimation::NodeKeyframes{
-                    .mTranslations = readAsVector<math::Vec<3, float>>(aIn, keyframesCount),
-                    .mRotations = readAsVector<math::Quaternion<float>>(
+                    .mTranslations = readBlobAsVector<math::Vec<3, float>>(aIn, keyframesCount),
+                    .mRotations = readBlobAsVector<math::Quaternion<float>>(
                         aIn, keyframesCount, math::Quaternion<float>::Identity()),
-                    .mScales = readAsVector<math::Vec<3, float>>(aIn, keyframesCount),
+                    .mScales = readBlobAsVector<math::Vec<3, float>>(aIn, keyframesCount),
                 });
             }
         }
@@ -366,6 +420,19 @@ namespace {
     };
 
 
+    /// @brief Load the image, converting it to linear color space.
+    arte::Image<math::sdr::Rgba> decodeImage(const std::filesystem::path & aImagePath, ColorSpace aColorSpace)
+    {
+        // Image files are expected to have the usual top-left origin
+        arte::Image<math::sdr::Rgba> image{aImagePath, arte::ImageOrientation::InvertVerticalAxis};
+        if(aColorSpace == ColorSpace::sRGB)
+        {
+            decodeSRGBToLinear(image);
+        }
+        return image;
+    }
+
+
     // TODO replace this smelly approach to DDS handling
     // The complication is that, at first, we want optional support for compressed texture
     // basically, picking a .dds variant if it present, using the original image in the material otherwise.
@@ -375,7 +442,8 @@ namespace {
         struct MyDds
         {
             dds::Header mHeader;
-            std::ifstream mDataStream;
+            // Either the file, or its content already read in memory.
+            std::unique_ptr<std::istream> mDataStream;
         };
 
 
@@ -385,30 +453,72 @@ namespace {
         }
 
 
+        MyDds readMyDds(std::unique_ptr<std::istream> aDdsStream)
+        {
+            dds::Header header = dds::readHeader(*aDdsStream);
+            return MyDds{
+                .mHeader = std::move(header),
+                .mDataStream = std::move(aDdsStream),
+            };
+        }
+
+
         MyDds loadMyDds(std::filesystem::path aDds)
         {
             SELOG(debug)("Loading the DDS texture: {}", aDds.string());
 
-            std::ifstream ddsStream{aDds, std::ios_base::in | std::ios_base::binary};
-            if(!ddsStream.good())
+            auto ddsStream = std::make_unique<std::ifstream>(aDds, std::ios_base::in | std::ios_base::binary);
+            if(!ddsStream->good())
             {
                 throw std::runtime_error{"Unable to open DDS file: '" + aDds.string() + "'."};
             }
 
-            dds::Header header = dds::readHeader(ddsStream);
-            return MyDds{
-                .mHeader = std::move(header),
-                .mDataStream = std::move(ddsStream),
-            };
+            return readMyDds(std::move(ddsStream));
         }
 
 
-        /// @brief Construct a MyDds instance if `aDdsCandidate` file exists.
-        std::optional<MyDds> tryDds(std::filesystem::path aDdsCandidate)
+        /// @brief Construct a MyDds instance if `aTexturePath` has a DDS candidate,
+        /// either already read in `aPrepared` or as a file.
+        std::optional<MyDds> tryDds(std::filesystem::path aTexturePath, PreparedBinary::Textures * aPrepared)
         {
-            if(is_regular_file(aDdsCandidate))
+            if(aPrepared)
+            {
+                if(auto found = aPrepared->find(aTexturePath);
+                   found != aPrepared->end() && !found->second.mDds.empty())
+                {
+                    // Each prepared texture is uploaded once, its content can be moved out.
+                    return readMyDds(std::make_unique<std::istringstream>(std::move(found->second.mDds),
+                                                                          std::ios_base::in | std::ios_base::binary));
+                }
+            }
+
+            if(auto ddsCandidate = getDdsCandidate(aTexturePath); is_regular_file(ddsCandidate))
             {
-                return loadMyDds(aDdsCandidate);
+                return loadMyDds(ddsCandidate);
+            }
+            return std::nullopt;
+        }
+
+
+        /// @brief Return the compressed format of the DDS candidate of `aTexturePath`, if there is one.
+        /// Contrary to tryDds(), it leaves the prepared textures untouched.
+        std::optional<GLenum> tryDdsFormat(std::filesystem::path aTexturePath, const PreparedBinary::Textures * aPrepared)
+        {
+            if(aPrepared)
+            {
+                if(auto found = aPrepared->find(aTexturePath);
+                   found != aPrepared->end() && !found->second.mDds.empty())
+                {
+                    // The header is at most 128 + 20 bytes (with the DX10 extension).
+                    std::istringstream header{found->second.mDds.substr(0, 128 + 20),
+                                              std::ios_base::in | std::ios_base::binary};
+                    return dds::getCompressedFormat(dds::readHeader(header));
+                }
+            }
+
+            if(auto dds = tryDds(aTexturePath, nullptr))
+            {
+                return dds::getCompressedFormat(dds->mHeader);
             }
             return std::nullopt;
         }
@@ -558,7 +668,8 @@ namespace {
                           GLint aLayerIdx,
                           std::filesystem::path aTexturePath,
                           math::Size<2, int> aExpectedDimensions,
-                          ColorSpace aSourceColorSpace)
+                          ColorSpace aSourceColorSpace,
+                          PreparedBinary::Textures * aPrepared)
     {
         // If the layered texutre internal format is uncompressed SDR RGBA, load the uncompressed image and transfer it
         if(!useCompressedTextures(aTextureInternalFormat))
@@ -569,15 +680,17 @@ namespace {
             // (it would likely mean that we forgot to compress some)
             assert(!std::filesystem::exists(hackish::getDdsCandidate(aTexturePath)));
 
-            // Image files are expected to have the usual top-left origin
-            arte::Image<math::sdr::Rgba> image{aTexturePath, arte::ImageOrientation::InvertVerticalAxis};
-
-            assert(aExpectedDimensions == image.dimensions());
-
-            if(aSourceColorSpace == ColorSpace::sRGB)
+            std::optional<arte::Image<math::sdr::Rgba>> prepared;
+            if(aPrepared)
             {
-                decodeSRGBToLinear(image);
+                if(auto found = aPrepared->find(aTexturePath); found != aPrepared->end())
+                {
+                    prepared = std::move(found->second.mImage);
+                }
             }
+            arte::Image<math::sdr::Rgba> image = prepared ? std::move(*prepared) : decodeImage(aTexturePath, aSourceColorSpace);
+
+            assert(aExpectedDimensions == image.dimensions());
 
             proto::writeTo(a3dTexture,
                            static_cast<const std::byte *>(image),
@@ -587,8 +700,7 @@ namespace {
         // Handle compressed texture data
         else
         {
-            auto ddsCandidate = hackish::getDdsCandidate(aTexturePath);
-            if(auto dds = hackish::tryDds(ddsCandidate))
+            if(auto dds = hackish::tryDds(aTexturePath, aPrepared))
             {
                 GLenum ddsFormat = dds::getCompressedFormat(dds->mHeader);
                 // In addition to better memory usage, we do that to speed-up loading:
@@ -596,7 +708,7 @@ namespace {
                 if(ddsFormat != aTextureInternalFormat)
                 {
                     SELOG(critical)("Texture internal format {} does not match DDS file '{}' internal format {}.",
-                                    aTextureInternalFormat, ddsCandidate.string(), ddsFormat);
+                                    aTextureInternalFormat, hackish::getDdsCandidate(aTexturePath).string(), ddsFormat);
                     throw std::invalid_argument{"The texture internal format does not match the DDS file content."};
                 }
 
@@ -613,7 +725,7 @@ namespace {
                 // (128 + 20 see last example in: https://learn.microsoft.com/en-us/windows/win32/direct3ddds/dds-file-layout-for-textures)
                 // Yet, the standard does not guarantee that tellg() returns a byte offset
                 // (Unices do, and Windows do for files opened in binary mode)
-                assert(dds->mDataStream.tellg() == 128 + 20);
+                assert(dds->mDataStream->tellg() == 128 + 20);
 
                 const CompressedBlockInfo blockInfo = getBlockInfo(a3dTexture.mTarget, ddsFormat);
                 loadDdsData(a3dTexture,
@@ -621,7 +733,7 @@ namespace {
                             mainImageDimensions,
                             blockInfo,
                             dds->mHeader,
-                            dds->mDataStream,
+                            *dds->mDataStream,
                             aLayerIdx);
             }
             else
@@ -633,19 +745,27 @@ namespace {
     }
 
 
+    // IMPORTANT: This sequence is in the exact order of texture types in a binary.
+    const std::pair<Semantic, ColorSpace> gTextureSequence[] = {
+        {semantic::gDiffuseTexture, ColorSpace::sRGB},
+        {semantic::gNormalTexture, ColorSpace::Linear}, 
+        {semantic::gMetallicRoughnessAoTexture, ColorSpace::Linear},
+    };
+
+
     // TODO Ad 2023/08/01: 
     // Review how the effects (the programs) are provided to the parts (currently hardcoded)
-    MaterialContext loadMaterials(BinaryInArchive & aIn, Storage & aStorage)
+    MaterialContext loadMaterials(MappedInArchive & aIn, Storage & aStorage, PreparedBinary::Textures * aPrepared)
     {
         unsigned int materialsCount;
         aIn.read(materialsCount);
 
-        graphics::UniformBufferObject & ubo = aStorage.mUbos.emplace_back();
+        graphics::BufferAny & materialsSsbo = aStorage.mBuffers.emplace_back();
         {
             std::vector<GenericMaterial> materials{materialsCount};
             aIn.read(std::span{materials});
 
-            graphics::load(ubo, std::span{materials}, graphics::BufferHint::StaticDraw);
+            proto::load(materialsSsbo, std::span{materials}, graphics::BufferHint::StaticDraw);
         }
 
         { // load material names
@@ -671,7 +791,7 @@ namespace {
         };
 
 
-        auto loadTextures = [&aIn, &aStorage](ColorSpace aColorSpace) -> Handle<graphics::Texture>
+        auto loadTextures = [&aIn, &aStorage, aPrepared](ColorSpace aColorSpace) -> Handle<graphics::Texture>
         {
             math::Size<2, int> imageSize;        
             aIn.read(imageSize);
@@ -691,9 +811,9 @@ namespace {
                 // Unfortunately, our hackish approach requires to retrieve the first path to see if .dds candidates are
                 // expected or not.
                 std::string path = aIn.readString();
-                if(auto dds = hackish::tryDds(hackish::getDdsCandidate(aIn.mParentPath / path)))
+                if(auto ddsFormat = hackish::tryDdsFormat(aIn.mParentPath / path, aPrepared))
                 {
-                    internalFormat = dds::getCompressedFormat(dds->mHeader);
+                    internalFormat = *ddsFormat;
                 }
                 else
                 {
@@ -718,11 +838,11 @@ namespace {
                 }
 
                 // We had to retrieve the first path to try the DDS candidate, so we have to handle it out of the loop
-                loadTextureLayer(textureArray, internalFormat, 0, aIn.mParentPath / path, imageSize, aColorSpace);
+                loadTextureLayer(textureArray, internalFormat, 0, aIn.mParentPath / path, imageSize, aColorSpace, aPrepared);
                 for(unsigned int pathIdx = 1; pathIdx != pathsCount; ++pathIdx)
                 {
                     std::string path = aIn.readString();
-                    loadTextureLayer(textureArray, internalFormat, pathIdx, aIn.mParentPath / path, imageSize, aColorSpace);
+                    loadTextureLayer(textureArray, internalFormat, pathIdx, aIn.mParentPath / path, imageSize, aColorSpace, aPrepared);
                 }
 
                 // When a compressed texture container was not used, mipmaps should be generated
@@ -739,14 +859,8 @@ namespace {
             }
         };
 
-        // IMPORTANT: This sequence is in the exact order of texture types in a binary.
-        static const std::pair<Semantic, ColorSpace> semanticSequence[] = {
-            {semantic::gDiffuseTexture, ColorSpace::sRGB},
-            {semantic::gNormalTexture, ColorSpace::Linear}, 
-            {semantic::gMetallicRoughnessAoTexture, ColorSpace::Linear},
-        };
         RepositoryTexture textureRepo;
-        for (auto [texSemantic, colorSpace] : semanticSequence)
+        for (auto [texSemantic, colorSpace] : gTextureSequence)
         {
             if(Handle<graphics::Texture> texture = loadTextures(colorSpace))
             {
@@ -757,12 +871,146 @@ namespace {
         }
 
         return MaterialContext{
-            .mUboRepo = {{semantic::gMaterials, &ubo}},
+            .mUboRepo = {{semantic::gMaterials, &materialsSsbo}},
             .mTextureRepo = std::move(textureRepo),
         };
     }
 
 
+    /// @brief Read the texture images listed by the materials section, `aIn` being at the start of the section.
+    ///
+    /// Mirrors loadMaterials(), which decides from the first texture of each array if the array is compressed.
+    PreparedBinary::Textures prepareTextures(MappedInArchive & aIn)
+    {
+        PreparedBinary::Textures textures;
+
+        unsigned int materialsCount;
+        aIn.read(materialsCount);
+        {
+            std::vector<GenericMaterial> materials{materialsCount};
+            aIn.read(std::span{materials});
+        }
+
+        unsigned int namesCount;
+        aIn.read(namesCount);
+        for(unsigned int nameIdx = 0; nameIdx != namesCount; ++nameIdx)
+        {
+            aIn.readString();
+        }
+
+        for (auto [_texSemantic, colorSpace] : gTextureSequence)
+        {
+            math::Size<2, int> imageSize;
+            aIn.read(imageSize);
+
+            unsigned int pathsCount;
+            aIn.read(pathsCount);
+
+            std::optional<bool> compressed;
+            for(unsigned int pathIdx = 0; pathIdx != pathsCount; ++pathIdx)
+            {
+                const std::filesystem::path path = aIn.mParentPath / aIn.readString();
+                const std::filesystem::path ddsCandidate = hackish::getDdsCandidate(path);
+                if(!compressed)
+                {
+                    compressed = is_regular_file(ddsCandidate);
+                }
+
+                PreparedBinary::Texture & texture = textures[path];
+                if(*compressed)
+                {
+                    // A missing DDS file is reported by the upload.
+                    if(std::ifstream dds{ddsCandidate, std::ios_base::in | std::ios_base::binary})
+                    {
+                        std::ostringstream content;
+                        content << dds.rdbuf();
+                        texture.mDds = std::move(content).str();
+                    }
+                }
+                else
+                {
+                    texture.mImage = decodeImage(path, colorSpace);
+                }
+            }
+        }
+
+        return textures;
+    }
+
+
+    /// @brief Read one byte per page, so the pages of the mapping are loaded by the calling thread.
+    void prefault(std::span<const std::byte> aBytes)
+    {
+        constexpr std::size_t gPageSize = 4096;
+        unsigned char accumulator = 0;
+        for(std::size_t offset = 0; offset < aBytes.size(); offset += gPageSize)
+        {
+            accumulator ^= static_cast<unsigned char>(aBytes[offset]);
+        }
+        // Prevents the reads from being optimized away.
+        volatile unsigned char sink = accumulator;
+        (void)sink;
+    }
+
+
+    struct SeumHeader
+    {
+        unsigned int mVersion;
+        // Version 4 sections are contiguous, without table of contents nor blob alignment.
+        std::optional<SeumTableOfContents> mTableOfContents;
+    };
+
+
+    /// @brief Read the preamble of a binary, leaving `aIn` at the start of the first section.
+    std::variant<SeumHeader, SeumErrorCode> readSeumHeader(MappedInArchive & aIn)
+    {
+        // TODO we need a unified design where the load code does not duplicate the type of the write.
+        std::uint16_t magicValue{0};
+        aIn.read(magicValue);
+        if(magicValue != gSeumMagic)
+        {
+            SELOG(error)("The seum magic preamble is not matching.");
+            return SeumErrorCode::InvalidMagicPreamble;
+        }
+
+        SeumHeader header;
+        aIn.read(header.mVersion);
+        if(header.mVersion > gSeumVersion)
+        {
+            SELOG(error)("The provided binary has version {}, but the most recent version of the format known to this build is {}.",
+                         header.mVersion, gSeumVersion);
+            return SeumErrorCode::UnknownVersion;
+        }
+        else if(header.mVersion < gSeumOldestSupportedVersion)
+        {
+            SELOG(warn)("The provided binary has version {}, but oldest supported version of the format is {}.", 
+                        header.mVersion, gSeumOldestSupportedVersion);
+            return SeumErrorCode::OutdatedVersion;
+        }
+
+        if(header.mVersion >= 5)
+        {
+            aIn.read(std::span{&header.mTableOfContents.emplace(), 1});
+            aIn.mBlobAlignment = gSeumBlobAlignment;
+
+            const std::uint64_t dataSize = aIn.mData.size();
+            for(const SeumSection & section : {header.mTableOfContents->mNodes,
+                                               header.mTableOfContents->mAnimations,
+                                               header.mTableOfContents->mMaterials})
+            {
+                if(section.mOffset > dataSize || section.mSize > dataSize - section.mOffset)
+                {
+                    SELOG(error)("A section of the table of contents, at offset {} with size {}, extends past the end of the {} bytes binary.",
+                                 section.mOffset, section.mSize, dataSize);
+                    return SeumErrorCode::TruncatedData;
+                }
+            }
+        }
+
+        return header;
+    }
+
+
 } // unnamed namespace
 
 
@@ -802,7 +1050,7 @@ graphics::Texture loadDds(std::filesystem::path aDds)
                         imageSize,
                         blockInfo,
                         dds.mHeader,
-                        dds.mDataStream);
+                        *dds.mDataStream);
         }
     }
     else
@@ -813,7 +1061,7 @@ graphics::Texture loadDds(std::filesystem::path aDds)
                     imageSize,
                     blockInfo,
                     dds.mHeader,
-                    dds.mDataStream);
+                    *dds.mDataStream);
     }
 
     return texture;
@@ -1049,22 +1297,8 @@ ModelWithFeatures getModelAndFeatures(std::filesystem::path aJsonFile)
 }
 
 
-// TODO should not take a default effect, but have a way to get the actual effect to use 
-// (maybe directly from the binary file)
-std::variant<Node, SeumErrorCode> loadBinary(const std::filesystem::path & aBinaryFile,
-                                             Storage & aStorage,
-                                             Effect * aPartsEffect,
-                                             const GenericStream & aStream)
+std::variant<PreparedBinary, SeumErrorCode> prepareBinary(const std::filesystem::path & aBinaryFile)
 {
-    // A quick hack to get around the limitation that the profiler system expects the client to maintain
-    // the c-string alive.
-    // Very thread unsafe
-    static std::vector<std::string> gUnsafeSectionNames;
-    gUnsafeSectionNames.push_back(fmt::format("load_binary: {}", aBinaryFile.stem().string()));
-
-    PROFILER_SCOPE_SINGLESHOT_SECTION(gRenderProfiler, gUnsafeSectionNames.back().c_str(),
-                                      renderer::CpuTime, renderer::GpuTime);
-
     if(aBinaryFile.extension() != ".seum")
     {
         SELOG(error)("Files with extension '{}' are not supported.",
@@ -1072,161 +1306,223 @@ std::variant<Node, SeumErrorCode> loadBinary(const std::filesystem::path & aBina
         return SeumErrorCode::UnsupportedFormat;
     }
 
-    BinaryInArchive in{
-        .mIn{std::ifstream{aBinaryFile, std::ios::binary}},
+    PreparedBinary prepared{
+        .mPath = aBinaryFile,
+        .mMapped = MappedFile{aBinaryFile},
+    };
+    if(!prepared.mMapped)
+    {
+        return SeumErrorCode::UnsupportedFormat;
+    }
+
+    // Load the pages now, instead of when the GL uploads source the vertex data from the mapping.
+    prefault(prepared.mMapped.bytes());
+
+    MappedInArchive in{
+        .mData = prepared.mMapped.bytes(),
         .mParentPath{aBinaryFile.parent_path()},
     };
 
-    // TODO we need a unified design where the load code does not duplicate the type of the write.
-    std::uint16_t magicValue{0};
-    in.read(magicValue);
-    if(magicValue != gSeumMagic)
+    try
     {
-        SELOG(error)("The seum magic preamble is not matching.");
-        return SeumErrorCode::InvalidMagicPreamble;
+        std::variant<SeumHeader, SeumErrorCode> header = readSeumHeader(in);
+        if(const SeumErrorCode * errorCode = std::get_if<SeumErrorCode>(&header))
+        {
+            return *errorCode;
+        }
+
+        // Without a table of contents, the materials section can only be reached by reading the whole binary:
+        // the textures will be read by the upload.
+        if(const auto & tableOfContents = std::get<SeumHeader>(header).mTableOfContents)
+        {
+            in.seek(tableOfContents->mMaterials.mOffset);
+            prepared.mTextures = prepareTextures(in);
+        }
+
+        return prepared;
     }
+    catch(const ArchiveOverrun & aException)
+    {
+        SELOG(error)("Preparing binary '{}' failed, the data is truncated: {}",
+                     aBinaryFile.string(), aException.what());
+        return SeumErrorCode::TruncatedData;
+    }
+}
+
 
-    unsigned int version;
-    in.read(version);
-    assert(version <= gSeumVersion);
-    if(version != gSeumVersion)
+std::variant<Node, SeumErrorCode> loadBinary(const std::filesystem::path & aBinaryFile,
+                                             Storage & aStorage,
+                                             Effect * aPartsEffect,
+                                             const GenericStream & aStream)
+{
+    std::variant<PreparedBinary, SeumErrorCode> prepared = prepareBinary(aBinaryFile);
+    if(const SeumErrorCode * errorCode = std::get_if<SeumErrorCode>(&prepared))
     {
-        SELOG(warn)("The provided binary has version {}, but current version of the format is {}.", 
-                    version, gSeumVersion);
-        return SeumErrorCode::OutdatedVersion;
+        return *errorCode;
     }
+    return loadBinary(std::get<PreparedBinary>(std::move(prepared)), aStorage, aPartsEffect, aStream);
+}
 
-    unsigned int verticesCount = 0;
-    unsigned int indicesCount = 0;
-    in.read(verticesCount);
-    in.read(indicesCount);
 
+// TODO should not take a default effect, but have a way to get the actual effect to use 
+// (maybe directly from the binary file)
+std::variant<Node, SeumErrorCode> loadBinary(PreparedBinary aBinary,
+                                             Storage & aStorage,
+                                             Effect * aPartsEffect,
+                                             const GenericStream & aStream)
+{
+    // A quick hack to get around the limitation that the profiler system expects the client to maintain
+    // the c-string alive.
+    // Very thread unsafe
+    static std::vector<std::string> gUnsafeSectionNames;
+    gUnsafeSectionNames.push_back(fmt::format("load_binary: {}", aBinary.mPath.stem().string()));
 
-    // Binary attributes descriptions
-    // TODO Ad 2023/10/11: #loader Support dynamic set of attributes in the binary
-    static const std::array<AttributeDescription, 6> gAttributeStreamsInBinary {
-        AttributeDescription{
-            .mSemantic = semantic::gPosition,
-            .mDimension = 3,
-            .mComponentType = GL_FLOAT,
-        },
-        AttributeDescription{
-            .mSemantic = semantic::gNormal,
-            .mDimension = 3,
-            .mComponentType = GL_FLOAT,
-        },
-        AttributeDescription{
-            .mSemantic = semantic::gTangent,
-            .mDimension = 3,
-            .mComponentType = GL_FLOAT,
-        },
-        AttributeDescription{
-            .mSemantic = semantic::gBitangent,
-            .mDimension = 3,
-            .mComponentType = GL_FLOAT,
-        },
-        AttributeDescription{
-            .mSemantic = semantic::gColor,
-            .mDimension = 4,
-            .mComponentType = GL_FLOAT,
-        },
-        AttributeDescription{
-            .mSemantic = semantic::gUv,
-            .mDimension = 2,
-            .mComponentType = GL_FLOAT,
-        },
+    PROFILER_SCOPE_SINGLESHOT_SECTION(gRenderProfiler, gUnsafeSectionNames.back().c_str(),
+                                      renderer::CpuTime, renderer::GpuTime);
+
+    // The mapping must outlive the GL uploads, which source the vertex data directly from it.
+    MappedInArchive in{
+        .mData = aBinary.mMapped.bytes(),
+        .mParentPath{aBinary.mPath.parent_path()},
     };
 
-    static const std::array<std::pair<AttributeDescription, std::size_t>, 2> gInterleavedJointAttributes {{
+    try
+    {
+        std::variant<SeumHeader, SeumErrorCode> header = readSeumHeader(in);
+        if(const SeumErrorCode * errorCode = std::get_if<SeumErrorCode>(&header))
         {
-            AttributeDescription{
-                .mSemantic = semantic::gJoints0,
-                .mDimension = VertexJointData::gMaxBones,
-                .mComponentType = GL_UNSIGNED_INT,
-            },
-            offsetof(VertexJointData, mBoneIndices),
-        },
+            return *errorCode;
+        }
+        const unsigned int version = std::get<SeumHeader>(header).mVersion;
+        const std::optional<SeumTableOfContents> tableOfContents = std::get<SeumHeader>(header).mTableOfContents;
+
+        // Position the archive at the beginning of the section, when there is a table of contents.
+        // (readSeumHeader() ensured the sections are within the data.)
+        auto enterSection = [&in, &tableOfContents](SeumSection SeumTableOfContents::* aSection)
         {
-            AttributeDescription{
-                .mSemantic = semantic::gWeights0,
-                .mDimension = VertexJointData::gMaxBones,
-                .mComponentType = GL_FLOAT,
-            },
-            offsetof(VertexJointData, mBoneWeights),
+            if(tableOfContents)
+            {
+                in.seek(((*tableOfContents).*aSection).mOffset);
+            }
+        };
+
+        enterSection(&SeumTableOfContents::mNodes);
+        unsigned int verticesCount = 0;
+        unsigned int indicesCount = 0;
+        in.read(verticesCount);
+        in.read(indicesCount);
+
+        // Up to version 5, all vertex attributes were stored as 32 bits components.
+        VertexEncoding vertexEncoding = gFloatVertexEncoding;
+        if(version >= 6)
+        {
+            in.read(std::span{&vertexEncoding, 1});
         }
-    }};
 
-    // Prepare the single buffer storage for the whole binary
-    VertexStream * consolidatedStream = makeVertexStream(
-        verticesCount,
-        indicesCount,
-        GL_UNSIGNED_INT,
-        gAttributeStreamsInBinary,
-        aStorage,
-        aStream);
-
-    // Add the interleaved joint attributes to the vertex stream
-    Handle<graphics::BufferAny> vertexJointDataBuffer = makeBuffer(
-        sizeof(VertexJointData),
-        verticesCount,
-        GL_STATIC_DRAW,
-        aStorage);
-    addInterleavedAttributes(
-        consolidatedStream,
-        sizeof(VertexJointData),
-        gInterleavedJointAttributes,
-        vertexJointDataBuffer,
-        verticesCount);
-
-    // Prepare a MaterialContext for the whole binary, 
-    // I.e. in a scene, each entry (each distinct binary) gets its own material UBO and its own Texture array.
-    // TODO #azdo #perf we could load textures and materials in a single buffer for a whole scene to further consolidate
-    MaterialContext & commonMaterialContext = aStorage.mMaterialContexts.emplace_back();
+        // Binary attributes descriptions
+        // TODO Ad 2023/10/11: #loader Support dynamic set of attributes in the binary
+        const std::array<AttributeDescription, 6> attributeStreamsInBinary {
+            describe(semantic::gPosition, vertexEncoding.mPosition),
+            describe(semantic::gNormal, vertexEncoding.mNormal),
+            describe(semantic::gTangent, vertexEncoding.mTangent),
+            describe(semantic::gBitangent, vertexEncoding.mBitangent),
+            describe(semantic::gColor, vertexEncoding.mColor),
+            describe(semantic::gUv, vertexEncoding.mUv),
+        };
+
+        // The joint indices are followed by the weights, for each vertex.
+        const std::array<InterleavedAttributeDescription, 2> interleavedJointAttributes {{
+            {
+                describe(semantic::gJoints0, vertexEncoding.mJointIndices),
+                0,
+            },
+            {
+                describe(semantic::gWeights0, vertexEncoding.mJointWeights),
+                vertexEncoding.mJointIndices.getByteSize(),
+            }
+        }};
+        const GLsizei jointDataStride = vertexEncoding.getJointDataStride();
+
+        // Prepare the single buffer storage for the whole binary
+        VertexStream * consolidatedStream = makeVertexStream(
+            verticesCount,
+            indicesCount,
+            GL_UNSIGNED_INT,
+            attributeStreamsInBinary,
+            aStorage,
+            aStream);
+
+        // Add the interleaved joint attributes to the vertex stream
+        Handle<graphics::BufferAny> vertexJointDataBuffer = makeBuffer(
+            jointDataStride,
+            verticesCount,
+            GL_STATIC_DRAW,
+            aStorage);
+        addInterleavedAttributes(
+            consolidatedStream,
+            jointDataStride,
+            interleavedJointAttributes,
+            vertexJointDataBuffer,
+            verticesCount);
+
+        // Prepare a MaterialContext for the whole binary, 
+        // I.e. in a scene, each entry (each distinct binary) gets its own material UBO and its own Texture array.
+        // TODO #azdo #perf we could load textures and materials in a single buffer for a whole scene to further consolidate
+        MaterialContext & commonMaterialContext = aStorage.mMaterialContexts.emplace_back();
     
-    // Set the common values shared by all parts in this binary.
-    // (The actual phong material index will be set later, by each part)
-    Material baseMaterial{
-        // The material names is a single array for all binaries
-        // the binary-local material index needs to be offset to index into the common name array.
-        .mNameArrayOffset = aStorage.mMaterialNames.size(),
-        .mContext = &commonMaterialContext,
-        .mEffect = aPartsEffect,
-    };
+        // Set the common values shared by all parts in this binary.
+        // (The actual phong material index will be set later, by each part)
+        Material baseMaterial{
+            // The material names is a single array for all binaries
+            // the binary-local material index needs to be offset to index into the common name array.
+            .mNameArrayOffset = aStorage.mMaterialNames.size(),
+            .mContext = &commonMaterialContext,
+            .mEffect = aPartsEffect,
+        };
 
-    GLuint vertexFirst = 0;
-    GLuint indexFirst = 0;
+        GLuint vertexFirst = 0;
+        GLuint indexFirst = 0;
 
-    // TODO Ad 2024/03/07: Find a cleaner (more direct and explicit) way to handle rigs and their animations
-    // Currently compares the number of AnimatedRigs before and after loading then node, to see if one was added
-    std::size_t rigsCount = aStorage.mAnimatedRigs.size();
-    Node result = loadNode(in, aStorage, baseMaterial, *consolidatedStream, vertexFirst, indexFirst);
-    rigsCount = aStorage.mAnimatedRigs.size() - rigsCount;
+        // TODO Ad 2024/03/07: Find a cleaner (more direct and explicit) way to handle rigs and their animations
+        // Currently compares the number of AnimatedRigs before and after loading then node, to see if one was added
+        std::size_t rigsCount = aStorage.mAnimatedRigs.size();
+        Node result = loadNode(in, version, vertexEncoding, aStorage, baseMaterial, *consolidatedStream, vertexFirst, indexFirst);
+        rigsCount = aStorage.mAnimatedRigs.size() - rigsCount;
 
-    // Hackish way to add the RigAnimations into the AnimateRig
-    {
-        std::vector<RigAnimation> animations = loadAnimations(in);
-        
-        if(animations.empty())
-        {
-            assert(rigsCount == 0);
-        }
-        else
+        // Hackish way to add the RigAnimations into the AnimateRig
         {
-            assert(rigsCount == 1);
-            auto & nameToAnim = aStorage.mAnimatedRigs.back().mNameToAnimation;
-            for(RigAnimation & anim : animations)
+            enterSection(&SeumTableOfContents::mAnimations);
+            std::vector<RigAnimation> animations = loadAnimations(in);
+        
+            if(animations.empty())
+            {
+                assert(rigsCount == 0);
+            }
+            else
             {
-                nameToAnim.emplace(anim.mName, std::move(anim));
+                assert(rigsCount == 1);
+                auto & nameToAnim = aStorage.mAnimatedRigs.back().mNameToAnimation;
+                for(RigAnimation & anim : animations)
+                {
+                    nameToAnim.emplace(anim.mName, std::move(anim));
+                }
             }
         }
-    }
     
 
-    // TODO #assetprocessor If materials were loaded first, then the empty context 
-    // Then we could directly instantiate the MaterialContext with this value.
-    commonMaterialContext = loadMaterials(in, aStorage);
+        // TODO #assetprocessor If materials were loaded first, then the empty context 
+        // Then we could directly instantiate the MaterialContext with this value.
+        enterSection(&SeumTableOfContents::mMaterials);
+        commonMaterialContext = loadMaterials(in, aStorage, &aBinary.mTextures);
 
-    return result;
+        return result;
+    }
+    catch(const ArchiveOverrun & aException)
+    {
+        SELOG(error)("Loading binary '{}' failed, the data is truncated: {}",
+                     aBinary.mPath.string(), aException.what());
+        return SeumErrorCode::TruncatedData;
+    }
 }
 
 
@@ -1265,7 +1561,8 @@ std::vector<Technique> populateTechniques(const Loader & aLoader,
             Technique & inserted = result.back();
             for(auto [category, value] : technique.at("annotations").items())
             {
-                inserted.mAnnotations.emplace(category, value.get<std::string>());
+                inserted.mAnnotations.emplace(StringKey::Intern(category),
+                                              StringKey::Intern(value.get<std::string>()));
             }
         }
     }
@@ -1301,6 +1598,8 @@ bool recompileEffects(const Loader & aLoader, Storage & aStorage)
         ++effectIt;
     }
 
+    ++aStorage.mEffectsGeneration;
+
     return success;
 }
 
@@ -1410,6 +1709,10 @@ IntrospectProgram Loader::loadProgram(const filesystem::path & aProgFile,
         {
             stageEnumerator = GL_GEOMETRY_SHADER;
         }
+        else if(shaderStage == "compute")
+        {
+            stageEnumerator = GL_COMPUTE_SHADER;
+        }
         else
         {
             SELOG(critical)("Unable to map shader stage key '{}' to a program stage.", shaderStage);
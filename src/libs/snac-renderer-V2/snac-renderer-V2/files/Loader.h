@@ -1,13 +1,21 @@
 #pragma once
 
 
+#include "MappedFile.h"
+
 #include "../Model.h"
 
+#include <arte/Image.h>
+
+#include <math/Color.h>
 #include <math/Homogeneous.h>
 
 #include <resource/ResourceFinder.h>
 
 #include <filesystem>
+#include <map>
+#include <optional>
+#include <string>
 #include <variant>
 
 
@@ -30,6 +38,8 @@ enum class SeumErrorCode
     InvalidMagicPreamble,
     UnsupportedFormat,
     OutdatedVersion,
+    UnknownVersion, // The binary was written by a more recent version of the format.
+    TruncatedData, // The data, or a section of the table of contents, extends past the end of the file.
 };
 
 
@@ -47,6 +57,37 @@ struct ModelWithFeatures
 ModelWithFeatures getModelAndFeatures(std::filesystem::path aJsonFile);
 
 
+/// @brief A binary file read ahead of its upload: mapped with its pages loaded, and its textures decoded.
+///
+/// Preparing does not require the GL context, so it can be done by I/O threads,
+/// leaving only the GL uploads to the thread where the context is current.
+struct PreparedBinary
+{
+    /// @brief A texture image referenced by the binary.
+    struct Texture
+    {
+        /// @brief The decoded image, converted to linear color space, for uncompressed textures.
+        std::optional<arte::Image<math::sdr::Rgba>> mImage;
+        /// @brief The content of the DDS file, for compressed textures.
+        std::string mDds;
+    };
+
+    /// @brief Textures by path as referenced in the binary (i.e. before substitution of the DDS file).
+    using Textures = std::map<std::filesystem::path, Texture>;
+
+    std::filesystem::path mPath;
+    MappedFile mMapped;
+    /// @brief Empty for binaries without table of contents, whose textures are then read by loadBinary().
+    Textures mTextures;
+};
+
+
+/// @brief Read `aBinaryFile` and its textures, without requiring a GL context.
+/// @note Can be called concurrently from several threads.
+std::variant<PreparedBinary, SeumErrorCode> prepareBinary(const std::filesystem::path & aBinaryFile);
+
+
+/// @brief Load a binary file in `aStorage`, equivalent to loadBinary(prepareBinary(aBinaryFile), ...).
 std::variant<Node, SeumErrorCode> loadBinary(const std::filesystem::path & aBinaryFile,
                                              Storage & aStorage,
                                              Effect * aPartsEffect,
@@ -54,6 +95,12 @@ std::variant<Node, SeumErrorCode> loadBinary(const std::filesystem::path & aBina
                                              // stream already containing the instance data
                                              const GenericStream & aStream/*to provide instance data, such as model transform*/);
 
+/// @brief Upload a prepared binary in `aStorage`, must be called on the thread where the GL context is current.
+std::variant<Node, SeumErrorCode> loadBinary(PreparedBinary aBinary,
+                                             Storage & aStorage,
+                                             Effect * aPartsEffect,
+                                             const GenericStream & aStream);
+
 
 /// @brief Load a triangle and a cube models in the same buffer objects (they do not share vertices though).
 std::pair<Node, Node> loadTriangleAndCube(Storage & aStorage, 
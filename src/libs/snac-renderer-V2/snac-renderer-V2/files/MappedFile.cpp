@@ -0,0 +1,113 @@
+#include "MappedFile.h"
+
+#include "../Logging.h"
+
+#if defined(_WIN32)
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include <utility>
+
+
+namespace ad::renderer {
+
+
+MappedFile::MappedFile(const std::filesystem::path & aFile)
+{
+#if defined(_WIN32)
+    HANDLE file = CreateFileW(aFile.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr,
+                              OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if(file == INVALID_HANDLE_VALUE)
+    {
+        SELOG(error)("Cannot open file '{}' for mapping.", aFile.string());
+        return;
+    }
+
+    LARGE_INTEGER size;
+    if(GetFileSizeEx(file, &size) && size.QuadPart > 0)
+    {
+        // The view keeps a reference to the mapping object, which keeps a reference to the file.
+        if(HANDLE mapping = CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr))
+        {
+            mData = static_cast<const std::byte *>(MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0));
+            mSize = mData != nullptr ? (std::size_t)size.QuadPart : 0;
+            CloseHandle(mapping);
+        }
+    }
+    CloseHandle(file);
+#else
+    int file = open(aFile.c_str(), O_RDONLY);
+    if(file == -1)
+    {
+        SELOG(error)("Cannot open file '{}' for mapping.", aFile.string());
+        return;
+    }
+
+    struct stat status;
+    if(fstat(file, &status) == 0 && status.st_size > 0)
+    {
+        void * data = mmap(nullptr, (std::size_t)status.st_size, PROT_READ, MAP_PRIVATE, file, 0);
+        if(data != MAP_FAILED)
+        {
+            mData = static_cast<const std::byte *>(data);
+            mSize = (std::size_t)status.st_size;
+        }
+    }
+    // The mapping remains valid after the descriptor is closed.
+    close(file);
+#endif
+
+    if(mData == nullptr)
+    {
+        SELOG(error)("Cannot map file '{}'.", aFile.string());
+    }
+}
+
+
+MappedFile::~MappedFile()
+{
+    unmap();
+}
+
+
+MappedFile::MappedFile(MappedFile && aOther) noexcept :
+    mData{std::exchange(aOther.mData, nullptr)},
+    mSize{std::exchange(aOther.mSize, 0)}
+{}
+
+
+MappedFile & MappedFile::operator=(MappedFile && aOther) noexcept
+{
+    if(this != &aOther)
+    {
+        unmap();
+        mData = std::exchange(aOther.mData, nullptr);
+        mSize = std::exchange(aOther.mSize, 0);
+    }
+    return *this;
+}
+
+
+void MappedFile::unmap()
+{
+    if(mData != nullptr)
+    {
+#if defined(_WIN32)
+        UnmapViewOfFile(mData);
+#else
+        munmap(const_cast<std::byte *>(mData), mSize);
+#endif
+        mData = nullptr;
+        mSize = 0;
+    }
+}
+
+
+} // namespace ad::renderer
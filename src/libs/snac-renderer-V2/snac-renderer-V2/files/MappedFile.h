@@ -0,0 +1,44 @@
+#pragma once
+
+
+#include <cstddef>
+#include <filesystem>
+#include <span>
+
+
+namespace ad::renderer {
+
+
+/// @brief Read-only memory mapping of a whole file, unmapped on destruction.
+///
+/// The pages are only loaded by the OS when they are accessed,
+/// so the content can be handed directly to GL without intermediate heap copies.
+class MappedFile
+{
+public:
+    /// @brief Map `aFile`, the mapping is empty (and the instance converts to false) on failure.
+    explicit MappedFile(const std::filesystem::path & aFile);
+
+    ~MappedFile();
+
+    MappedFile(const MappedFile &) = delete;
+    MappedFile & operator=(const MappedFile &) = delete;
+
+    MappedFile(MappedFile && aOther) noexcept;
+    MappedFile & operator=(MappedFile && aOther) noexcept;
+
+    explicit operator bool() const
+    { return mData != nullptr; }
+
+    std::span<const std::byte> bytes() const
+    { return {mData, mSize}; }
+
+private:
+    void unmap();
+
+    const std::byte * mData = nullptr;
+    std::size_t mSize = 0;
+};
+
+
+} // namespace ad::renderer
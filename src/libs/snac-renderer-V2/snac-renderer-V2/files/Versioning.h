@@ -1,6 +1,7 @@
 #pragma once
 
 
+#include <cstddef>
 #include <cstdint>
 
 
@@ -8,7 +9,32 @@ namespace ad::renderer {
 
 
 static constexpr std::uint16_t gSeumMagic = 0x0410;
-static constexpr std::uint32_t gSeumVersion = 4;
+static constexpr std::uint32_t gSeumVersion = 7;
+/// @brief Oldest version of the format that can still be loaded.
+/// @note Version 4 is the last version without table of contents nor blob alignment.
+static constexpr std::uint32_t gSeumOldestSupportedVersion = 4;
+
+/// @brief Alignment, in bytes, of the raw data blobs (vertex attributes, indices, keyframes, ...)
+/// relative to the beginning of the file (since version 5).
+static constexpr std::size_t gSeumBlobAlignment = 16;
+
+
+/// @brief Position of a section in the file, in bytes.
+struct SeumSection
+{
+    std::uint64_t mOffset;
+    std::uint64_t mSize;
+};
+
+
+/// @brief Written right after the version (since version 5).
+struct SeumTableOfContents
+{
+    // Vertices and indices counts, followed by the node hierarchy (with meshes and rigs).
+    SeumSection mNodes;
+    SeumSection mAnimations;
+    SeumSection mMaterials;
+};
 
 
 } // namespace ad::renderer
@@ -0,0 +1,104 @@
+#pragma once
+
+
+#include <renderer/GL_Loader.h>
+
+#include <cstdint>
+
+
+//
+// IMPORTANT: keep it header only, it is included from the asset processor.
+//
+
+namespace ad::renderer {
+
+
+/// @brief Encoding of a vertex attribute in the binary, directly usable as the client format of a GL vertex attribute.
+struct AttributeEncoding
+{
+    /// @brief Size in bytes of the attribute for a single vertex.
+    std::uint32_t getByteSize() const
+    {
+        return mComponentCount * getComponentByteSize(mComponentType);
+    }
+
+    static std::uint32_t getComponentByteSize(GLenum aComponentType)
+    {
+        switch(aComponentType)
+        {
+            case GL_BYTE:
+            case GL_UNSIGNED_BYTE:
+                return 1;
+            case GL_SHORT:
+            case GL_UNSIGNED_SHORT:
+            case GL_HALF_FLOAT:
+                return 2;
+            default:
+                return 4;
+        }
+    }
+
+    std::uint32_t mComponentType; // GLenum
+    std::uint32_t mComponentCount;
+    // Integer data are mapped to [0, 1] (unsigned) or [-1, 1] (signed) when non-zero.
+    std::uint32_t mNormalized = 0;
+};
+
+
+/// @brief Encoding of each vertex stream of a binary, written in the binary since version 6.
+///
+/// The joint indices and weights are interleaved in the same vertex buffer, indices first.
+struct VertexEncoding
+{
+    /// @brief Size of the interleaved joint data of a single vertex.
+    std::uint32_t getJointDataStride() const
+    {
+        return mJointIndices.getByteSize() + mJointWeights.getByteSize();
+    }
+
+    /// @brief Quantized positions must be mapped to the Object space, see Object::mPositionDequantization.
+    bool hasQuantizedPositions() const
+    {
+        return mPosition.mNormalized != 0;
+    }
+
+    AttributeEncoding mPosition;
+    AttributeEncoding mNormal;
+    AttributeEncoding mTangent;
+    AttributeEncoding mBitangent;
+    AttributeEncoding mColor;
+    AttributeEncoding mUv;
+    AttributeEncoding mJointIndices;
+    AttributeEncoding mJointWeights;
+};
+
+
+/// @brief The only encoding up to version 5 (and still the default).
+inline constexpr VertexEncoding gFloatVertexEncoding{
+    .mPosition     = {GL_FLOAT, 3},
+    .mNormal       = {GL_FLOAT, 3},
+    .mTangent      = {GL_FLOAT, 3},
+    .mBitangent    = {GL_FLOAT, 3},
+    .mColor        = {GL_FLOAT, 4},
+    .mUv           = {GL_FLOAT, 2},
+    .mJointIndices = {GL_UNSIGNED_INT, 4},
+    .mJointWeights = {GL_FLOAT, 4},
+};
+
+
+/// @brief Compact encoding, that GL decodes natively through normalized and half-float formats.
+/// @note Positions are quantized relative to the AABB of their Object,
+/// joint indices require the Rig to have at most 256 joints.
+inline constexpr VertexEncoding gCompactVertexEncoding{
+    .mPosition     = {GL_UNSIGNED_SHORT, 3, 1},
+    .mNormal       = {GL_SHORT, 3, 1},
+    .mTangent      = {GL_SHORT, 3, 1},
+    .mBitangent    = {GL_SHORT, 3, 1},
+    .mColor        = {GL_UNSIGNED_BYTE, 4, 1},
+    .mUv           = {GL_HALF_FLOAT, 2},
+    .mJointIndices = {GL_UNSIGNED_BYTE, 4},
+    .mJointWeights = {GL_UNSIGNED_SHORT, 4, 1},
+};
+
+
+} // namespace ad::renderer
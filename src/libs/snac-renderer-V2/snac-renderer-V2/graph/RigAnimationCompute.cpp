@@ -0,0 +1,202 @@
+#include "RigAnimationCompute.h"
+
+#include "../Profiling.h"
+#include "../RendererReimplement.h"
+
+#include "../files/Loader.h"
+
+#include <profiler/GlApi.h>
+
+#include <algorithm>
+
+#include <cassert>
+
+
+namespace ad::renderer {
+
+
+static_assert(sizeof(RigAnimationCompute::AnimationRecord_glsl) == 32, "Must match the std430 layout.");
+static_assert(sizeof(RigAnimationCompute::Keyframe_glsl) == 48, "Must match the std430 layout.");
+static_assert(sizeof(RigAnimationCompute::RigNode_glsl) == 80, "Must match the std430 layout.");
+static_assert(sizeof(RigAnimationCompute::Joint_glsl) == 80, "Must match the std430 layout.");
+static_assert(sizeof(RigAnimationCompute::InstanceRecord_glsl) == 16, "Must match the std430 layout.");
+
+
+namespace {
+
+    // Binding indices of the shader storage blocks, see Bindings.md
+    enum StorageBinding : GLuint
+    {
+        Animations = 0,
+        Timepoints,
+        Keyframes,
+        Nodes,
+        Joints,
+        Instances,
+        Poses,
+        Palettes,
+    };
+
+    template <class T_value>
+    void loadStorage(const graphics::BufferAny & aBuffer, const std::vector<T_value> & aValues)
+    {
+        proto::load(aBuffer, std::span{aValues}, graphics::BufferHint::StaticDraw);
+    }
+
+} // unnamed namespace
+
+
+RigAnimationCompute::RigAnimationCompute(const Loader & aLoader) :
+    mProgram{aLoader.loadProgram("programs/AnimateRigs.prog")}
+{}
+
+
+GLuint RigAnimationCompute::getAnimationId(const Rig & aRig, const RigAnimation * aAnimation)
+{
+    using Node = NodeTree<Rig::Pose>::Node;
+
+    if(auto found = mAnimationIds.find({&aRig, aAnimation}); found != mAnimationIds.end())
+    {
+        return found->second;
+    }
+
+    const NodeTree<Rig::Pose> & tree = aRig.mJointTree;
+
+    AnimationRecord_glsl record{
+        .mTimepointsOffset = (GLuint)mTimepoints.size(),
+        .mTimepointsCount = 0,
+        .mKeyframesOffset = (GLuint)mKeyframes.size(),
+        .mNodesOffset = (GLuint)mNodes.size(),
+        .mNodesCount = (GLuint)tree.size(),
+        .mJointsOffset = (GLuint)mJoints.size(),
+        .mJointsCount = (GLuint)aRig.countJoints(),
+        .mLevelsCount = 0,
+    };
+
+    // Maps each node of the tree to the animation channel targetting it.
+    std::vector<GLint> nodeChannels(tree.size(), -1);
+
+    if(aAnimation != nullptr)
+    {
+        record.mTimepointsCount = (GLuint)aAnimation->mTimepoints.size();
+        mTimepoints.insert(mTimepoints.end(), aAnimation->mTimepoints.begin(), aAnimation->mTimepoints.end());
+
+        for(std::size_t channelIdx = 0; channelIdx != aAnimation->mNodes.size(); ++channelIdx)
+        {
+            nodeChannels[aAnimation->mNodes[channelIdx]] = (GLint)channelIdx;
+
+            const RigAnimation::NodeKeyframes & keyframes = aAnimation->mKeyframes[channelIdx];
+            for(std::size_t keyframeIdx = 0; keyframeIdx != aAnimation->mTimepoints.size(); ++keyframeIdx)
+            {
+                const auto & translation = keyframes.mTranslations[keyframeIdx];
+                const auto & scale = keyframes.mScales[keyframeIdx];
+                mKeyframes.push_back(Keyframe_glsl{
+                    .mTranslation{translation.x(), translation.y(), translation.z(), 0.f},
+                    .mRotation = keyframes.mRotations[keyframeIdx],
+                    .mScale{scale.x(), scale.y(), scale.z(), 0.f},
+                });
+            }
+        }
+    }
+
+    for(Node::Index nodeIdx = 0; nodeIdx != tree.size(); ++nodeIdx)
+    {
+        const Node & node = tree[nodeIdx];
+        // Parents are stored before their children (see NodeTree::addNode()), which the compute program relies on.
+        assert(!tree.hasParent(nodeIdx) || node.mParent < nodeIdx);
+        mNodes.push_back(RigNode_glsl{
+            .mDefaultLocalPose = tree.mLocalPose[nodeIdx],
+            .mParent = tree.hasParent(nodeIdx) ? (GLint)node.mParent : -1,
+            .mLevel = node.mLevel,
+            .mChannel = nodeChannels[nodeIdx],
+        });
+        record.mLevelsCount = std::max(record.mLevelsCount, node.mLevel + 1);
+    }
+
+    for(std::size_t jointIdx = 0; jointIdx != aRig.countJoints(); ++jointIdx)
+    {
+        mJoints.push_back(Joint_glsl{
+            .mInverseBindMatrix = aRig.mJoints.mInverseBindMatrices[jointIdx],
+            .mNode = (GLuint)aRig.mJoints.mIndices[jointIdx],
+        });
+    }
+
+    GLuint id = (GLuint)mAnimations.size();
+    mAnimations.push_back(record);
+    mAnimationIds.emplace(std::make_pair(&aRig, aAnimation), id);
+    mPackedDataChanged = true;
+    return id;
+}
+
+
+void RigAnimationCompute::dispatch(std::span<const AnimatedInstance> aInstances,
+                                   std::size_t aPaletteSize,
+                                   const graphics::BufferAny & aPalettes)
+{
+    PROFILER_SCOPE_RECURRING_SECTION(gRenderProfiler, "animate_rigs_compute", CpuTime, GpuTime);
+
+    if(mPackedDataChanged)
+    {
+        loadStorage(mAnimationsBuffer, mAnimations);
+        loadStorage(mTimepointsBuffer, mTimepoints);
+        loadStorage(mKeyframesBuffer, mKeyframes);
+        loadStorage(mNodesBuffer, mNodes);
+        loadStorage(mJointsBuffer, mJoints);
+        mPackedDataChanged = false;
+    }
+
+    // Assign a range of the poses scratch buffer to each instance.
+    mInstanceRecords.clear();
+    GLuint posesCount = 0;
+    for(const AnimatedInstance & instance : aInstances)
+    {
+        mInstanceRecords.push_back(InstanceRecord_glsl{
+            .mAnimation = instance.mAnimation,
+            .mTimepoint = instance.mTimepoint,
+            .mPaletteOffset = instance.mPaletteOffset,
+            .mPosesOffset = posesCount,
+        });
+        posesCount += mAnimations[instance.mAnimation].mNodesCount;
+    }
+    proto::load(mInstancesBuffer, std::span{mInstanceRecords}, graphics::BufferHint::StreamDraw);
+
+    // Only grow the scratch buffer
+    if(posesCount > mPosesCapacity)
+    {
+        graphics::ScopedBind bound{mPosesBuffer, graphics::BufferType::Array};
+        gl.BufferData(GL_ARRAY_BUFFER, posesCount * sizeof(Rig::Pose), nullptr, GL_DYNAMIC_COPY);
+        mPosesCapacity = posesCount;
+    }
+
+    {
+        // Any target can re-specify the storage, the shader storage binding is made below.
+        graphics::ScopedBind bound{aPalettes, graphics::BufferType::Array};
+        gl.BufferData(GL_ARRAY_BUFFER, aPaletteSize * sizeof(Rig::Pose), nullptr, GL_STREAM_COPY);
+    }
+
+    if(aInstances.empty())
+    {
+        return;
+    }
+
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, Animations, mAnimationsBuffer);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, Timepoints, mTimepointsBuffer);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, Keyframes, mKeyframesBuffer);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, Nodes, mNodesBuffer);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, Joints, mJointsBuffer);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, Instances, mInstancesBuffer);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, Poses, mPosesBuffer);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, Palettes, aPalettes);
+
+    {
+        graphics::ScopedBind boundProgram{mProgram};
+        // One work group per instance
+        glDispatchCompute((GLuint)aInstances.size(), 1, 1);
+    }
+
+    // The palettes are then sourced by shader storage blocks.
+    glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT);
+}
+
+
+} // namespace ad::renderer
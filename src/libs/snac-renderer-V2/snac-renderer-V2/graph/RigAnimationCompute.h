@@ -0,0 +1,119 @@
+#pragma once
+
+
+#include "../IntrospectProgram.h"
+#include "../Rigging.h"
+
+#include <renderer/VertexSpecification.h>
+
+#include <map>
+#include <span>
+#include <utility>
+#include <vector>
+
+
+namespace ad::renderer {
+
+
+struct Loader;
+
+
+/// @brief GPU alternative to animate() and Rig::computeJointMatrices().
+///
+/// The data of each (rig, animation) pair is packed into shader storage buffers once, on first request.
+/// Each frame, the client only provides the (animation id, time) of each instance,
+/// and a compute program evaluates the poses, writing the joint matrix palettes in the buffer read by vertex shaders.
+/// @note Requires OpenGL 4.3.
+struct RigAnimationCompute
+{
+    struct AnimatedInstance
+    {
+        GLuint mAnimation;
+        GLfloat mTimepoint;
+        // First joint matrix of this instance palette.
+        GLuint mPaletteOffset;
+    };
+
+    RigAnimationCompute(const Loader & aLoader);
+
+    /// @brief Return the id of the (rig, animation) pair, packing its data on first request.
+    /// @param aAnimation Null for the default pose of `aRig`.
+    GLuint getAnimationId(const Rig & aRig, const RigAnimation * aAnimation);
+
+    /// @brief Write the palette of each instance in the shader storage buffer `aPalettes`,
+    /// (re-)specified to hold `aPaletteSize` matrices.
+    /// The palettes are visible to shader storage blocks sourced from `aPalettes` when the function returns.
+    void dispatch(std::span<const AnimatedInstance> aInstances,
+                  std::size_t aPaletteSize,
+                  const graphics::BufferAny & aPalettes);
+
+    // Layouts matching the std430 structures of AnimateRigs.comp
+    struct AnimationRecord_glsl
+    {
+        GLuint mTimepointsOffset;
+        GLuint mTimepointsCount;
+        GLuint mKeyframesOffset;
+        GLuint mNodesOffset;
+        GLuint mNodesCount;
+        GLuint mJointsOffset;
+        GLuint mJointsCount;
+        GLuint mLevelsCount;
+    };
+
+    struct Keyframe_glsl
+    {
+        math::Vec<4, GLfloat> mTranslation;
+        math::Quaternion<GLfloat> mRotation;
+        math::Vec<4, GLfloat> mScale;
+    };
+
+    struct alignas(16) RigNode_glsl
+    {
+        Rig::Pose mDefaultLocalPose;
+        GLint mParent;
+        GLuint mLevel;
+        GLint mChannel;
+    };
+
+    struct alignas(16) Joint_glsl
+    {
+        Rig::Ibm mInverseBindMatrix;
+        GLuint mNode;
+    };
+
+    struct InstanceRecord_glsl
+    {
+        GLuint mAnimation;
+        GLfloat mTimepoint;
+        GLuint mPaletteOffset;
+        GLuint mPosesOffset;
+    };
+
+    IntrospectProgram mProgram;
+
+    // Keyed by (rig, animation), the value is the animation id (index in mAnimations).
+    std::map<std::pair<const Rig *, const RigAnimation *>, GLuint> mAnimationIds;
+
+    // Client copies of the packed data, re-uploaded when an animation is added.
+    std::vector<AnimationRecord_glsl> mAnimations;
+    std::vector<GLfloat> mTimepoints;
+    std::vector<Keyframe_glsl> mKeyframes;
+    std::vector<RigNode_glsl> mNodes;
+    std::vector<Joint_glsl> mJoints;
+    bool mPackedDataChanged = false;
+
+    // Intended for function-local storage, made a member so its reuses the allocated memory between frames.
+    std::vector<InstanceRecord_glsl> mInstanceRecords;
+
+    graphics::BufferAny mAnimationsBuffer;
+    graphics::BufferAny mTimepointsBuffer;
+    graphics::BufferAny mKeyframesBuffer;
+    graphics::BufferAny mNodesBuffer;
+    graphics::BufferAny mJointsBuffer;
+    graphics::BufferAny mInstancesBuffer;
+    graphics::BufferAny mPosesBuffer;
+    std::size_t mPosesCapacity = 0;
+};
+
+
+} // namespace ad::renderer
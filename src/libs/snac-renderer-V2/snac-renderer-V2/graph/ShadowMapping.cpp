@@ -486,7 +486,7 @@ LightsDataInternal fillShadowMap(const ShadowMapping & aPass,
                                  const Camera & aCamera,
                                  const LightsDataUi & aLights,
                                  ShadowMapUbos aUbos,
-                                 std::function<void(DepthMethod)> aOpaquePass)
+                                 std::function<void(DepthMethod, std::span<const math::Matrix<4, 4, GLfloat>>)> aOpaquePass)
 {
     const ShadowMapping::Controls & c = aPass.mControls;
     const DepthMethod method = c.mUseCascades ? DepthMethod::Cascaded : DepthMethod::Single;
@@ -622,7 +622,8 @@ LightsDataInternal fillShadowMap(const ShadowMapping & aPass,
                 // done once after this for-loop.
                 loadCameraUbo(*aUbos.mViewingUbo, 
                               GpuViewProjectionBlock{orientationWorldToLight, fullProjection});
-                aOpaquePass(DepthMethod::Single);
+                aOpaquePass(DepthMethod::Single,
+                            std::span{&lightViewProjection.mLightViewProjections[shadowLightIdx], 1});
             }
 
             ++shadowLightIdx;
@@ -658,7 +659,10 @@ LightsDataInternal fillShadowMap(const ShadowMapping & aPass,
             lightViewProjection.mLightViewProjectionOffset = gCascadesPerShadow * directionalIdx;
             updateOffsetInLightViewProjectionUbo(*aUbos.mLightViewProjectionUbo,
                                                 lightViewProjection);
-            aOpaquePass(DepthMethod::Cascaded);
+            assert(lightViewProjection.mLightViewProjectionOffset + gCascadesPerShadow <= gMaxShadowMaps);
+            aOpaquePass(DepthMethod::Cascaded,
+                        std::span{&lightViewProjection.mLightViewProjections[lightViewProjection.mLightViewProjectionOffset],
+                                  gCascadesPerShadow});
         }
     }
     else
@@ -9,6 +9,9 @@
 #include <snac-renderer-V2/Model.h>
 #include <snac-renderer-V2/Lights.h>
 
+#include <functional>
+#include <span>
+
 
 namespace ad::renderer {
 
@@ -134,6 +137,8 @@ struct ShadowMapUbos
 /// @param aSceneAabb_world The bounding box of the whole scene, in world coordinates.
 /// @param aCamera The camera for which a shadow mapped rendering will occur.
 /// @param aLights A collection of lights, some of which might project a shadow (up to gMaxShadowLights)
+/// @param aOpaquePass Renders the shadow casters, it receives the view-projections (world to light clip space)
+/// of the shadow maps rendered by this invocation, so it can cull the casters outside of all of them.
 /// @return A buffer associating each light to a base shadow map index, or InvalidIndex if the light does not project.
 /// 
 /// This function is loading the shadow cascade and light-view-projections UBOs, render the shadow map textures,
@@ -143,7 +148,7 @@ LightsDataInternal fillShadowMap(const ShadowMapping & aPass,
                                  const Camera & aCamera,
                                  const LightsDataUi & aLights,
                                  ShadowMapUbos aUbos,
-                                 std::function<void(DepthMethod)> aOpaquePass);
+                                 std::function<void(DepthMethod, std::span<const math::Matrix<4, 4, GLfloat>>)> aOpaquePass);
 
 
 } // namespace ad::renderer
\ No newline at end of file
@@ -259,15 +259,15 @@ TextPart makePartForFont(const Font & aFont,
     Handle<graphics::UniformBufferObject> metricsUbo = &aStorage.mUbos.back();
     proto::load(*metricsUbo, std::span{aFont.mCharMap.mMetrics}, graphics::BufferHint::StaticDraw);
 
-    // String entities UBO
-    aStorage.mUbos.emplace_back();
-    Handle<graphics::UniformBufferObject> entitiesUbo = &aStorage.mUbos.back();
+    // String entities SSBO
+    aStorage.mBuffers.emplace_back();
+    Handle<const graphics::BufferAny> entitiesSsbo = &aStorage.mBuffers.back();
 
     aStorage.mMaterialContexts.emplace_back(
         MaterialContext{
             .mUboRepo = RepositoryUbo{
                 {semantic::gGlyphMetrics, metricsUbo},
-                {semantic::gTextEntities, entitiesUbo},
+                {semantic::gTextEntities, entitiesSsbo},
             },
             .mTextureRepo = {
                 {semantic::gGlyphAtlas, aFont.mGlyphAtlas}
@@ -295,7 +295,7 @@ TextPart makePartForFont(const Font & aFont,
     };
     result.mGlyphInstanceBuffer = glyphInstanceBuffer;
     result.mInstanceToStringEntityBuffer = instanceToStringEntityBuffer;
-    result.mStringEntitiesUbo = entitiesUbo;
+    result.mStringEntitiesSsbo = entitiesSsbo;
     return result;
 }
 
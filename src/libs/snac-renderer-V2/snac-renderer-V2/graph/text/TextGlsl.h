@@ -49,7 +49,7 @@ namespace ad::renderer {
     {
         Handle<const graphics::BufferAny> mGlyphInstanceBuffer;
         Handle<const graphics::BufferAny> mInstanceToStringEntityBuffer;
-        Handle<graphics::UniformBufferObject> mStringEntitiesUbo;
+        Handle<const graphics::BufferAny> mStringEntitiesSsbo;
     };
 
     GenericStream makeGlyphInstanceStream(renderer::Storage & aStorage);
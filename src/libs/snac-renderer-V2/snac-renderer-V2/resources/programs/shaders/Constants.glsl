@@ -11,12 +11,14 @@
 // Note: we could use the defines provided by the client directly in the shader code
 // but I would rather have the definition visible in some GLSL code to be grep friendly.
 
-#define MAX_ENTITIES CLIENT_MAX_ENTITIES
-#define MAX_JOINTS CLIENT_MAX_JOINTS
 #define SDF_DOUBLE_SPREAD CLIENT_SDF_DOUBLE_SPREAD
 #define MAX_LIGHTS CLIENT_MAX_LIGHTS
 #define MAX_SHADOW_LIGHTS CLIENT_MAX_SHADOW_LIGHTS // The maximum number of lights that could project shadows
 #define CASCADES_PER_SHADOW CLIENT_CASCADES_PER_SHADOW
+
+// Unpack the fields of a uint packed by the client (see PackedEntityMaterial)
+#define UNPACK_ENTITY_IDX(packed) CLIENT_UNPACK_ENTITY_IDX(packed)
+#define UNPACK_MATERIAL_IDX(packed) CLIENT_UNPACK_MATERIAL_IDX(packed)
 #define MAX_SHADOW_MAPS (MAX_SHADOW_LIGHTS * CASCADES_PER_SHADOW)
 
 #endif // include guard
\ No newline at end of file
@@ -4,7 +4,7 @@
 
 // The instance attribute associating the OpenGL instance
 // (in the sense of instanced rendering) to its corresponding Entity.
-//in uint in_EntityIdx;
+//in uint in_PackedEntityMaterial;
 
 struct EntityData
 {
@@ -20,20 +20,21 @@ struct EntityData
     //   * Having it as a data member even if RIGGING is not defined is a drawback of the second appraoch.
 };
 
-// TODO #ssbo Use a shader storage block, due to the unbounded nature of the number of instances
-layout(std140, binding = 1) uniform EntitiesBlock
+// A shader storage block, so the number of entities is only bounded by the size of the bound range.
+// Note: EntityData has the same layout in std430 and std140.
+layout(std430, binding = 1) readonly buffer EntitiesBlock
 {
-    EntityData ub_Entities[MAX_ENTITIES];
+    EntityData sb_Entities[];
 };
 
 mat4 getModelTransform()
 {
-    return ub_Entities[ENTITY_IDX_ATTRIBUTE].localToWorld;
+    return sb_Entities[ENTITY_IDX_ATTRIBUTE].localToWorld;
 }
 
 EntityData getEntity()
 {
-    return ub_Entities[ENTITY_IDX_ATTRIBUTE];
+    return sb_Entities[ENTITY_IDX_ATTRIBUTE];
 }
 
 
@@ -1,4 +1,4 @@
-#version 420
+#version 430
 
 #include "Constants.glsl"
 
@@ -11,28 +11,28 @@ in vec2 ve_Uv;
 
 #if defined(ENTITIES)
     // The instance attribute associating the OpenGL instance
-    // (in the sense of instanced rendering) to its corresponding Entity.
-    in uint in_EntityIdx; // Note: cannot be part of the include, which might be used in FS.
-    #define ENTITY_IDX_ATTRIBUTE in_EntityIdx
+    // (in the sense of instanced rendering) to its corresponding Entity and material.
+    in uint in_PackedEntityMaterial; // Note: cannot be part of the include, which might be used in FS.
+    #define ENTITY_IDX_ATTRIBUTE UNPACK_ENTITY_IDX(in_PackedEntityMaterial)
+    #define MATERIAL_IDX_ATTRIBUTE UNPACK_MATERIAL_IDX(in_PackedEntityMaterial)
     #include "Entities.glsl"
     out flat uint ex_EntityIdx;
 #else //ENTITIES
     in uint in_ModelTransformIdx;
+    in uint in_MaterialIdx;
+    #define MATERIAL_IDX_ATTRIBUTE in_MaterialIdx
 
-    // TODO #ssbo Use a shader storage block, due to the unbounded nature of the number of instances
-    layout(std140, binding = 1) uniform LocalToWorldBlock
+    layout(std430, binding = 1) readonly buffer LocalToWorldBlock
     {
-        mat4 modelTransforms[MAX_ENTITIES];
+        mat4 sb_ModelTransforms[];
     };
 
     mat4 getModelTransform()
     {
-        return modelTransforms[in_ModelTransformIdx];
+        return sb_ModelTransforms[in_ModelTransformIdx];
     }
 #endif //ENTITIES
 
-in uint in_MaterialIdx;
-
 #include "ViewProjectionBlock.glsl"
 
 #ifdef SHADOW_MAPPING
@@ -92,10 +92,10 @@ void main(void)
 
     ex_Color = ve_Color;
     ex_Uv[0] = ve_Uv; // only 1 uv channel input at the moment
-    ex_MaterialIdx = in_MaterialIdx;
+    ex_MaterialIdx = MATERIAL_IDX_ATTRIBUTE;
 
 #if defined(ENTITIES)
-    ex_EntityIdx = in_EntityIdx;
+    ex_EntityIdx = ENTITY_IDX_ATTRIBUTE;
 #endif //ENTITIES
 
 #ifdef SHADOW_MAPPING
@@ -12,7 +12,8 @@ struct GenericMaterial
     float specularExponent;
 };
 
-layout(std140, binding = 2) uniform MaterialsBlock
+// Note: GenericMaterial has the same layout in std430 and std140 (its size is a multiple of 16).
+layout(std430, binding = 2) readonly buffer MaterialsBlock
 {
-    GenericMaterial ub_MaterialParams[128];
+    GenericMaterial sb_MaterialParams[];
 };
@@ -138,7 +138,7 @@ LightContributions applyLight_pbr(vec3 aView, vec3 aLightDir, vec3 aShadingNorma
 void main()
 {
     // Fetch the material
-    GenericMaterial material = ub_MaterialParams[ex_MaterialIdx];
+    GenericMaterial material = sb_MaterialParams[ex_MaterialIdx];
 
 #ifdef VERTEX_COLOR
     vec4 albedo = ex_Color;
@@ -1,4 +1,4 @@
-#version 420
+#version 430
 
 #include "Gamma.glsl"
 #include "Helpers.glsl"
@@ -27,7 +27,7 @@ out vec4 out_Color;
 void main()
 {
     // Fetch the material
-    GenericMaterial material = ub_MaterialParams[ex_MaterialIdx];
+    GenericMaterial material = sb_MaterialParams[ex_MaterialIdx];
 
 #ifdef VERTEX_COLOR
     vec4 albedo = ex_Color;
@@ -1,4 +1,4 @@
-#version 420
+#version 430
 
 #include "Helpers.glsl"
 
@@ -17,22 +17,7 @@ in flat uint ex_MaterialIdx;
 uniform sampler2DArray u_DiffuseTexture;
 #endif
 
-struct GenericMaterial
-{
-    vec4 ambientColor;
-    vec4 diffuseColor;
-    vec4 specularColor;
-    uint diffuseTextureIndex;
-    uint diffuseUvChannel;
-    uint normalTextureIndex;
-    uint normalUvChannel;
-    float specularExponent;
-};
-
-layout(std140, binding = 2) uniform MaterialsBlock
-{
-    GenericMaterial ub_MaterialParams[128];
-};
+#include "GenericMaterial.glsl"
 
 
 layout(location = 0) out vec4  out_Accum;
@@ -70,7 +55,7 @@ void writePixel(vec4 premultipliedReflect, vec3 transmit, float csZ) {
 void main()
 {
     // Material
-    GenericMaterial material = ub_MaterialParams[ex_MaterialIdx];
+    GenericMaterial material = sb_MaterialParams[ex_MaterialIdx];
 
 #ifdef VERTEX_COLOR
     vec4 albedo = ex_Color;
@@ -4,18 +4,18 @@ in vec4  ve_Weights0;
 in uint in_MatrixPaletteOffset; // default value of 0 is what we need when a single palette is provided.
 
 // Having a fixed binding value in an included file is dangerous.
-// Yet this seems to be required to avoid collisions with other uniform blocks.
-layout(std140, binding = 3) uniform JointMatricesBlock
+// Yet this seems to be required to avoid collisions with other shader storage blocks.
+layout(std430, binding = 3) readonly buffer JointMatricesBlock
 {
-    mat4 joints[MAX_JOINTS];
+    mat4 sb_Joints[];
 };
 
 mat4 assembleSkinningMatrix()
 {
     return 
-          ve_Weights0[0] * joints[in_MatrixPaletteOffset + ve_Joints0[0]]
-        + ve_Weights0[1] * joints[in_MatrixPaletteOffset + ve_Joints0[1]]
-        + ve_Weights0[2] * joints[in_MatrixPaletteOffset + ve_Joints0[2]]
-        + ve_Weights0[3] * joints[in_MatrixPaletteOffset + ve_Joints0[3]]
+          ve_Weights0[0] * sb_Joints[in_MatrixPaletteOffset + ve_Joints0[0]]
+        + ve_Weights0[1] * sb_Joints[in_MatrixPaletteOffset + ve_Joints0[1]]
+        + ve_Weights0[2] * sb_Joints[in_MatrixPaletteOffset + ve_Joints0[2]]
+        + ve_Weights0[3] * sb_Joints[in_MatrixPaletteOffset + ve_Joints0[3]]
     ;
 }
\ No newline at end of file
@@ -1,4 +1,4 @@
-#version 420
+#version 430
 
 in vec3 ve_Position_l;
 in vec4 a_Color;
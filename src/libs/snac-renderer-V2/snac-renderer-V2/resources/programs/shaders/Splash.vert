@@ -1,4 +1,4 @@
-#version 420
+#version 430
 
 #include "Constants.glsl"
 
@@ -17,9 +17,9 @@ const vec2 tex_data[4] = vec2[] (
 );
 
 // The instance attribute associating the OpenGL instance
-// (in the sense of instanced rendering) to its corresponding Entity.
-in uint in_EntityIdx; // Note: cannot be part of the include, which might be used in FS.
-#define ENTITY_IDX_ATTRIBUTE in_EntityIdx
+// (in the sense of instanced rendering) to its corresponding Entity (and material, unused here).
+in uint in_PackedEntityMaterial; // Note: cannot be part of the include, which might be used in FS.
+#define ENTITY_IDX_ATTRIBUTE UNPACK_ENTITY_IDX(in_PackedEntityMaterial)
 #include "Entities.glsl"
 out flat uint ex_EntityIdx;
 
@@ -1,4 +1,4 @@
-#version 420
+#version 430
 
 #include "Constants.glsl"
 #include "ViewProjectionBlock.glsl"
@@ -48,9 +48,9 @@ struct StringEntity
     vec4 color;
 };
 
-layout(std140, binding = 1) uniform TextEntitiesBlock
+layout(std430, binding = 1) readonly buffer TextEntitiesBlock
 {
-    StringEntity stringEntities[MAX_ENTITIES];
+    StringEntity sb_StringEntities[];
 };
 
 
@@ -66,7 +66,7 @@ void main(void)
     ex_AtlasUv_tex = (gUvs[gl_VertexID % 4] * glyph.boundingBox_pix)
         + vec2(glyph.linearOffset_pix, 0);
 
-    StringEntity entity = stringEntities[in_EntityIdx];
+    StringEntity entity = sb_StringEntities[in_EntityIdx];
     ex_Color = entity.color;
 
     // Compute the scaling factor applied to the glyph
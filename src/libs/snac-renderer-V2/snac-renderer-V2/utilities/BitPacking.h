@@ -0,0 +1,107 @@
+#pragma once
+
+
+#include <renderer/commons.h>
+
+#include <array>
+#include <concepts>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include <cassert>
+#include <cstdint>
+
+
+namespace ad::renderer {
+
+
+/// @brief A 32-bit word packing unsigned fields of `N_widths` bits each, starting from the least significant bits.
+///
+/// Intended as a data member of structures loaded in buffers (e.g. instance attributes),
+/// the layout being described once for both sides:
+/// the client packs with this class, and the shaders unpack with the macros from makeGlslUnpackDefines().
+template <unsigned int... N_widths>
+class BitPack
+{
+    static_assert(sizeof...(N_widths) > 0, "A pack must have at least one field.");
+    static_assert(((N_widths > 0) && ...), "Fields must not be empty.");
+    static_assert((N_widths + ...) <= 32, "Fields must fit in a 32-bit word.");
+
+public:
+    static constexpr std::size_t gFieldCount = sizeof...(N_widths);
+    static constexpr std::array<unsigned int, gFieldCount> gWidths{N_widths...};
+
+    static constexpr std::array<unsigned int, gFieldCount> gOffsets = []()
+    {
+        std::array<unsigned int, gFieldCount> offsets{};
+        unsigned int offset = 0;
+        for(std::size_t fieldIdx = 0; fieldIdx != gFieldCount; ++fieldIdx)
+        {
+            offsets[fieldIdx] = offset;
+            offset += gWidths[fieldIdx];
+        }
+        return offsets;
+    }();
+
+    /// @brief The largest value that can be stored in field `N_field`.
+    template <std::size_t N_field>
+    static constexpr std::uint32_t max()
+    { return mask(N_field); }
+
+    BitPack() = default;
+
+    /// @brief Pack one value per field, in field order.
+    /// @attention Values must fit in their field, which is only asserted:
+    /// values from outside the program (e.g. loaded) have to be validated against max() beforehand.
+    template <std::convertible_to<std::uint32_t>... VT_values>
+        requires (sizeof...(VT_values) == gFieldCount)
+    explicit BitPack(VT_values... aValues)
+    {
+        std::size_t fieldIdx = 0;
+        (store(fieldIdx++, static_cast<std::uint32_t>(aValues)), ...);
+    }
+
+    template <std::size_t N_field>
+    std::uint32_t get() const
+    { return (mWord >> gOffsets[N_field]) & mask(N_field); }
+
+    template <std::size_t N_field>
+    void set(std::uint32_t aValue)
+    { store(N_field, aValue); }
+
+    std::uint32_t word() const
+    { return mWord; }
+
+    /// @brief Return one function-like macro per field, named after `aMacroNames`,
+    /// which expands to the value of the field in the packed uint passed as argument.
+    /// @note Intended to be added to the defines of the programs reading the packed words.
+    static std::vector<graphics::MacroDefine> makeGlslUnpackDefines(
+        const std::array<std::string_view, gFieldCount> & aMacroNames)
+    {
+        std::vector<graphics::MacroDefine> result;
+        for(std::size_t fieldIdx = 0; fieldIdx != gFieldCount; ++fieldIdx)
+        {
+            result.push_back(std::string{aMacroNames[fieldIdx]} + "(packed)"
+                             + " (((packed) >> " + std::to_string(gOffsets[fieldIdx]) + "u)"
+                             + " & " + std::to_string(mask(fieldIdx)) + "u)");
+        }
+        return result;
+    }
+
+private:
+    static constexpr std::uint32_t mask(std::size_t aField)
+    { return (std::uint32_t)((std::uint64_t{1} << gWidths[aField]) - 1); }
+
+    void store(std::size_t aField, std::uint32_t aValue)
+    {
+        assert(aValue <= mask(aField) && "Value overflows its packed field.");
+        mWord = (mWord & ~(mask(aField) << gOffsets[aField]))
+                | ((aValue & mask(aField)) << gOffsets[aField]);
+    }
+
+    std::uint32_t mWord = 0;
+};
+
+
+} // namespace ad::renderer
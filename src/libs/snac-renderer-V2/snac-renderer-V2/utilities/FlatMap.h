@@ -0,0 +1,198 @@
+#pragma once
+
+
+#include <algorithm>
+#include <initializer_list>
+#include <iterator>
+#include <stdexcept>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+
+namespace ad::renderer {
+
+
+/// @brief Associative container storing its entries contiguously, sorted by key.
+///
+/// Intended for small maps with cheap keys (e.g. StringId), which are looked up much more often than modified:
+/// a lookup is a binary search over contiguous memory, and a copy is a single allocation.
+/// The interface mimics the subset of std::map used by the renderer.
+///
+/// @attention Keys must not be modified through iterators.
+template <class T_key, class T_mapped>
+class FlatMap
+{
+public:
+    using key_type = T_key;
+    using mapped_type = T_mapped;
+    using value_type = std::pair<T_key, T_mapped>;
+    using iterator = typename std::vector<value_type>::iterator;
+    using const_iterator = typename std::vector<value_type>::const_iterator;
+
+    FlatMap() = default;
+
+    /// @brief As for std::map, the first value is kept when a key is repeated.
+    FlatMap(std::initializer_list<value_type> aValues)
+    {
+        mValues.reserve(aValues.size());
+        for(const value_type & value : aValues)
+        {
+            emplace(value.first, value.second);
+        }
+    }
+
+    iterator begin()
+    { return mValues.begin(); }
+    iterator end()
+    { return mValues.end(); }
+    const_iterator begin() const
+    { return mValues.begin(); }
+    const_iterator end() const
+    { return mValues.end(); }
+
+    bool empty() const
+    { return mValues.empty(); }
+    std::size_t size() const
+    { return mValues.size(); }
+    void clear()
+    { mValues.clear(); }
+
+    iterator find(const T_key & aKey)
+    {
+        auto found = lowerBound(aKey);
+        return (found != end() && found->first == aKey) ? found : end();
+    }
+
+    const_iterator find(const T_key & aKey) const
+    {
+        auto found = lowerBound(aKey);
+        return (found != end() && found->first == aKey) ? found : end();
+    }
+
+    std::size_t count(const T_key & aKey) const
+    { return find(aKey) != end() ? 1 : 0; }
+
+    bool contains(const T_key & aKey) const
+    { return find(aKey) != end(); }
+
+    T_mapped & at(const T_key & aKey)
+    {
+        if(auto found = find(aKey); found != end())
+        {
+            return found->second;
+        }
+        throw std::out_of_range{"FlatMap::at() key is not present."};
+    }
+
+    const T_mapped & at(const T_key & aKey) const
+    {
+        if(auto found = find(aKey); found != end())
+        {
+            return found->second;
+        }
+        throw std::out_of_range{"FlatMap::at() key is not present."};
+    }
+
+    T_mapped & operator[](const T_key & aKey)
+    { return try_emplace(aKey).first->second; }
+
+    /// @brief Insert a value constructed from `aArgs` if `aKey` is not present.
+    template <class... VT_args>
+    std::pair<iterator, bool> try_emplace(const T_key & aKey, VT_args &&... aArgs)
+    {
+        auto position = lowerBound(aKey);
+        if(position != end() && position->first == aKey)
+        {
+            return {position, false};
+        }
+        position = mValues.emplace(position,
+                                   std::piecewise_construct,
+                                   std::forward_as_tuple(aKey),
+                                   std::forward_as_tuple(std::forward<VT_args>(aArgs)...));
+        return {position, true};
+    }
+
+    template <class T_value>
+    std::pair<iterator, bool> emplace(const T_key & aKey, T_value && aValue)
+    { return try_emplace(aKey, std::forward<T_value>(aValue)); }
+
+    template <class T_value>
+    std::pair<iterator, bool> insert_or_assign(const T_key & aKey, T_value && aValue)
+    {
+        auto [position, didInsert] = try_emplace(aKey, std::forward<T_value>(aValue));
+        if(!didInsert)
+        {
+            position->second = std::forward<T_value>(aValue);
+        }
+        return {position, didInsert};
+    }
+
+    std::size_t erase(const T_key & aKey)
+    {
+        if(auto found = find(aKey); found != end())
+        {
+            mValues.erase(found);
+            return 1;
+        }
+        return 0;
+    }
+
+    /// @brief Insert the entries of `aOther` whose key is not already present.
+    /// @note Contrary to std::map::merge(), `aOther` is left untouched.
+    void merge(const FlatMap & aOther)
+    {
+        if(aOther.empty())
+        {
+            return;
+        }
+
+        std::vector<value_type> merged;
+        merged.reserve(mValues.size() + aOther.mValues.size());
+        auto mine = mValues.begin();
+        auto other = aOther.mValues.begin();
+        while(mine != mValues.end() && other != aOther.mValues.end())
+        {
+            if(other->first < mine->first)
+            {
+                merged.push_back(*other++);
+            }
+            else
+            {
+                if(!(mine->first < other->first))
+                {
+                    // Same key, this map value takes precedence.
+                    ++other;
+                }
+                merged.push_back(std::move(*mine++));
+            }
+        }
+        std::move(mine, mValues.end(), std::back_inserter(merged));
+        std::copy(other, aOther.mValues.end(), std::back_inserter(merged));
+        mValues = std::move(merged);
+    }
+
+private:
+    iterator lowerBound(const T_key & aKey)
+    {
+        return std::lower_bound(mValues.begin(), mValues.end(), aKey,
+                                [](const value_type & aValue, const T_key & aSearched)
+                                {
+                                    return aValue.first < aSearched;
+                                });
+    }
+
+    const_iterator lowerBound(const T_key & aKey) const
+    {
+        return std::lower_bound(mValues.begin(), mValues.end(), aKey,
+                                [](const value_type & aValue, const T_key & aSearched)
+                                {
+                                    return aValue.first < aSearched;
+                                });
+    }
+
+    std::vector<value_type> mValues;
+};
+
+
+} // namespace ad::renderer
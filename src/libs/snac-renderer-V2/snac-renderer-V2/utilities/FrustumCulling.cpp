@@ -0,0 +1,169 @@
+#include "FrustumCulling.h"
+
+#include <algorithm>
+#include <limits>
+
+#include <cassert>
+#include <cmath>
+
+
+namespace ad::renderer {
+
+
+Frustum Frustum::FromViewProjection(const math::Matrix<4, 4, GLfloat> & aViewProjection)
+{
+    // With row vectors, clip coordinates are the dot product of the position with each column.
+    auto column = [&aViewProjection](int aColumn)
+    {
+        return math::Vec<4, GLfloat>{
+            aViewProjection.at(0, aColumn),
+            aViewProjection.at(1, aColumn),
+            aViewProjection.at(2, aColumn),
+            aViewProjection.at(3, aColumn),
+        };
+    };
+
+    const math::Vec<4, GLfloat> x = column(0);
+    const math::Vec<4, GLfloat> y = column(1);
+    const math::Vec<4, GLfloat> z = column(2);
+    const math::Vec<4, GLfloat> w = column(3);
+
+    // Inside the clip volume: -w <= x, y, z <= w
+    return Frustum{
+        .mPlanes = {{
+            w + x, // left
+            w - x, // right
+            w + y, // bottom
+            w - y, // top
+            w + z, // near
+            w - z, // far
+        }}
+    };
+}
+
+
+math::Box<GLfloat> transformAabb(const math::Box<GLfloat> & aBox,
+                                 const math::AffineMatrix<4, GLfloat> & aTransform)
+{
+    const math::Vec<3, GLfloat> halfExtent = aBox.mDimension.as<math::Vec>() / 2.f;
+    const math::Position<3, GLfloat> center = aBox.mPosition + halfExtent;
+
+    const math::Position<3, GLfloat> transformedCenter =
+        math::homogeneous::homogenize(math::homogeneous::makePosition(center) * aTransform).xyz();
+
+    // Each transformed half-extent is the sum of the absolute contributions of the local axes.
+    math::Vec<3, GLfloat> transformedHalf{0.f, 0.f, 0.f};
+    for(int column = 0; column != 3; ++column)
+    {
+        for(int row = 0; row != 3; ++row)
+        {
+            transformedHalf[column] += std::abs(aTransform.at(row, column)) * halfExtent[row];
+        }
+    }
+
+    return math::Box<GLfloat>{
+        .mPosition = transformedCenter - transformedHalf,
+        .mDimension = (2.f * transformedHalf).as<math::Size>(),
+    };
+}
+
+
+void FrustumCuller::clear()
+{
+    mCenterX.clear();
+    mCenterY.clear();
+    mCenterZ.clear();
+    mHalfX.clear();
+    mHalfY.clear();
+    mHalfZ.clear();
+}
+
+
+void FrustumCuller::reserve(std::size_t aCapacity)
+{
+    mCenterX.reserve(aCapacity);
+    mCenterY.reserve(aCapacity);
+    mCenterZ.reserve(aCapacity);
+    mHalfX.reserve(aCapacity);
+    mHalfY.reserve(aCapacity);
+    mHalfZ.reserve(aCapacity);
+}
+
+
+void FrustumCuller::push_back(const math::Box<GLfloat> & aBox)
+{
+    mHalfX.push_back(aBox.width() / 2.f);
+    mHalfY.push_back(aBox.height() / 2.f);
+    mHalfZ.push_back(aBox.depth() / 2.f);
+    mCenterX.push_back(aBox.xMin() + mHalfX.back());
+    mCenterY.push_back(aBox.yMin() + mHalfY.back());
+    mCenterZ.push_back(aBox.zMin() + mHalfZ.back());
+}
+
+
+void FrustumCuller::pushUnbounded()
+{
+    // The plane test is written so an infinite radius always passes (even when producing NaN).
+    constexpr GLfloat infinity = std::numeric_limits<GLfloat>::infinity();
+    mCenterX.push_back(0.f);
+    mCenterY.push_back(0.f);
+    mCenterZ.push_back(0.f);
+    mHalfX.push_back(infinity);
+    mHalfY.push_back(infinity);
+    mHalfZ.push_back(infinity);
+}
+
+
+void FrustumCuller::cullFrustum(const Frustum & aFrustum, std::vector<std::uint8_t> & aVisible)
+{
+    const std::size_t count = size();
+    mInside.assign(count, 1);
+
+    const GLfloat * centerX = mCenterX.data();
+    const GLfloat * centerY = mCenterY.data();
+    const GLfloat * centerZ = mCenterZ.data();
+    const GLfloat * halfX = mHalfX.data();
+    const GLfloat * halfY = mHalfY.data();
+    const GLfloat * halfZ = mHalfZ.data();
+    std::uint8_t * inside = mInside.data();
+
+    for(const math::Vec<4, GLfloat> & plane : aFrustum.mPlanes)
+    {
+        const GLfloat a = plane[0];
+        const GLfloat b = plane[1];
+        const GLfloat c = plane[2];
+        const GLfloat d = plane[3];
+        const GLfloat absA = std::abs(a);
+        const GLfloat absB = std::abs(b);
+        const GLfloat absC = std::abs(c);
+
+        // A box is outside the plane when its center signed distance is below minus
+        // the projection of its half-extents on the plane normal.
+        for(std::size_t boxIdx = 0; boxIdx != count; ++boxIdx)
+        {
+            const GLfloat distance = a * centerX[boxIdx] + b * centerY[boxIdx] + c * centerZ[boxIdx] + d;
+            const GLfloat radius = absA * halfX[boxIdx] + absB * halfY[boxIdx] + absC * halfZ[boxIdx];
+            inside[boxIdx] &= (std::uint8_t)!(distance + radius < 0.f);
+        }
+    }
+
+    for(std::size_t boxIdx = 0; boxIdx != count; ++boxIdx)
+    {
+        aVisible[boxIdx] |= inside[boxIdx];
+    }
+}
+
+
+std::size_t FrustumCuller::cull(std::span<const math::Matrix<4, 4, GLfloat>> aViewProjections,
+                                std::vector<std::uint8_t> & aVisible)
+{
+    aVisible.assign(size(), 0);
+    for(const math::Matrix<4, 4, GLfloat> & viewProjection : aViewProjections)
+    {
+        cullFrustum(Frustum::FromViewProjection(viewProjection), aVisible);
+    }
+    return (std::size_t)std::count(aVisible.begin(), aVisible.end(), std::uint8_t{1});
+}
+
+
+} // namespace ad::renderer
@@ -0,0 +1,83 @@
+#pragma once
+
+
+#include <renderer/GL_Loader.h>
+
+#include <math/Box.h>
+#include <math/Homogeneous.h>
+#include <math/Matrix.h>
+#include <math/Vector.h>
+
+#include <array>
+#include <span>
+#include <vector>
+
+#include <cstdint>
+
+
+namespace ad::renderer {
+
+
+/// @brief The 6 clipping planes of a view frustum, in the space the view-projection is applied to.
+///
+/// Each plane is stored as (a, b, c, d), so a point (x, y, z) is on the inner side when
+/// a*x + b*y + c*z + d >= 0. Planes are not normalized, which does not affect the sign of the test.
+struct Frustum
+{
+    /// @brief Extract the planes from a view-projection matrix (Gribb & Hartmann),
+    /// for the row-vector convention of the math library and OpenGL clip space.
+    static Frustum FromViewProjection(const math::Matrix<4, 4, GLfloat> & aViewProjection);
+
+    std::array<math::Vec<4, GLfloat>, 6> mPlanes;
+};
+
+
+/// @brief Return the axis aligned box bounding `aBox` once transformed by `aTransform`.
+math::Box<GLfloat> transformAabb(const math::Box<GLfloat> & aBox,
+                                 const math::AffineMatrix<4, GLfloat> & aTransform);
+
+
+/// @brief Tests a batch of bounding boxes against view frusta.
+///
+/// Boxes are stored as a structure of arrays (centers and half-extents),
+/// so the test is a branchless loop over contiguous floats, that the compiler vectorizes.
+/// The test is conservative: a box can be reported visible while being outside of a frustum
+/// (near its corners), but a box intersecting a frustum is never culled.
+class FrustumCuller
+{
+public:
+    void clear();
+
+    void reserve(std::size_t aCapacity);
+
+    void push_back(const math::Box<GLfloat> & aBox);
+
+    /// @brief Push a box that is never culled (e.g. for geometry without reliable bounds).
+    void pushUnbounded();
+
+    std::size_t size() const
+    { return mCenterX.size(); }
+
+    /// @brief Mark the boxes intersecting at least one of the frusta.
+    /// @param aViewProjections The view-projection matrix of each frustum.
+    /// @param aVisible Receives one entry per box, non-zero if the box is visible.
+    /// @return The number of visible boxes.
+    std::size_t cull(std::span<const math::Matrix<4, 4, GLfloat>> aViewProjections,
+                     std::vector<std::uint8_t> & aVisible);
+
+private:
+    void cullFrustum(const Frustum & aFrustum, std::vector<std::uint8_t> & aVisible);
+
+    std::vector<GLfloat> mCenterX;
+    std::vector<GLfloat> mCenterY;
+    std::vector<GLfloat> mCenterZ;
+    std::vector<GLfloat> mHalfX;
+    std::vector<GLfloat> mHalfY;
+    std::vector<GLfloat> mHalfZ;
+
+    // Scratch storage, for the visibility against a single frustum.
+    std::vector<std::uint8_t> mInside;
+};
+
+
+} // namespace ad::renderer
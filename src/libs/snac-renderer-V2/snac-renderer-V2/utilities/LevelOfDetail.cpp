@@ -0,0 +1,89 @@
+#include "LevelOfDetail.h"
+
+#include "../Model.h"
+
+#include <algorithm>
+#include <limits>
+
+#include <cmath>
+
+
+namespace ad::renderer {
+
+
+LodView LodView::FromViewProjection(const math::Matrix<4, 4, GLfloat> & aViewProjection)
+{
+    // With row vectors, clip coordinates are the dot product of the position with each column.
+    // The y column maps world lengths to clip-space lengths (before the perspective division).
+    const math::Vec<3, GLfloat> y{
+        aViewProjection.at(0, 1),
+        aViewProjection.at(1, 1),
+        aViewProjection.at(2, 1),
+    };
+
+    return LodView{
+        .mW = {
+            aViewProjection.at(0, 3),
+            aViewProjection.at(1, 3),
+            aViewProjection.at(2, 3),
+            aViewProjection.at(3, 3),
+        },
+        .mClipScale = y.getNorm(),
+    };
+}
+
+
+GLfloat LodView::getWorldLength(GLfloat aNdcLength, math::Position<3, GLfloat> aPosition) const
+{
+    // w is constant (1) with orthographic projections, the distance to the view plane with perspective.
+    const GLfloat w = math::homogeneous::makePosition(aPosition).as<math::Vec>().dot(mW);
+    return std::max(0.f, aNdcLength * w / mClipScale);
+}
+
+
+GLfloat getMaxScale(const math::AffineMatrix<4, GLfloat> & aTransform)
+{
+    // With row vectors, each row of the linear part is the image of a basis vector.
+    GLfloat result = 0.f;
+    for(int row = 0; row != 3; ++row)
+    {
+        const math::Vec<3, GLfloat> axis{
+            aTransform.at(row, 0),
+            aTransform.at(row, 1),
+            aTransform.at(row, 2),
+        };
+        result = std::max(result, axis.getNorm());
+    }
+    return result;
+}
+
+
+std::size_t selectLod(const Part & aPart,
+                      const LodInstance & aInstance,
+                      std::span<const LodView> aViews,
+                      GLfloat aMaxError)
+{
+    if(aPart.mLods.empty() || aMaxError <= 0.f || aInstance.mScale <= 0.f)
+    {
+        return 0;
+    }
+
+    // The error allowed in the Part space, by the view where the Part appears the largest.
+    GLfloat allowedError = std::numeric_limits<GLfloat>::max();
+    for(const LodView & view : aViews)
+    {
+        allowedError = std::min(allowedError, view.getWorldLength(aMaxError, aInstance.mCenter));
+    }
+    allowedError /= aInstance.mScale;
+
+    // The levels are ordered by increasing error.
+    auto coarser = std::find_if(aPart.mLods.begin(), aPart.mLods.end(),
+                                [allowedError](const PartLod & aLod)
+                                {
+                                    return aLod.mError > allowedError;
+                                });
+    return (std::size_t)(coarser - aPart.mLods.begin());
+}
+
+
+} // namespace ad::renderer
@@ -0,0 +1,61 @@
+#pragma once
+
+
+#include <renderer/GL_Loader.h>
+
+#include <math/Box.h>
+#include <math/Homogeneous.h>
+#include <math/Matrix.h>
+#include <math/Vector.h>
+
+#include <span>
+
+
+namespace ad::renderer {
+
+
+struct Part;
+
+
+/// @brief How a view projects world space lengths, to estimate the screen size of the levels of detail errors.
+struct LodView
+{
+    static LodView FromViewProjection(const math::Matrix<4, 4, GLfloat> & aViewProjection);
+
+    /// @brief Return the world space length projecting to `aNdcLength` (relative to half the viewport height)
+    /// at `aPosition`, or zero if the position is on or behind the view plane.
+    GLfloat getWorldLength(GLfloat aNdcLength, math::Position<3, GLfloat> aPosition) const;
+
+    // Column of the view-projection giving the clip-space w coordinate (row-vector convention).
+    math::Vec<4, GLfloat> mW;
+    // Scaling of world lengths to vertical clip-space lengths.
+    GLfloat mClipScale;
+};
+
+
+/// @brief The world placement of a Part instance, required to project the errors of its levels of detail.
+struct LodInstance
+{
+    math::Position<3, GLfloat> mCenter;
+    // Scaling from the Part space (in which the errors are expressed) to the world space.
+    GLfloat mScale;
+};
+
+
+/// @brief The largest scaling applied by the linear part of `aTransform`.
+/// @note It is exact for a scaling followed by a rotation.
+GLfloat getMaxScale(const math::AffineMatrix<4, GLfloat> & aTransform);
+
+
+/// @brief Return the level of detail of `aPart` to draw: 0 for the Part itself, `i` for `aPart.mLods[i - 1]`.
+///
+/// This is the coarsest level whose error, projected by each of `aViews`, does not exceed `aMaxError`.
+/// @param aMaxError Projected error, relative to half the viewport height (i.e. in normalized device coordinates).
+/// A non-positive value always selects the Part itself.
+std::size_t selectLod(const Part & aPart,
+                      const LodInstance & aInstance,
+                      std::span<const LodView> aViews,
+                      GLfloat aMaxError);
+
+
+} // namespace ad::renderer
@@ -1,6 +1,5 @@
 #include "LoadUbos.h"
 
-#include "../Constants.h"
 // TODO Ad 2023/10/18: Should get rid of this repeated implementation
 #include "../RendererReimplement.h"
 
@@ -63,8 +62,6 @@ void updateOffsetInLightViewProjectionUbo(const graphics::UniformBufferObject &
 void loadJoints(const graphics::UniformBufferObject & aUbo,
                 std::span<math::AffineMatrix<4, GLfloat>> aJointMatrices)
 {
-    // Check that we will not exceed the UBO capacity
-    assert(aJointMatrices.size() <= gMaxJoints);
     renderer::proto::load(aUbo,
                           aJointMatrices,
                           graphics::BufferHint::StreamDraw);
@@ -0,0 +1,83 @@
+#pragma once
+
+
+#include "../Handle.h"
+
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include <cassert>
+#include <cstdint>
+
+
+namespace ad::renderer {
+
+
+// TODO Ad 2023/10/05: for OpenGL resource, maybe we should directly use the GL name?
+// or do we want to reimplement Handle<> in term of index in storage containers?
+/// @brief Hackish class, associating a resource to an integer value.
+///
+/// The value is suitable to compose a DrawEntry::Key via bitwise operations.
+template <class T_resource>
+struct ResourceIdMap
+{
+    /// @param aValueBits The width of the key field, which bounds the number of distinct resources.
+    explicit ResourceIdMap(unsigned int aValueBits) :
+        mMaxValue{aValueBits >= 64 ? std::numeric_limits<std::uint64_t>::max()
+                                   : (std::uint64_t{1} << aValueBits) - 1}
+    {
+        clear();
+    }
+
+    /// @brief Forget all resources, the values might then be reassigned.
+    void clear()
+    {
+        mResourceToId.clear();
+        mIdToResource.clear();
+        // By adding the nullptr as the zero value, this helps debugging
+        get(nullptr);
+        assert(get(nullptr)== 0);
+    }
+
+    /// @brief Get the value associated to provided resource.
+    /// A given map instance will always return the same value for the same resource.
+    /// @throw std::overflow_error if the resource would be assigned a value that does not fit in the field.
+    std::uint64_t get(Handle<T_resource> aResource)
+    {
+        auto [iterator, didInsert] = mResourceToId.try_emplace(aResource,
+                                                               (std::uint64_t)mResourceToId.size());
+        if(didInsert)
+        {
+            if(iterator->second > mMaxValue)
+            {
+                mResourceToId.erase(iterator);
+                throw std::overflow_error{
+                    "Too many distinct resources for a draw sort key field of value at most "
+                    + std::to_string(mMaxValue) + "."};
+            }
+            mIdToResource.push_back(aResource);
+        }
+        return iterator->second;
+    }
+
+    /// @brief Return the resource from it value.
+    Handle<T_resource> reverseLookup(std::uint64_t aValue) const
+    {
+        if(aValue < mIdToResource.size())
+        {
+            return mIdToResource[aValue];
+        }
+        throw std::logic_error{"The provided value is not present in this ResourceIdMap."};
+    }
+
+    std::uint64_t mMaxValue;
+    std::unordered_map<Handle<T_resource>, std::uint64_t> mResourceToId;
+    // Values are assigned sequentially, so they index the resources.
+    std::vector<Handle<T_resource>> mIdToResource;
+};
+
+
+} // namespace ad::renderer
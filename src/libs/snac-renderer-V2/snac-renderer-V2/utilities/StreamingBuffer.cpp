@@ -0,0 +1,153 @@
+#include "StreamingBuffer.h"
+
+#include "../Logging.h"
+
+#include <profiler/GlApi.h>
+
+#include <algorithm>
+#include <stdexcept>
+
+
+namespace ad::renderer {
+
+
+namespace {
+
+    constexpr GLbitfield gStorageFlags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+
+    // Timeout of each client wait, in nanoseconds, before checking the fence again.
+    constexpr GLuint64 gWaitTimeout = 1'000'000;
+
+    GLintptr alignUp(GLintptr aOffset, GLsizeiptr aAlignment)
+    {
+        return ((aOffset + aAlignment - 1) / aAlignment) * aAlignment;
+    }
+
+} // unnamed namespace
+
+
+StreamingBuffer::StreamingBuffer(GLsizeiptr aRegionCapacity)
+{
+    GLint uniformOffsetAlignment;
+    glGetIntegerv(GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, &uniformOffsetAlignment);
+    mUniformOffsetAlignment = uniformOffsetAlignment;
+
+    GLint shaderStorageOffsetAlignment;
+    glGetIntegerv(GL_SHADER_STORAGE_BUFFER_OFFSET_ALIGNMENT, &shaderStorageOffsetAlignment);
+    mShaderStorageOffsetAlignment = shaderStorageOffsetAlignment;
+
+    allocateStorage(aRegionCapacity);
+}
+
+
+StreamingBuffer::~StreamingBuffer()
+{
+    for(GLsync fence : mFences)
+    {
+        // Deleting a null sync is silently ignored.
+        glDeleteSync(fence);
+    }
+    // The buffers are implicitly unmapped when they are deleted.
+}
+
+
+void StreamingBuffer::allocateStorage(GLsizeiptr aRegionCapacity)
+{
+    // Each region starts at an offset that satisfies the buffer-backed blocks alignment requirements.
+    mRegionCapacity = alignUp(aRegionCapacity,
+                              std::max(mUniformOffsetAlignment, mShaderStorageOffsetAlignment));
+    const GLsizeiptr size = mRegionCapacity * gFrameRegions;
+
+    if(mStorage)
+    {
+        mRetired.push_back(std::move(mStorage));
+    }
+    mStorage = std::make_unique<Storage>();
+
+    glBindBuffer(GL_COPY_WRITE_BUFFER, mStorage->mBuffer);
+    glBufferStorage(GL_COPY_WRITE_BUFFER, size, nullptr, gStorageFlags);
+    mStorage->mMapped = static_cast<std::byte *>(glMapBufferRange(GL_COPY_WRITE_BUFFER, 0, size, gStorageFlags));
+    glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+
+    if(mStorage->mMapped == nullptr)
+    {
+        throw std::runtime_error{"Could not map the storage of a streaming buffer."};
+    }
+
+    // The fences protect the regions of the replaced storage, which will not be written anymore.
+    for(GLsync & fence : mFences)
+    {
+        glDeleteSync(fence);
+        fence = nullptr;
+    }
+    mHead = mRegion * mRegionCapacity;
+}
+
+
+void StreamingBuffer::beginFrame()
+{
+    mRegion = (mRegion + 1) % gFrameRegions;
+    mHead = mRegion * mRegionCapacity;
+
+    if(GLsync & fence = mFences[mRegion])
+    {
+        // Poll first, so only the fences actually blocking the CPU are reported.
+        GLenum status = glClientWaitSync(fence, 0, 0);
+        if(status == GL_TIMEOUT_EXPIRED)
+        {
+            gl.countFenceWait();
+            do
+            {
+                status = glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, gWaitTimeout);
+            } while(status == GL_TIMEOUT_EXPIRED);
+        }
+
+        if(status == GL_WAIT_FAILED)
+        {
+            SELOG(error)("Waiting on a streaming buffer fence failed.");
+        }
+
+        glDeleteSync(fence);
+        fence = nullptr;
+    }
+}
+
+
+void StreamingBuffer::endFrame()
+{
+    assert(mFences[mRegion] == nullptr);
+    mFences[mRegion] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+
+    // The commands reading the retired buffers are issued,
+    // GL defers the actual release of their storage until those commands complete.
+    mRetired.clear();
+}
+
+
+StreamingBuffer::Range StreamingBuffer::allocate(GLsizeiptr aSize, GLsizeiptr aAlignment)
+{
+    assert(aAlignment > 0);
+
+    GLintptr offset = alignUp(mHead, aAlignment);
+    if(offset + aSize > (GLintptr)(mRegion + 1) * mRegionCapacity)
+    {
+        const GLsizeiptr regionCapacity = std::max(2 * mRegionCapacity, aSize + aAlignment);
+        SELOG(debug)("Streaming buffer region of {} bytes overflowed, reallocating regions of {} bytes.",
+                     mRegionCapacity, regionCapacity);
+        allocateStorage(regionCapacity);
+        offset = alignUp(mHead, aAlignment);
+    }
+    mHead = offset + aSize;
+
+    gl.countMappedWrite(aSize);
+
+    return Range{
+        .mBuffer = mStorage->mBuffer,
+        .mOffset = offset,
+        .mSize = aSize,
+        .mMapped = mStorage->mMapped + offset,
+    };
+}
+
+
+} // namespace ad::renderer
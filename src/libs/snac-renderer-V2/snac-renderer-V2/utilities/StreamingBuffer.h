@@ -0,0 +1,110 @@
+#pragma once
+
+
+#include "../Repositories.h"
+
+#include <renderer/GL_Loader.h>
+#include <renderer/VertexSpecification.h>
+
+#include <array>
+#include <memory>
+#include <span>
+#include <vector>
+
+#include <cassert>
+#include <cstddef>
+
+
+namespace ad::renderer {
+
+
+/// @brief A persistently mapped buffer, from which per-frame data is sub-allocated and written in place by the CPU.
+///
+/// The storage is split in gFrameRegions regions, used in turn by successive frames.
+/// Each frame linearly allocates ranges from its region, which are bound with glBindBufferRange().
+/// The region is fenced at the end of the frame, and the fence is waited on before the region is reused,
+/// so the CPU never overwrites memory the GPU might still be reading, without any implicit synchronization.
+///
+/// When a frame overflows its region, the buffer is replaced by a larger one:
+/// the replaced buffer stays mapped until the end of the frame, so the ranges already allocated remain valid.
+///
+/// Bytes written and fences waited on are reported to GlApi metrics.
+/// @note Requires OpenGL 4.4 (glBufferStorage).
+class StreamingBuffer
+{
+public:
+    static constexpr std::size_t gFrameRegions = 3;
+
+    struct Range
+    {
+        BufferRange binding() const
+        { return BufferRange{mBuffer, mOffset, mSize}; }
+
+        /// @brief View the mapped memory as an array of `T_element`.
+        template <class T_element>
+        std::span<T_element> as() const
+        {
+            assert(mSize % sizeof(T_element) == 0);
+            return {reinterpret_cast<T_element *>(mMapped), mSize / sizeof(T_element)};
+        }
+
+        GLuint mBuffer;
+        GLintptr mOffset;
+        GLsizeiptr mSize;
+        std::byte * mMapped;
+    };
+
+    explicit StreamingBuffer(GLsizeiptr aRegionCapacity);
+    ~StreamingBuffer();
+
+    StreamingBuffer(const StreamingBuffer &) = delete;
+    StreamingBuffer & operator=(const StreamingBuffer &) = delete;
+
+    /// @brief Make the next region current, waiting for the GPU to complete the commands of the frame that last used it.
+    void beginFrame();
+
+    /// @brief Fence the commands issued until now, which might read the current region.
+    void endFrame();
+
+    /// @brief Allocate `aSize` bytes from the current region, at an offset multiple of `aAlignment`.
+    /// @note The client is expected to write the whole range, this is what is reported as written memory.
+    Range allocate(GLsizeiptr aSize, GLsizeiptr aAlignment);
+
+    /// @brief Allocate a range suitable to back a uniform block, holding `aCount` elements.
+    template <class T_element>
+    Range allocateUniform(std::size_t aCount)
+    { return allocate(aCount * sizeof(T_element), mUniformOffsetAlignment); }
+
+    /// @brief Allocate a range suitable to back a shader storage block, holding `aCount` elements.
+    template <class T_element>
+    Range allocateShaderStorage(std::size_t aCount)
+    { return allocate(aCount * sizeof(T_element), mShaderStorageOffsetAlignment); }
+
+    GLsizeiptr getRegionCapacity() const
+    { return mRegionCapacity; }
+
+private:
+    struct Storage
+    {
+        graphics::BufferAny mBuffer;
+        std::byte * mMapped = nullptr;
+    };
+
+    /// @brief Replace the storage with a new one, whose regions have `aRegionCapacity` bytes.
+    void allocateStorage(GLsizeiptr aRegionCapacity);
+
+    std::unique_ptr<Storage> mStorage;
+    // Replaced storages, which might back ranges allocated during the current frame.
+    std::vector<std::unique_ptr<Storage>> mRetired;
+
+    GLsizeiptr mRegionCapacity = 0;
+    GLsizeiptr mUniformOffsetAlignment = 0;
+    GLsizeiptr mShaderStorageOffsetAlignment = 0;
+    std::size_t mRegion = gFrameRegions - 1; // so the first frame uses region 0
+    // Next free offset, from the start of the buffer.
+    GLintptr mHead = 0;
+    std::array<GLsync, gFrameRegions> mFences{};
+};
+
+
+} // namespace ad::renderer
@@ -116,6 +116,7 @@ void addVertexAttribute(Handle<VertexStream> aVertexStream,
                 .mOffset = 0, // No interleaving is hardcoded at the moment
                 .mComponentType = aAttribute.mComponentType,
             },
+            .mNormalized = aAttribute.mNormalized,
         }
     );
 
@@ -148,6 +149,7 @@ void addInterleavedAttributes(Handle<VertexStream> aVertexStream,
                     .mOffset = offset,
                     .mComponentType = attribute.mComponentType,
                 },
+                .mNormalized = attribute.mNormalized,
             });
     }
 
@@ -12,12 +12,19 @@ struct AttributeDescription
     // To replace wih graphics::ClientAttribute if we support interleaved buffers (i.e. with offset)
     graphics::AttributeDimension mDimension;
     GLenum mComponentType;   // data individual components' type.
+    // Integer components are mapped to [0, 1] or [-1, 1] (i.e. unsigned or signed normalized)
+    bool mNormalized = false;
 };
 
 
 /// @brief Return the byte size of an attribute.
 inline GLuint getByteSize(AttributeDescription aAttribute)
-{ return aAttribute.mDimension.countComponents() * graphics::getByteSize(aAttribute.mComponentType); }
+{ 
+    // Half-floats do not have a C++ type, which graphics::getByteSize() maps the component types to.
+    GLuint componentSize = aAttribute.mComponentType == GL_HALF_FLOAT ?
+        2 : graphics::getByteSize(aAttribute.mComponentType);
+    return aAttribute.mDimension.countComponents() * componentSize;
+}
 
 
 Handle<graphics::BufferAny> makeBuffer(GLsizei aElementSize,
@@ -0,0 +1,178 @@
+#pragma once
+
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <exception>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include <cstddef>
+
+
+namespace ad {
+
+
+/// @brief A fixed pool of worker threads, executing batches of indexed jobs.
+///
+/// A batch is submitted with parallelFor(), which blocks until all jobs of the batch returned.
+/// The calling thread participates in the batch, so a pool with zero workers degrades to a serial loop.
+///
+/// @note Batches are not reentrant: a job must not submit a batch to the pool executing it.
+class JobPool
+{
+public:
+    /// @brief Leave one hardware thread for the submitting thread, which also executes jobs.
+    static unsigned int DefaultWorkerCount()
+    { return std::max(1u, std::thread::hardware_concurrency()) - 1; }
+
+    explicit JobPool(unsigned int aWorkerCount = DefaultWorkerCount())
+    {
+        mWorkers.reserve(aWorkerCount);
+        for(unsigned int i = 0; i != aWorkerCount; ++i)
+        {
+            mWorkers.emplace_back([this](){ work(); });
+        }
+    }
+
+    ~JobPool()
+    {
+        {
+            std::lock_guard lock{mMutex};
+            mStop = true;
+        }
+        mWakeWorkers.notify_all();
+        for(std::thread & worker : mWorkers)
+        {
+            worker.join();
+        }
+    }
+
+    JobPool(const JobPool &) = delete;
+    JobPool & operator=(const JobPool &) = delete;
+
+    std::size_t countWorkers() const
+    { return mWorkers.size(); }
+
+    /// @brief Invoke `aJob(i)` for each `i` in [0, aCount), distributed over the workers and the calling thread.
+    ///
+    /// Blocks until all invocations returned.
+    /// If any invocation throws, the first exception is rethrown on the calling thread
+    /// (the remaining jobs of the batch are still executed).
+    template <class T_job>
+    void parallelFor(std::size_t aCount, T_job && aJob)
+    {
+        if(aCount == 0)
+        {
+            return;
+        }
+        else if(aCount == 1)
+        {
+            // Not worth waking the workers.
+            aJob(0);
+            return;
+        }
+
+        {
+            std::unique_lock lock{mMutex};
+            // A worker might still be leaving the previous batch (after joining it too late to get a job).
+            mBatchDone.wait(lock, [this](){ return mActiveWorkers == 0; });
+
+            mJob = const_cast<void *>(static_cast<const void *>(&aJob));
+            mInvoke = [](void * aJobPtr, std::size_t aIndex)
+            {
+                (*static_cast<std::remove_reference_t<T_job> *>(aJobPtr))(aIndex);
+            };
+            mCount = aCount;
+            mNext.store(0, std::memory_order_relaxed);
+            mException = nullptr;
+            ++mGeneration;
+        }
+        mWakeWorkers.notify_all();
+
+        drain();
+
+        std::exception_ptr exception;
+        {
+            std::unique_lock lock{mMutex};
+            mBatchDone.wait(lock, [this](){ return mActiveWorkers == 0; });
+            exception = std::exchange(mException, nullptr);
+        }
+
+        if(exception)
+        {
+            std::rethrow_exception(exception);
+        }
+    }
+
+private:
+    void work()
+    {
+        unsigned int seenGeneration = 0;
+        std::unique_lock lock{mMutex};
+        while(true)
+        {
+            mWakeWorkers.wait(lock, [&](){ return mStop || mGeneration != seenGeneration; });
+            if(mStop)
+            {
+                return;
+            }
+            seenGeneration = mGeneration;
+
+            ++mActiveWorkers;
+            lock.unlock();
+            drain();
+            lock.lock();
+            if(--mActiveWorkers == 0)
+            {
+                mBatchDone.notify_all();
+            }
+        }
+    }
+
+    /// @brief Execute jobs of the current batch until none are left to claim.
+    void drain()
+    {
+        for(std::size_t index = mNext.fetch_add(1, std::memory_order_relaxed);
+            index < mCount;
+            index = mNext.fetch_add(1, std::memory_order_relaxed))
+        {
+            try
+            {
+                mInvoke(mJob, index);
+            }
+            catch(...)
+            {
+                std::lock_guard lock{mMutex};
+                if(!mException)
+                {
+                    mException = std::current_exception();
+                }
+            }
+        }
+    }
+
+    std::mutex mMutex;
+    std::condition_variable mWakeWorkers;
+    std::condition_variable mBatchDone;
+
+    // Current batch, only modified under mMutex while no worker is active.
+    void * mJob = nullptr;
+    void (*mInvoke)(void *, std::size_t) = nullptr;
+    std::size_t mCount = 0;
+    std::atomic<std::size_t> mNext{0};
+    std::exception_ptr mException;
+
+    unsigned int mGeneration = 0;
+    unsigned int mActiveWorkers = 0;
+    bool mStop = false;
+
+    std::vector<std::thread> mWorkers;
+};
+
+
+} // namespace ad